@@ -0,0 +1,106 @@
+/*
+ * KDevelop Debugger Support
+ *
+ * Copyright 2016  Aetf <aetf@unlimitedcodeworks.xyz>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "test_treemodel.h"
+
+#include <debugger/util/treeitem.h>
+#include <debugger/util/treemodel.h>
+
+#include <QTest>
+
+QTEST_MAIN(KDevelop::TestTreeModel)
+
+using namespace KDevelop;
+
+namespace {
+class TestItem : public TreeItem
+{
+public:
+    explicit TestItem(TreeModel* model, TreeItem* parent = nullptr)
+        : TreeItem(model, parent)
+    {
+        setData({QStringLiteral("item")});
+    }
+
+    void fetchMoreChildren() override { ++fetchCount; }
+
+    void addPage(int count, bool more)
+    {
+        for (int i = 0; i < count; ++i) {
+            appendChild(new TestItem(model(), this));
+        }
+        setHasMore(more);
+    }
+
+    int fetchCount = 0;
+};
+}
+
+void TestTreeModel::testEllipsisFetchesWhenShown()
+{
+    TreeModel model({QStringLiteral("Name")});
+    auto* root = new TestItem(&model);
+    model.setRootItem(root);
+    QCOMPARE(root->fetchCount, 1);
+
+    root->addPage(2, true);
+    QCOMPARE(model.rowCount(), 3);
+    const QModelIndex ellipsis = model.index(2, 0);
+    QCOMPARE(ellipsis.data().toString(), QStringLiteral("..."));
+
+    // the next page is requested once, after painting
+    model.shown(ellipsis);
+    model.shown(ellipsis);
+    QCOMPARE(root->fetchCount, 1);
+    QTRY_COMPARE(root->fetchCount, 2);
+    model.clicked(ellipsis);
+    QCoreApplication::processEvents();
+    QCOMPARE(root->fetchCount, 2);
+
+    // the page replaces the ellipsis by a new one
+    root->addPage(2, true);
+    QCOMPARE(model.rowCount(), 5);
+    model.clicked(model.index(4, 0));
+    QCOMPARE(root->fetchCount, 3);
+
+    root->addPage(1, false);
+    QCOMPARE(model.rowCount(), 5);
+    QCOMPARE(model.index(4, 0).data().toString(), QStringLiteral("item"));
+}
+
+void TestTreeModel::testEllipsisOfFirstPage()
+{
+    TreeModel model({QStringLiteral("Name")});
+    auto* root = new TestItem(&model);
+    model.setRootItem(root);
+    root->addPage(0, true);
+    QCOMPARE(model.rowCount(), 1);
+
+    // the first page is fetched when expanding the parent, not when showing it
+    const QModelIndex ellipsis = model.index(0, 0);
+    model.shown(ellipsis);
+    QCoreApplication::processEvents();
+    QCOMPARE(root->fetchCount, 1);
+
+    model.clicked(ellipsis);
+    QCOMPARE(root->fetchCount, 2);
+}
@@ -22,6 +22,7 @@
 #include "treeitem.h"
 
 #include <QModelIndex>
+#include <QTimer>
 
 #include <debug.h>
 #include "treemodel.h"
@@ -186,8 +187,9 @@ class EllipsisItem : public TreeItem
 {
     Q_OBJECT
 public:
-    EllipsisItem(TreeModel *model, TreeItem *parent)
+    EllipsisItem(TreeModel *model, TreeItem *parent, bool firstPage)
     : TreeItem(model, parent)
+    , firstPage_(firstPage)
     {
         const int dataCount = model->columnCount(QModelIndex());
         QVector<QVariant> data;
@@ -203,10 +205,37 @@ public:
         qCDebug(DEBUGGER) << "Ellipsis item clicked";
         /* FIXME: restore
            Q_ASSERT (parentItem->hasMore()); */
-        parentItem->fetchMoreChildren();
+        fetchParentChildren();
+    }
+
+    void shown() override
+    {
+        // The first page is fetched when the parent is expanded, further
+        // pages once the ellipsis is scrolled into view.
+        if (firstPage_ || fetchScheduled_)
+            return;
+
+        // The view is painting, so change the model afterwards.
+        fetchScheduled_ = true;
+        QTimer::singleShot(0, this, &EllipsisItem::fetchParentChildren);
     }
 
     void fetchMoreChildren() override {}
+
+private:
+    void fetchParentChildren()
+    {
+        // The fetched children replace this item, so only request
+        // the next page once.
+        if (fetchRequested_)
+            return;
+        fetchRequested_ = true;
+        parentItem->fetchMoreChildren();
+    }
+
+    const bool firstPage_;
+    bool fetchScheduled_ = false;
+    bool fetchRequested_ = false;
 };
 
 void TreeItem::setHasMore(bool more)
@@ -218,7 +247,7 @@ void TreeItem::setHasMore(bool more)
     if (more && !more_)
     {
         model_->beginInsertRows(index, childItems.size(), childItems.size());
-        ellipsis_ = new EllipsisItem (model(), this);
+        ellipsis_ = new EllipsisItem (model(), this, childItems.isEmpty());
         more_ = more;
         model_->endInsertRows();
     }
@@ -243,7 +272,7 @@ void TreeItem::setHasMoreInitial(bool more)
 
     if (more)
     {
-        ellipsis_ = new EllipsisItem (model(), this);
+        ellipsis_ = new EllipsisItem (model(), this, childItems.isEmpty());
     }
 }
 
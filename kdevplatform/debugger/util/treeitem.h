@@ -109,6 +109,9 @@ protected: // Backend implementation of Model/View
     void setExpanded(bool b);
 
     virtual void clicked() {}
+    /** Called when the item is painted in a view.  The model must not
+        be changed from here, as the view is still painting.  */
+    virtual void shown() {}
     virtual QVariant icon(int column) const;
 
 protected:
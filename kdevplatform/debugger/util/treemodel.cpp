@@ -209,6 +209,12 @@ void TreeModel::clicked(const QModelIndex &index)
     item->clicked();
 }
 
+void TreeModel::shown(const QModelIndex &index)
+{
+    TreeItem* item = itemForIndex(index);
+    item->shown();
+}
+
 bool TreeModel::setData(const QModelIndex& index, const QVariant& value,
                         int role)
 {
@@ -47,6 +47,7 @@ public:
     void expanded(const QModelIndex &index);
     void collapsed(const QModelIndex &index);
     void clicked(const QModelIndex &index);
+    void shown(const QModelIndex &index);
 
     void setEditable(bool);
     TreeItem* root() const;
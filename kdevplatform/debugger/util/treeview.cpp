@@ -62,6 +62,15 @@ void AsyncTreeView::slotClicked(const QModelIndex &index)
     resizeColumns();
 }
 
+void AsyncTreeView::drawRow(QPainter* painter, const QStyleOptionViewItem& options,
+                            const QModelIndex& index) const
+{
+    QTreeView::drawRow(painter, options, index);
+
+    // lets items such as "..." fetch more data once they are visible
+    static_cast<TreeModel*>(m_proxy->sourceModel())->shown(m_proxy->mapToSource(index));
+}
+
 QSize AsyncTreeView::sizeHint() const
 {
     //Assuming that columns are always resized to fit their contents, return a size that will fit all without a scrollbar
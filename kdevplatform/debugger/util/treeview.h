@@ -43,6 +43,10 @@ class TreeModel;
         // Well, I really, really, need this.
         using QTreeView::indexRowSizeHint;
 
+    protected:
+        void drawRow(QPainter* painter, const QStyleOptionViewItem& options,
+                     const QModelIndex& index) const override;
+
     private Q_SLOTS:
         void slotExpanded(const QModelIndex &index);
         void slotCollapsed(const QModelIndex &index);
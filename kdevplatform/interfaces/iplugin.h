@@ -67,6 +67,7 @@ class IPluginPrivate;
  * X-KDevelop-Category=
  * X-KDevelop-Mode=GUI
  * X-KDevelop-LoadMode=
+ * X-KDevelop-LoadOnDemand=
  * X-KDevelop-Languages=
  * X-KDevelop-SupportedMimeTypes=
  * X-KDevelop-Interfaces=
@@ -110,6 +111,9 @@ class IPluginPrivate;
  * explanation) (required);
  * - <i>X-KDevelop-LoadMode</i> can be set to AlwaysOn in which case the plugin will
  *   never be unloaded even if requested via the API. (optional);
+ * - <i>X-KDevelop-LoadOnDemand</i> can be set to true for global plugins which are only
+ *   used through their X-KDevelop-Interfaces. Such plugins are not loaded at startup,
+ *   but on the first request for one of their interfaces (optional);
  *
  * Plugin scope can be either:
  * - Global
@@ -50,6 +50,8 @@ class ProjectBaseItem;
 class ProjectFileItem;
 class ProjectFolderItem;
 class IndexedString;
+class ProjectFileSet;
+struct ProjectFileSetDelta;
 
 /**
  * \brief Object which represents a KDevelop project
@@ -127,7 +129,26 @@ public:
 
     virtual void addToFileSet( ProjectFileItem* item ) = 0;
     virtual void removeFromFileSet( ProjectFileItem* item ) = 0;
+    /**
+     * Adds or removes the @p path of a file which is stored compactly in the project model,
+     * i.e. which has no ProjectFileItem, see ProjectFolderItem::appendCompactFile().
+     *
+     * Emits filePathAddedToSet() and filePathRemovedFromSet() respectively.
+     */
+    virtual void addPathToFileSet( const IndexedString& path ) = 0;
+    virtual void removePathFromFileSet( const IndexedString& path ) = 0;
+    /**
+     * @return all files of the project
+     *
+     * Prefer fileSetSnapshot() and fileSetChanged() to keep track of the files of large projects.
+     */
     virtual QSet<IndexedString> fileSet() const = 0;
+    /**
+     * @return an immutable snapshot of the files of the project, which is cheap to copy
+     * and to keep around, unlike the result of fileSet() it never needs to be detached
+     * when the project changes.
+     */
+    virtual ProjectFileSet fileSetSnapshot() const = 0;
 
     /** Returns whether the project is ready to be used or not.
         A project won't be ready for use when it's being reloaded or still loading
@@ -144,11 +165,14 @@ public:
     virtual Q_SCRIPTABLE QString name() const = 0;
 
     /**
-     * @brief Check if the project contains an item with the given @p path.
+     * @brief Check if the project contains a file with the given @p path.
+     *
+     * This is answered from the file set, so it does not look up the project model
+     * and is false for folders.
      *
      * @param path the path to check
      *
-     * @return true if the path @a path is a part of the project.
+     * @return true if the file @a path is a part of the project.
      */
     virtual bool inProject(const IndexedString &path) const = 0;
 
@@ -168,6 +192,20 @@ Q_SIGNALS:
      * Gets emitted whenever a file was removed from the project.
      */
     void fileRemovedFromSet( KDevelop::ProjectFileItem* item );
+    /**
+     * Gets emitted whenever a compactly stored file, for which no item exists, was added to the project.
+     */
+    void filePathAddedToSet( const KDevelop::IndexedString& path );
+    /**
+     * Gets emitted whenever a compactly stored file, for which no item exists, was removed from the project.
+     */
+    void filePathRemovedFromSet( const KDevelop::IndexedString& path );
+    /**
+     * Gets emitted after the file set changed. Changes may be collected and emitted in a single
+     * delta once control returns to the event loop, so this is the cheapest way to follow the
+     * file set of a project: take a snapshot, then apply the deltas following its version.
+     */
+    void fileSetChanged( const KDevelop::ProjectFileSetDelta& delta );
 
 public Q_SLOTS:
     /** Make the model to reload */
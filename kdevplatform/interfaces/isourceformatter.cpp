@@ -164,6 +164,11 @@ void SourceFormatterStyle::copyDataFrom(SourceFormatterStyle *other)
 	m_overrideSample = other->overrideSample();
 }
 
+bool ISourceFormatter::isThreadSafe() const
+{
+	return false;
+}
+
 QString ISourceFormatter::optionMapToString(const QMap<QString, QVariant> &map)
 {
 	QString options;
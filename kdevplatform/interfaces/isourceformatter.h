@@ -173,6 +173,13 @@ class KDEVPLATFORMINTERFACES_EXPORT ISourceFormatter
 											   const QString& leftContext = QString(),
 											   const QString& rightContext = QString() ) const = 0;
 
+		/**
+		 * \return Whether formatSourceWithStyle() may be called from any thread, also concurrently,
+		 * as long as it is passed a style with content. Batch reformatting then formats many files
+		 * in parallel. The default implementation returns false.
+		 */
+		virtual bool isThreadSafe() const;
+
 		/** \return A map of predefined styles (a key and a caption for each type)
 		*/
 		virtual QVector<SourceFormatterStyle> predefinedStyles() const = 0;
@@ -32,6 +32,7 @@
 #include <QThread>
 
 #include <KConfigGroup>
+#include <KDirWatch>
 #include <KSharedConfig>
 #include <KLocalizedString>
 
@@ -47,6 +48,9 @@
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
 
+#include <language/editor/modificationrevision.h>
+#include <project/abstractfilemanagerplugin.h>
+
 #include <debug.h>
 
 #include "parsejob.h"
@@ -996,6 +1000,18 @@ void BackgroundParser::projectOpened(IProject* project)
     Q_D(BackgroundParser);
 
     d->m_loadingProjects.remove(project);
+
+    // Files changed on disk get their modification-time read again on the next out-of-date check,
+    // instead of reusing the cached one for up to cacheModificationTimesForSeconds.
+    auto* fileManager = dynamic_cast<AbstractFileManagerPlugin*>(project->projectFileManager());
+    if (auto* watcher = fileManager ? fileManager->projectWatcher(project) : nullptr) {
+        const auto clearModificationCache = [](const QString& path) {
+            ModificationRevision::clearModificationCache(IndexedString(path));
+        };
+        connect(watcher, &KDirWatch::dirty, this, clearModificationCache);
+        connect(watcher, &KDirWatch::created, this, clearModificationCache);
+        connect(watcher, &KDirWatch::deleted, this, clearModificationCache);
+    }
 }
 
 void BackgroundParser::projectOpeningAborted(IProject* project)
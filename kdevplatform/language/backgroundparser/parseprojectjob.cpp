@@ -27,17 +27,271 @@
 #include <interfaces/icompletionsettings.h>
 
 #include <language/backgroundparser/backgroundparser.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
+#include <project/projectfileset.h>
 
 #include <kcoreaddons_version.h>
 #include <KLocalizedString>
 
+#include <QAtomicInt>
 #include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QPointer>
-#include <QSet>
 #include <QTimer>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <functional>
 
 using namespace KDevelop;
 
+namespace {
+
+struct ParseOrder
+{
+    // files to parse, ordered by decreasing number of files they include
+    QVector<IndexedString> files;
+    // the number of bands the files got distributed into, used as priority offsets
+    QVector<int> bands;
+    // the number of files queued last, as they are most likely updated while parsing the files including them
+    int coveredCount = 0;
+};
+
+struct ScannedIncludes
+{
+    int includeCount = 0;
+    QVector<QString> quotedIncludes;
+};
+
+/**
+ * Scans the include directives of @p fileName without preprocessing it.
+ *
+ * Only the start of the file is read, which is where include directives are found in practice.
+ * Conditional includes are all counted, which is fine for an estimate of the parse order.
+ */
+ScannedIncludes scanIncludes(const QString& fileName)
+{
+    const qint64 maxScannedBytes = 64 * 1024;
+
+    ScannedIncludes result;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return result;
+    }
+
+    qint64 scannedBytes = 0;
+    while (scannedBytes < maxScannedBytes && !file.atEnd()) {
+        const QByteArray line = file.readLine(1024);
+        scannedBytes += line.size();
+
+        const QByteArray directive = line.trimmed();
+        if (!directive.startsWith('#')) {
+            continue;
+        }
+        const QByteArray include = directive.mid(1).trimmed();
+        if (!include.startsWith("include")) {
+            continue;
+        }
+        const QByteArray target = include.mid(7).trimmed();
+        if (target.startsWith('<')) {
+            ++result.includeCount;
+        } else if (target.startsWith('"')) {
+            const int end = target.indexOf('"', 1);
+            if (end > 1) {
+                ++result.includeCount;
+                result.quotedIncludes.append(QString::fromUtf8(target.mid(1, end - 1)));
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Orders @p files for parsing by their include relationships.
+ *
+ * The include relationships are taken from the DUChain of the previous session. Files the DUChain
+ * knows nothing about, e.g. on the first import of a project, get their include directives scanned
+ * instead. As no include paths are known there, quoted includes are only resolved relative to the
+ * including file, or to the one file to parse with a matching path suffix.
+ *
+ * The files are sorted such that the ones including the most files come first, so the shared contexts
+ * of many headers get stored early instead of parsing the headers repeatedly. Files which are included
+ * by other files to parse most likely get updated while parsing those, so they are queued last when
+ * @p demoteIncluded is true. They are never dropped though: the include data may be outdated, and
+ * headers still get parsed standalone.
+ *
+ * This looks up every file to parse, so it is meant to be run in a background thread. It returns an
+ * empty order when @p canceled gets set meanwhile.
+ */
+ParseOrder includeOrderedFiles(const ProjectFileSet& files, bool demoteIncluded, const QAtomicInt& canceled)
+{
+    const int bandCount = 10;
+    // don't block the parse threads writing to the DUChain while looking up all files of a big project
+    const int lookupsPerLock = 500;
+
+    QHash<IndexedString, QVector<IndexedString>> importersInSet;
+    QHash<IndexedString, int> includeCounts;
+    QVector<IndexedString> unknownFiles;
+
+    {
+        DUChainReadLocker lock;
+        int lookups = 0;
+        bool stopped = false;
+        files.forEach([&](const IndexedString& file) {
+            if (stopped) {
+                return;
+            }
+            if (++lookups % lookupsPerLock == 0) {
+                lock.unlock();
+                if (canceled.loadAcquire()) {
+                    stopped = true;
+                    return;
+                }
+                lock.lock();
+            }
+
+            const auto environmentFiles = DUChain::self()->allEnvironmentFiles(file);
+            if (environmentFiles.isEmpty()) {
+                unknownFiles.append(file);
+                return;
+            }
+
+            int includeCount = 0;
+            auto& importers = importersInSet[file];
+            for (const auto& environmentFile : environmentFiles) {
+                if (!environmentFile) {
+                    continue;
+                }
+                includeCount = qMax(includeCount, static_cast<int>(environmentFile->importsCache().count()));
+                if (demoteIncluded) {
+                    const auto fileImporters = environmentFile->importers();
+                    for (const auto& importer : fileImporters) {
+                        const auto importerUrl = importer ? importer->url() : IndexedString();
+                        if (!importerUrl.isEmpty() && importerUrl != file && files.contains(importerUrl)) {
+                            importers.append(importerUrl);
+                        }
+                    }
+                }
+            }
+            includeCounts.insert(file, includeCount);
+        });
+    }
+    if (canceled.loadAcquire()) {
+        return {};
+    }
+
+    if (!unknownFiles.isEmpty()) {
+        // resolves includes not found next to the including file by their path suffix, if that is unique
+        QHash<QString, QVector<IndexedString>> filesByName;
+        files.forEach([&filesByName](const IndexedString& file) {
+            const QString path = file.str();
+            filesByName[path.mid(path.lastIndexOf(QLatin1Char('/')) + 1)].append(file);
+        });
+        const auto resolveInclude = [&](const QDir& directory, const QString& include) {
+            const IndexedString relative(QDir::cleanPath(directory.absoluteFilePath(include)));
+            if (files.contains(relative)) {
+                return relative;
+            }
+            const QString suffix = QLatin1Char('/') + QDir::cleanPath(include);
+            const auto candidates = filesByName.value(include.mid(include.lastIndexOf(QLatin1Char('/')) + 1));
+            IndexedString match;
+            for (const auto& candidate : candidates) {
+                if (candidate.str().endsWith(suffix)) {
+                    if (!match.isEmpty()) {
+                        return IndexedString();
+                    }
+                    match = candidate;
+                }
+            }
+            return match;
+        };
+
+        for (const auto& file : qAsConst(unknownFiles)) {
+            if (canceled.loadAcquire()) {
+                return {};
+            }
+            const QString fileName = file.str();
+            const auto scanned = scanIncludes(fileName);
+            includeCounts.insert(file, scanned.includeCount);
+            if (!demoteIncluded) {
+                continue;
+            }
+            const QDir directory = QFileInfo(fileName).absoluteDir();
+            for (const auto& include : scanned.quotedIncludes) {
+                const auto included = resolveInclude(directory, include);
+                if (!included.isEmpty() && included != file) {
+                    importersInSet[included].append(file);
+                }
+            }
+        }
+    }
+
+    // A file is covered when one of its importers gets parsed or is covered itself.
+    // Files on include cycles without any parsed importer stay uncovered, so they do get parsed.
+    enum State { Unresolved, InProgress, Covered, NotCovered };
+    QHash<IndexedString, State> states;
+    std::function<bool(const IndexedString&)> isCovered = [&](const IndexedString& file) {
+        auto& state = states[file];
+        if (state == InProgress) {
+            return false;
+        } else if (state != Unresolved) {
+            return state == Covered;
+        }
+        state = InProgress;
+        bool covered = false;
+        const auto importers = importersInSet.value(file);
+        for (const auto& importer : importers) {
+            isCovered(importer);
+            // the importer is either parsed or covered itself, unless we are going in circles
+            if (states.value(importer) != InProgress) {
+                covered = true;
+                break;
+            }
+        }
+        // the reference might have been invalidated by the recursion
+        states[file] = covered ? Covered : NotCovered;
+        return covered;
+    };
+
+    QVector<QPair<int, IndexedString>> rankedFiles;
+    rankedFiles.reserve(includeCounts.size());
+    QVector<IndexedString> coveredFiles;
+    for (auto it = includeCounts.constBegin(), end = includeCounts.constEnd(); it != end; ++it) {
+        if (demoteIncluded && isCovered(it.key())) {
+            coveredFiles.append(it.key());
+            continue;
+        }
+        rankedFiles.append({it.value(), it.key()});
+    }
+    std::sort(rankedFiles.begin(), rankedFiles.end(), [](const QPair<int, IndexedString>& lhs,
+                                                         const QPair<int, IndexedString>& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    ParseOrder order;
+    order.files.reserve(files.size());
+    order.bands.reserve(files.size());
+    for (int i = 0; i < rankedFiles.size(); ++i) {
+        order.files.append(rankedFiles[i].second);
+        order.bands.append(i * bandCount / rankedFiles.size());
+    }
+    // usually up to date by the time they are processed, which then is cheap
+    for (const auto& file : qAsConst(coveredFiles)) {
+        order.files.append(file);
+        order.bands.append(bandCount);
+    }
+    order.coveredCount = coveredFiles.size();
+    return order;
+}
+
+}
+
 class KDevelop::ParseProjectJobPrivate
 {
 public:
@@ -50,17 +304,39 @@ public:
     const bool forceUpdate;
     const bool parseAllProjectSources;
     int fileCountLeftToParse = 0;
-    QSet<IndexedString> filesToParse;
+    ProjectFileSet filesToParse;
+    QFutureWatcher<ParseOrder>* orderWatcher = nullptr;
+    QAtomicInt orderCanceled;
+
+    void cancelOrdering()
+    {
+        if (!orderWatcher) {
+            return;
+        }
+        orderCanceled.storeRelease(1);
+        orderWatcher->disconnect();
+        orderWatcher->waitForFinished();
+        orderWatcher->deleteLater();
+        orderWatcher = nullptr;
+    }
 };
 
 bool ParseProjectJob::doKill()
 {
+    Q_D(ParseProjectJob);
+
     qCDebug(LANGUAGE) << "stopping project parse job";
+    d->cancelOrdering();
     ICore::self()->languageController()->backgroundParser()->revertAllRequests(this);
     return true;
 }
 
-ParseProjectJob::~ParseProjectJob() = default;
+ParseProjectJob::~ParseProjectJob()
+{
+    Q_D(ParseProjectJob);
+
+    d->cancelOrdering();
+}
 
 ParseProjectJob::ParseProjectJob(IProject* project, bool forceUpdate, bool parseAllProjectSources)
     : d_ptr{new ParseProjectJobPrivate(forceUpdate, parseAllProjectSources)}
@@ -68,11 +344,11 @@ ParseProjectJob::ParseProjectJob(IProject* project, bool forceUpdate, bool parse
     Q_D(ParseProjectJob);
 
     if (parseAllProjectSources) {
-        d->filesToParse = project->fileSet();
+        d->filesToParse = project->fileSetSnapshot();
     } else {
         // In case we don't want to parse the whole project, still add all currently open files that belong to the project to the background-parser
         const auto documents = ICore::self()->documentController()->openDocuments();
-        const auto projectFiles = project->fileSet();
+        const auto projectFiles = project->fileSetSnapshot();
         for (auto* document : documents) {
             const auto path = IndexedString(document->url());
             if (projectFiles.contains(path)) {
@@ -153,11 +429,9 @@ void ParseProjectJob::queueFilesToParse()
 
     if (auto currentDocument = ICore::self()->documentController()->activeDocument()) {
         const auto path = IndexedString(currentDocument->url());
-        const auto fileIt = d->filesToParse.constFind(path);
-        if (fileIt != d->filesToParse.cend()) {
+        if (d->filesToParse.remove(path)) {
             ICore::self()->languageController()->backgroundParser()->addDocument(path,
                     openDocumentProcessingLevel, BackgroundParser::BestPriority, this);
-            d->filesToParse.erase(fileIt);
         }
     }
 
@@ -169,11 +443,9 @@ void ParseProjectJob::queueFilesToParse()
         const auto documents = ICore::self()->documentController()->openDocuments();
         for (auto* document : documents) {
             const auto path = IndexedString(document->url());
-            const auto fileIt = d->filesToParse.constFind(path);
-            if (fileIt != d->filesToParse.cend()) {
+            if (d->filesToParse.remove(path)) {
                 ICore::self()->languageController()->backgroundParser()->addDocument(path,
                         openDocumentProcessingLevel, openDocumentPriority, this);
-                d->filesToParse.erase(fileIt);
             }
         }
     } else {
@@ -184,28 +456,62 @@ void ParseProjectJob::queueFilesToParse()
 
     // prevent UI-lockup by processing events after some files
     // esp. noticeable when dealing with huge projects
-    const int processAfter = 1000;
-    int processed = 0;
-    // guard against reentrancy issues, see also bug 345480
-    auto crashGuard = QPointer<ParseProjectJob> {this};
-    for (const IndexedString& url : qAsConst(d->filesToParse)) {
-        ICore::self()->languageController()->backgroundParser()->addDocument(url, processingLevel,
-                                                                             priority,
-                                                                             this);
-        ++processed;
-        if (processed == processAfter) {
-            QCoreApplication::processEvents();
-            if (Q_UNLIKELY(!crashGuard)) {
-                qCDebug(LANGUAGE) << "Aborting queuing project files to parse."
-                                     " This job has been destroyed.";
-                return;
+    const auto queueOrderedFiles = [this, processingLevel, priority, isJobKilled](const ParseOrder& order) {
+        const int processAfter = 1000;
+        int processed = 0;
+        // guard against reentrancy issues, see also bug 345480
+        auto crashGuard = QPointer<ParseProjectJob> {this};
+        for (int i = 0; i < order.files.size(); ++i) {
+            ICore::self()->languageController()->backgroundParser()->addDocument(order.files[i], processingLevel,
+                                                                                 priority + order.bands[i],
+                                                                                 this);
+            ++processed;
+            if (processed == processAfter) {
+                QCoreApplication::processEvents();
+                if (Q_UNLIKELY(!crashGuard)) {
+                    qCDebug(LANGUAGE) << "Aborting queuing project files to parse."
+                                         " This job has been destroyed.";
+                    return;
+                }
+                if (isJobKilled()) {
+                    return;
+                }
+                processed = 0;
             }
-            if (isJobKilled()) {
-                return;
-            }
-            processed = 0;
         }
+    };
+
+    if (!d->parseAllProjectSources) {
+        ParseOrder order;
+        order.files.reserve(d->filesToParse.size());
+        d->filesToParse.forEach([&order](const IndexedString& url) {
+            order.files.append(url);
+            order.bands.append(0);
+        });
+        d->filesToParse = {};
+        queueOrderedFiles(order);
+        return;
     }
 
-    d->filesToParse = {}; // free memory or prevent detaching
+    // Order the files by their include relationships. Included files are updated when parsing
+    // the files including them, so unless an update is forced, they are queued last.
+    // Looking up all files of a big project takes a while, so do it in the background.
+    d->orderWatcher = new QFutureWatcher<ParseOrder>(this);
+    connect(d->orderWatcher, &QFutureWatcherBase::finished, this, [this, queueOrderedFiles]() {
+        Q_D(ParseProjectJob);
+
+        const auto order = d->orderWatcher->result();
+        d->orderWatcher->deleteLater();
+        d->orderWatcher = nullptr;
+        qCDebug(LANGUAGE) << "queuing" << order.files.size() << "project files, of which" << order.coveredCount
+                          << "files included by others come last";
+        queueOrderedFiles(order);
+    });
+    const auto files = d->filesToParse;
+    const bool demoteIncluded = !d->forceUpdate;
+    const QAtomicInt* canceled = &d->orderCanceled;
+    d->filesToParse = {};
+    d->orderWatcher->setFuture(QtConcurrent::run([files, demoteIncluded, canceled]() {
+        return includeOrderedFiles(files, demoteIncluded, *canceled);
+    }));
 }
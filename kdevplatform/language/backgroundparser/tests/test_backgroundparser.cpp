@@ -23,7 +23,9 @@
 #include "test_backgroundparser.h"
 
 #include <QTest>
+#include <QDir>
 #include <QElapsedTimer>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QApplication>
 #include <QSemaphore>
@@ -35,10 +37,13 @@
 #include <tests/testcore.h>
 #include <tests/testlanguagecontroller.h>
 #include <tests/testhelpers.h>
+#include <tests/testproject.h>
 
 #include <language/duchain/duchain.h>
 #include <language/duchain/duchainlock.h>
+#include <language/duchain/parsingenvironment.h>
 #include <language/backgroundparser/backgroundparser.h>
+#include <language/backgroundparser/parseprojectjob.h>
 
 #include <interfaces/ilanguagecontroller.h>
 
@@ -450,3 +455,78 @@ void TestBackgroundparser::testSuspendResume()
     parser->resume();
     QVERIFY(m_jobPlan.runJobs(100));
 }
+
+void TestBackgroundparser::testParseProjectJobQueuesIncludedFiles()
+{
+    const IndexedString source(QStringLiteral("/test_ppj_source.txt"));
+    const IndexedString header(QStringLiteral("/test_ppj_header.txt"));
+
+    {
+        // DUChain data as left by a previous session, in which the source included the header
+        DUChainWriteLocker lock;
+        auto* headerTop = new TopDUContext(header, RangeInRevision(), new ParsingEnvironmentFile(header));
+        DUChain::self()->addDocumentChain(headerTop);
+        auto* sourceTop = new TopDUContext(source, RangeInRevision(), new ParsingEnvironmentFile(source));
+        DUChain::self()->addDocumentChain(sourceTop);
+        sourceTop->addImportedParentContext(headerTop);
+    }
+
+    m_jobPlan.addJob(JobPrototype(source.toUrl(), BackgroundParser::InitialParsePriority,
+                                  ParseJob::IgnoresSequentialProcessing));
+    m_jobPlan.addJob(JobPrototype(header.toUrl(), BackgroundParser::InitialParsePriority,
+                                  ParseJob::IgnoresSequentialProcessing));
+
+    TestProject project;
+    project.addPathToFileSet(source);
+    project.addPathToFileSet(header);
+
+    auto* job = new ParseProjectJob(&project, false, true);
+    job->start();
+
+    // the header is most likely updated while parsing the source, but still gets queued
+    QTRY_COMPARE(m_jobPlan.numCreatedJobs(), 2);
+    QCOMPARE(m_jobPlan.m_createdJobs.first(), source);
+
+    {
+        DUChainWriteLocker lock;
+        for (const auto& url : {source, header}) {
+            DUChain::self()->removeDocumentChain(DUChain::self()->chainForDocument(url));
+        }
+    }
+}
+
+void TestBackgroundparser::testParseProjectJobScansUnknownIncludes()
+{
+    // no DUChain data for these files, as on the first import of a project
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString sourcePath = dir.filePath(QStringLiteral("test_ppj_scan_source.txt"));
+    const QString headerPath = dir.filePath(QStringLiteral("include/test_ppj_scan_header.txt"));
+    QVERIFY(QDir(dir.path()).mkdir(QStringLiteral("include")));
+    {
+        QFile source(sourcePath);
+        QVERIFY(source.open(QIODevice::WriteOnly));
+        source.write("#include <vector>\n  #  include \"include/test_ppj_scan_header.txt\"\n\nint main() {}\n");
+        QFile header(headerPath);
+        QVERIFY(header.open(QIODevice::WriteOnly));
+        header.write("#pragma once\n");
+    }
+    const IndexedString source(sourcePath);
+    const IndexedString header(headerPath);
+
+    m_jobPlan.addJob(JobPrototype(source.toUrl(), BackgroundParser::InitialParsePriority,
+                                  ParseJob::IgnoresSequentialProcessing));
+    m_jobPlan.addJob(JobPrototype(header.toUrl(), BackgroundParser::InitialParsePriority,
+                                  ParseJob::IgnoresSequentialProcessing));
+
+    TestProject project;
+    project.addPathToFileSet(header);
+    project.addPathToFileSet(source);
+
+    auto* job = new ParseProjectJob(&project, false, true);
+    job->start();
+
+    // the scanned include makes the header come after the source
+    QTRY_COMPARE(m_jobPlan.numCreatedJobs(), 2);
+    QCOMPARE(m_jobPlan.m_createdJobs.first(), source);
+}
@@ -111,6 +111,8 @@ private Q_SLOTS:
 
     void testNoDeadlockInJobCreation();
     void testSuspendResume();
+    void testParseProjectJobQueuesIncludedFiles();
+    void testParseProjectJobScansUnknownIncludes();
 
     void benchmark();
 
@@ -24,6 +24,7 @@
 #include "../../interfaces/icore.h"
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
+#include <project/projectfileset.h>
 
 #include <KLocalizedString>
 
@@ -70,21 +71,14 @@ void AllClassesFolder::populateNode()
 void AllClassesFolder::projectClosing(KDevelop::IProject* project)
 {
     // Run over all the files in the project.
-    const auto files = project->fileSet();
-    for (const IndexedString& file : files) {
+    project->fileSetSnapshot().forEach([this](const IndexedString& file) {
         closeDocument(file);
-    }
+    });
 }
 
 void AllClassesFolder::projectOpened(KDevelop::IProject* project)
 {
-    // Run over all the files in the project.
-    const auto files = project->fileSet();
-    for (const IndexedString& file : files) {
-        parseDocument(file);
-    }
-
-    recursiveSort();
+    parseDocuments(project->fileSetSnapshot());
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -150,6 +150,26 @@ bool ClassModel::hasChildren(const QModelIndex& parent) const
     return node->hasChildren();
 }
 
+bool ClassModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return false;
+
+    Node* node = static_cast<Node*>(parent.internalPointer());
+
+    return node->canFetchMore();
+}
+
+void ClassModel::fetchMore(const QModelIndex& parent)
+{
+    if (!parent.isValid())
+        return;
+
+    Node* node = static_cast<Node*>(parent.internalPointer());
+
+    node->fetchMore();
+}
+
 QModelIndex ClassModel::index(int row, int column, const QModelIndex& parent) const
 {
     if (row < 0 || column != 0)
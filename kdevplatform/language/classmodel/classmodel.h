@@ -140,6 +140,8 @@ public: // QAbstractItemModel overrides
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
 
     bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
     QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex& child) const override;
@@ -49,6 +49,15 @@ IdentifierNode::IdentifierNode(KDevelop::Declaration* a_decl,
 {
 }
 
+IdentifierNode::IdentifierNode(const KDevelop::IndexedQualifiedIdentifier& a_identifier,
+                               const KDevelop::IndexedDeclaration& a_decl,
+                               const QString& a_displayName, NodesModelInterface* a_model)
+    : DynamicNode(a_displayName, a_model)
+    , m_identifier(a_identifier)
+    , m_indexedDeclaration(a_decl)
+{
+}
+
 Declaration* IdentifierNode::declaration()
 {
     if (!m_cachedDeclaration)
@@ -123,6 +132,12 @@ ClassNode::ClassNode(Declaration* a_decl, NodesModelInterface* a_model)
 {
 }
 
+ClassNode::ClassNode(const IndexedQualifiedIdentifier& a_identifier, const IndexedDeclaration& a_decl,
+                     const QString& a_displayName, NodesModelInterface* a_model)
+    : IdentifierNode(a_identifier, a_decl, a_displayName, a_model)
+{
+}
+
 ClassNode::~ClassNode()
 {
     if (!m_cachedUrl.isEmpty()) {
@@ -410,6 +425,7 @@ void DerivedClassesFolderNode::populateNode()
 
 Node::Node(const QString& a_displayName, NodesModelInterface* a_model)
     : m_parentNode(nullptr)
+    , m_rowHint(-1)
     , m_displayName(a_displayName)
     , m_model(a_model)
 {
@@ -487,7 +503,11 @@ int Node::row()
     if (m_parentNode == nullptr)
         return -1;
 
-    return m_parentNode->m_children.indexOf(this);
+    const NodesList& siblings = m_parentNode->m_children;
+    if (m_rowHint < 0 || m_rowHint >= siblings.size() || siblings.at(m_rowHint) != this)
+        m_rowHint = siblings.indexOf(this);
+
+    return m_rowHint;
 }
 
 QIcon ClassModelNodes::Node::cachedIcon()
@@ -58,6 +58,12 @@ public: // Operations
     /// Called by the model to expand the node and populate it with sub-nodes if needed.
     virtual void expand() {};
 
+    /// Return true if more sub-nodes can be created on demand by fetchMore().
+    virtual bool canFetchMore() const { return false; }
+
+    /// Called by the model to create the next batch of sub-nodes.
+    virtual void fetchMore() {};
+
     /// Append a new child node to the list.
     void addNode(Node* a_child);
 
@@ -106,6 +112,9 @@ protected:
 private:
     Node* m_parentNode;
 
+    /// Cached position in the parent node, to avoid a linear search in big folders.
+    int m_rowHint;
+
     /// Called once the node has been populated to sort the entire tree / branch.
     void recursiveSortInternal();
 
@@ -165,6 +174,11 @@ public:
     IdentifierNode(KDevelop::Declaration* a_decl, NodesModelInterface* a_model,
                    const QString& a_displayName = QString());
 
+    /// Creates the node without looking up the declaration, it is only loaded once needed.
+    IdentifierNode(const KDevelop::IndexedQualifiedIdentifier& a_identifier,
+                   const KDevelop::IndexedDeclaration& a_decl,
+                   const QString& a_displayName, NodesModelInterface* a_model);
+
 public:
     /// Returns the qualified identifier for this node by going through the tree
     const KDevelop::IndexedQualifiedIdentifier& identifier() const { return m_identifier; }
@@ -209,6 +223,9 @@ class ClassNode
 {
 public:
     ClassNode(KDevelop::Declaration* a_decl, NodesModelInterface* a_model);
+    ClassNode(const KDevelop::IndexedQualifiedIdentifier& a_identifier,
+              const KDevelop::IndexedDeclaration& a_decl,
+              const QString& a_displayName, NodesModelInterface* a_model);
     ~ClassNode() override;
 
     /// Lookup a contained class and return the related node.
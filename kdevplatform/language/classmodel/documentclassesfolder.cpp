@@ -26,15 +26,23 @@
 #include "../duchain/duchain.h"
 #include "../duchain/persistentsymboltable.h"
 #include "../duchain/codemodel.h"
+#include <project/projectfileset.h>
 
+#include <QFutureWatcher>
 #include <QIcon>
 #include <QTimer>
+#include <QtConcurrentRun>
 
-#include <boost/foreach.hpp>
+#include <algorithm>
 
 using namespace KDevelop;
 using namespace ClassModelNodes;
 
+namespace {
+/// How many class nodes are created at once when a folder is expanded or scrolled to its end.
+const int classesBatchSize = 256;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
@@ -43,7 +51,8 @@ class ClassModelNodes::StaticNamespaceFolderNode
     : public Node
 {
 public:
-    StaticNamespaceFolderNode(const KDevelop::QualifiedIdentifier& a_identifier, NodesModelInterface* a_model);
+    StaticNamespaceFolderNode(const KDevelop::QualifiedIdentifier& a_identifier, DocumentClassesFolder* a_folder,
+                              NodesModelInterface* a_model);
 
     /// Returns the qualified identifier for this node
     const KDevelop::QualifiedIdentifier& qualifiedIdentifier() const { return m_identifier; }
@@ -51,17 +60,40 @@ public:
 public: // Node overrides
     bool getIcon(QIcon& a_resultIcon) override;
     int score() const override { return 101; }
+    bool hasChildren() const override;
+    bool canFetchMore() const override;
+    void fetchMore() override;
 
 private:
     /// The namespace identifier.
     KDevelop::QualifiedIdentifier m_identifier;
+
+    /// The folder holding the classes of this namespace.
+    DocumentClassesFolder* m_folder;
 };
 
 StaticNamespaceFolderNode::StaticNamespaceFolderNode(const KDevelop::QualifiedIdentifier& a_identifier,
+                                                     DocumentClassesFolder* a_folder,
                                                      NodesModelInterface* a_model)
     : Node(a_identifier.last().toString(), a_model)
     , m_identifier(a_identifier)
+    , m_folder(a_folder)
+{
+}
+
+bool StaticNamespaceFolderNode::hasChildren() const
+{
+    return Node::hasChildren() || m_folder->hasPendingClasses(this);
+}
+
+bool StaticNamespaceFolderNode::canFetchMore() const
 {
+    return m_folder->hasPendingClasses(this);
+}
+
+void StaticNamespaceFolderNode::fetchMore()
+{
+    m_folder->fetchMoreClasses(this);
 }
 
 bool StaticNamespaceFolderNode::getIcon(QIcon& a_resultIcon)
@@ -75,10 +107,12 @@ bool StaticNamespaceFolderNode::getIcon(QIcon& a_resultIcon)
 
 DocumentClassesFolder::OpenedFileClassItem::OpenedFileClassItem(const KDevelop::IndexedString& a_file,
                                                                 const KDevelop::IndexedQualifiedIdentifier& a_classIdentifier,
-                                                                ClassModelNodes::ClassNode* a_nodeItem)
+                                                                ClassModelNodes::ClassNode* a_nodeItem,
+                                                                ClassModelNodes::Node* a_parentNode)
     : file(a_file)
     , classIdentifier(a_classIdentifier)
     , nodeItem(a_nodeItem)
+    , parentNode(a_parentNode)
 {
 }
 
@@ -119,6 +153,11 @@ void DocumentClassesFolder::nodeCleared()
     // Clear open files and classes list
     m_openFiles.clear();
     m_openFilesClasses.clear();
+    m_pendingClasses.clear();
+    m_unsortedPendingClasses.clear();
+
+    // Drop the results of running parses.
+    ++m_generation;
 
     // Stop the update timer.
     m_updateTimer->stop();
@@ -145,8 +184,13 @@ ClassNode* DocumentClassesFolder::findClassNode(const IndexedQualifiedIdentifier
     if (iter == m_openFilesClasses.get<ClassIdentifierIndex>().end())
         return nullptr;
 
+    // The node may not have been created yet.
+    while (iter->nodeItem == nullptr && iter->parentNode && hasPendingClasses(iter->parentNode)) {
+        fetchMoreClasses(iter->parentNode);
+    }
+
     // If the node is invisible - make it visible by going over the identifiers list.
-    if (iter->nodeItem == nullptr) {
+    if (iter->nodeItem == nullptr && iter->parentNode == nullptr) {
         QualifiedIdentifier qualifiedIdentifier = a_id.identifier();
 
         // Ignore zero length identifiers.
@@ -185,30 +229,119 @@ void DocumentClassesFolder::closeDocument(const IndexedString& a_file)
 {
     // Get list of nodes associated with this file and remove them.
     std::pair<FileIterator, FileIterator> range = m_openFilesClasses.get<FileIndex>().equal_range(a_file);
-    if (range.first != m_openFilesClasses.get<FileIndex>().end()) {
-        BOOST_FOREACH(const OpenedFileClassItem &item, range)
-        {
-            if (item.nodeItem)
-                removeClassNode(item.nodeItem);
-        }
-
-        // Clear the lists
-        m_openFilesClasses.get<FileIndex>().erase(range.first, range.second);
+    QVector<FileIterator> items;
+    for (FileIterator iter = range.first; iter != range.second; ++iter) {
+        items.append(iter);
     }
+    removeClassItems(items);
 
     // Clear the file from the list of monitored documents.
     m_openFiles.remove(a_file);
 }
 
-bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file)
+QVector<DocumentClassesFolder::ClassEntry> DocumentClassesFolder::collectClasses(const IndexedString& a_file,
+                                                                              QHash<IndexedQualifiedIdentifier, bool>& a_namespaces)
 {
+    QVector<ClassEntry> classes;
+
+    // The code model items are only valid while the chain is locked.
+    DUChainReadLocker lock;
+
     uint codeModelItemCount = 0;
     const CodeModelItem* codeModelItems;
     CodeModel::self().items(a_file, codeModelItemCount, codeModelItems);
 
-    // List of declared namespaces in this file.
-    QSet<QualifiedIdentifier> declaredNamespaces;
+    // Namespaces declared in this document.
+    for (uint codeModelItemIndex = 0; codeModelItemIndex < codeModelItemCount; ++codeModelItemIndex) {
+        const CodeModelItem& item = codeModelItems[codeModelItemIndex];
+        if (item.kind & CodeModelItem::Namespace)
+            a_namespaces.insert(item.id, true);
+    }
+
+    for (uint codeModelItemIndex = 0; codeModelItemIndex < codeModelItemCount; ++codeModelItemIndex) {
+        const CodeModelItem& item = codeModelItems[codeModelItemIndex];
+
+        // Don't insert unknown or forward declarations into the class browser
+        if (item.kind == CodeModelItem::Unknown || (item.kind & CodeModelItem::ForwardDeclaration))
+            continue;
+
+        if (!(item.kind & CodeModelItem::Class))
+            continue;
+
+        KDevelop::QualifiedIdentifier id = item.id.identifier();
+
+        // Don't add empty identifiers and ignore empty unnamed classes.
+        if (id.count() == 0 || id.last().toString().isEmpty())
+            continue;
+
+        bool inNamespace = false;
+        if (id.count() > 1) {
+            // The class might be declared under a namespace which isn't declared in this document.
+            // If the parent isn't a namespace, we assume that it is a class and in that case,
+            // when the parent class gets expanded, it will show it.
+            const IndexedQualifiedIdentifier parentIdentifier(id.left(-1));
+            auto namespaceIt = a_namespaces.find(parentIdentifier);
+            if (namespaceIt == a_namespaces.end()) {
+                bool isNamespace = false;
+
+                uint declsCount = 0;
+                const IndexedDeclaration* decls;
+                PersistentSymbolTable::self().declarations(parentIdentifier, declsCount, decls);
+
+                for (uint i = 0; i < declsCount; ++i) {
+                    // Look for the first valid declaration.
+                    if (Declaration* decl = decls[i].declaration()) {
+                        isNamespace = (decl->kind() == Declaration::Namespace);
+                        break;
+                    }
+                }
+
+                namespaceIt = a_namespaces.insert(parentIdentifier, isNamespace);
+            }
+            inNamespace = *namespaceIt;
+        }
+
+        IndexedDeclaration decl;
+        uint count = 0;
+        const IndexedDeclaration* declarations;
+        PersistentSymbolTable::self().declarations(item.id, count, declarations);
+        for (uint i = 0; i < count; ++i) {
+            if (declarations[i].indexedTopContext().url() == a_file) {
+                decl = declarations[i];
+                break;
+            }
+            // Otherwise use the first declaration found in another file.
+            if (i == 0)
+                decl = declarations[i];
+        }
+
+        classes.append({item.id, decl, inNamespace});
+    }
+
+    return classes;
+}
+
+QVector<DocumentClassesFolder::DocumentClasses> DocumentClassesFolder::collectDocuments(const QVector<IndexedString>& a_files)
+{
+    QVector<DocumentClasses> documents;
+    documents.reserve(a_files.size());
+
+    QHash<IndexedQualifiedIdentifier, bool> namespaces;
+    for (const IndexedString& file : a_files) {
+        documents.append({file, collectClasses(file, namespaces)});
+    }
+
+    return documents;
+}
+
+bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file)
+{
+    QHash<IndexedQualifiedIdentifier, bool> namespaces;
+    return applyClasses(a_file, collectClasses(a_file, namespaces));
+}
 
+bool DocumentClassesFolder::applyClasses(const KDevelop::IndexedString& a_file, const QVector<ClassEntry>& a_classes)
+{
     // List of removed classes - it initially contains all the known classes, we'll eliminate them
     // one by one later on when we encounter them in the document.
     QMap<IndexedQualifiedIdentifier, FileIterator> removedClasses;
@@ -223,137 +356,179 @@ bool DocumentClassesFolder::updateDocument(const KDevelop::IndexedString& a_file
 
     bool documentChanged = false;
 
-    for (uint codeModelItemIndex = 0; codeModelItemIndex < codeModelItemCount; ++codeModelItemIndex) {
-        const CodeModelItem& item = codeModelItems[codeModelItemIndex];
-
-        // Don't insert unknown or forward declarations into the class browser
-        if (item.kind == CodeModelItem::Unknown || (item.kind & CodeModelItem::ForwardDeclaration))
-            continue;
+    // A class may be found several times in the same document, it only gets one entry per file.
+    QSet<IndexedQualifiedIdentifier> documentClasses;
 
-        KDevelop::QualifiedIdentifier id = item.id.identifier();
+    for (const ClassEntry& entry : a_classes) {
+        KDevelop::QualifiedIdentifier id = entry.id.identifier();
 
-        // Don't add empty identifiers.
-        if (id.count() == 0)
+        // See if it matches our filter?
+        if (isClassFiltered(id))
             continue;
 
-        // If it's a namespace, create it in the list.
-        if (item.kind & CodeModelItem::Namespace) {
-            // This should create the namespace folder and add it to the cache.
-            namespaceFolder(id);
-
-            // Add to the locally created namespaces.
-            declaredNamespaces.insert(id);
-        } else if (item.kind & CodeModelItem::Class) {
-            // Ignore empty unnamed classes.
-            if (id.last().toString().isEmpty())
-                continue;
+        if (documentClasses.contains(entry.id))
+            continue;
+        documentClasses.insert(entry.id);
 
-            // See if it matches our filter?
-            if (isClassFiltered(id))
-                continue;
+        // Is this a new class or an existing class?
+        const auto classIt = removedClasses.find(entry.id);
+        if (classIt != removedClasses.end()) {
+            // It already exist - remove it from the known classes and continue.
+            removedClasses.erase(classIt);
+            continue;
+        }
 
-            // Is this a new class or an existing class?
-            const auto classIt = removedClasses.find(id);
-            if (classIt != removedClasses.end()) {
-                // It already exist - remove it from the known classes and continue.
-                removedClasses.erase(classIt);
+        // Where should we put this class? It stays hidden if it has no parent node.
+        Node* parentNode = nullptr;
+        if (id.count() == 1)
+            parentNode = this;
+        else if (entry.inNamespace)
+            parentNode = namespaceFolder(id.left(-1));
+
+        // The same class may be declared in several documents, these share a single node.
+        std::pair<ClassIdentifierIterator, ClassIdentifierIterator> sameClasses =
+            m_openFilesClasses.get<ClassIdentifierIndex>().equal_range(entry.id);
+        if (sameClasses.first != sameClasses.second) {
+            ClassNode* nodeItem = sameClasses.first->nodeItem;
+            if (sameClasses.first->parentNode || !parentNode) {
+                m_openFilesClasses.insert(OpenedFileClassItem(a_file, entry.id, nodeItem,
+                                                              sameClasses.first->parentNode));
                 continue;
             }
 
-            // Where should we put this class?
-            Node* parentNode = nullptr;
-
-            // Check if it's namespaced and add it to the proper namespace.
-            if (id.count() > 1) {
-                QualifiedIdentifier parentIdentifier(id.left(-1));
-
-                // Look up the namespace in the cache.
-                // If we fail to find it we assume that the parent context is a class
-                // and in that case, when the parent class gets expanded, it will show it.
-                NamespacesMap::iterator iter = m_namespaces.find(parentIdentifier);
-                if (iter != m_namespaces.end()) {
-                    // Add to the namespace node.
-                    parentNode = iter.value();
-                } else
-                {
-                    // Reaching here means we didn't encounter any namespace declaration in the document
-                    // But a class might still be declared under a namespace.
-                    // So we'll perform a more through search to see if it's under a namespace.
-
-                    DUChainReadLocker readLock(DUChain::lock());
-
-                    uint declsCount = 0;
-                    const IndexedDeclaration* decls;
-                    PersistentSymbolTable::self().declarations(parentIdentifier, declsCount, decls);
-
-                    for (uint i = 0; i < declsCount; ++i) {
-                        // Look for the first valid declaration.
-                        if (decls->declaration()) {
-                            // See if it should be namespaced.
-                            if (decls->declaration()->kind() == Declaration::Namespace) {
-                                // This should create the namespace folder and add it to the cache.
-                                parentNode = namespaceFolder(parentIdentifier);
-
-                                // Add to the locally created namespaces.
-                                declaredNamespaces.insert(parentIdentifier);
-                            }
-
-                            break;
-                        }
-                    }
-                }
-            } else
-            {
-                // Add to the main root.
-                parentNode = this;
+            // The class was hidden so far, show it in the parent found for this document.
+            for (ClassIdentifierIterator iter = sameClasses.first; iter != sameClasses.second; ++iter) {
+                iter->parentNode = parentNode;
             }
+        }
 
-            ClassNode* newNode = nullptr;
-            if (parentNode != nullptr) {
-                // Create the new node and add it.
-                IndexedDeclaration decl;
-                uint count = 0;
-                const IndexedDeclaration* declarations;
-                DUChainReadLocker lock;
-                PersistentSymbolTable::self().declarations(item.id, count, declarations);
-                for (uint i = 0; i < count; ++i) {
-                    if (declarations[i].indexedTopContext().url() == a_file) {
-                        decl = declarations[i];
-                        break;
-                    }
-                }
-
-                if (decl.isValid()) {
-                    newNode = new ClassNode(decl.declaration(), m_model);
-                    parentNode->addNode(newNode);
-                }
-            }
+        // Insert it to the map, the node is only created once it's about to be shown.
+        m_openFilesClasses.insert(OpenedFileClassItem(a_file, entry.id, nullptr, parentNode));
 
-            // Insert it to the map - newNode can be 0 - meaning the class is hidden.
-            m_openFilesClasses.insert(OpenedFileClassItem(a_file, id, newNode));
-            documentChanged = true;
+        if (parentNode) {
+            m_pendingClasses[parentNode].append({entry.id, entry.declaration, id.last().toString()});
+            m_unsortedPendingClasses.insert(parentNode);
         }
-    }
 
-    // Remove empty namespaces from the list.
-    // We need this because when a file gets unloaded, we unload the declared classes in it
-    // and if a namespace has no class in it, it'll forever exist and no one will remove it
-    // from the children list.
-    for (const QualifiedIdentifier& id : qAsConst(declaredNamespaces)) {
-        removeEmptyNamespace(id);
+        documentChanged = true;
     }
 
     // Clear erased classes.
-    for (const FileIterator item : qAsConst(removedClasses)) {
-        if (item->nodeItem)
-            removeClassNode(item->nodeItem);
-        m_openFilesClasses.get<FileIndex>().erase(item);
+    if (!removedClasses.isEmpty()) {
+        QVector<FileIterator> items;
+        items.reserve(removedClasses.size());
+        for (const FileIterator item : qAsConst(removedClasses)) {
+            items.append(item);
+        }
+        removeClassItems(items);
         documentChanged = true;
     }
 
     return documentChanged;
 }
 
+void DocumentClassesFolder::removeClassItems(const QVector<FileIterator>& a_items)
+{
+    QHash<Node*, QSet<IndexedQualifiedIdentifier>> removedPendingClasses;
+    for (const FileIterator item : a_items) {
+        const IndexedQualifiedIdentifier id = item->classIdentifier;
+        ClassNode* nodeItem = item->nodeItem;
+        Node* parentNode = item->parentNode;
+        m_openFilesClasses.get<FileIndex>().erase(item);
+
+        // Keep the node while the class is still declared in another file.
+        if (m_openFilesClasses.get<ClassIdentifierIndex>().count(id))
+            continue;
+
+        if (nodeItem)
+            removeClassNode(nodeItem);
+        else if (parentNode)
+            removedPendingClasses[parentNode].insert(id);
+    }
+
+    for (auto it = removedPendingClasses.constBegin(); it != removedPendingClasses.constEnd(); ++it) {
+        removePendingClasses(it.key(), it.value());
+    }
+}
+
+bool DocumentClassesFolder::hasPendingClasses(const Node* a_parent) const
+{
+    return m_pendingClasses.contains(const_cast<Node*>(a_parent));
+}
+
+bool DocumentClassesFolder::canFetchMore() const
+{
+    return hasPendingClasses(this);
+}
+
+void DocumentClassesFolder::fetchMore()
+{
+    fetchMoreClasses(this);
+}
+
+void DocumentClassesFolder::fetchMoreClasses(Node* a_parent)
+{
+    auto it = m_pendingClasses.find(a_parent);
+    if (it == m_pendingClasses.end())
+        return;
+
+    QVector<PendingClass>& pendingClasses = *it;
+    if (m_unsortedPendingClasses.remove(a_parent)) {
+        std::sort(pendingClasses.begin(), pendingClasses.end(), [](const PendingClass& a, const PendingClass& b) {
+            return b.displayName < a.displayName;
+        });
+    }
+
+    const int count = qMin(classesBatchSize, pendingClasses.size());
+    const int firstRow = a_parent->children().size();
+    auto* lastClassNode = (firstRow > 0) ? dynamic_cast<ClassNode*>(a_parent->children().last()) : nullptr;
+    const bool needsSort = (lastClassNode && lastClassNode->sortableString() > pendingClasses.last().displayName);
+
+    m_model->nodesAboutToBeAdded(a_parent, firstRow, count);
+    for (int i = 0; i < count; ++i) {
+        const PendingClass& pendingClass = pendingClasses.last();
+        auto* newNode = new ClassNode(pendingClass.id, pendingClass.declaration, pendingClass.displayName, m_model);
+        a_parent->addNode(newNode);
+
+        std::pair<ClassIdentifierIterator, ClassIdentifierIterator> range =
+            m_openFilesClasses.get<ClassIdentifierIndex>().equal_range(pendingClass.id);
+        for (ClassIdentifierIterator iter = range.first; iter != range.second; ++iter) {
+            iter->nodeItem = newNode;
+        }
+
+        pendingClasses.removeLast();
+    }
+    m_model->nodesAdded(a_parent);
+
+    if (pendingClasses.isEmpty())
+        m_pendingClasses.erase(it);
+
+    // Classes found later may have to be shown between the existing ones.
+    if (needsSort)
+        a_parent->recursiveSort();
+}
+
+void DocumentClassesFolder::removePendingClasses(Node* a_parent, const QSet<IndexedQualifiedIdentifier>& a_ids)
+{
+    auto it = m_pendingClasses.find(a_parent);
+    if (it == m_pendingClasses.end())
+        return;
+
+    QVector<PendingClass>& pendingClasses = *it;
+    pendingClasses.erase(std::remove_if(pendingClasses.begin(), pendingClasses.end(), [&](const PendingClass& pendingClass) {
+        return a_ids.contains(pendingClass.id);
+    }), pendingClasses.end());
+
+    if (pendingClasses.isEmpty()) {
+        m_pendingClasses.erase(it);
+        m_unsortedPendingClasses.remove(a_parent);
+    }
+
+    // Remove empty namespace
+    if (auto namespaceParent = dynamic_cast<StaticNamespaceFolderNode*>(a_parent))
+        removeEmptyNamespace(namespaceParent->qualifiedIdentifier());
+}
+
 void DocumentClassesFolder::parseDocument(const IndexedString& a_file)
 {
     // Add the document to the list of open files - this means we monitor it.
@@ -363,6 +538,46 @@ void DocumentClassesFolder::parseDocument(const IndexedString& a_file)
     updateDocument(a_file);
 }
 
+void DocumentClassesFolder::parseDocuments(const ProjectFileSet& a_files)
+{
+    // Add the documents to the list of open files - this means we monitor them.
+    QVector<IndexedString> files;
+    files.reserve(a_files.size());
+    m_openFiles.reserve(m_openFiles.size() + a_files.size());
+    a_files.forEach([this, &files](const IndexedString& file) {
+        m_openFiles.insert(file);
+        files.append(file);
+    });
+
+    // Looking up thousands of classes takes a while, so do it in the background.
+    auto* watcher = new QFutureWatcher<QVector<DocumentClasses>>(this);
+    const int generation = m_generation;
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+
+        // The node was cleared in the meantime.
+        if (generation != m_generation)
+            return;
+
+        bool hadChanges = false;
+        const auto documents = watcher->result();
+        for (const DocumentClasses& document : documents) {
+            // Skip documents closed in the meantime.
+            if (m_openFiles.contains(document.file))
+                hadChanges |= applyClasses(document.file, document.classes);
+        }
+
+        if (hadChanges) {
+            recursiveSort();
+
+            // Show the first classes right away, the rest is added once the view asks for them.
+            if (canFetchMore())
+                fetchMore();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&DocumentClassesFolder::collectDocuments, files));
+}
+
 void DocumentClassesFolder::removeClassNode(ClassModelNodes::ClassNode* a_node)
 {
     // Get the parent namespace identifier.
@@ -413,7 +628,7 @@ StaticNamespaceFolderNode* DocumentClassesFolder::namespaceFolder(const KDevelop
 
         // Create the new node.
         auto* newNode =
-            new StaticNamespaceFolderNode(a_identifier, m_model);
+            new StaticNamespaceFolderNode(a_identifier, this, m_model);
         parentNode->addNode(newNode);
 
         // Add it to the cache.
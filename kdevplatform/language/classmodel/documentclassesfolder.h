@@ -23,10 +23,17 @@
 #define KDEVPLATFORM_DOCUMENTCLASSESFOLDER_H
 
 #include "classmodelnode.h"
+
+#include <QVector>
+
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 
+namespace KDevelop {
+class ProjectFileSet;
+}
+
 namespace ClassModelNodes {
 class StaticNamespaceFolderNode;
 
@@ -48,6 +55,9 @@ protected: // Documents list handling.
     /// Parse a single document for classes and add them to the list.
     void parseDocument(const KDevelop::IndexedString& a_file);
 
+    /// Parse the given documents for classes in a background thread and add them to the list once done.
+    void parseDocuments(const KDevelop::ProjectFileSet& a_files);
+
     /// Re-parse the given document - remove old declarations and add new declarations.
     bool updateDocument(const KDevelop::IndexedString& a_file);
 
@@ -65,6 +75,8 @@ public: // Node overrides
     void nodeCleared() override;
     void populateNode() override;
     bool hasChildren() const override { return true; }
+    bool canFetchMore() const override;
+    void fetchMore() override;
 
 private Q_SLOTS:
     // Files update.
@@ -77,6 +89,55 @@ private: // File updates related.
     /// Timer for batch updates.
     QTimer* m_updateTimer;
 
+private: // Classes index.
+    friend class StaticNamespaceFolderNode;
+
+    /// A class found in the code model of a document.
+    struct ClassEntry
+    {
+        KDevelop::IndexedQualifiedIdentifier id;
+        KDevelop::IndexedDeclaration declaration;
+        /// Whether the class lives in a namespace, other nested classes are shown inside their parent class.
+        bool inNamespace;
+    };
+
+    struct DocumentClasses
+    {
+        KDevelop::IndexedString file;
+        QVector<ClassEntry> classes;
+    };
+
+    /// Collects the classes of @p a_file from the code model, it's safe to call this from a background thread.
+    /// @param a_namespaces caches whether identifiers denote namespaces across calls.
+    static QVector<ClassEntry> collectClasses(const KDevelop::IndexedString& a_file,
+                                              QHash<KDevelop::IndexedQualifiedIdentifier, bool>& a_namespaces);
+    static QVector<DocumentClasses> collectDocuments(const QVector<KDevelop::IndexedString>& a_files);
+
+    /// Update the list of classes of @p a_file - remove old classes and add new classes.
+    /// Classes are not turned into nodes here, see fetchMoreClasses().
+    bool applyClasses(const KDevelop::IndexedString& a_file, const QVector<ClassEntry>& a_classes);
+
+    /// A class which has no node yet.
+    struct PendingClass
+    {
+        KDevelop::IndexedQualifiedIdentifier id;
+        KDevelop::IndexedDeclaration declaration;
+        QString displayName;
+    };
+
+    /// Create the nodes for the next batch of pending classes in @p a_parent.
+    void fetchMoreClasses(Node* a_parent);
+    bool hasPendingClasses(const Node* a_parent) const;
+    void removePendingClasses(Node* a_parent, const QSet<KDevelop::IndexedQualifiedIdentifier>& a_ids);
+
+    /// Classes without node per parent node, sorted by descending name so the next batch is at the end.
+    QHash<Node*, QVector<PendingClass>> m_pendingClasses;
+    /// Parent nodes whose pending classes need to be sorted before creating the next batch.
+    QSet<Node*> m_unsortedPendingClasses;
+
+    /// Incremented when the node is cleared, so results of running background parses are dropped.
+    int m_generation = 0;
+
 private: // Opened class identifiers container definition.
     // An opened class item.
     struct OpenedFileClassItem
@@ -84,7 +145,7 @@ private: // Opened class identifiers container definition.
         OpenedFileClassItem();
         OpenedFileClassItem(const KDevelop::IndexedString& a_file,
                             const KDevelop::IndexedQualifiedIdentifier& a_classIdentifier,
-                            ClassNode* a_nodeItem);
+                            ClassNode* a_nodeItem, Node* a_parentNode);
 
         /// The file this class declaration comes from.
         KDevelop::IndexedString file;
@@ -92,8 +153,14 @@ private: // Opened class identifiers container definition.
         /// The identifier for this class.
         KDevelop::IndexedQualifiedIdentifier classIdentifier;
 
-        /// An existing node item. It maybe 0 - meaning the class node is currently hidden.
-        ClassNode* nodeItem;
+        /// An existing node item. It maybe 0 - meaning the class node is currently hidden or not created yet.
+        /// Items of the same class declared in several files share this node.
+        /// This is not part of any index, so it may be changed in place.
+        mutable ClassNode* nodeItem;
+
+        /// The node the class is shown in. It maybe 0 - meaning the class is only shown inside its parent class.
+        /// This is not part of any index, so it may be changed in place.
+        mutable Node* parentNode;
     };
 
     // Index definitions.
@@ -118,7 +185,7 @@ private: // Opened class identifiers container definition.
                 boost::multi_index::tag<FileIndex>,
                 FileMember
             >,
-            boost::multi_index::ordered_unique<
+            boost::multi_index::ordered_non_unique<
                 boost::multi_index::tag<ClassIdentifierIndex>,
                 ClassIdentifierMember
             >
@@ -149,6 +216,9 @@ private:
 
     /// Remove a single class node from the lists.
     void removeClassNode(ClassNode* a_node);
+
+    /// Remove the given class items, their node is only removed once no other file declares the class.
+    void removeClassItems(const QVector<FileIterator>& a_items);
 };
 } // namespace ClassModelNodes
 
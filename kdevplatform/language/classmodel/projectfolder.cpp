@@ -18,6 +18,7 @@
 
 #include "../../interfaces/iproject.h"
 #include "../../serialization/indexedstring.h"
+#include <project/projectfileset.h>
 #include <KLocalizedString>
 
 using namespace KDevelop;
@@ -40,12 +41,7 @@ ProjectFolder::ProjectFolder(NodesModelInterface* a_model)
 
 void ProjectFolder::populateNode()
 {
-    const auto files = m_project->fileSet();
-    for (const IndexedString& file : files) {
-        parseDocument(file);
-    }
-
-    recursiveSort();
+    parseDocuments(m_project->fileSetSnapshot());
 }
 
 //////////////////////////////////////////////////////////////////////////////
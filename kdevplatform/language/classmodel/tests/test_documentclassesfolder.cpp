@@ -0,0 +1,129 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "test_documentclassesfolder.h"
+
+#include "../classmodel.h"
+#include "../documentclassesfolder.h"
+
+#include <QTest>
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+#include <language/duchain/codemodel.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+
+QTEST_MAIN(TestDocumentClassesFolder)
+
+using namespace KDevelop;
+using namespace ClassModelNodes;
+
+namespace {
+class TestNodesModel
+    : public NodesModelInterface
+{
+public:
+    void nodesLayoutAboutToBeChanged(Node*) override {}
+    void nodesLayoutChanged(Node*) override {}
+    void nodesAboutToBeRemoved(Node*, int, int) override {}
+    void nodesRemoved(Node*) override {}
+    void nodesAboutToBeAdded(Node*, int, int) override {}
+    void nodesAdded(Node*) override {}
+    Features features() const override { return Features(); }
+};
+
+class TestClassesFolder
+    : public DocumentClassesFolder
+{
+public:
+    explicit TestClassesFolder(NodesModelInterface* a_model)
+        : DocumentClassesFolder(QStringLiteral("Classes"), a_model)
+    {
+    }
+
+    using DocumentClassesFolder::parseDocument;
+    using DocumentClassesFolder::updateDocument;
+    using DocumentClassesFolder::closeDocument;
+};
+
+void setClassDeclared(const IndexedString& file, const IndexedQualifiedIdentifier& id, bool declared)
+{
+    DUChainWriteLocker lock;
+    if (declared)
+        CodeModel::self().addItem(file, id, CodeModelItem::Class);
+    else
+        CodeModel::self().removeItem(file, id);
+}
+}
+
+void TestDocumentClassesFolder::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    DUChain::self()->disablePersistentStorage();
+}
+
+void TestDocumentClassesFolder::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void TestDocumentClassesFolder::testClassInSeveralDocuments()
+{
+    const IndexedString first(QStringLiteral("/test_documentclassesfolder/first.h"));
+    const IndexedString second(QStringLiteral("/test_documentclassesfolder/second.h"));
+    const IndexedQualifiedIdentifier id(QualifiedIdentifier(QStringLiteral("SharedClass")));
+
+    setClassDeclared(first, id, true);
+    setClassDeclared(second, id, true);
+
+    TestNodesModel model;
+    TestClassesFolder folder(&model);
+    folder.parseDocument(first);
+    folder.parseDocument(second);
+
+    // There is no declaration in the symbol table, the class is shown anyway.
+    ClassNode* node = folder.findClassNode(id);
+    QVERIFY(node);
+    QCOMPARE(folder.children().size(), 1);
+
+    // The class is still declared in the second document.
+    folder.closeDocument(first);
+    QCOMPARE(folder.findClassNode(id), node);
+
+    // Re-opening the first document shares the existing node.
+    folder.parseDocument(first);
+    QCOMPARE(folder.findClassNode(id), node);
+    QCOMPARE(folder.children().size(), 1);
+
+    // The class is still declared in the first document.
+    setClassDeclared(second, id, false);
+    QVERIFY(folder.updateDocument(second));
+    QCOMPARE(folder.findClassNode(id), node);
+
+    // No document declares the class anymore.
+    setClassDeclared(first, id, false);
+    QVERIFY(folder.updateDocument(first));
+    QVERIFY(!folder.findClassNode(id));
+    QVERIFY(folder.children().isEmpty());
+
+    folder.closeDocument(first);
+    folder.closeDocument(second);
+}
@@ -42,6 +42,7 @@
 #include "../interfaces/ilanguagesupport.h"
 #include "../interfaces/icodehighlighting.h"
 #include "../backgroundparser/backgroundparser.h"
+#include "../editor/modificationrevision.h"
 #include <debug.h>
 
 #include "language-features.h"
@@ -80,6 +81,9 @@ const uint cleanupEverySeconds = 200;
 const uint maxFinalCleanupCheckContexts = 2000;
 const uint minimumFinalCleanupCheckContextsPercentage = 10; //Check at least n% of all top-contexts during cleanup
 //Set to true as soon as the duchain is deleted
+
+///Count of loaded buckets per item-repository whose trailing free space is reclaimed during each cleanup
+const uint reclaimBucketsPerCleanup = 200;
 }
 
 namespace KDevelop {
@@ -381,6 +385,8 @@ public:
             }
         }
 
+        ModificationRevision::loadFileJournal(globalItemRepositoryRegistry().path() + QLatin1String("/file_journal"));
+
         ///Read in the list of available top-context indices
         {
             QFile f(globalItemRepositoryRegistry().path() + QLatin1String("/available_top_context_indices"));
@@ -884,6 +890,10 @@ unloadContexts:
                 //If nothing has changed, it is only a low-cost call.
                 unload->m_dynamicData->store();
                 Q_ASSERT(!unload->d_func()->m_dynamic);
+                if (LANGUAGE().isDebugEnabled()) {
+                    // collecting the statistics walks all loaded items, don't do it for nothing
+                    qCDebug(LANGUAGE) << "unloading" << unload->url().str() << unload->memoryStatistics();
+                }
                 removeDocumentChainFromMemory(unload);
                 workOnContexts.remove(unload);
                 unloadedOne = true;
@@ -935,6 +945,9 @@ unloadContexts:
         if (retries)
             writeLock.unlock();
 
+        //Give the space of deleted items back for reuse incrementally, so it is stored together with the buckets
+        globalItemRepositoryRegistry().reclaimTrailingFreeSpace(reclaimBucketsPerCleanup);
+
         //This must be the last step, due to the on-disk reference counting
         globalItemRepositoryRegistry().store(); //Stores all repositories
 
@@ -943,17 +956,23 @@ unloadContexts:
             ///@todo Solve this more elegantly, using a general mechanism to store static duchain-like data
             Q_ASSERT(ParsingEnvironmentFile::m_staticData);
             QFile f(globalItemRepositoryRegistry().path() + QLatin1String("/parsing_environment_data"));
+            globalItemRepositoryRegistry().journalReplacedFile(f.fileName());
             bool opened = f.open(QIODevice::WriteOnly);
             Q_ASSERT(opened);
             Q_UNUSED(opened);
             f.write(reinterpret_cast<const char*>(ParsingEnvironmentFile::m_staticData), sizeof(StaticParsingEnvironmentData));
         }
 
+        const QString fileJournalPath = globalItemRepositoryRegistry().path() + QLatin1String("/file_journal");
+        globalItemRepositoryRegistry().journalReplacedFile(fileJournalPath);
+        ModificationRevision::storeFileJournal(fileJournalPath);
+
         ///Write out the list of available top-context indices
         {
             QMutexLocker lock(&m_chainsMutex);
 
             QFile f(globalItemRepositoryRegistry().path() + QLatin1String("/available_top_context_indices"));
+            globalItemRepositoryRegistry().journalReplacedFile(f.fileName());
             bool opened = f.open(QIODevice::WriteOnly);
             Q_ASSERT(opened);
             Q_UNUSED(opened);
@@ -108,6 +108,10 @@ const IndexedIdentifier& globalIndexedAliasIdentifier()
 void DUContext::rebuildDynamicData(DUContext* parent, uint ownIndex)
 {
     Q_ASSERT(!parent || ownIndex);
+    if (!m_dynamicData) {
+        // the dynamic data of contexts loaded from disk can only be created once the top-context is known
+        m_dynamicData = parent->topContext()->m_dynamicData->createContextDynamicData(this);
+    }
     m_dynamicData->m_topContext = parent ? parent->topContext() : static_cast<TopDUContext*>(this);
     m_dynamicData->m_indexInTopContext = ownIndex;
     m_dynamicData->m_parentContext = DUContextPointer(parent);
@@ -349,13 +353,14 @@ int DUContext::depth() const
 
 DUContext::DUContext(DUContextData& data)
     : DUChainBase(data)
-    , m_dynamicData(new DUContextDynamicData(this))
+    , m_dynamicData(nullptr)
 {
 }
 
 DUContext::DUContext(const RangeInRevision& range, DUContext* parent, bool anonymous)
     : DUChainBase(*new DUContextData(), range)
-    , m_dynamicData(new DUContextDynamicData(this))
+    , m_dynamicData(parent ? parent->topContext()->m_dynamicData->createContextDynamicData(this)
+                    : new DUContextDynamicData(this))
 {
     d_func_dynamic()->setClassId(this);
     if (parent)
@@ -394,12 +399,16 @@ bool DUContext::isAnonymous() const
 void DUContext::initFromTopContext()
 {
     Q_ASSERT(dynamic_cast<TopDUContext*>(this));
+    if (!m_dynamicData) {
+        m_dynamicData = new DUContextDynamicData(this);
+    }
     m_dynamicData->m_topContext = static_cast<TopDUContext*>(this);
 }
 
 DUContext::DUContext(DUContextData& dd, const RangeInRevision& range, DUContext* parent, bool anonymous)
     : DUChainBase(dd, range)
-    , m_dynamicData(new DUContextDynamicData(this))
+    , m_dynamicData(parent ? parent->topContext()->m_dynamicData->createContextDynamicData(this)
+                    : new DUContextDynamicData(this))
 {
     if (parent)
         m_dynamicData->m_topContext = parent->topContext();
@@ -471,9 +480,11 @@ DUContext::~DUContext()
         Q_ASSERT(d_func()->isDynamic() ==
                 (doCleanup ||
                 top->m_dynamicData->isTemporaryContextIndex(m_dynamicData->m_indexInTopContext)));
-    }
 
-    delete m_dynamicData;
+        top->m_dynamicData->destroyContextDynamicData(m_dynamicData);
+    } else {
+        delete m_dynamicData;
+    }
 }
 
 QVector<DUContext*> DUContext::childContexts() const
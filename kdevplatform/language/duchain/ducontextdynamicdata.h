@@ -23,6 +23,11 @@
 #define DUCONTEXTDYNAMICDATA_H
 
 #include "ducontextdata.h"
+#include <QMutex>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace KDevelop {
 ///This class contains data that is only runtime-dependent and does not need to be stored to disk
@@ -160,6 +165,103 @@ public:
     bool imports(const DUContext* context, const TopDUContext* source,
                  QSet<const DUContextDynamicData*>* recursionGuard) const;
 };
+
+/**
+ * Allocates the dynamic data of the contexts of one top-context from a few large blocks,
+ * instead of doing one heap allocation per context. Slots of destroyed contexts are reused,
+ * the blocks themselves are only freed together with the arena, when the top-context is unloaded.
+ *
+ * The first block is sized for the expected number of contexts, later blocks double the
+ * allocated slots, so top-contexts with only a few contexts don't waste a full block.
+ *
+ * Contexts are also loaded from disk while only the duchain read-lock is held, so the slots are
+ * guarded by their own mutex.
+ */
+class DUContextDynamicDataArena
+{
+public:
+    DUContextDynamicDataArena() = default;
+    DUContextDynamicDataArena(const DUContextDynamicDataArena&) = delete;
+    DUContextDynamicDataArena& operator=(const DUContextDynamicDataArena&) = delete;
+
+    /**
+     * @param expectedSlots The number of contexts expected to be created, used to size the first block.
+     */
+    DUContextDynamicData* create(DUContext* context, uint expectedSlots = 0)
+    {
+        Slot* slot;
+        {
+            QMutexLocker lock(&m_mutex);
+            slot = m_freeList;
+            if (slot) {
+                m_freeList = slot->nextFree;
+            } else {
+                if (m_usedInLastBlock == m_lastBlockSlots) {
+                    const uint wantedSlots = m_blocks.empty() ? expectedSlots : m_allocatedSlots;
+                    m_lastBlockSlots = qBound<uint>(minSlotsPerBlock, wantedSlots, maxSlotsPerBlock);
+                    m_blocks.emplace_back(new Slot[m_lastBlockSlots]);
+                    m_allocatedSlots += m_lastBlockSlots;
+                    m_usedInLastBlock = 0;
+                }
+                slot = &m_blocks.back()[m_usedInLastBlock++];
+            }
+            ++m_usedSlots;
+        }
+        return new (&slot->storage) DUContextDynamicData(context);
+    }
+
+    void destroy(DUContextDynamicData* data)
+    {
+        data->~DUContextDynamicData();
+        auto* slot = reinterpret_cast<Slot*>(data);
+
+        QMutexLocker lock(&m_mutex);
+        slot->nextFree = m_freeList;
+        m_freeList = slot;
+        --m_usedSlots;
+    }
+
+    /**
+     * Destroys @p data while the whole arena is about to be freed.
+     * The slot is not made available again, which saves taking the mutex for every context.
+     */
+    void destroyForTeardown(DUContextDynamicData* data)
+    {
+        data->~DUContextDynamicData();
+    }
+
+    uint usedSlots() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_usedSlots;
+    }
+
+    size_t allocatedBytes() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_allocatedSlots * sizeof(Slot);
+    }
+
+private:
+    enum {
+        minSlotsPerBlock = 8,
+        maxSlotsPerBlock = 256
+    };
+
+    union Slot
+    {
+        Slot* nextFree;
+        std::aligned_storage<sizeof(DUContextDynamicData), alignof(DUContextDynamicData)>::type storage;
+    };
+
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<Slot[]>> m_blocks;
+    Slot* m_freeList = nullptr;
+    uint m_lastBlockSlots = 0;
+    uint m_usedInLastBlock = 0;
+    uint m_allocatedSlots = 0;
+    uint m_usedSlots = 0;
+};
 }
 
 Q_DECLARE_TYPEINFO(KDevelop::DUContextDynamicData::VisibleDeclarationIterator::StackEntry, Q_MOVABLE_TYPE);
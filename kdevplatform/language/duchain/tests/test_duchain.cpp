@@ -25,6 +25,8 @@
 
 #include <QTest>
 #include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
 
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
@@ -42,6 +44,7 @@
 #include <language/duchain/parsingenvironment.h>
 
 #include <language/codegen/coderepresentation.h>
+#include <language/editor/modificationrevision.h>
 
 #include <language/util/setrepository.h>
 #include <language/util/basicsetrepository.h>
@@ -1074,6 +1077,127 @@ void TestDUChain::benchDUChainItemFactory_copy_data()
     QTest::newRow("flip") << 2;
 }
 
+void TestDUChain::testContextDynamicDataArena()
+{
+    DUChain::self()->disablePersistentStorage(false);
+
+    const IndexedString url("/my/test/arena");
+    // more contexts than fit into one block of the arena
+    const int contextCount = 300;
+
+    TopDUContextPointer smartTop;
+
+    {
+        DUChainWriteLocker lock;
+        auto file = new ParsingEnvironmentFile(url);
+        auto top = new TopDUContext(url, {0, 0, contextCount * 2, 0}, file);
+
+        const auto dynamicDataBytes = [top]() {
+            const auto statistics = top->memoryStatistics();
+            const int start = statistics.indexOf(QLatin1String("dynamic data: ")) + 14;
+            return statistics.midRef(start, statistics.indexOf(QLatin1Char(' '), start) - start).toUInt();
+        };
+
+        QVector<DUContext*> contexts;
+        uint singleContextBytes = 0;
+        for (int i = 0; i < contextCount; ++i) {
+            auto context = new DUContext({i, 0, i, 1}, top);
+            context->setLocalScopeIdentifier(QualifiedIdentifier(QString::number(i)));
+            contexts << context;
+            if (i == 0) {
+                singleContextBytes = dynamicDataBytes();
+            }
+        }
+        // the blocks grow with the number of contexts, a single one does not get a full block
+        QVERIFY(singleContextBytes > 0);
+        QVERIFY(singleContextBytes * 16 < dynamicDataBytes());
+        // free some slots, so they get reused
+        for (int i = 0; i < contextCount; i += 3) {
+            delete contexts.at(i);
+        }
+        for (int i = contextCount; i < contextCount + 10; ++i) {
+            new DUContext({i, 0, i, 1}, top);
+        }
+        QCOMPARE(top->childContexts().size(), contextCount - contextCount / 3 + 10);
+        QVERIFY(top->memoryStatistics().startsWith(QStringLiteral("loaded contexts: %1 ").arg(top->childContexts().size())));
+
+        DUChain::self()->addDocumentChain(top);
+        smartTop = top;
+    }
+
+    DUChain::self()->storeToDisk();
+
+    {
+        DUChainWriteLocker lock;
+        QVERIFY(!smartTop);
+        auto top = DUChain::self()->chainForDocument(url);
+        QVERIFY(top);
+        smartTop = top;
+
+        // loading the child contexts creates their dynamic data in the arena of the loaded top-context
+        const auto children = top->childContexts();
+        QCOMPARE(children.size(), contextCount - contextCount / 3 + 10);
+        QCOMPARE(children.first()->localScopeIdentifier(), QualifiedIdentifier(QStringLiteral("1")));
+        QVERIFY(top->memoryStatistics().startsWith(QStringLiteral("loaded contexts: %1 ").arg(children.size())));
+
+        DUChain::self()->removeDocumentChain(top);
+        QVERIFY(!smartTop);
+    }
+}
+
+void TestDUChain::testModificationRevisionJournal()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath(QStringLiteral("journal.cpp"));
+    const QString journalPath = dir.filePath(QStringLiteral("file_journal"));
+    const IndexedString url(filePath);
+
+    // rewrites the file, which also bumps its modification-time by at least one second
+    auto writeFile = [&](const QByteArray& contents) {
+        QTest::qSleep(1100);
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(contents);
+        file.close();
+        ModificationRevision::clearModificationCache(url);
+    };
+
+    writeFile("int foo;");
+    const auto first = ModificationRevision::revisionForFile(url);
+    QVERIFY(ModificationRevision::isUpToDate(url, first));
+
+    // the contents are recorded when the file is seen for the first time, so touching it
+    // keeps the previously recorded revision valid
+    writeFile("int foo;");
+    const auto touched = ModificationRevision::revisionForFile(url);
+    QVERIFY(touched != first);
+    QVERIFY(ModificationRevision::isUpToDate(url, first));
+
+    writeFile("int foo;");
+    QVERIFY(ModificationRevision::revisionForFile(url) != touched);
+    QVERIFY(ModificationRevision::isUpToDate(url, touched));
+
+    // changed contents of the same size
+    writeFile("int bar;");
+    QVERIFY(!ModificationRevision::isUpToDate(url, touched));
+    const auto changed = ModificationRevision::revisionForFile(url);
+
+    // the journal survives a store/load round trip
+    ModificationRevision::storeFileJournal(journalPath);
+    ModificationRevision::loadFileJournal(journalPath);
+    writeFile("int bar;");
+    QVERIFY(ModificationRevision::revisionForFile(url) != changed);
+    QVERIFY(ModificationRevision::isUpToDate(url, changed));
+
+    // files not looked up since the journal was loaded are dropped when storing it
+    ModificationRevision::loadFileJournal(journalPath);
+    ModificationRevision::storeFileJournal(journalPath);
+    ModificationRevision::loadFileJournal(journalPath);
+    ModificationRevision::clearModificationCache(url);
+    QVERIFY(!ModificationRevision::isUpToDate(url, changed));
+}
+
 void TestDUChain::benchDeclarationQualifiedIdentifier()
 {
     QVector<DUContext*> contexts;
@@ -46,6 +46,8 @@ private Q_SLOTS:
     void testLockForRead();
     void testLockForReadWrite();
     void testProblemSerialization();
+    void testContextDynamicDataArena();
+    void testModificationRevisionJournal();
     void testIdentifiers();
     ///NOTE: these are not "automated"!
 //     void testImportCache();
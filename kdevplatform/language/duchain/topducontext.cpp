@@ -1128,6 +1128,11 @@ bool TopDUContext::isOnDisk() const
     return m_dynamicData->isOnDisk();
 }
 
+QString TopDUContext::memoryStatistics() const
+{
+    return m_dynamicData->statistics().print();
+}
+
 void TopDUContext::clearUsedDeclarationIndices()
 {
     ENSURE_CAN_WRITE
@@ -146,6 +146,11 @@ public:
     /// Whether this top-context has a stored version on disk
     bool isOnDisk() const;
 
+    /**
+     * Returns a summary of the memory used by the currently loaded contexts and declarations of this top-context.
+     * */
+    QString memoryStatistics() const;
+
     /**
      * Returns a list of all problems encountered while parsing this top-context.
      * Does not include the problems of imported contexts.
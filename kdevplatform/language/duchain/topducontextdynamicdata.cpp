@@ -648,9 +648,10 @@ void TopDUContextDynamicData::deleteOnDisk()
 
     m_onDisk = false;
 
-    bool successfullyRemoved = QFile::remove(filePath());
-    Q_UNUSED(successfullyRemoved);
-    Q_ASSERT(successfullyRemoved);
+    // while the repository is locked for writing, the journal moves the file aside
+    globalItemRepositoryRegistry().journalReplacedFile(filePath());
+    QFile::remove(filePath());
+    Q_ASSERT(!QFile::exists(filePath()));
     qCDebug(LANGUAGE) << "deletion ready";
 }
 
@@ -736,6 +737,7 @@ void TopDUContextDynamicData::store()
     QDir().mkpath(basePath());
 
     QFile file(filePath());
+    globalItemRepositoryRegistry().journalReplacedFile(file.fileName());
     if (file.open(QIODevice::WriteOnly)) {
         file.resize(0);
 
@@ -871,6 +873,89 @@ void TopDUContextDynamicData::clearContextIndex(DUContext* context)
     m_contexts.clearItemIndex(context, context->m_dynamicData->m_indexInTopContext);
 }
 
+DUContextDynamicData* TopDUContextDynamicData::createContextDynamicData(DUContext* ctx)
+{
+    // when loading from disk, the stored contexts are the ones expected to be loaded
+    return m_contextDataArena.create(ctx, m_dataLoaded ? m_contexts.offsets.size() : 0);
+}
+
+void TopDUContextDynamicData::destroyContextDynamicData(DUContextDynamicData* data)
+{
+    if (m_deleting) {
+        // the arena is freed right after the contexts are deleted
+        m_contextDataArena.destroyForTeardown(data);
+    } else {
+        m_contextDataArena.destroy(data);
+    }
+}
+
+TopDUContextDynamicData::Statistics TopDUContextDynamicData::statistics() const
+{
+    Statistics ret;
+
+    auto addContext = [&ret](const DUContext* context) {
+        const auto* dynamicData = context->m_dynamicData;
+        ret.dynamicDataBytes += dynamicData->m_childContexts.capacity() * sizeof(DUContext*)
+                              + dynamicData->m_localDeclarations.capacity() * sizeof(Declaration*);
+    };
+
+    // the top-context itself is not allocated from the arena
+    ret.dynamicDataBytes = m_contextDataArena.allocatedBytes() + sizeof(DUContextDynamicData);
+    addContext(m_topContext);
+
+    for (const auto* context : qAsConst(m_contexts.items)) {
+        if (context) {
+            ++ret.loadedContexts;
+            addContext(context);
+        }
+    }
+    for (const auto* context : qAsConst(m_contexts.temporaryItems)) {
+        if (context) {
+            ++ret.temporaryItems;
+            addContext(context);
+        }
+    }
+    for (const auto* declaration : qAsConst(m_declarations.items)) {
+        if (declaration) {
+            ++ret.loadedDeclarations;
+        }
+    }
+    for (const auto* declaration : qAsConst(m_declarations.temporaryItems)) {
+        if (declaration) {
+            ++ret.temporaryItems;
+        }
+    }
+    ret.storedContexts = m_contexts.offsets.size();
+    ret.storedDeclarations = m_declarations.offsets.size();
+
+    ret.indexTableBytes = (m_contexts.items.capacity() + m_contexts.temporaryItems.capacity()) * sizeof(DUContext*)
+                        + (m_declarations.items.capacity() + m_declarations.temporaryItems.capacity()) * sizeof(Declaration*)
+                        + (m_contexts.offsets.capacity() + m_declarations.offsets.capacity()) * sizeof(ItemDataInfo);
+
+    if (m_mappedData) {
+        ret.itemDataBytes = m_mappedDataSize;
+    } else {
+        for (const auto& data : qAsConst(m_data)) {
+            ret.itemDataBytes += data.array.size();
+        }
+    }
+    for (const auto& data : qAsConst(m_topContextData)) {
+        ret.itemDataBytes += data.array.size();
+    }
+
+    return ret;
+}
+
+QString TopDUContextDynamicData::Statistics::print() const
+{
+    QString ret;
+    ret += QStringLiteral("loaded contexts: %1 of %2 loaded declarations: %3 of %4 temporary items: %5").arg(
+        loadedContexts).arg(storedContexts).arg(loadedDeclarations).arg(storedDeclarations).arg(temporaryItems);
+    ret += QStringLiteral("\ndynamic data: %1 bytes index tables: %2 bytes item data: %3 bytes").arg(
+        dynamicDataBytes).arg(indexTableBytes).arg(itemDataBytes);
+    return ret;
+}
+
 void TopDUContextDynamicData::clearProblems()
 {
     m_problems.clearItems();
@@ -22,6 +22,7 @@
 #include <QVector>
 #include <QByteArray>
 #include "problem.h"
+#include "ducontextdynamicdata.h"
 
 class QFile;
 
@@ -70,6 +71,14 @@ public:
 
     void clearContextIndex(DUContext* ctx);
 
+    /**
+     * Creates the dynamic data of a context within this top-context.
+     * The memory is taken from an arena that is freed in one step together with this object.
+     * While the top-context is deleted, the slots are not made available for reuse anymore.
+     */
+    DUContextDynamicData* createContextDynamicData(DUContext* ctx);
+    void destroyContextDynamicData(DUContextDynamicData* data);
+
     /**
      * Allocates an index for the given problem in this top-context.
      * The returned index is never zero.
@@ -104,6 +113,26 @@ public:
     bool isTemporaryContextIndex(uint index) const;
     bool isTemporaryDeclarationIndex(uint index) const;
 
+    struct Statistics
+    {
+        uint loadedContexts = 0;
+        uint storedContexts = 0;
+        uint loadedDeclarations = 0;
+        uint storedDeclarations = 0;
+        uint temporaryItems = 0;
+        /// Memory of the contexts' dynamic data and of their child and declaration lists
+        size_t dynamicDataBytes = 0;
+        /// Memory of the tables that map the local indices to the items
+        size_t indexTableBytes = 0;
+        /// Size of the data loaded or mapped from disk, or of the not yet stored data
+        size_t itemDataBytes = 0;
+
+        QString print() const;
+    };
+
+    /// Returns the memory used by the currently loaded items of this top-context
+    Statistics statistics() const;
+
     bool m_deleting; ///Flag used during destruction
 
     struct ItemDataInfo
@@ -134,6 +163,9 @@ private:
 
     TopDUContext* m_topContext;
 
+    // declared before the item storages, so it outlives all contexts deleted with them
+    DUContextDynamicDataArena m_contextDataArena;
+
     template <class Item>
     struct DUChainItemStorage
     {
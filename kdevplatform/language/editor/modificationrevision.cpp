@@ -19,17 +19,29 @@
 #include "modificationrevision.h"
 
 #include <QString>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
 #include <QFileInfo>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSaveFile>
+#include <QtConcurrentMap>
 
 #include <serialization/indexedstring.h>
+#include <debug.h>
 #include "modificationrevisionset.h"
 
 #include <KTextEditor/Document>
 
-/// @todo Listen to filesystem changes (together with the project manager)
-/// and call fileModificationCache().clear(...) when a file has changed
+/// The background parser clears the cached modification-time of project files when
+/// the project watcher reports them as changed, other files are read again after
+/// cacheModificationTimesForSeconds.
+///
+/// On-disk modification-times are additionally recorded in a journal together with the file size
+/// and a content-hash. When a file is touched without changing its contents (e.g. by a checkout
+/// or a build-system regenerating it), isUpToDate() still accepts the revisions recorded before,
+/// so the duchain data depending on the file is not considered outdated.
 
 using namespace KDevelop;
 
@@ -60,22 +72,107 @@ OpenDocumentRevisionsMap& openDocumentsRevisionMap()
     return map;
 }
 
-QDateTime fileModificationTimeCached(const IndexedString& fileName)
+///Stat-data and content-hash of a file as seen the last time its modification-time was read
+struct FileJournalEntry
 {
-    const auto currentTime = QDateTime::currentDateTime();
+    qint64 diskModificationTime; //Milliseconds since epoch, as reported by the file-system
+    qint64 size;
+    QByteArray contentHash; //Empty if the file could not be read
+    qint64 contentModificationTime; //Milliseconds since epoch, the first modification-time seen with the current contents
+    bool used; //Whether the file was looked up in this session. Unused entries are not stored again.
+};
+Q_DECLARE_TYPEINFO(FileJournalEntry, Q_MOVABLE_TYPE);
+
+using FileJournal = QHash<KDevelop::IndexedString, FileJournalEntry>;
 
+FileJournal& fileJournal()
+{
+    static FileJournal journal;
+    return journal;
+}
+
+//bump whenever the format of the stored journal changes
+const quint32 fileJournalFormatVersion = 2;
+
+//Below this amount of files, spreading the lookups over multiple threads does not pay off
+const int minimumParallelPrefetchCount = 16;
+
+bool cachedModificationTime(const IndexedString& fileName, const QDateTime& currentTime, QDateTime* modificationTime)
+{
     auto it = fileModificationCache().constFind(fileName);
     if (it != fileModificationCache().constEnd()) {
         ///Use the cache for X seconds
         if (it.value().m_readTime.secsTo(currentTime) < cacheModificationTimesForSeconds) {
-            return it.value().m_modificationTime;
+            *modificationTime = it.value().m_modificationTime;
+            return true;
+        }
+    }
+    return false;
+}
+
+QByteArray fileContentHash(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
+
+///Reads the modification-time of the given file from disk and caches it.
+///The file-system is accessed without holding fileModificationTimeCacheMutex, so lookups from multiple threads don't serialize.
+QDateTime readModificationTime(const IndexedString& fileName)
+{
+    const auto currentTime = QDateTime::currentDateTime();
+    const QString filePath = fileName.str();
+    const QFileInfo fileInfo(filePath);
+    const auto modificationTime = fileInfo.lastModified();
+
+    if (fileInfo.exists()) {
+        FileJournalEntry entry = {-1, -1, QByteArray(), -1, false};
+        {
+            QMutexLocker lock(&fileModificationTimeCacheMutex);
+            entry = fileJournal().value(fileName, entry);
         }
+
+        const qint64 diskTime = modificationTime.toMSecsSinceEpoch();
+        const qint64 size = fileInfo.size();
+        const bool knownFile = (entry.size != -1);
+        if (!knownFile) {
+            //Record the contents right away, so a later touch can be told apart from a change
+            entry.contentHash = fileContentHash(filePath);
+            entry.contentModificationTime = diskTime;
+            entry.diskModificationTime = diskTime;
+            entry.size = size;
+        } else if (entry.diskModificationTime != diskTime || entry.size != size) {
+            const QByteArray contentHash = fileContentHash(filePath);
+            if (contentHash.isEmpty() || entry.contentHash.isEmpty() || entry.size != size
+                || entry.contentHash != contentHash) {
+                //The contents changed, or we cannot tell
+                entry.contentModificationTime = diskTime;
+            }
+            entry.contentHash = contentHash;
+            entry.diskModificationTime = diskTime;
+            entry.size = size;
+        } else if (entry.contentHash.isEmpty()) {
+            //The file could not be read before, the contents are unchanged as far as we know
+            entry.contentHash = fileContentHash(filePath);
+        }
+        entry.used = true;
+
+        QMutexLocker lock(&fileModificationTimeCacheMutex);
+        fileJournal().insert(fileName, entry);
+    } else {
+        QMutexLocker lock(&fileModificationTimeCacheMutex);
+        fileJournal().remove(fileName);
     }
 
-    QFileInfo fileInfo(fileName.str());
-    FileModificationCache data = {currentTime, fileInfo.lastModified()};
+    QMutexLocker lock(&fileModificationTimeCacheMutex);
+    FileModificationCache data = {currentTime, modificationTime};
     fileModificationCache().insert(fileName, data);
-    return data.m_modificationTime;
+    return modificationTime;
 }
 
 void ModificationRevision::clearModificationCache(const IndexedString& fileName)
@@ -88,11 +185,117 @@ void ModificationRevision::clearModificationCache(const IndexedString& fileName)
     fileModificationCache().remove(fileName);
 }
 
+void ModificationRevision::prefetchModificationTimes(const QVector<IndexedString>& fileNames)
+{
+    QVector<IndexedString> uncachedFileNames;
+    {
+        QMutexLocker lock(&fileModificationTimeCacheMutex);
+
+        const auto currentTime = QDateTime::currentDateTime();
+        QDateTime modificationTime;
+        for (const auto& fileName : fileNames) {
+            if (!cachedModificationTime(fileName, currentTime, &modificationTime)) {
+                uncachedFileNames.append(fileName);
+            }
+        }
+    }
+
+    if (uncachedFileNames.size() < minimumParallelPrefetchCount) {
+        for (const auto& fileName : qAsConst(uncachedFileNames)) {
+            readModificationTime(fileName);
+        }
+        return;
+    }
+
+    QtConcurrent::blockingMap(uncachedFileNames, [](const IndexedString& fileName) {
+        readModificationTime(fileName);
+    });
+}
+
+void ModificationRevision::loadFileJournal(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 version = 0;
+    stream >> version;
+    if (stream.status() != QDataStream::Ok || version != fileJournalFormatVersion) {
+        qCDebug(LANGUAGE) << "discarding file journal of unsupported version" << version;
+        return;
+    }
+
+    qint32 count = 0;
+    stream >> count;
+
+    FileJournal journal;
+    if (count > 0 && stream.status() == QDataStream::Ok) {
+        journal.reserve(count);
+    }
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        FileJournalEntry entry;
+        stream >> fileName >> entry.diskModificationTime >> entry.size >> entry.contentHash >> entry.contentModificationTime;
+        entry.used = false;
+        journal.insert(IndexedString(fileName), entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(LANGUAGE) << "discarding corrupted file journal" << filePath;
+        return;
+    }
+
+    QMutexLocker lock(&fileModificationTimeCacheMutex);
+    fileJournal() = journal;
+}
+
+void ModificationRevision::storeFileJournal(const QString& filePath)
+{
+    FileJournal journal;
+    {
+        QMutexLocker lock(&fileModificationTimeCacheMutex);
+        //Only keep the files looked up in this session, so the journal does not grow without bounds
+        //with files that were deleted meanwhile or belong to projects which are not used anymore
+        for (auto it = fileJournal().constBegin(), end = fileJournal().constEnd(); it != end; ++it) {
+            if (it->used) {
+                journal.insert(it.key(), *it);
+            }
+        }
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(LANGUAGE) << "failed to write file journal" << filePath << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << fileJournalFormatVersion << static_cast<qint32>(journal.size());
+    for (auto it = journal.constBegin(), end = journal.constEnd(); it != end; ++it) {
+        stream << it.key().str() << it->diskModificationTime << it->size << it->contentHash << it->contentModificationTime;
+    }
+
+    file.commit();
+}
+
 ModificationRevision ModificationRevision::revisionForFile(const IndexedString& url)
 {
     QMutexLocker lock(&fileModificationTimeCacheMutex);
 
-    ModificationRevision ret(fileModificationTimeCached(url));
+    QDateTime modificationTime;
+    if (!cachedModificationTime(url, QDateTime::currentDateTime(), &modificationTime)) {
+        lock.unlock();
+        modificationTime = readModificationTime(url);
+        lock.relock();
+    }
+
+    ModificationRevision ret(modificationTime);
 
     OpenDocumentRevisionsMap::const_iterator it = openDocumentsRevisionMap().constFind(url);
     if (it != openDocumentsRevisionMap().constEnd()) {
@@ -102,6 +305,24 @@ ModificationRevision ModificationRevision::revisionForFile(const IndexedString&
     return ret;
 }
 
+bool ModificationRevision::isUpToDate(const IndexedString& fileName, const ModificationRevision& recorded)
+{
+    const ModificationRevision current = revisionForFile(fileName);
+    if (current == recorded) {
+        return true;
+    }
+    if (current.revision != recorded.revision || recorded.modificationTime > current.modificationTime) {
+        return false;
+    }
+
+    //The file was touched since, check whether its contents still are the ones recorded
+    QMutexLocker lock(&fileModificationTimeCacheMutex);
+    const auto it = fileJournal().constFind(fileName);
+    return it != fileJournal().constEnd()
+        && QDateTime::fromMSecsSinceEpoch(it->diskModificationTime).toSecsSinceEpoch() == current.modificationTime
+        && QDateTime::fromMSecsSinceEpoch(it->contentModificationTime).toSecsSinceEpoch() <= recorded.modificationTime;
+}
+
 void ModificationRevision::clearEditorRevisionForFile(const KDevelop::IndexedString& url)
 {
     ModificationRevisionSet::clearCache(); ///@todo Make the cache management more clever (don't clear the whole)
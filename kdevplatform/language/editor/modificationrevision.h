@@ -20,6 +20,7 @@
 #define KDEVPLATFORM_MODIFICATIONREVISION_H
 
 #include <QDateTime>
+#include <QVector>
 #include <language/languageexport.h>
 #include "../backgroundparser/documentchangetracker.h"
 
@@ -53,6 +54,22 @@ public:
     ///Otherwise, the on-disk modification-times are re-used for a specific amount of time
     static void clearModificationCache(const IndexedString& fileName);
 
+    ///Makes sure the on-disk modification-times of all the given files are cached.
+    ///Files that are not cached yet are read from disk in parallel batches, which is a lot
+    ///faster than one-by-one lookups on slow (e.g. network-mounted) file-systems.
+    static void prefetchModificationTimes(const QVector<IndexedString>& fileNames);
+
+    ///@return whether @p recorded, a revision returned by revisionForFile() earlier, still describes the
+    ///current contents of the file. Unlike comparing it to revisionForFile(), this also is the case when
+    ///the file was only touched since, without its contents changing.
+    static bool isUpToDate(const IndexedString& fileName, const ModificationRevision& recorded);
+
+    ///The journal remembers the stat-data and a content-hash of each file across sessions, which is
+    ///what isUpToDate() uses to recognize touched files. Only the files looked up since the journal was
+    ///loaded are stored again.
+    static void loadFileJournal(const QString& filePath);
+    static void storeFileJournal(const QString& filePath);
+
     ///The default-revision is 0, because that is the kate moving-revision for cleanly opened documents
     explicit ModificationRevision(const QDateTime& modTime = QDateTime(), int revision_ = 0);
 
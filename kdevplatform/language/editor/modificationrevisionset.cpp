@@ -263,8 +263,7 @@ static bool nodeNeedsUpdate(uint index)
         //Do  the actual checking
         for (unsigned int a = nodeData->start(); a < nodeData->end(); ++a) {
             const FileModificationPair* data = fileModificationPairRepository().itemFromIndex(a);
-            ModificationRevision revision = KDevelop::ModificationRevision::revisionForFile(data->file);
-            if (revision != data->revision) {
+            if (!KDevelop::ModificationRevision::isUpToDate(data->file, data->revision)) {
                 result = true;
                 break;
             }
@@ -296,23 +295,46 @@ QString ModificationRevisionSet::toString() const
 
 bool ModificationRevisionSet::needsUpdate() const
 {
+  #ifdef DEBUG_NEEDSUPDATE
     QMutexLocker lock(&modificationRevisionSetMutex);
 
-  #ifdef DEBUG_NEEDSUPDATE
     Utils::Set set(m_index, &FileModificationSetRepositoryRepresenter::repository());
     Utils::Set::Iterator it = set.iterator();
     while (it) {
         const FileModificationPair* data = fileModificationPairRepository().itemFromIndex(*it);
-        ModificationRevision revision = KDevelop::ModificationRevision::revisionForFile(data->file);
-        if (revision != data->revision) {
+        if (!KDevelop::ModificationRevision::isUpToDate(data->file, data->revision)) {
             qCDebug(LANGUAGE) << "dependency" << data->file.str() << "has changed, stored stamp:" << data->revision <<
-                "new time:" << revision;
+                "new time:" << KDevelop::ModificationRevision::revisionForFile(data->file);
             return true;
         }
         ++it;
     }
     return false;
   #else
+    if (!m_index) {
+        return false;
+    }
+
+    QVector<IndexedString> files;
+    {
+        QMutexLocker lock(&modificationRevisionSetMutex);
+        const auto cached = needsUpdateCache.constFind(m_index);
+        if (cached == needsUpdateCache.constEnd()
+            || cached->first.secsTo(QDateTime::currentDateTime()) >= cacheModificationTimesForSeconds) {
+            Utils::Set set(m_index, &FileModificationSetRepositoryRepresenter::repository());
+            for (Utils::Set::Iterator it = set.iterator(); it; ++it) {
+                files.append(fileModificationPairRepository().itemFromIndex(*it)->file);
+            }
+        }
+    }
+
+    // Read all modification-times of the set in one parallel batch, so that nodeNeedsUpdate()
+    // below can be answered from the cache. The lookups don't need modificationRevisionSetMutex,
+    // so this works the same when a caller up the stack still holds it.
+    if (!files.isEmpty()) {
+        ModificationRevision::prefetchModificationTimes(files);
+    }
+
     return nodeNeedsUpdate(m_index);
   #endif
 }
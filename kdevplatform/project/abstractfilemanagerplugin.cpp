@@ -206,7 +206,16 @@ void AbstractFileManagerPluginPrivate::addJobItems(FileManagerListJob* job,
 
     // remove obsolete rows
     for ( int j = 0; j < baseItem->rowCount(); ++j ) {
-        if ( ProjectFolderItem* f = baseItem->child(j)->folder() ) {
+        if ( baseItem->isCompactChild(j) ) {
+            // check if this is still a valid file, without creating an item for it
+            int index = files.indexOf( baseItem->childPath(j) );
+            if ( index == -1 ) {
+                baseItem->removeRow( j );
+                --j;
+            } else {
+                files.remove( index );
+            }
+        } else if ( ProjectFolderItem* f = baseItem->child(j)->folder() ) {
             // check if this is still a valid folder
             int index = folders.indexOf( f->path() );
             if ( index == -1 ) {
@@ -237,7 +246,13 @@ void AbstractFileManagerPluginPrivate::addJobItems(FileManagerListJob* job,
     }
 
     // add new rows
+    // while the project is not in the model yet, nobody can be interested in the items of its files
+    const bool compact = !baseItem->model() && q->storesFilesCompactly(baseItem->project());
     for (const Path& path : qAsConst(files)) {
+        if (compact) {
+            baseItem->appendCompactFile(path.lastPathSegment());
+            continue;
+        }
         ProjectFileItem* file = q->createFileItem( baseItem->project(), path, baseItem );
         if (file) {
             emit q->fileAdded( file );
@@ -687,6 +702,12 @@ ProjectFileItem* AbstractFileManagerPlugin::createFileItem( IProject* project, c
     return new ProjectFileItem( project, path, parent );
 }
 
+bool AbstractFileManagerPlugin::storesFilesCompactly(IProject* project) const
+{
+    Q_UNUSED(project);
+    return false;
+}
+
 ProjectFolderItem* AbstractFileManagerPlugin::createFolderItem( IProject* project, const Path& path,
                                                                 ProjectBaseItem* parent )
 {
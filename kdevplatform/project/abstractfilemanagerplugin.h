@@ -99,6 +99,16 @@ protected:
     virtual ProjectFileItem* createFileItem( IProject* project, const Path& path,
                                              ProjectBaseItem* parent);
 
+    /**
+     * Whether the files found while importing @p project shall be stored compactly,
+     * see ProjectFolderItem::appendCompactFile(). This saves lots of memory for very
+     * large projects, but createFileItem() is not called and fileAdded() is not emitted
+     * for such files. Files which are added later on always get a full item.
+     *
+     * The default implementation returns false.
+     */
+    virtual bool storesFilesCompactly(IProject* project) const;
+
     /**
      * @return the @c KDirWatch for the given @p project.
      */
@@ -0,0 +1,142 @@
+/* This file is part of KDevelop
+    Copyright 2020 The KDevelop developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "projectfileset.h"
+
+#include <QtGlobal>
+
+namespace KDevelop
+{
+
+namespace {
+// pending changes are merged into the base set once there are more of them than this,
+// or than an eighth of the base set, which keeps the amortized cost of a change constant
+const int minimumSqueezeSize = 1024;
+}
+
+quint64 ProjectFileSet::version() const
+{
+    return m_version;
+}
+
+bool ProjectFileSet::contains(const IndexedString& file) const
+{
+    if (m_added.contains(file)) {
+        return true;
+    }
+    return m_base.contains(file) && !m_removed.contains(file);
+}
+
+int ProjectFileSet::size() const
+{
+    return m_base.size() - m_removed.size() + m_added.size();
+}
+
+bool ProjectFileSet::isEmpty() const
+{
+    return size() == 0;
+}
+
+void ProjectFileSet::forEach(const std::function<void(const IndexedString& file)>& callback) const
+{
+    for (const IndexedString& file : m_base) {
+        if (m_removed.isEmpty() || !m_removed.contains(file)) {
+            callback(file);
+        }
+    }
+    for (const IndexedString& file : m_added) {
+        callback(file);
+    }
+}
+
+QSet<IndexedString> ProjectFileSet::toSet() const
+{
+    if (m_added.isEmpty() && m_removed.isEmpty()) {
+        return m_base;
+    }
+    QSet<IndexedString> ret = m_base;
+    ret.subtract(m_removed);
+    ret.unite(m_added);
+    return ret;
+}
+
+bool ProjectFileSet::insert(const IndexedString& file)
+{
+    if (m_removed.remove(file)) {
+        // the file is in m_base again
+        ++m_version;
+        return true;
+    }
+    if (m_base.contains(file) || m_added.contains(file)) {
+        return false;
+    }
+    m_added.insert(file);
+    ++m_version;
+    squeezeIfNeeded();
+    return true;
+}
+
+bool ProjectFileSet::remove(const IndexedString& file)
+{
+    if (m_added.remove(file)) {
+        ++m_version;
+        return true;
+    }
+    if (!m_base.contains(file) || m_removed.contains(file)) {
+        return false;
+    }
+    m_removed.insert(file);
+    ++m_version;
+    squeezeIfNeeded();
+    return true;
+}
+
+void ProjectFileSet::clear()
+{
+    if (isEmpty()) {
+        return;
+    }
+    // don't touch the data shared with snapshots
+    m_base = {};
+    m_added = {};
+    m_removed = {};
+    ++m_version;
+}
+
+void ProjectFileSet::squeeze()
+{
+    if (m_added.isEmpty() && m_removed.isEmpty()) {
+        return;
+    }
+    // this copies the base set if snapshots share it
+    m_base.subtract(m_removed);
+    m_base.unite(m_added);
+    m_added = {};
+    m_removed = {};
+}
+
+void ProjectFileSet::squeezeIfNeeded()
+{
+    const int pending = m_added.size() + m_removed.size();
+    if (pending > qMax(minimumSqueezeSize, m_base.size() / 8)) {
+        squeeze();
+    }
+}
+
+}
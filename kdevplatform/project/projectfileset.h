@@ -0,0 +1,106 @@
+/* This file is part of KDevelop
+    Copyright 2020 The KDevelop developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KDEVPLATFORM_PROJECTFILESET_H
+#define KDEVPLATFORM_PROJECTFILESET_H
+
+#include "projectexport.h"
+
+#include <serialization/indexedstring.h>
+
+#include <QMetaType>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
+
+namespace KDevelop
+{
+
+/**
+ * The set of files of a project, see IProject::fileSetSnapshot().
+ *
+ * ProjectFileSet is a value type: copying it takes constant time and a copy never
+ * changes when the original is modified, so copies can be used as immutable snapshots.
+ *
+ * Internally, a large base set is shared between all copies, and changes are collected
+ * in small additional sets until they are merged into the base set. Changing a set of
+ * which snapshots exist thus only copies the pending changes instead of all files.
+ *
+ * Every modification increments the version, which allows to match a snapshot
+ * with the ProjectFileSetDelta instances emitted by IProject::fileSetChanged().
+ */
+class KDEVPLATFORMPROJECT_EXPORT ProjectFileSet
+{
+public:
+    /// @return the version of the set, which is incremented by every modification
+    quint64 version() const;
+
+    bool contains(const IndexedString& file) const;
+    int size() const;
+    bool isEmpty() const;
+
+    /// Calls @p callback for all files, in no particular order
+    void forEach(const std::function<void(const IndexedString& file)>& callback) const;
+
+    /**
+     * @return all files as QSet
+     *
+     * This is cheap if there are no pending changes, e.g. after calling squeeze().
+     */
+    QSet<IndexedString> toSet() const;
+
+    /// @return true if @p file was not in the set yet
+    bool insert(const IndexedString& file);
+    /// @return true if @p file was in the set
+    bool remove(const IndexedString& file);
+    void clear();
+
+    /// Merges the pending changes into the shared base set
+    void squeeze();
+
+private:
+    void squeezeIfNeeded();
+
+    QSet<IndexedString> m_base;
+    // files which are not in m_base, and files of m_base which are no longer in the set
+    QSet<IndexedString> m_added;
+    QSet<IndexedString> m_removed;
+    quint64 m_version = 0;
+};
+
+/**
+ * The changes of a project's file set, see IProject::fileSetChanged().
+ */
+struct ProjectFileSetDelta
+{
+    /// The version of the file set before and after the changes
+    quint64 fromVersion = 0;
+    quint64 toVersion = 0;
+    /// If true, the file set was cleared before the files in @c added were added, e.g. because the project was reloaded
+    bool cleared = false;
+    QVector<IndexedString> added;
+    QVector<IndexedString> removed;
+};
+
+}
+
+Q_DECLARE_METATYPE(KDevelop::ProjectFileSetDelta)
+
+#endif // KDEVPLATFORM_PROJECTFILESET_H
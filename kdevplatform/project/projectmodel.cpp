@@ -26,6 +26,7 @@
 #include <QMimeType>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QVector>
 
 #include <kio_version.h>
 #include <KIO/StatJob>
@@ -36,6 +37,7 @@
 #include <interfaces/icore.h>
 #include "interfaces/iprojectfilemanager.h"
 #include <serialization/indexedstring.h>
+#include <serialization/internedpath.h>
 
 #include "debug.h"
 #include "path.h"
@@ -94,8 +96,27 @@ public:
         return model->itemFromIndex( idx );
     }
 
+    /// @return the parent item if @p idx refers to a compactly stored file, which has no item yet
+    ProjectBaseItem* compactFileParent(const QModelIndex& idx) const
+    {
+        if (!compactFileCount || idx.column() != 0 || idx.model() != model) {
+            return nullptr;
+        }
+        auto* parent = static_cast<ProjectBaseItem*>(idx.internalPointer());
+        return parent && parent->isCompactChild(idx.row()) ? parent : nullptr;
+    }
+
     // a hash of IndexedString::indexForString(path) <-> ProjectBaseItem for fast lookup
     QMultiHash<uint, ProjectBaseItem*> pathLookupTable;
+    // the number of compactly stored files in the model, they are not in the pathLookupTable
+    int compactFileCount = 0;
+};
+
+/// A child slot of an item. For compactly stored files no item exists, only their path is known.
+struct ProjectBaseItemChild
+{
+    ProjectBaseItem* item;
+    InternedPath compactPath;
 };
 
 class ProjectBaseItemPrivate
@@ -105,15 +126,31 @@ public:
     ProjectModel* model = nullptr;
     IProject* project = nullptr;
     ProjectBaseItem* parent = nullptr;
-    QList<ProjectBaseItem*> children;
+    QVector<ProjectBaseItemChild> children;
     QString text;
     Path m_path;
+    // only computed once compactly stored files are appended
+    InternedPath m_internedPath;
     QString iconName;
     int row = -1;
+    int compactChildCount = 0;
     uint m_pathIndex = 0;
     ProjectBaseItem::ProjectItemType type;
     Qt::ItemFlags flags;
 
+    int compactRow(const InternedPath& path) const
+    {
+        if (!compactChildCount) {
+            return -1;
+        }
+        for (int i = 0; i < children.size(); ++i) {
+            if (!children.at(i).item && children.at(i).compactPath == path) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
     ProjectBaseItem::RenameStatus renameBaseItem(ProjectBaseItem* item, const QString& newName)
     {
         if (item->parent()) {
@@ -198,16 +235,111 @@ ProjectBaseItem::~ProjectBaseItem()
 ProjectBaseItem* ProjectBaseItem::child( int row ) const
 {
     Q_D(const ProjectBaseItem);
-    if( row < 0 || row >= d->children.length() ) {
+    if( row < 0 || row >= d->children.size() ) {
         return nullptr;
     }
-    return d->children.at( row );
+    if (ProjectBaseItem* item = d->children.at(row).item) {
+        return item;
+    }
+    // items of compactly stored files are created on demand
+    return const_cast<ProjectBaseItem*>(this)->createCompactChildItem(row);
 }
 
 QList< ProjectBaseItem* > ProjectBaseItem::children() const
 {
     Q_D(const ProjectBaseItem);
-    return d->children;
+    QList<ProjectBaseItem*> children;
+    children.reserve(d->children.size());
+    for (int i = 0; i < d->children.size(); ++i) {
+        children.append(child(i));
+    }
+    return children;
+}
+
+bool ProjectBaseItem::isCompactChild( int row ) const
+{
+    Q_D(const ProjectBaseItem);
+    return row >= 0 && row < d->children.size() && !d->children.at(row).item;
+}
+
+Path ProjectBaseItem::childPath( int row ) const
+{
+    Q_D(const ProjectBaseItem);
+    if( row < 0 || row >= d->children.size() ) {
+        return Path();
+    }
+    const ProjectBaseItemChild& child = d->children.at(row);
+    return child.item ? child.item->path() : child.compactPath.toPath();
+}
+
+IndexedString ProjectBaseItem::childIndexedPath( int row ) const
+{
+    Q_D(const ProjectBaseItem);
+    if( row < 0 || row >= d->children.size() ) {
+        return IndexedString();
+    }
+    const ProjectBaseItemChild& child = d->children.at(row);
+    return child.item ? child.item->indexedPath() : child.compactPath.toIndexed();
+}
+
+void ProjectBaseItem::appendCompactChild( const QString& name )
+{
+    Q_D(ProjectBaseItem);
+    Q_ASSERT(!name.isEmpty() && !name.contains(QLatin1Char('/')));
+
+    if (!d->m_internedPath.isValid()) {
+        d->m_internedPath = InternedPath(d->m_path);
+    }
+    const InternedPath path(d->m_internedPath, name);
+
+    const int row = d->children.size();
+    if( model() ) {
+        model()->beginInsertRows(index(), row, row);
+    }
+    d->children.append(ProjectBaseItemChild{nullptr, path});
+    ++d->compactChildCount;
+    if( model() ) {
+        ++model()->d_func()->compactFileCount;
+        model()->endInsertRows();
+    }
+
+    if (d->project) {
+        d->project->addPathToFileSet(path.toIndexed());
+    }
+}
+
+ProjectBaseItem* ProjectBaseItem::createCompactChildItem( int row )
+{
+    Q_D(ProjectBaseItem);
+    Q_ASSERT(!d->children.at(row).item);
+
+    // the path is already in the file set, so this does not emit IProject::fileAddedToSet
+    auto* item = new ProjectFileItem(d->project, d->children.at(row).compactPath.toPath());
+
+    d->children[row] = ProjectBaseItemChild{item, InternedPath()};
+    --d->compactChildCount;
+    if( model() ) {
+        --model()->d_func()->compactFileCount;
+    }
+
+    // the row does not change, hence no model signals are required
+    item->d_func()->parent = this;
+    item->setRow(row);
+    item->setModel(model());
+    return item;
+}
+
+void ProjectBaseItem::releaseCompactChild( const InternedPath& path )
+{
+    Q_D(ProjectBaseItem);
+
+    --d->compactChildCount;
+    if( model() ) {
+        --model()->d_func()->compactFileCount;
+    }
+    if (d->project) {
+        d->project->removePathFromFileSet(path.toIndexed());
+    }
 }
 
 ProjectBaseItem* ProjectBaseItem::takeRow(int row)
@@ -215,17 +347,23 @@ ProjectBaseItem* ProjectBaseItem::takeRow(int row)
     Q_D(ProjectBaseItem);
     Q_ASSERT(row >= 0 && row < d->children.size());
 
+    if (!d->children.at(row).item) {
+        createCompactChildItem(row);
+    }
+
     if( model() ) {
         model()->beginRemoveRows(index(), row, row);
     }
-    ProjectBaseItem* olditem = d->children.takeAt( row );
+    ProjectBaseItem* olditem = d->children.takeAt( row ).item;
     olditem->d_func()->parent = nullptr;
     olditem->d_func()->row = -1;
     olditem->setModel( nullptr );
 
     for(int i=row; i<rowCount(); i++) {
-        child(i)->d_func()->row--;
-        Q_ASSERT(child(i)->d_func()->row==i);
+        if (ProjectBaseItem* item = d->children.at(i).item) {
+            item->d_func()->row--;
+            Q_ASSERT(item->d_func()->row==i);
+        }
     }
 
     if( model() ) {
@@ -253,26 +391,31 @@ void ProjectBaseItem::removeRows(int row, int count)
     }
 
     //NOTE: we unset parent, row and model manually to speed up the deletion
-    if (row == 0 && count == d->children.size()) {
-        // optimize if we want to delete all
-        for (ProjectBaseItem* item : qAsConst(d->children)) {
+    auto removeChild = [this](const ProjectBaseItemChild& child) {
+        if (ProjectBaseItem* item = child.item) {
             item->d_func()->parent = nullptr;
             item->d_func()->row = -1;
             item->setModel( nullptr );
             delete item;
+        } else {
+            releaseCompactChild(child.compactPath);
+        }
+    };
+
+    if (row == 0 && count == d->children.size()) {
+        // optimize if we want to delete all
+        for (const ProjectBaseItemChild& child : qAsConst(d->children)) {
+            removeChild(child);
         }
         d->children.clear();
     } else {
-        for (int i = row; i < count; ++i) {
-            ProjectBaseItem* item = d->children.at(i);
-            item->d_func()->parent = nullptr;
-            item->d_func()->row = -1;
-            item->setModel( nullptr );
-            delete d->children.takeAt( row );
+        for (int i = 0; i < count; ++i) {
+            removeChild(d->children.takeAt(row));
         }
         for(int i = row; i < d->children.size(); ++i) {
-            d->children.at(i)->d_func()->row--;
-            Q_ASSERT(child(i)->d_func()->row==i);
+            if (ProjectBaseItem* item = d->children.at(i).item) {
+                item->d_func()->row = i;
+            }
         }
     }
 
@@ -339,18 +482,26 @@ void ProjectBaseItem::setModel( ProjectModel* model )
         return;
     }
 
-    if (d->model && d->m_pathIndex) {
-        d->model->d_func()->pathLookupTable.remove(d->m_pathIndex, this);
+    if (d->model) {
+        if (d->m_pathIndex) {
+            d->model->d_func()->pathLookupTable.remove(d->m_pathIndex, this);
+        }
+        d->model->d_func()->compactFileCount -= d->compactChildCount;
     }
 
     d->model = model;
 
-    if (model && d->m_pathIndex) {
-        model->d_func()->pathLookupTable.insert(d->m_pathIndex, this);
+    if (model) {
+        if (d->m_pathIndex) {
+            model->d_func()->pathLookupTable.insert(d->m_pathIndex, this);
+        }
+        model->d_func()->compactFileCount += d->compactChildCount;
     }
 
-    for (ProjectBaseItem* item : qAsConst(d->children)) {
-        item->setModel( model );
+    for (const ProjectBaseItemChild& child : qAsConst(d->children)) {
+        if (child.item) {
+            child.item->setModel( model );
+        }
     }
 }
 
@@ -441,7 +592,7 @@ void ProjectBaseItem::appendRow( ProjectBaseItem* item )
         startrow = endrow = d->children.count();
         model()->beginInsertRows(index(), startrow, endrow);
     }
-    d->children.append( item );
+    d->children.append(ProjectBaseItemChild{item, InternedPath()});
     item->setRow( d->children.count() - 1 );
     item->d_func()->parent = this;
     item->setModel( model() );
@@ -476,11 +627,28 @@ void ProjectBaseItem::setPath( const Path& path)
 
     d->m_path = path;
     d->m_pathIndex = indexForPath(path);
+    d->m_internedPath = InternedPath();
     setText( path.lastPathSegment() );
 
     if (model() && d->m_pathIndex) {
         model()->d_func()->pathLookupTable.insert(d->m_pathIndex, this);
     }
+
+    if (d->compactChildCount) {
+        // compactly stored files move along with their folder
+        d->m_internedPath = InternedPath(path);
+        for (ProjectBaseItemChild& child : d->children) {
+            if (child.item) {
+                continue;
+            }
+            const InternedPath newPath(d->m_internedPath, child.compactPath.lastPathSegment());
+            if (d->project) {
+                d->project->removePathFromFileSet(child.compactPath.toIndexed());
+                d->project->addPathToFileSet(newPath.toIndexed());
+            }
+            child.compactPath = newPath;
+        }
+    }
 }
 
 Qt::ItemFlags ProjectBaseItem::flags()
@@ -532,8 +700,9 @@ QList<ProjectFolderItem*> ProjectBaseItem::folderList() const
     QList<ProjectFolderItem*> lst;
     for ( int i = 0; i < rowCount(); ++i )
     {
-        ProjectBaseItem* item = child( i );
-        if ( item->type() == Folder || item->type() == BuildFolder )
+        // compactly stored children are always files
+        ProjectBaseItem* item = d_ptr->children.at( i ).item;
+        if ( item && ( item->type() == Folder || item->type() == BuildFolder ) )
         {
             auto *kdevitem = dynamic_cast<ProjectFolderItem*>( item );
             if ( kdevitem )
@@ -549,9 +718,9 @@ QList<ProjectTargetItem*> ProjectBaseItem::targetList() const
     QList<ProjectTargetItem*> lst;
     for ( int i = 0; i < rowCount(); ++i )
     {
-        ProjectBaseItem* item = child( i );
+        ProjectBaseItem* item = d_ptr->children.at( i ).item;
 
-        if ( item->type() == Target || item->type() == LibraryTarget || item->type() == ExecutableTarget )
+        if ( item && ( item->type() == Target || item->type() == LibraryTarget || item->type() == ExecutableTarget ) )
         {
             auto *kdevitem = dynamic_cast<ProjectTargetItem*>( item );
             if ( kdevitem )
@@ -638,8 +807,12 @@ void ProjectFolderItem::propagateRename( const Path& newBase ) const
 {
     Path path = newBase;
     path.addPath(QStringLiteral("dummy"));
-    const auto children = this->children();
-    for (KDevelop::ProjectBaseItem* child : children) {
+    // compactly stored files were already moved by ProjectBaseItem::setPath
+    for (const ProjectBaseItemChild& slot : qAsConst(d_ptr->children)) {
+        ProjectBaseItem* child = slot.item;
+        if (!child) {
+            continue;
+        }
         path.setLastPathSegment( child->text() );
         child->setPath( path );
 
@@ -657,13 +830,22 @@ ProjectBaseItem::RenameStatus ProjectFolderItem::rename(const QString& newName)
 
 bool ProjectFolderItem::hasFileOrFolder(const QString& name) const
 {
-    const auto children = this->children();
-    return std::any_of(children.begin(), children.end(), [&](ProjectBaseItem* item) {
+    const auto& children = d_ptr->children;
+    return std::any_of(children.begin(), children.end(), [&](const ProjectBaseItemChild& child) {
+        ProjectBaseItem* item = child.item;
+        if (!item) {
+            return name == child.compactPath.lastPathSegment();
+        }
         return ((item->type() == Folder || item->type() == File || item->type() == BuildFolder)
                 && name == item->baseName());
     });
 }
 
+void ProjectFolderItem::appendCompactFile(const QString& name)
+{
+    appendCompactChild(name);
+}
+
 bool ProjectBaseItem::isProjectRoot() const
 {
     return parent()==nullptr;
@@ -744,7 +926,7 @@ bool isNumeric(const QStringRef& str)
 class IconNameCache
 {
 public:
-    QString iconNameForPath(const Path& path, const QString& fileName)
+    QString iconNameForFile(const QString& fileName)
     {
         // find icon name based on file extension, if possible
         QString extension;
@@ -765,7 +947,7 @@ public:
             }
         }
 
-        QMimeType mime = QMimeDatabase().mimeTypeForFile(path.lastPathSegment(), QMimeDatabase::MatchExtension); // no I/O
+        QMimeType mime = QMimeDatabase().mimeTypeForFile(fileName, QMimeDatabase::MatchExtension); // no I/O
         QMutexLocker lock(&mutex);
         QHash< QString, QString >::const_iterator it = mimeToIcon.constFind(mime.name());
         QString iconName;
@@ -795,7 +977,7 @@ QString ProjectFileItem::iconName() const
     // think of d_ptr->iconName as mutable, possible since d_ptr is not const
     if (d_ptr->iconName.isEmpty()) {
         // lazy load implementation of icon lookup
-        d_ptr->iconName = s_cache->iconNameForPath( d_ptr->m_path, d_ptr->text );
+        d_ptr->iconName = s_cache->iconNameForFile( d_ptr->text );
         // we should always get *some* icon name back
         Q_ASSERT(!d_ptr->iconName.isEmpty());
     }
@@ -990,6 +1172,24 @@ QVariant ProjectModel::data( const QModelIndex& index, int role ) const
         UrlRole
     };
     if( allowedRoles.contains(role) && index.isValid() ) {
+        Q_D(const ProjectModel);
+        ProjectBaseItem* compactParent = role == ProjectItemRole ? nullptr : d->compactFileParent(index);
+        if (compactParent) {
+            // answer directly, views shall not create the items of all visible files
+            const InternedPath& path = compactParent->d_func()->children.at(index.row()).compactPath;
+            switch(role) {
+                case Qt::DecorationRole:
+                    return QIcon::fromTheme(s_cache->iconNameForFile(path.lastPathSegment()));
+                case Qt::ToolTipRole:
+                    return path.pathOrUrl();
+                case Qt::DisplayRole:
+                    return path.lastPathSegment();
+                case UrlRole:
+                    return path.toPath().toUrl();
+                case ProjectRole:
+                    return QVariant::fromValue<QObject*>(compactParent->project());
+            }
+        }
         ProjectBaseItem* item = itemFromIndex( index );
         if( item ) {
             switch(role) {
@@ -1082,6 +1282,13 @@ QList< ProjectBaseItem* > ProjectModel::topItems() const
 
 Qt::ItemFlags ProjectModel::flags(const QModelIndex& index) const
 {
+    Q_D(const ProjectModel);
+
+    if (d->compactFileParent(index)) {
+        // the flags of a ProjectFileItem
+        return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+    }
+
     ProjectBaseItem* item = itemFromIndex( index );
     if(item)
         return item->flags();
@@ -1111,14 +1318,37 @@ QList<ProjectBaseItem*> ProjectModel::itemsForPath(const IndexedString& path) co
 {
     Q_D(const ProjectModel);
 
-    return d->pathLookupTable.values(path.index());
+    QList<ProjectBaseItem*> items = d->pathLookupTable.values(path.index());
+    if (!d->compactFileCount || path.isEmpty()) {
+        return items;
+    }
+
+    // compactly stored files are not in the lookup table, look for them in the folders of their parent path
+    const InternedPath internedPath = InternedPath::lookup(Path(path.str()));
+    const InternedPath parentPath = internedPath.parent();
+    if (!parentPath.isValid()) {
+        return items;
+    }
+    const auto folders = d->pathLookupTable.values(parentPath.toIndexed().index());
+    for (ProjectBaseItem* folder : folders) {
+        const int row = folder->d_func()->compactRow(internedPath);
+        if (row != -1) {
+            items.append(folder->child(row));
+        }
+    }
+    return items;
 }
 
 ProjectBaseItem* ProjectModel::itemForPath(const IndexedString& path) const
 {
     Q_D(const ProjectModel);
 
-    return d->pathLookupTable.value(path.index());
+    ProjectBaseItem* item = d->pathLookupTable.value(path.index());
+    if (!item && d->compactFileCount) {
+        const auto items = itemsForPath(path);
+        return items.isEmpty() ? nullptr : items.first();
+    }
+    return item;
 }
 
 void ProjectVisitor::visit( ProjectModel* model )
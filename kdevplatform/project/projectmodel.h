@@ -42,6 +42,7 @@ class ProjectExecutableTargetItem;
 class ProjectLibraryTargetItem;
 class ProjectModel;
 class IndexedString;
+class InternedPath;
 class Path;
 class ProjectModelPrivate;
 
@@ -152,10 +153,28 @@ class KDEVPLATFORMPROJECT_EXPORT ProjectBaseItem
         virtual bool lessThan( const KDevelop::ProjectBaseItem* ) const;
         static bool pathLessThan(KDevelop::ProjectBaseItem* item1, KDevelop::ProjectBaseItem* item2);
 
-        /** @returns the @p row item in the list of children of this item or 0 if there is no such child. */
+        /**
+         * @returns the @p row item in the list of children of this item or 0 if there is no such child.
+         *
+         * If the child is a compactly stored file, its item is created now.
+         */
         ProjectBaseItem* child( int row ) const;
-        /** @returns the list of children of this item. */
+        /**
+         * @returns the list of children of this item.
+         *
+         * This creates the items of all compactly stored files, prefer the row based API for large folders.
+         */
         QList<ProjectBaseItem*> children() const;
+        /**
+         * @returns whether the child in @p row is a compactly stored file, for which no item was created yet.
+         *
+         * @see ProjectFolderItem::appendCompactFile()
+         */
+        bool isCompactChild( int row ) const;
+        /** @returns the path of the child in @p row, without creating the item of a compactly stored file. */
+        Path childPath( int row ) const;
+        /** @returns the indexed path of the child in @p row, without creating the item of a compactly stored file. */
+        IndexedString childIndexedPath( int row ) const;
         /** @returns a valid QModelIndex for usage with the model API for this item. */
         QModelIndex index() const;
         /** @returns The parent item if this item has one, else it return 0. */
@@ -253,10 +272,18 @@ class KDEVPLATFORMPROJECT_EXPORT ProjectBaseItem
          */
         void setText( const QString& text );
 
+        /**
+         * Appends a child for the file @p name in this item's path, without creating an item for it.
+         */
+        void appendCompactChild( const QString& name );
+
         const QScopedPointer<class ProjectBaseItemPrivate> d_ptr;
         void setRow( int row );
         void setModel( ProjectModel* model );
     private:
+        ProjectBaseItem* createCompactChildItem( int row );
+        void releaseCompactChild( const InternedPath& path );
+
         Q_DECLARE_PRIVATE(ProjectBaseItem)
         friend class ProjectModel;
 };
@@ -298,6 +325,19 @@ public:
     /** @returns Returns whether this folder directly contains the specified file or folder. */
     bool hasFileOrFolder(const QString& name) const;
 
+    /**
+     * Appends the file @p name in this folder without creating a ProjectFileItem for it.
+     *
+     * Creating an item for every file is expensive in very large projects. A compactly stored file
+     * only occupies a slot in the children of its folder and is added to the file set of the project
+     * with IProject::addPathToFileSet(). The model provides the display, decoration, tooltip and URL
+     * data of such files itself, a plain ProjectFileItem is only created once the file is accessed
+     * as an item, e.g. via child(), children(), fileList() or ProjectModel::itemsForPath().
+     *
+     * @p name must not contain a slash, and it must not be the name of another child.
+     */
+    void appendCompactFile(const QString& name);
+
     QString iconName() const override;
     RenameStatus rename(const QString& newname) override;
 
@@ -33,8 +33,52 @@ KDevelop::ProjectModel * ProjectProxyModel::projectModel() const
     return qobject_cast<KDevelop::ProjectModel*>( sourceModel() );
 }
 
+namespace {
+/// @returns the name of the compactly stored file at @p index, or a null string if it has an item
+QString compactFileName(const KDevelop::ProjectModel* model, const QModelIndex& index)
+{
+    // top level rows are projects and folders are never stored compactly,
+    // so looking up the parent item does not create any item
+    const QModelIndex parent = index.parent();
+    KDevelop::ProjectBaseItem* parentItem = parent.isValid() ? model->itemFromIndex(parent) : nullptr;
+    if (!parentItem || !parentItem->isCompactChild(index.row())) {
+        return QString();
+    }
+    return parentItem->childPath(index.row()).lastPathSegment();
+}
+
+bool isTargetType(int type)
+{
+    return type == KDevelop::ProjectBaseItem::Target
+        || type == KDevelop::ProjectBaseItem::LibraryTarget
+        || type == KDevelop::ProjectBaseItem::ExecutableTarget;
+}
+}
+
 bool ProjectProxyModel::lessThan(const QModelIndex & left, const QModelIndex & right) const
 {
+    // compactly stored files are sorted by name, without creating their items
+    const QString leftName = compactFileName(projectModel(), left);
+    const QString rightName = compactFileName(projectModel(), right);
+    if (!leftName.isNull() && !rightName.isNull()) {
+        return leftName.compare(rightName, Qt::CaseInsensitive) < 0;
+    }
+    if (!leftName.isNull() || !rightName.isNull()) {
+        KDevelop::ProjectBaseItem* item = projectModel()->itemFromIndex(leftName.isNull() ? left : right);
+        if (!item) return false;
+        if (item->type() < KDevelop::ProjectBaseItem::CustomProjectItemType && item->file()) {
+            const int cmp = leftName.isNull()
+                ? item->file()->fileName().compare(rightName, Qt::CaseInsensitive)
+                : leftName.compare(item->file()->fileName(), Qt::CaseInsensitive);
+            return cmp < 0;
+        }
+        if (item->type() < KDevelop::ProjectBaseItem::CustomProjectItemType) {
+            // folders, build folders and targets come before files
+            return leftName.isNull();
+        }
+        // custom types may override lessThan, that needs both items
+    }
+
     KDevelop::ProjectBaseItem *iLeft=projectModel()->itemFromIndex(left), *iRight=projectModel()->itemFromIndex(right);
     if(!iLeft || !iRight) return false;
 
@@ -55,13 +99,16 @@ bool ProjectProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourc
         return true;
     }
     else {
+        // Compactly stored children are always files, don't create their items.
+        KDevelop::ProjectBaseItem* parentItem = sourceParent.isValid() ? projectModel()->itemFromIndex(sourceParent) : nullptr;
+        if (parentItem && parentItem->isCompactChild(sourceRow)) {
+            return true;
+        }
         // Get the base item for the associated parent and row.
         QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
         auto *item = projectModel()->itemFromIndex(index);
         // If it's a target, return false, otherwise true.
-        return item->type() != KDevelop::ProjectBaseItem::Target
-            && item->type() != KDevelop::ProjectBaseItem::LibraryTarget
-            && item->type() != KDevelop::ProjectBaseItem::ExecutableTarget;
+        return item && !isTargetType(item->type());
     }
 }
 
@@ -22,6 +22,8 @@
 #include <project/projectmodel.h>
 #include "path.h"
 
+#include <serialization/indexedstring.h>
+
 
 namespace KDevelop {
 
@@ -60,6 +62,23 @@ void forEachFile(const ProjectBaseItem* projectItem,
     }
 }
 
+void forEachFilePath(const ProjectBaseItem* projectItem,
+                     const std::function<void(const Path&, const IndexedString&)>& callback)
+{
+    if (auto* file = projectItem->file()) {
+        callback(file->path(), file->indexedPath());
+        return;
+    }
+
+    for (int row = 0, rows = projectItem->rowCount(); row < rows; ++row) {
+        if (projectItem->isCompactChild(row)) {
+            callback(projectItem->childPath(row), projectItem->childIndexedPath(row));
+        } else {
+            forEachFilePath(projectItem->child(row), callback);
+        }
+    }
+}
+
 QList<ProjectFileItem*> allFiles(const ProjectBaseItem* projectItem)
 {
     QList<ProjectFileItem*> files;
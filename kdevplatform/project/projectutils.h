@@ -33,6 +33,8 @@ class QMenu;
 
 namespace KDevelop {
 
+class IndexedString;
+class Path;
 class ProjectBaseItem;
 class ProjectFileItem;
 
@@ -54,6 +56,14 @@ private:
 KDEVPLATFORMPROJECT_EXPORT void forEachFile(const ProjectBaseItem* projectItem,
                                             const std::function<void(ProjectFileItem*)>& callback);
 
+/**
+ * Runs the @p callback on the paths of all files that have @p projectItem as ancestor
+ *
+ * Unlike forEachFile(), this does not create the items of compactly stored files.
+ */
+KDEVPLATFORMPROJECT_EXPORT void forEachFilePath(const ProjectBaseItem* projectItem,
+                                                const std::function<void(const Path&, const IndexedString&)>& callback);
+
 /**
  * Returns all the files that have @p projectItem as ancestor
  */
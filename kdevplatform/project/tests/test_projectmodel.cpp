@@ -29,6 +29,7 @@
 #include <QAbstractItemModelTester>
 #endif
 
+#include <projectfileset.h>
 #include <projectmodel.h>
 #include <projectproxymodel.h>
 #if QT_VERSION < QT_VERSION_CHECK(5, 11, 0)
@@ -38,6 +39,7 @@
 #include <tests/kdevsignalspy.h>
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
+#include <serialization/indexedstring.h>
 #include <util/path.h>
 
 using namespace KDevelop;
@@ -558,6 +560,68 @@ void TestProjectModel::testProjectFileSet()
     QVERIFY(project->fileSet().isEmpty());
 }
 
+void TestProjectModel::testProjectFileSetSnapshot()
+{
+    qRegisterMetaType<ProjectFileSetDelta>();
+    QScopedPointer<TestProject> project(new TestProject());
+    QSignalSpy spy(project.data(), &IProject::fileSetChanged);
+
+    const ProjectFileSet empty = project->fileSetSnapshot();
+    QVERIFY(empty.isEmpty());
+
+    Path path(QDir::tempPath() + "/a");
+    auto* item = new ProjectFileItem(project.data(), path, project->projectItem());
+    const ProjectFileSet snapshot = project->fileSetSnapshot();
+    QCOMPARE(snapshot.size(), 1);
+    QVERIFY(snapshot.contains(item->indexedPath()));
+    QVERIFY(snapshot.version() > empty.version());
+    QCOMPARE(spy.count(), 1);
+    auto delta = spy.last().at(0).value<ProjectFileSetDelta>();
+    QCOMPARE(delta.fromVersion, empty.version());
+    QCOMPARE(delta.toVersion, snapshot.version());
+    QCOMPARE(delta.added, QVector<IndexedString>{item->indexedPath()});
+    QVERIFY(delta.removed.isEmpty());
+
+    // snapshots are not affected by later changes
+    const IndexedString indexedPath = item->indexedPath();
+    delete item;
+    QVERIFY(project->fileSetSnapshot().isEmpty());
+    QVERIFY(empty.isEmpty());
+    QVERIFY(snapshot.contains(indexedPath));
+    QCOMPARE(spy.count(), 2);
+    delta = spy.last().at(0).value<ProjectFileSetDelta>();
+    QCOMPARE(delta.fromVersion, snapshot.version());
+    QCOMPARE(delta.removed, QVector<IndexedString>{indexedPath});
+
+    // many changes are merged into the base set, which still must not affect snapshots
+    ProjectFileSet set;
+    for (int i = 0; i < 2000; ++i) {
+        QVERIFY(set.insert(IndexedString(QString::number(i))));
+    }
+    const ProjectFileSet copy = set;
+    QVERIFY(!set.insert(IndexedString(QStringLiteral("0"))));
+    QVERIFY(set.remove(IndexedString(QStringLiteral("0"))));
+    QVERIFY(!set.remove(IndexedString(QStringLiteral("0"))));
+    QVERIFY(set.insert(IndexedString(QStringLiteral("foo"))));
+    QCOMPARE(set.size(), 2000);
+    QCOMPARE(set.toSet().size(), 2000);
+    QVERIFY(!set.contains(IndexedString(QStringLiteral("0"))));
+    QVERIFY(copy.contains(IndexedString(QStringLiteral("0"))));
+    QVERIFY(!copy.contains(IndexedString(QStringLiteral("foo"))));
+    int count = 0;
+    set.forEach([&count](const IndexedString&) { ++count; });
+    QCOMPARE(count, 2000);
+
+    const quint64 version = set.version();
+    set.squeeze();
+    QCOMPARE(set.version(), version);
+    QCOMPARE(set.size(), 2000);
+    QCOMPARE(copy.size(), 2000);
+    set.clear();
+    QVERIFY(set.isEmpty());
+    QVERIFY(!copy.isEmpty());
+}
+
 void TestProjectModel::testProjectFileIcon()
 {
     QMimeDatabase db;
@@ -570,4 +634,96 @@ void TestProjectModel::testProjectFileIcon()
     QVERIFY(item->iconName() != txtIcon);
 }
 
+void TestProjectModel::testCompactFiles()
+{
+    QScopedPointer<TestProject> project(new TestProject());
+    ProjectFolderItem* root = project->projectItem();
+    auto* folder = new ProjectFolderItem(QStringLiteral("folder"), root);
+    folder->appendCompactFile(QStringLiteral("a.cpp"));
+    folder->appendCompactFile(QStringLiteral("b.h"));
+
+    const Path filePath(folder->path(), QStringLiteral("b.h"));
+    const IndexedString indexedFilePath(filePath.pathOrUrl());
+    QCOMPARE(folder->rowCount(), 2);
+    QVERIFY(folder->isCompactChild(1));
+    QCOMPARE(folder->childPath(1), filePath);
+    QCOMPARE(folder->childIndexedPath(1), indexedFilePath);
+    QVERIFY(folder->hasFileOrFolder(QStringLiteral("b.h")));
+    QVERIFY(folder->folderList().isEmpty());
+    QCOMPARE(project->fileSet().size(), 2);
+    QVERIFY(project->fileSet().contains(indexedFilePath));
+
+    // the model provides the data of compact files without creating items
+    const QModelIndex idx = model->index(1, 0, folder->index());
+    QCOMPARE(model->data(idx).toString(), QStringLiteral("b.h"));
+    QCOMPARE(model->data(idx, ProjectModel::UrlRole).toUrl(), filePath.toUrl());
+    QVERIFY(folder->isCompactChild(1));
+
+    // looking the file up creates its item in place
+    const auto items = model->itemsForPath(indexedFilePath);
+    QCOMPARE(items.size(), 1);
+    QVERIFY(!folder->isCompactChild(1));
+    QVERIFY(folder->isCompactChild(0));
+    ProjectBaseItem* item = items.first();
+    QVERIFY(item->file());
+    QCOMPARE(item->path(), filePath);
+    QCOMPARE(item->row(), 1);
+    QCOMPARE(item->parent(), static_cast<ProjectBaseItem*>(folder));
+    QCOMPARE(model->itemFromIndex(idx), item);
+    QCOMPARE(model->itemForPath(indexedFilePath), item);
+    QCOMPARE(project->fileSet().size(), 2);
+
+    // renaming the folder moves the compact files along
+    const IndexedString oldPath(Path(folder->path(), QStringLiteral("a.cpp")).pathOrUrl());
+    folder->setPath(Path(root->path(), QStringLiteral("renamed")));
+    const IndexedString newPath(Path(folder->path(), QStringLiteral("a.cpp")).pathOrUrl());
+    QVERIFY(folder->isCompactChild(0));
+    QVERIFY(!project->fileSet().contains(oldPath));
+    QVERIFY(project->fileSet().contains(newPath));
+    QCOMPARE(folder->childIndexedPath(0), newPath);
+
+    // removing rows removes compact files from the file set, too
+    folder->removeRow(0);
+    QVERIFY(!project->fileSet().contains(newPath));
+    QCOMPARE(folder->rowCount(), 1);
+    QCOMPARE(folder->child(0), item);
+    QCOMPARE(item->row(), 0);
+}
+
+void TestProjectModel::testCompactFilesProxy()
+{
+    QScopedPointer<TestProject> project(new TestProject());
+    auto* folder = new ProjectFolderItem(QStringLiteral("folder"), project->projectItem());
+    folder->appendCompactFile(QStringLiteral("d.cpp"));
+    folder->appendCompactFile(QStringLiteral("B.h"));
+    auto* file = new ProjectFileItem(QStringLiteral("c.txt"), folder);
+    new ProjectFolderItem(QStringLiteral("sub"), folder);
+    auto* target = new ProjectTargetItem(project.data(), QStringLiteral("target"), folder);
+    folder->appendCompactFile(QStringLiteral("a.cpp"));
+
+    // sorting puts folders and targets first, then all files by name
+    const QModelIndex proxyFolder = proxy->mapFromSource(folder->index());
+    QCOMPARE(proxy->rowCount(proxyFolder), 6);
+    const QStringList sorted = {
+        QStringLiteral("sub"), QStringLiteral("target"), QStringLiteral("a.cpp"),
+        QStringLiteral("B.h"), QStringLiteral("c.txt"), QStringLiteral("d.cpp")
+    };
+    for (int i = 0; i < sorted.size(); ++i) {
+        QCOMPARE(proxy->index(i, 0, proxyFolder).data().toString(), sorted.at(i));
+    }
+
+    // filtering hides the target only
+    proxy->showTargets(false);
+    QCOMPARE(proxy->rowCount(proxyFolder), 5);
+    QCOMPARE(proxy->index(1, 0, proxyFolder).data().toString(), QStringLiteral("a.cpp"));
+    proxy->showTargets(true);
+
+    // neither created the items of the compact files
+    QVERIFY(folder->isCompactChild(0));
+    QVERIFY(folder->isCompactChild(1));
+    QVERIFY(folder->isCompactChild(5));
+    QCOMPARE(file->row(), 2);
+    QCOMPARE(target->row(), 4);
+}
+
 QTEST_MAIN(TestProjectModel)
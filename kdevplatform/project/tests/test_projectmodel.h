@@ -51,7 +51,10 @@ private Q_SLOTS:
     void testItemsForPath_data();
     void testProjectProxyModel();
     void testProjectFileSet();
+    void testProjectFileSetSnapshot();
     void testProjectFileIcon();
+    void testCompactFiles();
+    void testCompactFilesProxy();
 private:
     KDevelop::ProjectModel* model;
     ProjectProxyModel* proxy;
@@ -26,6 +26,8 @@
 class QString;
 
 namespace KDevelop {
+struct ItemRepositoryRuntimeStatistics;
+
 /// Returns a version-number that is used to reset the item-repository after incompatible layout changes.
 KDEVPLATFORMSERIALIZATION_EXPORT uint staticItemRepositoryVersion();
 
@@ -43,8 +45,15 @@ public:
     /// Does a big cleanup, removing all non-persistent items in the repositories.
     /// @returns Count of bytes of data that have been removed.
     virtual int finalCleanup() = 0;
+    /// Gives the free space at the end of the used area of up to @p maxBuckets buckets back for reuse,
+    /// continuing where the previous call stopped. Items are never moved, so free space between
+    /// items stays fragmented, but all indices stay valid.
+    /// @returns Count of bytes that have been given back.
+    virtual uint reclaimTrailingFreeSpace(uint maxBuckets) = 0;
     virtual QString repositoryName() const = 0;
     virtual QString printStatistics() const = 0;
+    /// @returns sizes and counters of the repository, without loading anything from disk
+    virtual ItemRepositoryRuntimeStatistics runtimeStatistics() const = 0;
 };
 
 /// Internal helper class that wraps around a repository object and manages its lifetime.
@@ -0,0 +1,269 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "internedpath.h"
+
+#include "indexedstring.h"
+
+#include <util/path.h>
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+using namespace KDevelop;
+
+namespace {
+struct Node
+{
+    /// The node of the path without the last segment, 0 for the first segment
+    uint treeParent;
+    /// The node of the parent directory as returned by Path::parent(), 0 for root paths
+    uint parent;
+    uint depth;
+    QString segment;
+    /// Index of the IndexedString of the complete path, 0 if it was not computed yet
+    uint indexedString;
+};
+
+struct ChildKey
+{
+    uint treeParent;
+    QString segment;
+
+    bool operator==(const ChildKey& other) const
+    {
+        return treeParent == other.treeParent && segment == other.segment;
+    }
+};
+
+inline uint qHash(const ChildKey& key)
+{
+    return qHash(key.segment, key.treeParent);
+}
+
+inline bool isWindowsDriveLetter(const QString& segment)
+{
+#ifdef Q_OS_WIN
+    return segment.size() == 2 && segment.at(0).isLetter() && segment.at(1) == QLatin1Char(':');
+#else
+    Q_UNUSED(segment);
+    return false;
+#endif
+}
+
+class PathTree
+{
+public:
+    static PathTree& self()
+    {
+        static PathTree tree;
+        return tree;
+    }
+
+    uint intern(uint index, const QString* begin, const QString* end)
+    {
+        {
+            QReadLocker lock(&m_lock);
+            for (; begin != end; ++begin) {
+                const auto it = m_children.constFind({index, *begin});
+                if (it == m_children.constEnd()) {
+                    break;
+                }
+                index = *it;
+            }
+        }
+        if (begin == end) {
+            return index;
+        }
+
+        QWriteLocker lock(&m_lock);
+        for (; begin != end; ++begin) {
+            index = child(index, *begin);
+        }
+        return index;
+    }
+
+    uint find(const QString* begin, const QString* end) const
+    {
+        QReadLocker lock(&m_lock);
+        uint index = 0;
+        for (; begin != end; ++begin) {
+            const auto it = m_children.constFind({index, *begin});
+            if (it == m_children.constEnd()) {
+                return 0;
+            }
+            index = *it;
+        }
+        return index;
+    }
+
+    Node node(uint index) const
+    {
+        QReadLocker lock(&m_lock);
+        return m_nodes.at(index);
+    }
+
+    QVector<QString> segments(uint index) const
+    {
+        QReadLocker lock(&m_lock);
+        QVector<QString> ret(m_nodes.at(index).depth);
+        for (int i = ret.size() - 1; i >= 0; --i) {
+            const Node& node = m_nodes.at(index);
+            ret[i] = node.segment;
+            index = node.treeParent;
+        }
+        return ret;
+    }
+
+    void setIndexedString(uint index, uint indexedString)
+    {
+        QWriteLocker lock(&m_lock);
+        m_nodes[index].indexedString = indexedString;
+    }
+
+private:
+    PathTree()
+    {
+        // node 0 is the invalid path
+        m_nodes.append({0, 0, 0, QString(), 0});
+    }
+
+    /// must be called with the write lock held
+    uint child(uint treeParent, const QString& segment)
+    {
+        uint& index = m_children[{treeParent, segment}];
+        if (index) {
+            return index;
+        }
+
+        const Node& parentNode = m_nodes.at(treeParent);
+        // the first segment of a remote path is the url prefix, which is not a directory
+        const bool isRemotePrefix = treeParent == 0 && segment.contains(QLatin1Char('/'));
+        const bool isRootLevel = !isRemotePrefix
+                                 && (treeParent == 0 || (parentNode.depth == 1 && parentNode.segment.contains(QLatin1Char('/'))));
+
+        uint parent = treeParent;
+        if (isRemotePrefix || (isRootLevel && (segment.isEmpty() || isWindowsDriveLetter(segment)))) {
+            // root paths have no parent
+            parent = 0;
+        } else if (isRootLevel) {
+            // like Path::parent(), the parent of a root level entry is the root path
+            parent = child(treeParent, QString());
+        }
+
+        // child() above may have inserted into the containers
+        const uint depth = m_nodes.at(treeParent).depth + 1;
+        const uint newIndex = m_nodes.size();
+        m_nodes.append({treeParent, parent, depth, segment, 0});
+        m_children[{treeParent, segment}] = newIndex;
+        return newIndex;
+    }
+
+    mutable QReadWriteLock m_lock;
+    QVector<Node> m_nodes;
+    QHash<ChildKey, uint> m_children;
+};
+}
+
+InternedPath::InternedPath(const Path& path)
+{
+    const auto& segments = path.segments();
+    m_index = PathTree::self().intern(0, segments.constData(), segments.constData() + segments.size());
+}
+
+InternedPath::InternedPath(const InternedPath& parent, const QString& segment)
+{
+    Q_ASSERT(parent.isValid());
+    Q_ASSERT(!segment.contains(QLatin1Char('/')));
+    m_index = PathTree::self().intern(parent.m_index, &segment, &segment + 1);
+}
+
+InternedPath InternedPath::lookup(const Path& path)
+{
+    const auto& segments = path.segments();
+    return fromIndex(PathTree::self().find(segments.constData(), segments.constData() + segments.size()));
+}
+
+InternedPath InternedPath::parent() const
+{
+    if (!m_index) {
+        return {};
+    }
+    return fromIndex(PathTree::self().node(m_index).parent);
+}
+
+bool InternedPath::isParentOf(const InternedPath& path) const
+{
+    if (!m_index) {
+        return false;
+    }
+
+    const auto& tree = PathTree::self();
+    for (uint index = path.m_index ? tree.node(path.m_index).parent : 0; index; index = tree.node(index).parent) {
+        if (index == m_index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString InternedPath::lastPathSegment() const
+{
+    if (!m_index) {
+        return QString();
+    }
+    const Node node = PathTree::self().node(m_index);
+    // the url prefix of a remote path is never returned as file name
+    return node.depth == 1 && node.segment.contains(QLatin1Char('/')) ? QString() : node.segment;
+}
+
+int InternedPath::depth() const
+{
+    return m_index ? PathTree::self().node(m_index).depth : 0;
+}
+
+Path InternedPath::toPath() const
+{
+    if (!m_index) {
+        return Path();
+    }
+    return Path(PathTree::self().segments(m_index));
+}
+
+QString InternedPath::pathOrUrl() const
+{
+    return toPath().pathOrUrl();
+}
+
+IndexedString InternedPath::toIndexed() const
+{
+    if (!m_index) {
+        return IndexedString();
+    }
+
+    auto& tree = PathTree::self();
+    uint indexedString = tree.node(m_index).indexedString;
+    if (!indexedString) {
+        indexedString = IndexedString::indexForString(pathOrUrl());
+        tree.setIndexedString(m_index, indexedString);
+    }
+    return IndexedString::fromIndex(indexedString);
+}
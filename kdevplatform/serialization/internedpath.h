@@ -0,0 +1,125 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_INTERNEDPATH_H
+#define KDEVPLATFORM_INTERNEDPATH_H
+
+#include "serializationexport.h"
+
+#include <QMetaType>
+#include <QString>
+
+namespace KDevelop {
+class IndexedString;
+class Path;
+
+/**
+ * Compact representation of a Path, for storing very many paths which share their prefixes.
+ *
+ * All interned paths are nodes of one process-wide prefix tree. A node stores the last segment
+ * of its path and the index of its parent node, so an InternedPath is nothing but a node index:
+ * copying, comparing and hashing it and getting its parent are O(1), and every directory is
+ * stored only once, no matter how many paths are below it.
+ *
+ * Unlike IndexedString, interned paths only live in memory, their indices must not be stored on disk.
+ * Nodes are never removed, so only intern paths which are likely needed again, like the ones of project files.
+ *
+ * All functions are thread-safe.
+ */
+class KDEVPLATFORMSERIALIZATION_EXPORT InternedPath
+{
+public:
+    /// Constructs the invalid path
+    InternedPath() = default;
+
+    /// Interns @p path, which takes one hash lookup per path segment.
+    explicit InternedPath(const Path& path);
+
+    /// Interns the path of the entry @p segment in the directory @p parent, which takes one hash lookup.
+    /// @p segment must not contain a slash.
+    InternedPath(const InternedPath& parent, const QString& segment);
+
+    /// @return the interned @p path, or an invalid path if it was never interned. Never adds new nodes.
+    static InternedPath lookup(const Path& path);
+
+    inline bool isValid() const
+    {
+        return m_index;
+    }
+
+    inline uint index() const
+    {
+        return m_index;
+    }
+
+    static inline InternedPath fromIndex(uint index)
+    {
+        InternedPath ret;
+        ret.m_index = index;
+        return ret;
+    }
+
+    inline bool operator==(const InternedPath& other) const
+    {
+        return m_index == other.m_index;
+    }
+
+    inline bool operator!=(const InternedPath& other) const
+    {
+        return m_index != other.m_index;
+    }
+
+    /// @return the path of the parent directory, or an invalid path if this is a root or invalid path
+    InternedPath parent() const;
+
+    /// @return whether this path is a (not necessarily direct) parent of @p path
+    bool isParentOf(const InternedPath& path) const;
+
+    QString lastPathSegment() const;
+
+    /// @return the number of segments of the path, which is also the number of its nodes
+    int depth() const;
+
+    Path toPath() const;
+
+    QString pathOrUrl() const;
+
+    /**
+     * @return the path as IndexedString.
+     *
+     * The index of the string is remembered in the node, so only the first conversion of a path
+     * allocates and hashes its string representation.
+     */
+    IndexedString toIndexed() const;
+
+private:
+    uint m_index = 0;
+};
+
+inline uint qHash(const InternedPath& path)
+{
+    return path.index();
+}
+}
+
+Q_DECLARE_TYPEINFO(KDevelop::InternedPath, Q_PRIMITIVE_TYPE);
+Q_DECLARE_METATYPE(KDevelop::InternedPath)
+
+#endif // KDEVPLATFORM_INTERNEDPATH_H
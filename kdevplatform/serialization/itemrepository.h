@@ -21,6 +21,7 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 
 #include <KMessageBox>
@@ -30,6 +31,7 @@
 #include "abstractitemrepository.h"
 #include "repositorymanager.h"
 #include "itemrepositoryregistry.h"
+#include "itemrepositorystatistics.h"
 
 //#define DEBUG_MONSTERBUCKETS
 
@@ -813,6 +815,49 @@ public:
         return need - found;
     }
 
+    ///Gives free items at the end of the used space back to the unused space behind it, so that they can be
+    ///allocated again for items of any size. Once all items are gone, this makes the bucket completely empty,
+    ///which deleteItem() can not do by itself for buckets with a fixed item size.
+    ///Items are never moved, so all indices into the bucket stay valid. Free space between items is left as it is:
+    ///closing those gaps would move items, and their indices are stored all over the DUChain.
+    ///@return The count of bytes that were given back
+    uint reclaimTrailingFreeSpace()
+    {
+        if (m_monsterBucketExtent || !m_freeItemCount)
+            return 0;
+
+        uint freeSpace = m_available;
+        for (unsigned short currentIndex = m_largestFreeItem; currentIndex; currentIndex = followerIndex(currentIndex))
+            freeSpace += freeSize(currentIndex) + AdditionalSpacePerItem;
+
+        if (freeSpace == ItemRepositoryBucketSize) {
+            //Everything has been deleted, make the bucket empty again without walking the free items one by one
+            prepareChange();
+            const uint reclaimed = ItemRepositoryBucketSize - m_available;
+            m_available = ItemRepositoryBucketSize;
+            m_freeItemCount = 0;
+            m_largestFreeItem = 0;
+            return reclaimed;
+        }
+
+        uint reclaimed = 0;
+        while (unsigned short index = trailingFreeItem()) {
+            if (!reclaimed)
+                prepareChange();
+
+            removeFromFreeChain(index);
+
+            const uint size = freeSize(index) + AdditionalSpacePerItem;
+            m_available += size;
+            reclaimed += size;
+        }
+
+        Q_ASSERT(( bool )m_freeItemCount == ( bool )m_largestFreeItem);
+        Q_ASSERT(m_available <= ItemRepositoryBucketSize);
+        ifDebugLostSpace(Q_ASSERT(!lostSpace()); )
+        return reclaimed;
+    }
+
 private:
 
     void makeDataPrivate()
@@ -956,6 +1001,42 @@ private:
         return false;
     }
 
+    /// Returns the free item that ends right where the unused space behind all items begins, or zero
+    unsigned short trailingFreeItem() const
+    {
+        const uint usedEnd = ItemRepositoryBucketSize - m_available;
+        unsigned short currentIndex = m_largestFreeItem;
+
+        while (currentIndex) {
+            if (currentIndex + freeSize(currentIndex) == usedEnd)
+                return currentIndex;
+
+            currentIndex = followerIndex(currentIndex);
+        }
+        return 0;
+    }
+
+    /// Takes the given free item out of the chain, without changing the order of the other free items
+    void removeFromFreeChain(unsigned short index)
+    {
+        unsigned short currentIndex = m_largestFreeItem;
+        unsigned short previousIndex = 0;
+
+        while (currentIndex != index) {
+            //If this assertion triggers, the item was not in the free chain
+            Q_ASSERT(currentIndex);
+            previousIndex = currentIndex;
+            currentIndex = followerIndex(currentIndex);
+        }
+
+        if (previousIndex)
+            setFollowerIndex(previousIndex, followerIndex(index));
+        else
+            m_largestFreeItem = followerIndex(index);
+
+        --m_freeItemCount;
+    }
+
     /// @param index the index of an item @return The index of the next item in the chain of items with a same local hash, or zero
     inline unsigned short followerIndex(unsigned short index) const
     {
@@ -1001,17 +1082,26 @@ private:
 template <bool lock>
 struct Locker   //This is a dummy that does nothing
 {
-    template <class T>
-    explicit Locker(const T& /*t*/)
+    template <class ... T>
+    explicit Locker(const T& ... /*t*/)
     {
     }
 };
 template <>
 struct Locker<true>
 {
-    explicit Locker(QMutex* mutex) : m_mutex(mutex)
-    {
-        m_mutex->lock();
+    explicit Locker(QMutex* mutex, ItemRepositoryCounters* counters = nullptr) : m_mutex(mutex)
+    {
+        if (counters && itemRepositoryInstrumentationEnabled()) {
+            if (!m_mutex->tryLock()) {
+                QElapsedTimer timer;
+                timer.start();
+                m_mutex->lock();
+                counters->recordLockWait(timer.nsecsElapsed());
+            }
+        } else {
+            m_mutex->lock();
+        }
     }
     ~Locker()
     {
@@ -1120,7 +1210,8 @@ public:
     ///@param request Item to retrieve the index from
     unsigned int index(const ItemRequest& request)
     {
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
+        ItemRepositoryLookupTimer timer(m_counters);
 
         const uint hash = request.hash();
         const uint size = request.itemSize();
@@ -1143,6 +1234,7 @@ public:
 
         if (foundIndexInBucket) {
             // 'request' is already present, return the existing index
+            timer.setFound();
             return createIndex(lastBucketWalked, foundIndexInBucket);
         }
 
@@ -1381,19 +1473,25 @@ public:
     ///Returns zero if the item is not in the repository yet
     unsigned int findIndex(const ItemRequest& request)
     {
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
+        ItemRepositoryLookupTimer timer(m_counters);
 
-        return walkBucketChain(request.hash(), [this, &request](ushort bucketIdx, const MyBucket* bucketPtr) {
+        const uint index = walkBucketChain(request.hash(), [this, &request](ushort bucketIdx,
+                                                                            const MyBucket* bucketPtr) {
                 const ushort indexInBucket = bucketPtr->findIndex(request);
                 return indexInBucket ? createIndex(bucketIdx, indexInBucket) : 0u;
             });
+        if (index) {
+            timer.setFound();
+        }
+        return index;
     }
 
     ///Deletes the item from the repository.
     void deleteItem(unsigned int index)
     {
         verifyIndex(index);
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
 
         m_metaDataChanged = true;
 
@@ -1480,7 +1578,7 @@ public:
     {
         verifyIndex(index);
 
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
 
         unsigned short bucket = (index >> 16);
 
@@ -1506,7 +1604,7 @@ public:
     {
         verifyIndex(index);
 
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
 
         unsigned short bucket = (index >> 16);
 
@@ -1525,7 +1623,7 @@ public:
     {
         verifyIndex(index);
 
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
 
         unsigned short bucket = (index >> 16);
 
@@ -1599,6 +1697,34 @@ public:
         return statistics().print();
     }
 
+    ItemRepositoryRuntimeStatistics runtimeStatistics() const override
+    {
+        // The registry calls this without holding the mutex, ThisLocker would not lock
+        // it for repositories that are not thread-safe
+        QMutexLocker lock(m_mutex);
+
+        ItemRepositoryRuntimeStatistics ret;
+        ret.name = m_repositoryName;
+        ret.totalItems = m_statItemCount;
+        ret.buckets = m_currentBucket;
+        for (auto* bucket : m_buckets) {
+            if (bucket) {
+                ++ret.loadedBuckets;
+                ret.usedMemory += bucket->usedMemory();
+                ret.freeSpaceInLoadedBuckets += bucket->totalFreeItemsSize() + bucket->available();
+            }
+        }
+        ret.bucketsWithFreeSpace = m_freeSpaceBuckets.size();
+        if (m_file) {
+            ret.fileSize += m_file->size();
+        }
+        if (m_dynamicFile) {
+            ret.fileSize += m_dynamicFile->size();
+        }
+        ret.counters = m_counters;
+        return ret;
+    }
+
     Statistics statistics() const
     {
         Statistics ret;
@@ -1732,7 +1858,7 @@ public:
     template <class Visitor>
     void visitAllItems(Visitor& visitor, bool onlyInMemory = false) const
     {
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
         for (int a = 1; a <= m_currentBucket; ++a) {
             if (!onlyInMemory || m_buckets.at(a)) {
                 if (bucketForIndex(a) && !bucketForIndex(a)->visitAllItems(visitor))
@@ -1755,6 +1881,10 @@ public:
             for (int a = 0; a < m_buckets.size(); ++a) {
                 if (m_buckets[a]) {
                     if (m_buckets[a]->changed()) {
+                        if (m_registry) {
+                            m_registry->journalFileRange(m_file, BucketStartOffset + qint64(a - 1) * MyBucket::DataSize,
+                                                         (1 + m_buckets[a]->monsterBucketExtent()) * MyBucket::DataSize);
+                        }
                         storeBucket(a);
                     }
                     if (m_unloadingEnabled) {
@@ -1772,6 +1902,11 @@ public:
             if (m_metaDataChanged) {
                 Q_ASSERT(m_dynamicFile);
 
+                if (m_registry) {
+                    m_registry->journalFileRange(m_file, 0, BucketStartOffset);
+                    m_registry->journalFileRange(m_dynamicFile, 0, m_dynamicFile->size());
+                }
+
                 m_file->seek(0);
                 m_file->write(reinterpret_cast<const char*>(&m_repositoryVersion), sizeof(uint));
                 uint hashSize = bucketHashSize;
@@ -1843,11 +1978,7 @@ private:
         unsigned short bucketIndex = m_firstBucketForHash[hash % bucketHashSize];
 
         while (bucketIndex) {
-            auto* bucketPtr = m_buckets.at(bucketIndex);
-            if (!bucketPtr) {
-                initializeBucket(bucketIndex);
-                bucketPtr = m_buckets.at(bucketIndex);
-            }
+            auto* bucketPtr = bucketForIndex(bucketIndex);
 
             if (auto visitResult = visitor(bucketIndex, bucketPtr)) {
                 return visitResult;
@@ -1967,6 +2098,9 @@ private:
     MyBucket* bucketForIndex(short unsigned int index) const
     {
         MyBucket* bucketPtr = m_buckets.at(index);
+        if (itemRepositoryInstrumentationEnabled()) {
+            m_counters.recordBucketAccess(bucketPtr != nullptr);
+        }
         if (!bucketPtr) {
             initializeBucket(index);
             bucketPtr = m_buckets.at(index);
@@ -2151,7 +2285,7 @@ private:
 
     int finalCleanup() override
     {
-        ThisLocker lock(m_mutex);
+        ThisLocker lock(m_mutex, &m_counters);
 
         int changed = 0;
         for (int a = 1; a <= m_currentBucket; ++a) {
@@ -2165,6 +2299,44 @@ private:
         return changed;
     }
 
+    ///Reclaims the trailing free space of up to @p maxBuckets of the loaded buckets, continuing behind the bucket
+    ///where the previous call stopped, so calling this regularly with a small count walks through the whole
+    ///repository without blocking it for long.
+    ///@see Bucket::reclaimTrailingFreeSpace()
+    uint reclaimTrailingFreeSpace(uint maxBuckets) override
+    {
+        // Called from the registry like store(), so lock even if the repository is not thread-safe
+        QMutexLocker lock(m_mutex);
+
+        uint reclaimed = 0;
+        //Visit every bucket at most once per call, buckets that are not loaded are skipped without counting them
+        for (int visited = 0; visited < m_currentBucket && maxBuckets; ++visited) {
+            if (m_reclaimCursor < 1 || m_reclaimCursor > m_currentBucket)
+                m_reclaimCursor = 1;
+
+            const int bucket = m_reclaimCursor;
+            MyBucket* bucketPtr = m_buckets.at(bucket);
+            ++m_reclaimCursor;
+            if (!bucketPtr)
+                continue;
+
+            --maxBuckets;
+            if (bucketPtr->monsterBucketExtent()) {
+                m_reclaimCursor += bucketPtr->monsterBucketExtent(); //Skip buckets that are attached as tail to monster-buckets
+                continue;
+            }
+
+            const uint bucketReclaimed = bucketPtr->reclaimTrailingFreeSpace();
+            if (bucketReclaimed) {
+                reclaimed += bucketReclaimed;
+                //The largest free size has grown, so the bucket may have to be added to or moved within m_freeSpaceBuckets
+                putIntoFreeList(bucket, bucketPtr);
+            }
+        }
+
+        return reclaimed;
+    }
+
     inline void initializeBucket(int bucketNumber) const
     {
         Q_ASSERT(bucketNumber);
@@ -2319,10 +2491,13 @@ private:
     mutable QMutex* m_mutex;
     QString m_repositoryName;
     mutable int m_currentBucket;
+    //The bucket where the next call to reclaimTrailingFreeSpace() continues
+    int m_reclaimCursor = 1;
     //List of buckets that have free space available that can be assigned. Sorted by size: Smallest space first. Second order sorting: Bucket index
     QVector<uint> m_freeSpaceBuckets;
     mutable QVector<MyBucket*> m_buckets;
     uint m_statBucketHashClashes, m_statItemCount;
+    mutable ItemRepositoryCounters m_counters;
     //Maps hash-values modulo 1<<bucketHashSizeBits to the first bucket such a hash-value appears in
     short unsigned int m_firstBucketForHash[bucketHashSize];
 
@@ -23,12 +23,15 @@
 #include <QCoreApplication>
 #include <QDataStream>
 #include <QStandardPaths>
+#include <QTextStream>
 
 #include <KLocalizedString>
 
 #include <util/shellutils.h>
 
 #include "abstractitemrepository.h"
+#include "itemrepositorystatistics.h"
+#include "repositoryjournal.h"
 #include "debug.h"
 
 using namespace KDevelop;
@@ -37,6 +40,9 @@ namespace {
 //If KDevelop crashed this many times consecutively, clean up the repository
 const int crashesBeforeCleanup = 1;
 
+//Records the changes made while the repository is locked for writing, see RepositoryJournal
+const char journalFileName[] = "is_writing_journal";
+
 void setCrashCounter(QFile& crashesFile, int count)
 {
     crashesFile.close();
@@ -58,9 +64,18 @@ bool shouldClear(const QString& path)
         return true;
     }
 
+    const QString journalPath = dir.filePath(QLatin1String(journalFileName));
     if (dir.exists(QStringLiteral("is_writing"))) {
-        qCWarning(SERIALIZATION) << "repository" << path << "was write-locked, it probably is inconsistent";
-        return true;
+        if (!RepositoryJournal::rollback(path, journalPath)) {
+            qCWarning(SERIALIZATION) << "repository" << path << "was write-locked, it probably is inconsistent";
+            return true;
+        }
+        qCWarning(SERIALIZATION) << "repository" << path << "was write-locked, restored the state from before writing";
+        QFile::remove(journalPath);
+        QFile::remove(dir.filePath(QStringLiteral("is_writing")));
+    } else if (dir.exists(QLatin1String(journalFileName))) {
+        //The writing was finished, only the journal was not removed any more
+        QFile::remove(journalPath);
     }
 
     if (!dir.exists(QStringLiteral("version_%1").arg(staticItemRepositoryVersion()))) {
@@ -116,6 +131,10 @@ public:
     QMap<AbstractItemRepository*, AbstractRepositoryManager*> m_repositories;
     QMap<QString, QAtomicInt*> m_customCounters;
     mutable QMutex m_mutex;
+    //Active while the repository is locked for writing
+    RepositoryJournal m_journal;
+    //Protects m_journal, which is used by the repositories while their own mutex is locked
+    QMutex m_journalMutex;
 
     explicit ItemRepositoryRegistryPrivate(ItemRepositoryRegistry* owner)
         : m_owner(owner)
@@ -235,6 +254,11 @@ QString ItemRepositoryRegistry::path() const
 void ItemRepositoryRegistryPrivate::lockForWriting()
 {
     QMutexLocker lock(&m_mutex);
+    //Start the journal before creating is_writing, so is_writing is never there without it
+    {
+        QMutexLocker journalLock(&m_journalMutex);
+        m_journal.begin(m_path, m_path + QLatin1Char('/') + QLatin1String(journalFileName));
+    }
     //Create is_writing
     QFile f(m_path + QLatin1String("/is_writing"));
     f.open(QIODevice::WriteOnly);
@@ -253,6 +277,9 @@ void ItemRepositoryRegistryPrivate::unlockForWriting()
     QMutexLocker lock(&m_mutex);
     //Delete is_writing
     QFile::remove(m_path + QLatin1String("/is_writing"));
+
+    QMutexLocker journalLock(&m_journalMutex);
+    m_journal.finish();
 }
 
 void ItemRepositoryRegistry::unlockForWriting()
@@ -284,6 +311,11 @@ void ItemRepositoryRegistryPrivate::deleteDataDirectory(const QString& path, boo
     bool result = QDir(path).removeRecursively();
     Q_ASSERT(result);
     Q_UNUSED(result);
+    {
+        //Nothing is left to roll back
+        QMutexLocker journalLock(&m_journalMutex);
+        m_journal.finish();
+    }
     // Just recreate the directory then; leave old path (as it is dependent on appname and session only).
     if (recreate) {
         QDir().mkpath(path);
@@ -342,6 +374,7 @@ void ItemRepositoryRegistry::store()
     }
 
     QFile versionFile(d->m_path + QStringLiteral("/version_%1").arg(staticItemRepositoryVersion()));
+    journalReplacedFile(versionFile.fileName());
     if (versionFile.open(QIODevice::WriteOnly)) {
         versionFile.close();
     } else {
@@ -350,6 +383,7 @@ void ItemRepositoryRegistry::store()
 
     //Store all custom counter values
     QFile f(d->m_path + QLatin1String("/Counters"));
+    journalReplacedFile(f.fileName());
     if (f.open(QIODevice::WriteOnly)) {
         f.resize(0);
         QDataStream stream(&f);
@@ -376,6 +410,36 @@ void ItemRepositoryRegistry::printAllStatistics() const
     }
 }
 
+QVector<ItemRepositoryRuntimeStatistics> ItemRepositoryRegistry::runtimeStatistics() const
+{
+    Q_D(const ItemRepositoryRegistry);
+
+    QMutexLocker lock(&d->m_mutex);
+    QVector<ItemRepositoryRuntimeStatistics> ret;
+    ret.reserve(d->m_repositories.size());
+    for (auto it = d->m_repositories.constBegin(), end = d->m_repositories.constEnd(); it != end; ++it) {
+        ret << it.key()->runtimeStatistics();
+    }
+    return ret;
+}
+
+QString ItemRepositoryRegistry::runtimeStatisticsReport() const
+{
+    const auto statistics = runtimeStatistics();
+    QString ret;
+    for (const auto& repositoryStatistics : statistics) {
+        ret += repositoryStatistics.print() + QLatin1Char('\n');
+    }
+    return ret;
+}
+
+void ItemRepositoryRegistry::printRuntimeStatistics() const
+{
+    // they are requested explicitly, so don't depend on the debug category being enabled
+    QTextStream out(stderr);
+    out << runtimeStatisticsReport();
+}
+
 int ItemRepositoryRegistry::finalCleanup()
 {
     Q_D(ItemRepositoryRegistry);
@@ -392,6 +456,38 @@ int ItemRepositoryRegistry::finalCleanup()
     return changed;
 }
 
+void ItemRepositoryRegistry::journalFileRange(QFile* file, qint64 offset, qint64 size)
+{
+    Q_D(ItemRepositoryRegistry);
+
+    QMutexLocker lock(&d->m_journalMutex);
+    d->m_journal.saveRange(file, offset, size);
+}
+
+void ItemRepositoryRegistry::journalReplacedFile(const QString& filePath)
+{
+    Q_D(ItemRepositoryRegistry);
+
+    QMutexLocker lock(&d->m_journalMutex);
+    d->m_journal.moveFileAside(filePath);
+}
+
+uint ItemRepositoryRegistry::reclaimTrailingFreeSpace(uint maxBucketsPerRepository)
+{
+    Q_D(ItemRepositoryRegistry);
+
+    QMutexLocker lock(&d->m_mutex);
+    uint reclaimed = 0;
+    for (auto it = d->m_repositories.constBegin(), end = d->m_repositories.constEnd(); it != end; ++it) {
+        reclaimed += it.key()->reclaimTrailingFreeSpace(maxBucketsPerRepository);
+    }
+
+    if (reclaimed) {
+        qCDebug(SERIALIZATION) << "reclaimed trailing free space in item-repositories, bytes:" << reclaimed;
+    }
+    return reclaimed;
+}
+
 void ItemRepositoryRegistryPrivate::close()
 {
     QMutexLocker lock(&m_mutex);
@@ -418,6 +514,10 @@ void ItemRepositoryRegistry::shutdown()
 {
     Q_D(ItemRepositoryRegistry);
 
+    if (itemRepositoryInstrumentationEnabled()) {
+        printRuntimeStatistics();
+    }
+
     QMutexLocker lock(&d->m_mutex);
     QString path = d->m_path;
 
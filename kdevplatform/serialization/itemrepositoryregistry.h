@@ -22,8 +22,10 @@
 #include "serializationexport.h"
 
 #include <QScopedPointer>
+#include <QVector>
 
 class QString;
+class QFile;
 class QMutex;
 class QAtomicInt;
 
@@ -32,6 +34,7 @@ class ISession;
 class AbstractRepositoryManager;
 class AbstractItemRepository;
 class ItemRepositoryRegistryPrivate;
+struct ItemRepositoryRuntimeStatistics;
 
 /**
  * Manages a set of item-repositories and allows loading/storing them all at once from/to disk.
@@ -77,9 +80,25 @@ public:
     /// @returns Count of bytes of data that have been removed.
     int finalCleanup();
 
+    /// Reclaims the trailing free space of the next @p maxBucketsPerRepository loaded buckets of every repository,
+    /// see AbstractItemRepository::reclaimTrailingFreeSpace().
+    /// @note Cheap enough to be called on a regular basis, a complete pass through the repositories is spread over many calls.
+    /// @returns Count of bytes that have been given back for reuse.
+    uint reclaimTrailingFreeSpace(uint maxBucketsPerRepository);
+
     /// Prints the statistics of all registered item-repositories to the command line using qDebug().
+    /// @note This loads all buckets of all repositories from disk, see runtimeStatistics() for a cheap alternative.
     void printAllStatistics() const;
 
+    /// @returns The sizes and counters of all registered item-repositories.
+    QVector<ItemRepositoryRuntimeStatistics> runtimeStatistics() const;
+
+    /// @returns The runtime statistics of all registered item-repositories as human-readable text.
+    QString runtimeStatisticsReport() const;
+
+    /// Prints the runtime statistics of all registered item-repositories to stderr.
+    void printRuntimeStatistics() const;
+
     /// Marks the directory as inconsistent, so it will be discarded
     /// on next startup if the application crashes during the write process.
     void lockForWriting();
@@ -87,6 +106,18 @@ public:
     /// Removes the inconsistency mark set by @ref lockForWriting().
     void unlockForWriting();
 
+    /// While locked for writing, saves the @p size bytes at @p offset in @p file before they are overwritten.
+    /// If the application crashes before @ref unlockForWriting(), the next start restores the state from
+    /// before @ref lockForWriting() instead of discarding the whole repository.
+    /// @note Does nothing while not locked for writing.
+    void journalFileRange(QFile* file, qint64 offset, qint64 size);
+
+    /// Same as @ref journalFileRange() for the complete file at @p filePath, which is about to be rewritten
+    /// from scratch or removed. It may also not exist yet.
+    /// @note While locked for writing, the file is moved aside instead of being copied, so it does not exist
+    ///       anymore when this returns.
+    void journalReplacedFile(const QString& filePath);
+
     /// Returns a custom counter persistently stored as part of item-repositories in the
     /// same directory, possibly creating it.
     /// @param identity     The string used to identify a counter.
@@ -0,0 +1,88 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "itemrepositorystatistics.h"
+
+#include <atomic>
+
+namespace KDevelop {
+namespace {
+std::atomic<bool>& instrumentationEnabled()
+{
+    static std::atomic<bool> enabled(qEnvironmentVariableIsSet("KDEV_ITEMREPOSITORY_STATISTICS"));
+    return enabled;
+}
+}
+
+void setItemRepositoryInstrumentationEnabled(bool enabled)
+{
+    instrumentationEnabled().store(enabled, std::memory_order_relaxed);
+}
+
+bool itemRepositoryInstrumentationEnabled()
+{
+    return instrumentationEnabled().load(std::memory_order_relaxed);
+}
+
+double ItemRepositoryRuntimeStatistics::fragmentation() const
+{
+    if (!usedMemory) {
+        return 0;
+    }
+    return 100.0 * freeSpaceInLoadedBuckets / usedMemory;
+}
+
+QString ItemRepositoryRuntimeStatistics::print() const
+{
+    QString ret;
+    ret += QStringLiteral("%1: items: %2 buckets: %3 loaded buckets: %4").arg(name).arg(totalItems).arg(buckets).arg(
+        loadedBuckets);
+    ret += QStringLiteral("\nused memory: %1 file size: %2 free space in loaded buckets: %3 (%4%) buckets with free space: %5")
+           .arg(usedMemory).arg(fileSize).arg(freeSpaceInLoadedBuckets).arg(fragmentation(), 0, 'f', 1)
+           .arg(bucketsWithFreeSpace);
+
+    if (counters.lookups) {
+        ret += QStringLiteral("\nlookups: %1, by latency:").arg(counters.lookups);
+        for (uint i = 0; i < counters.lookupLatencies.size(); ++i) {
+            if (i < ItemRepositoryCounters::lookupLatencyBounds.size()) {
+                ret += QStringLiteral(" <%1ns: %2").arg(ItemRepositoryCounters::lookupLatencyBounds[i]).arg(
+                    counters.lookupLatencies[i]);
+            } else {
+                ret += QStringLiteral(" more: %1").arg(counters.lookupLatencies[i]);
+            }
+        }
+    }
+    if (counters.lookupHits + counters.lookupMisses) {
+        ret += QStringLiteral("\nlookup hits: %1 misses: %2 (%3% hit rate)").arg(counters.lookupHits)
+               .arg(counters.lookupMisses)
+               .arg(ItemRepositoryCounters::hitRate(counters.lookupHits, counters.lookupMisses), 0, 'f', 1);
+    }
+    if (counters.bucketHits + counters.bucketMisses) {
+        ret += QStringLiteral("\nbucket accesses in memory: %1 loaded: %2 (%3% hit rate)").arg(counters.bucketHits)
+               .arg(counters.bucketMisses)
+               .arg(ItemRepositoryCounters::hitRate(counters.bucketHits, counters.bucketMisses), 0, 'f', 1);
+    }
+    if (counters.lockWaits) {
+        ret += QStringLiteral("\nlock waits: %1 total wait time: %2ms").arg(counters.lockWaits).arg(
+            counters.lockWaitNanoseconds / 1000000);
+    }
+    return ret;
+}
+}
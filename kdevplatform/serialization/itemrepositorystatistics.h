@@ -0,0 +1,149 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_ITEMREPOSITORYSTATISTICS_H
+#define KDEVPLATFORM_ITEMREPOSITORYSTATISTICS_H
+
+#include "serializationexport.h"
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <array>
+
+namespace KDevelop {
+/**
+ * Enables or disables the measurement of lookup latencies and lock wait times in all item-repositories.
+ * Counting items and bytes is always possible, measuring is off by default because it costs time on every lookup.
+ *
+ * It is enabled on startup if the environment variable KDEV_ITEMREPOSITORY_STATISTICS is set.
+ */
+KDEVPLATFORMSERIALIZATION_EXPORT void setItemRepositoryInstrumentationEnabled(bool enabled);
+KDEVPLATFORMSERIALIZATION_EXPORT bool itemRepositoryInstrumentationEnabled();
+
+/// Counters updated by an item-repository while its lock is held, if instrumentation is enabled.
+struct ItemRepositoryCounters
+{
+    /// Upper bounds of the lookup latency histogram buckets in nanoseconds, the last bucket is open.
+    static constexpr std::array<qint64, 4> lookupLatencyBounds{{1000, 10000, 100000, 1000000}};
+
+    void recordLookup(qint64 nanoseconds)
+    {
+        ++lookups;
+        uint bucket = 0;
+        while (bucket < lookupLatencyBounds.size() && nanoseconds >= lookupLatencyBounds[bucket]) {
+            ++bucket;
+        }
+        ++lookupLatencies[bucket];
+    }
+
+    void recordLockWait(qint64 nanoseconds)
+    {
+        ++lockWaits;
+        lockWaitNanoseconds += nanoseconds;
+    }
+
+    void recordBucketAccess(bool loaded)
+    {
+        ++(loaded ? bucketHits : bucketMisses);
+    }
+
+    /// Percentage of @p hits among all accesses, or -1 if there were none
+    static double hitRate(quint64 hits, quint64 misses)
+    {
+        return (hits + misses) ? 100.0 * hits / (hits + misses) : -1;
+    }
+
+    quint64 lookups = 0;
+    std::array<quint64, 5> lookupLatencies{};
+    /// Lookups that found an existing item, and the ones that did not
+    quint64 lookupHits = 0;
+    quint64 lookupMisses = 0;
+    /// Bucket accesses served from memory, and the ones that had to load or create the bucket
+    quint64 bucketHits = 0;
+    quint64 bucketMisses = 0;
+    /// How often the lock of the repository was already held by another thread
+    quint64 lockWaits = 0;
+    quint64 lockWaitNanoseconds = 0;
+};
+
+/// Measures a lookup for the lifetime of the object, if instrumentation is enabled.
+class ItemRepositoryLookupTimer
+{
+public:
+    explicit ItemRepositoryLookupTimer(ItemRepositoryCounters& counters)
+        : m_counters(itemRepositoryInstrumentationEnabled() ? &counters : nullptr)
+    {
+        if (m_counters) {
+            m_timer.start();
+        }
+    }
+
+    ~ItemRepositoryLookupTimer()
+    {
+        if (m_counters) {
+            m_counters->recordLookup(m_timer.nsecsElapsed());
+            ++(m_found ? m_counters->lookupHits : m_counters->lookupMisses);
+        }
+    }
+
+    /// Marks the lookup as having found an existing item
+    void setFound()
+    {
+        m_found = true;
+    }
+
+private:
+    Q_DISABLE_COPY(ItemRepositoryLookupTimer)
+
+    ItemRepositoryCounters* m_counters;
+    QElapsedTimer m_timer;
+    bool m_found = false;
+};
+
+/**
+ * Runtime view of an item-repository. Unlike ItemRepository::statistics(), collecting it does not load
+ * any buckets from disk, so it can be requested at any time.
+ */
+struct KDEVPLATFORMSERIALIZATION_EXPORT ItemRepositoryRuntimeStatistics
+{
+    QString name;
+    uint totalItems = 0;
+    /// Count of buckets in use, and how many of them are currently loaded into memory
+    uint buckets = 0;
+    uint loadedBuckets = 0;
+    /// Memory used by the loaded buckets
+    quint64 usedMemory = 0;
+    /// Size of the repository files on disk
+    quint64 fileSize = 0;
+    /// Free space in the loaded buckets, which is lost until items of a matching size are added
+    quint64 freeSpaceInLoadedBuckets = 0;
+    /// Count of buckets with free space that new items can be put into
+    uint bucketsWithFreeSpace = 0;
+    ItemRepositoryCounters counters;
+
+    /// Percentage of the loaded bucket memory that is not used by items
+    double fragmentation() const;
+
+    QString print() const;
+};
+}
+
+#endif // KDEVPLATFORM_ITEMREPOSITORYSTATISTICS_H
@@ -0,0 +1,275 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "repositoryjournal.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QVector>
+
+#include "debug.h"
+
+using namespace KDevelop;
+
+namespace {
+const quint32 journalMagic = 0x4b444a52;
+// bump whenever the format of the journal changes, older journals only lack the newer entry types
+const quint32 journalFormatVersion = 2;
+
+enum EntryType : quint8 {
+    SizeEntry,
+    RangeEntry,
+    FileEntry,
+    MovedFileEntry
+};
+
+struct Entry
+{
+    quint8 type = SizeEntry;
+    QString path;
+    qint64 offset = 0;
+    qint64 size = 0;
+    bool existed = false;
+    QByteArray data;
+    QString backupName;
+};
+
+QDataStream& operator>>(QDataStream& stream, Entry& entry)
+{
+    stream >> entry.type >> entry.path;
+    switch (entry.type) {
+    case SizeEntry:
+        stream >> entry.size;
+        break;
+    case RangeEntry:
+        stream >> entry.offset >> entry.data;
+        break;
+    case FileEntry:
+        stream >> entry.existed >> entry.data;
+        break;
+    case MovedFileEntry:
+        stream >> entry.existed >> entry.backupName;
+        break;
+    default:
+        stream.setStatus(QDataStream::ReadCorruptData);
+    }
+    return stream;
+}
+
+bool restore(const QString& filePath, const QDir& backupDir, const Entry& entry)
+{
+    QFile file(filePath);
+    switch (entry.type) {
+    case SizeEntry:
+        return file.resize(entry.size);
+    case RangeEntry:
+        return file.open(QIODevice::ReadWrite) && file.seek(entry.offset)
+               && file.write(entry.data) == entry.data.size();
+    case FileEntry:
+        if (!entry.existed) {
+            return !file.exists() || file.remove();
+        }
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(entry.data) == entry.data.size();
+    case MovedFileEntry: {
+        if (!entry.existed) {
+            return !file.exists() || file.remove();
+        }
+        // the entry is written before moving the file, so without a backup the file was never moved
+        const QString backupFilePath = backupDir.filePath(entry.backupName);
+        if (!QFile::exists(backupFilePath)) {
+            return true;
+        }
+        return (!file.exists() || file.remove()) && QFile::rename(backupFilePath, filePath);
+    }
+    }
+    return false;
+}
+}
+
+RepositoryJournal::~RepositoryJournal()
+{
+    // an active journal is kept on purpose, so the changes can be rolled back on the next start
+    m_journal.close();
+}
+
+bool RepositoryJournal::begin(const QString& basePath, const QString& journalPath)
+{
+    if (isActive()) {
+        return true;
+    }
+
+    m_basePath = basePath;
+    // left behind if finishing a previous journal was interrupted
+    QDir(backupPath(journalPath)).removeRecursively();
+    m_journal.setFileName(journalPath);
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(SERIALIZATION) << "Could not create repository journal" << journalPath << m_journal.errorString();
+        return false;
+    }
+
+    QDataStream stream(&m_journal);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << journalMagic << journalFormatVersion;
+    m_journal.flush();
+    return true;
+}
+
+void RepositoryJournal::finish()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    m_journal.close();
+    m_journal.remove();
+    QDir(backupPath(m_journal.fileName())).removeRecursively();
+    m_originalSizes.clear();
+    m_savedRanges.clear();
+    m_movedFiles.clear();
+}
+
+bool RepositoryJournal::isActive() const
+{
+    return m_journal.isOpen();
+}
+
+QString RepositoryJournal::relativePath(const QString& filePath) const
+{
+    return QDir(m_basePath).relativeFilePath(filePath);
+}
+
+QString RepositoryJournal::backupPath(const QString& journalPath)
+{
+    return journalPath + QLatin1String("_backup");
+}
+
+void RepositoryJournal::saveRange(QFile* file, qint64 offset, qint64 size)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    const QString path = relativePath(file->fileName());
+
+    QByteArray entry;
+    QDataStream stream(&entry, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    auto sizeIt = m_originalSizes.constFind(path);
+    if (sizeIt == m_originalSizes.constEnd()) {
+        sizeIt = m_originalSizes.insert(path, file->size());
+        stream << static_cast<quint8>(SizeEntry) << path << *sizeIt;
+    }
+
+    // bytes behind the original end of the file are removed by the size entry
+    size = qMin(size, *sizeIt - offset);
+    const QString rangeKey = path + QLatin1Char(':') + QString::number(offset);
+    if (size > 0 && !m_savedRanges.contains(rangeKey)) {
+        m_savedRanges.insert(rangeKey);
+        file->seek(offset);
+        stream << static_cast<quint8>(RangeEntry) << path << offset << file->read(size);
+    }
+
+    if (!entry.isEmpty()) {
+        m_journal.write(entry);
+        m_journal.flush();
+    }
+}
+
+void RepositoryJournal::moveFileAside(const QString& filePath)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    const QString path = relativePath(filePath);
+    if (m_movedFiles.contains(path)) {
+        return;
+    }
+
+    const bool existed = QFile::exists(filePath);
+    const QString backupName = QString::number(m_movedFiles.size());
+    const QDir backupDir(backupPath(m_journal.fileName()));
+    if (existed && !backupDir.exists() && !QDir().mkpath(backupDir.path())) {
+        qCWarning(SERIALIZATION) << "Could not create the repository journal backup directory" << backupDir.path();
+        return;
+    }
+    m_movedFiles.insert(path);
+
+    QByteArray entry;
+    QDataStream stream(&entry, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << static_cast<quint8>(MovedFileEntry) << path << existed << backupName;
+
+    // announce the move before doing it, so an interrupted move is recognized on rollback
+    m_journal.write(entry);
+    m_journal.flush();
+
+    if (existed && !QFile::rename(filePath, backupDir.filePath(backupName))) {
+        qCWarning(SERIALIZATION) << "Could not move" << filePath << "into the repository journal backup directory";
+    }
+}
+
+bool RepositoryJournal::rollback(const QString& basePath, const QString& journalPath)
+{
+    QFile journal(journalPath);
+    if (!journal.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&journal);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != journalMagic || !version
+        || version > journalFormatVersion) {
+        qCWarning(SERIALIZATION) << "Discarding unreadable repository journal" << journalPath;
+        return false;
+    }
+
+    QVector<Entry> entries;
+    while (!stream.atEnd()) {
+        Entry entry;
+        stream >> entry;
+        if (stream.status() != QDataStream::Ok) {
+            break;
+        }
+        entries.append(entry);
+    }
+
+    // undo the changes in reverse order, so the oldest saved state of every range wins
+    const QDir baseDir(basePath);
+    QDir backupDir(backupPath(journalPath));
+    bool success = true;
+    for (auto it = entries.crbegin(), end = entries.crend(); it != end; ++it) {
+        if (!restore(baseDir.filePath(it->path), backupDir, *it)) {
+            qCWarning(SERIALIZATION) << "Failed to restore" << it->path << "from the repository journal";
+            success = false;
+        }
+    }
+
+    if (success) {
+        backupDir.removeRecursively();
+    }
+
+    qCDebug(SERIALIZATION) << "rolled back" << entries.size() << "changes from the repository journal" << journalPath;
+    return success;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_REPOSITORYJOURNAL_H
+#define KDEVPLATFORM_REPOSITORYJOURNAL_H
+
+#include "serializationexport.h"
+
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+namespace KDevelop {
+/**
+ * Undo journal for the files of a repository directory.
+ *
+ * While the journal is active, the old contents of every file range are appended to the journal
+ * before the range is overwritten for the first time. Files which are replaced as a whole are
+ * moved into a backup directory next to the journal instead of being copied. If the application
+ * crashes before the journal is finished, rollback() restores the state the files had when the
+ * journal was begun, so the repository does not have to be discarded.
+ *
+ * The journal is flushed after every entry, so it protects against crashes of the application,
+ * not against crashes of the operating system.
+ */
+class KDEVPLATFORMSERIALIZATION_EXPORT RepositoryJournal
+{
+public:
+    RepositoryJournal() = default;
+    ~RepositoryJournal();
+
+    /// Starts recording changes to the files within @p basePath into the journal file @p journalPath.
+    /// Does nothing if the journal is already active, so the state at the first call can always be restored.
+    /// @returns whether the journal is active
+    bool begin(const QString& basePath, const QString& journalPath);
+
+    /// Closes and deletes the journal file and the backup directory, so the recorded changes become permanent.
+    void finish();
+
+    bool isActive() const;
+
+    /// Saves the @p size bytes at @p offset in @p file, unless they were saved before since begin().
+    /// Also saves the size of the file, so bytes appended behind it are removed again on rollback.
+    /// Does nothing if the journal is not active.
+    void saveRange(QFile* file, qint64 offset, qint64 size);
+
+    /// Moves @p filePath into the backup directory, or records that it does not exist, unless this was done
+    /// before since begin(). Meant for files which are about to be rewritten from scratch or removed: the caller
+    /// has to create the file again if it was moved.
+    /// Does nothing if the journal is not active.
+    void moveFileAside(const QString& filePath);
+
+    /// Restores all files within @p basePath to the state recorded in the journal file @p journalPath.
+    /// An incompletely written last entry is ignored, as the change it announces was never made.
+    /// @returns false if the journal could not be read at all
+    static bool rollback(const QString& basePath, const QString& journalPath);
+
+private:
+    Q_DISABLE_COPY(RepositoryJournal)
+
+    QString relativePath(const QString& filePath) const;
+    static QString backupPath(const QString& journalPath);
+
+    QFile m_journal;
+    QString m_basePath;
+    /// Original sizes of the files whose ranges were saved, by relative path
+    QHash<QString, qint64> m_originalSizes;
+    QSet<QString> m_savedRanges;
+    QSet<QString> m_movedFiles;
+};
+}
+
+#endif // KDEVPLATFORM_REPOSITORYJOURNAL_H
@@ -0,0 +1,111 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QDir>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <serialization/indexedstring.h>
+#include <serialization/internedpath.h>
+#include <serialization/itemrepositoryregistry.h>
+#include <util/path.h>
+
+using namespace KDevelop;
+
+class TestInternedPath : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        ItemRepositoryRegistry::initialize(m_repositoryPath);
+    }
+
+    void cleanupTestCase()
+    {
+        ItemRepositoryRegistry::deleteRepositoryFromDisk(m_repositoryPath);
+    }
+
+    void testRoundTrip_data()
+    {
+        QTest::addColumn<QString>("input");
+
+        QTest::newRow("root") << QStringLiteral("/");
+        QTest::newRow("file") << QStringLiteral("/foo/bar/asdf.txt");
+        QTest::newRow("remote-root") << QStringLiteral("http://foo.com/");
+        QTest::newRow("remote") << QStringLiteral("http://foo.com/bar/asdf.txt");
+    }
+
+    void testRoundTrip()
+    {
+        QFETCH(QString, input);
+        const Path path(input);
+        const InternedPath interned(path);
+
+        QVERIFY(interned.isValid());
+        QCOMPARE(interned.toPath(), path);
+        QCOMPARE(interned.pathOrUrl(), path.pathOrUrl());
+        QCOMPARE(interned.lastPathSegment(), path.lastPathSegment());
+        QCOMPARE(interned.depth(), path.segments().size());
+        QCOMPARE(interned.toIndexed(), IndexedString(path.pathOrUrl()));
+        // interning again yields the same node
+        QCOMPARE(InternedPath(Path(input)), interned);
+
+        // the parent matches Path::parent(), except that root paths have none
+        if (path.hasParent()) {
+            QCOMPARE(interned.parent().toPath(), path.parent());
+            QVERIFY(interned.parent().isParentOf(interned));
+        } else {
+            QVERIFY(!interned.parent().isValid());
+        }
+    }
+
+    void testChildren()
+    {
+        const InternedPath dir(Path(QStringLiteral("/foo/bar")));
+        const InternedPath file(dir, QStringLiteral("asdf.txt"));
+
+        QCOMPARE(file, InternedPath(Path(QStringLiteral("/foo/bar/asdf.txt"))));
+        QCOMPARE(file.parent(), dir);
+        QCOMPARE(dir.depth() + 1, file.depth());
+        QVERIFY(dir.isParentOf(file));
+        QVERIFY(dir.parent().isParentOf(file));
+        QVERIFY(InternedPath(Path(QStringLiteral("/"))).isParentOf(file));
+        QVERIFY(!file.isParentOf(dir));
+        QVERIFY(!file.isParentOf(file));
+        QVERIFY(!InternedPath(Path(QStringLiteral("/foo/baz"))).isParentOf(file));
+
+        QCOMPARE(InternedPath::lookup(Path(QStringLiteral("/foo/bar/asdf.txt"))), file);
+        QVERIFY(!InternedPath::lookup(Path(QStringLiteral("/foo/bar/never-interned.txt"))).isValid());
+
+        QVERIFY(!InternedPath().isValid());
+        QVERIFY(!InternedPath().parent().isValid());
+        QVERIFY(InternedPath().toIndexed().isEmpty());
+    }
+
+private:
+    const QString m_repositoryPath = QDir::tempPath() + QStringLiteral("/test_internedpath");
+};
+
+QTEST_GUILESS_MAIN(TestInternedPath)
+
+#include "test_internedpath.moc"
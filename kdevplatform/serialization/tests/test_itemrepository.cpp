@@ -234,6 +234,89 @@ private Q_SLOTS:
             delete[] item;
         }
     }
+    void testRuntimeStatistics()
+    {
+        ItemRepository<TestItem, TestItemRequest> repository(QStringLiteral("RuntimeStatistics"));
+        setItemRepositoryInstrumentationEnabled(true);
+
+        QList<TestItem*> items;
+        for (int i = 0; i < 100; ++i) {
+            TestItem* item = createItem(i, 100 + sizeof(TestItem));
+            items << item;
+            repository.index(TestItemRequest(*item));
+        }
+        for (auto item : qAsConst(items)) {
+            QVERIFY(repository.findIndex(TestItemRequest(*item)));
+        }
+
+        const auto stats = repository.runtimeStatistics();
+        QCOMPARE(stats.name, QStringLiteral("RuntimeStatistics"));
+        QCOMPARE(stats.totalItems, 100u);
+        QVERIFY(stats.loadedBuckets > 0);
+        QVERIFY(stats.usedMemory > 0);
+        QCOMPARE(stats.counters.lookups, quint64(200));
+        quint64 histogramTotal = 0;
+        for (auto count : stats.counters.lookupLatencies) {
+            histogramTotal += count;
+        }
+        QCOMPARE(histogramTotal, stats.counters.lookups);
+        // the first 100 lookups added the items, the other ones found them
+        QCOMPARE(stats.counters.lookupHits, quint64(100));
+        QCOMPARE(stats.counters.lookupMisses, quint64(100));
+        QVERIFY(stats.counters.bucketHits > 0);
+        QCOMPARE(ItemRepositoryCounters::hitRate(stats.counters.lookupHits, stats.counters.lookupMisses), 50.0);
+        QVERIFY(stats.print().contains(QStringLiteral("lookup hits: 100 misses: 100 (50.0% hit rate)")));
+        QVERIFY(stats.print().startsWith(QStringLiteral("RuntimeStatistics: items: 100 ")));
+
+        setItemRepositoryInstrumentationEnabled(false);
+        repository.findIndex(TestItemRequest(*items.first()));
+        QCOMPARE(repository.runtimeStatistics().counters.lookups, quint64(200));
+
+        for (auto item : qAsConst(items)) {
+            delete[] item;
+        }
+    }
+    void testReclaimTrailingFreeSpace()
+    {
+        ItemRepository<TestItem, TestItemRequest> repository(QStringLiteral("ReclaimTrailingFreeSpace"));
+        const uint itemSize = 500 + sizeof(TestItem);
+
+        QVector<TestItem*> items;
+        QVector<uint> indices;
+        for (int i = 0; i < 50; ++i) {
+            TestItem* item = createItem(i + 1, itemSize);
+            items << item;
+            indices << repository.index(TestItemRequest(*item));
+            // all items are appended to the same bucket
+            QCOMPARE(indices.last() >> 16, indices.first() >> 16);
+        }
+
+        // nothing has been deleted yet
+        QCOMPARE(repository.reclaimTrailingFreeSpace(10), 0u);
+
+        // free space at the end of the bucket is given back, the free space in between is kept
+        const int deleted = 20;
+        repository.deleteItem(indices[10]);
+        for (int i = items.size() - deleted; i < items.size(); ++i) {
+            repository.deleteItem(indices[i]);
+        }
+        QCOMPARE(repository.reclaimTrailingFreeSpace(10), deleted * (itemSize + 2));
+        QCOMPARE(repository.reclaimTrailingFreeSpace(10), 0u);
+
+        // the remaining items are still found at their old indices
+        for (int i = 0; i < items.size() - deleted; ++i) {
+            if (i == 10) {
+                QVERIFY(!repository.findIndex(TestItemRequest(*items[i])));
+                continue;
+            }
+            QCOMPARE(repository.findIndex(TestItemRequest(*items[i])), indices[i]);
+            QVERIFY(items[i]->equals(repository.itemFromIndex(indices[i])));
+        }
+
+        for (auto item : qAsConst(items)) {
+            delete[] item;
+        }
+    }
     void testStringSharing()
     {
         QString qString;
@@ -0,0 +1,168 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+#include <QTemporaryDir>
+
+#include <serialization/repositoryjournal.h>
+
+using namespace KDevelop;
+
+namespace {
+void writeFile(const QString& path, const QByteArray& contents)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(contents);
+}
+
+QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+}
+
+class TestRepositoryJournal : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRollback_data()
+    {
+        QTest::addColumn<int>("truncateJournalBy");
+
+        QTest::newRow("complete") << 0;
+        // a crash while the last entry was written, the announced change was never made
+        QTest::newRow("incomplete-last-entry") << 3;
+    }
+
+    void testRollback()
+    {
+        QFETCH(int, truncateJournalBy);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString journalPath = dir.filePath(QStringLiteral("journal"));
+        const QString repositoryPath = dir.filePath(QStringLiteral("repository"));
+        const QString createdPath = dir.filePath(QStringLiteral("created"));
+        const QString removedPath = dir.filePath(QStringLiteral("removed"));
+        const QString lastPath = dir.filePath(QStringLiteral("last"));
+        writeFile(repositoryPath, "0123456789");
+        writeFile(removedPath, "removed");
+        writeFile(lastPath, "last");
+
+        RepositoryJournal journal;
+        QVERIFY(journal.begin(dir.path(), journalPath));
+        QVERIFY(journal.isActive());
+
+        {
+            QFile repository(repositoryPath);
+            QVERIFY(repository.open(QIODevice::ReadWrite));
+            journal.saveRange(&repository, 2, 4);
+            repository.seek(2);
+            repository.write("abcd");
+            // saved again, the first state must win
+            journal.saveRange(&repository, 2, 4);
+            repository.seek(2);
+            repository.write("efgh");
+            // appended behind the original end
+            journal.saveRange(&repository, 10, 5);
+            repository.seek(10);
+            repository.write("appended");
+        }
+
+        journal.moveFileAside(createdPath);
+        writeFile(createdPath, "created");
+        // moved aside instead of being copied into the journal
+        journal.moveFileAside(removedPath);
+        QVERIFY(!QFile::exists(removedPath));
+        journal.moveFileAside(lastPath);
+        writeFile(lastPath, "changed");
+        // moved before, the first state must win
+        journal.moveFileAside(lastPath);
+        QCOMPARE(readFile(lastPath), QByteArray("changed"));
+
+        if (truncateJournalBy) {
+            QFile journalFile(journalPath);
+            QVERIFY(journalFile.resize(journalFile.size() - truncateJournalBy));
+        }
+
+        // simulate a crash: the journal is not finished
+        QVERIFY(RepositoryJournal::rollback(dir.path(), journalPath));
+
+        QCOMPARE(readFile(repositoryPath), QByteArray("0123456789"));
+        QVERIFY(!QFile::exists(createdPath));
+        QCOMPARE(readFile(removedPath), QByteArray("removed"));
+        QCOMPARE(readFile(lastPath), truncateJournalBy ? QByteArray("changed") : QByteArray("last"));
+        QVERIFY(!QFile::exists(journalPath + QLatin1String("_backup")));
+    }
+
+    void testRollbackOfUnmovedFile()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString journalPath = dir.filePath(QStringLiteral("journal"));
+        const QString filePath = dir.filePath(QStringLiteral("file"));
+        writeFile(filePath, "old");
+
+        RepositoryJournal journal;
+        QVERIFY(journal.begin(dir.path(), journalPath));
+        journal.moveFileAside(filePath);
+        // simulate a crash right after the move was announced, but before the file was moved
+        QVERIFY(QFile::rename(journalPath + QLatin1String("_backup/0"), filePath));
+
+        QVERIFY(RepositoryJournal::rollback(dir.path(), journalPath));
+        QCOMPARE(readFile(filePath), QByteArray("old"));
+    }
+
+    void testFinish()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString journalPath = dir.filePath(QStringLiteral("journal"));
+        const QString filePath = dir.filePath(QStringLiteral("file"));
+        writeFile(filePath, "old");
+
+        RepositoryJournal journal;
+        // nothing is recorded while the journal is not active
+        journal.moveFileAside(filePath);
+        QVERIFY(!QFile::exists(journalPath));
+        QCOMPARE(readFile(filePath), QByteArray("old"));
+
+        QVERIFY(journal.begin(dir.path(), journalPath));
+        journal.moveFileAside(filePath);
+        writeFile(filePath, "new");
+        journal.finish();
+
+        QVERIFY(!journal.isActive());
+        QVERIFY(!QFile::exists(journalPath));
+        QVERIFY(!QFile::exists(journalPath + QLatin1String("_backup")));
+        QVERIFY(!RepositoryJournal::rollback(dir.path(), journalPath));
+        QCOMPARE(readFile(filePath), QByteArray("new"));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRepositoryJournal)
+
+#include "test_repositoryjournal.moc"
@@ -19,6 +19,7 @@
  ***************************************************************************/
 #include "languagecontroller.h"
 
+#include <QDBusConnection>
 #include <QHash>
 #include <QMimeDatabase>
 #include <QMutexLocker>
@@ -32,6 +33,8 @@
 #include <language/interfaces/ilanguagesupport.h>
 #include <language/backgroundparser/backgroundparser.h>
 #include <language/duchain/duchain.h>
+#include <serialization/itemrepositoryregistry.h>
+#include <serialization/itemrepositorystatistics.h>
 
 #include "problemmodelset.h"
 
@@ -129,6 +132,8 @@ LanguageController::LanguageController(QObject *parent)
     , d_ptr(new LanguageControllerPrivate(this))
 {
     setObjectName(QStringLiteral("LanguageController"));
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/org/kdevelop/LanguageController"),
+                                                 this, QDBusConnection::ExportScriptableSlots);
 }
 
 LanguageController::~LanguageController() = default;
@@ -155,6 +160,16 @@ void LanguageController::cleanup()
     d->m_cleanedUp = true;
 }
 
+QString LanguageController::itemRepositoryStatistics() const
+{
+    return globalItemRepositoryRegistry().runtimeStatisticsReport();
+}
+
+void LanguageController::setItemRepositoryStatisticsEnabled(bool enabled)
+{
+    setItemRepositoryInstrumentationEnabled(enabled);
+}
+
 QList<ILanguageSupport*> LanguageController::activeLanguages()
 {
     Q_D(LanguageController);
@@ -32,6 +32,7 @@ class LanguageControllerPrivate;
 
 class KDEVPLATFORMSHELL_EXPORT LanguageController : public ILanguageController {
     Q_OBJECT
+    Q_CLASSINFO( "D-Bus Interface", "org.kdevelop.LanguageController" )
 public:
     explicit LanguageController(QObject *parent);
     ~LanguageController() override;
@@ -61,6 +62,12 @@ public:
     QList<ILanguageSupport*> languagesForMimetype(const QString& mime);
     QList<QString> mimetypesForLanguageName(const QString& languageName);
 
+public Q_SLOTS:
+    /// Returns the sizes and counters of all item-repositories, for inspecting a running session
+    Q_SCRIPTABLE QString itemRepositoryStatistics() const;
+    /// Enables measuring lookup latencies, lock waits and hit rates in all item-repositories
+    Q_SCRIPTABLE void setItemRepositoryStatisticsEnabled(bool enabled);
+
 protected:
     /**
      * functions for unit tests
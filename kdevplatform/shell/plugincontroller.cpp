@@ -25,6 +25,7 @@ Boston, MA 02110-1301, USA.
 
 #include <QElapsedTimer>
 #include <QMap>
+#include <QTextStream>
 
 #include <KConfigGroup>
 #include <KLocalizedString>
@@ -62,6 +63,7 @@ inline QString KEY_Required() { return QStringLiteral("X-KDevelop-IRequired"); }
 inline QString KEY_Optional() { return QStringLiteral("X-KDevelop-IOptional"); }
 inline QString KEY_KPlugin() { return QStringLiteral("KPlugin"); }
 inline QString KEY_EnabledByDefault() { return QStringLiteral("EnabledByDefault"); }
+inline QString KEY_LoadOnDemand() { return QStringLiteral("X-KDevelop-LoadOnDemand"); }
 
 inline QString KEY_Global() { return QStringLiteral("Global"); }
 inline QString KEY_Project() { return QStringLiteral("Project"); }
@@ -80,6 +82,18 @@ bool isGlobalPlugin( const KPluginMetaData& info )
     return info.value(KEY_Category()) == KEY_Global();
 }
 
+/**
+ * Plugins which opt into on-demand loading are not instantiated at startup,
+ * but on the first request for one of their interfaces. Plugins not declaring
+ * any interface could never be reached that way, so they are always loaded eagerly.
+ */
+bool isLoadedOnDemand( const KPluginMetaData& info )
+{
+    return info.rawData().value(KEY_LoadOnDemand()).toBool()
+        && info.value(KEY_LoadMode()) != KEY_AlwaysOn()
+        && !KPluginMetaData::readStringList(info.rawData(), KEY_Interfaces()).isEmpty();
+}
+
 bool hasMandatoryProperties( const KPluginMetaData& info )
 {
     QString mode = info.value(KEY_Mode());
@@ -185,6 +199,11 @@ public:
     };
     CleanupMode cleanupMode;
 
+    // set once the plugins requested at startup have been loaded,
+    // any plugin loaded afterwards was loaded on demand
+    bool startupDone = false;
+    QVector<PluginController::PluginLoadTiming> loadTimings;
+
     bool canUnload(const KPluginMetaData& plugin)
     {
         qCDebug(SHELL) << "checking can unload for:" << plugin.name() << plugin.value(KEY_LoadMode());
@@ -459,14 +478,24 @@ void PluginController::initialize()
     // Synchronize so we're writing out to the file.
     grp.sync();
 
-    // load global plugins
+    // load global plugins, deferring the ones which can be loaded on first use
     for (const KPluginMetaData& pi : qAsConst(d->plugins)) {
-        if (isGlobalPlugin(pi)) {
-            loadPluginInternal(pi.pluginId());
+        if (!isGlobalPlugin(pi)) {
+            continue;
+        }
+        if (isLoadedOnDemand(pi)) {
+            qCDebug(SHELL) << "Deferring loading of plugin" << pi.pluginId() << "until first use";
+            continue;
         }
+        loadPluginInternal(pi.pluginId());
     }
 
+    d->startupDone = true;
+
     qCDebug(SHELL) << "Done loading plugins - took:" << timer.elapsed() << "ms";
+    if (qEnvironmentVariableIsSet("KDEV_PLUGIN_STARTUP_REPORT")) {
+        qCInfo(SHELL).noquote() << loadReport();
+    }
 }
 
 QList<IPlugin *> PluginController::loadedPlugins() const
@@ -591,6 +620,9 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
         return nullptr;
     }
 
+    QElapsedTimer phaseTimer;
+    phaseTimer.start();
+
     // now ensure all dependencies are loaded
     QString failedDependency;
     if( !loadDependencies( info, failedDependency ) ) {
@@ -602,6 +634,11 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
     // same for optional dependencies, but don't error out if anything fails
     loadOptionalDependencies( info );
 
+    PluginLoadTiming timing;
+    timing.pluginId = pluginId;
+    timing.onDemand = d->startupDone;
+    timing.dependenciesTime = phaseTimer.restart();
+
     // now we can finally load the plugin itself
     KPluginLoader loader(info.fileName());
     auto factory = loader.factory();
@@ -611,6 +648,8 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
         return nullptr;
     }
 
+    timing.libraryLoadTime = phaseTimer.restart();
+
     // now create it
     auto plugin = factory->create<IPlugin>(d->core);
     if (!plugin) {
@@ -622,6 +661,8 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
         }
     }
 
+    timing.initializationTime = phaseTimer.elapsed();
+
     KConfigGroup group = Core::self()->activeSession()->config()->group(KEY_Plugins());
     // runtime errors such as missing executables on the system or such get checked now
     if (plugin->hasError()) {
@@ -635,6 +676,7 @@ IPlugin *PluginController::loadPluginInternal( const QString &pluginId )
 
     // yay, it all worked - the plugin is loaded
     d->loadedPlugins.insert(info, plugin);
+    d->loadTimings.append(timing);
     group.writeEntry(info.pluginId() + KEY_Suffix_Enabled(), true); // do the same as KPluginInfo did
     group.sync();
     qCDebug(SHELL) << "Successfully loaded plugin" << pluginId << "from" << loader.fileName() << "- took:" << timer.elapsed() << "ms";
@@ -852,7 +894,7 @@ void PluginController::updateLoadedPlugins()
                 {
                     grp.writeEntry( info.pluginId() + KEY_Suffix_Enabled(), false );
                 }
-            } else if( !loaded && enabled )
+            } else if( !loaded && enabled && !isLoadedOnDemand( info ) )
             {
                 loadPluginInternal( info.pluginId() );
             }
@@ -861,6 +903,64 @@ void PluginController::updateLoadedPlugins()
     }
 }
 
+void PluginController::loadOnDemandPlugins()
+{
+    Q_D(PluginController);
+
+    d->foreachEnabledPlugin([this](const KPluginMetaData& info) -> bool {
+        Q_D(PluginController);
+
+        if (isGlobalPlugin(info) && isLoadedOnDemand(info) && !d->loadedPlugins.contains(info)) {
+            loadPluginInternal(info.pluginId());
+        }
+        return true;
+    });
+}
+
+QVector<PluginController::PluginLoadTiming> PluginController::loadTimings() const
+{
+    Q_D(const PluginController);
+
+    return d->loadTimings;
+}
+
+QString PluginController::loadReport() const
+{
+    Q_D(const PluginController);
+
+    auto timings = d->loadTimings;
+    std::sort(timings.begin(), timings.end(), [](const PluginLoadTiming& lhs, const PluginLoadTiming& rhs) {
+        return lhs.totalTime() > rhs.totalTime();
+    });
+
+    qint64 startupTotal = 0;
+    qint64 onDemandTotal = 0;
+    for (const auto& timing : qAsConst(timings)) {
+        (timing.onDemand ? onDemandTotal : startupTotal) += timing.totalTime();
+    }
+
+    QString report;
+    QTextStream out(&report);
+    out << "Plugin load report: " << timings.size() << " plugins loaded, "
+        << startupTotal << " ms at startup, " << onDemandTotal << " ms on demand\n";
+    for (const auto& timing : qAsConst(timings)) {
+        out << "  " << timing.pluginId.leftJustified(32)
+            << " library: " << QString::number(timing.libraryLoadTime).rightJustified(5) << " ms"
+            << "  init: " << QString::number(timing.initializationTime).rightJustified(5) << " ms"
+            << "  dependencies: " << QString::number(timing.dependenciesTime).rightJustified(5) << " ms"
+            << (timing.onDemand ? "  (on demand)" : "") << '\n';
+    }
+
+    // list what we deferred, so one can tell whether it has been requested yet
+    for (const KPluginMetaData& info : qAsConst(d->plugins)) {
+        if (isGlobalPlugin(info) && isLoadedOnDemand(info) && !d->loadedPlugins.contains(info)) {
+            out << "  " << info.pluginId().leftJustified(32) << " not loaded yet (on demand)\n";
+        }
+    }
+    out.flush();
+    return report;
+}
+
 void PluginController::resetToDefaults()
 {
     Q_D(PluginController);
@@ -26,6 +26,8 @@ Boston, MA 02110-1301, USA.
 
 #include <interfaces/iplugincontroller.h>
 
+#include <QVector>
+
 #include "shellexport.h"
 
 
@@ -104,6 +106,13 @@ public:
      */
     void updateLoadedPlugins();
 
+    /**
+     * Loads all enabled global plugins whose loading was deferred until first use.
+     *
+     * Used where all plugins have to be present, e.g. to show the config pages of all plugins.
+     */
+    void loadOnDemandPlugins();
+
 
     /**
      * Queries for the plugin which supports given extension interface.
@@ -133,6 +142,40 @@ public:
 
     void resetToDefaults();
 
+    /**
+     * Timing information gathered while loading a single plugin.
+     *
+     * All times are in milliseconds. The time spent loading dependencies
+     * is accounted to the dependencies themselves as well.
+     */
+    struct PluginLoadTiming
+    {
+        QString pluginId;
+        /// time spent loading the required and optional dependencies
+        qint64 dependenciesTime = 0;
+        /// time spent loading the plugin library and obtaining its factory
+        qint64 libraryLoadTime = 0;
+        /// time spent in the plugin constructor
+        qint64 initializationTime = 0;
+        /// whether the plugin was loaded after startup, i.e. on first use
+        bool onDemand = false;
+
+        qint64 totalTime() const { return libraryLoadTime + initializationTime; }
+    };
+
+    /**
+     * @return the load timings of all plugins loaded so far, in load order
+     */
+    QVector<PluginLoadTiming> loadTimings() const;
+
+    /**
+     * @return a human readable break down of the plugin load timings,
+     *         including the plugins whose loading was deferred until first use
+     *
+     * The report is printed after startup when KDEV_PLUGIN_STARTUP_REPORT is set.
+     */
+    QString loadReport() const;
+
 private:
     /**
      * Directly unload the given \a plugin, either deleting it now or \a deletion.
@@ -46,6 +46,7 @@
 #include <interfaces/iruncontroller.h>
 #include <interfaces/iuicontroller.h>
 #include <interfaces/isession.h>
+#include <project/projectfileset.h>
 #include <project/projectmodel.h>
 #include <sublime/message.h>
 #include <util/path.h>
@@ -149,7 +150,14 @@ public:
     QString name;
     KSharedConfigPtr m_cfg;
     Project * const project;
-    QSet<KDevelop::IndexedString> fileSet;
+    // mutable so fileSet() can squeeze it
+    mutable ProjectFileSet fileSet;
+    // the changes since fileSetChanged was emitted last
+    QSet<IndexedString> pendingAddedFiles;
+    QSet<IndexedString> pendingRemovedFiles;
+    bool pendingFileSetCleared = false;
+    quint64 pendingFileSetVersion = 0;
+    QTimer fileSetChangedTimer;
     bool loading = false;
     bool fullReload;
     bool scheduleReload = false;
@@ -180,6 +188,75 @@ public:
         }
     }
 
+    void fileSetAboutToChange()
+    {
+        if (!fileSetChangedTimer.isActive()) {
+            pendingFileSetVersion = fileSet.version();
+            fileSetChangedTimer.start();
+        }
+    }
+
+    bool addToFileSet(const IndexedString& path)
+    {
+        if (fileSet.contains(path)) {
+            return false;
+        }
+        fileSetAboutToChange();
+        fileSet.insert(path);
+        if (!pendingRemovedFiles.remove(path)) {
+            pendingAddedFiles.insert(path);
+        }
+        return true;
+    }
+
+    bool removeFromFileSet(const IndexedString& path)
+    {
+        if (!fileSet.contains(path)) {
+            return false;
+        }
+        fileSetAboutToChange();
+        fileSet.remove(path);
+        if (!pendingAddedFiles.remove(path)) {
+            pendingRemovedFiles.insert(path);
+        }
+        return true;
+    }
+
+    void clearFileSet()
+    {
+        if (fileSet.isEmpty()) {
+            return;
+        }
+        fileSetAboutToChange();
+        fileSet.clear();
+        pendingAddedFiles.clear();
+        pendingRemovedFiles.clear();
+        pendingFileSetCleared = true;
+    }
+
+    void emitFileSetChanged()
+    {
+        ProjectFileSetDelta delta;
+        delta.fromVersion = pendingFileSetVersion;
+        delta.toVersion = fileSet.version();
+        delta.cleared = pendingFileSetCleared;
+        delta.added.reserve(pendingAddedFiles.size());
+        for (const IndexedString& file : qAsConst(pendingAddedFiles)) {
+            delta.added.append(file);
+        }
+        delta.removed.reserve(pendingRemovedFiles.size());
+        for (const IndexedString& file : qAsConst(pendingRemovedFiles)) {
+            delta.removed.append(file);
+        }
+        pendingAddedFiles.clear();
+        pendingRemovedFiles.clear();
+        pendingFileSetCleared = false;
+
+        if (delta.cleared || !delta.added.isEmpty() || !delta.removed.isEmpty()) {
+            emit project->fileSetChanged(delta);
+        }
+    }
+
     QList<ProjectBaseItem*> itemsForPath( const IndexedString& path ) const
     {
         if ( path.isEmpty() ) {
@@ -430,6 +507,12 @@ Project::Project( QObject *parent )
 
     d->progress = new ProjectProgress;
     Core::self()->uiController()->registerStatus( d->progress );
+
+    // collect the changes of the file set, mostly done in bulk on import and reload
+    d->fileSetChangedTimer.setSingleShot(true);
+    d->fileSetChangedTimer.setInterval(0);
+    connect(&d->fileSetChangedTimer, &QTimer::timeout,
+            this, [this] () { Q_D(Project); d->emitFileSetChanged(); });
 }
 
 Project::~Project()
@@ -483,7 +566,7 @@ void Project::reloadModel()
         return;
     }
     d->loading = true;
-    d->fileSet.clear();
+    d->clearFileSet();
 
     // delete topItem and remove it from model
     ProjectModel* model = Core::self()->projectController()->projectModel();
@@ -580,10 +663,7 @@ bool Project::inProject( const IndexedString& path ) const
 {
     Q_D(const Project);
 
-    if (d->fileSet.contains( path )) {
-        return true;
-    }
-    return !d->itemsForPath( path ).isEmpty();
+    return d->fileSet.contains( path );
 }
 
 QList< ProjectBaseItem* > Project::itemsForPath(const IndexedString& path) const
@@ -679,31 +759,51 @@ void Project::addToFileSet( ProjectFileItem* file )
 {
     Q_D(Project);
 
-    if (d->fileSet.contains(file->indexedPath())) {
-        return;
+    if (d->addToFileSet(file->indexedPath())) {
+        emit fileAddedToSet( file );
     }
-
-    d->fileSet.insert( file->indexedPath() );
-    emit fileAddedToSet( file );
 }
 
 void Project::removeFromFileSet( ProjectFileItem* file )
 {
     Q_D(Project);
 
-    QSet<IndexedString>::iterator it = d->fileSet.find(file->indexedPath());
-    if (it == d->fileSet.end()) {
-        return;
+    if (d->removeFromFileSet(file->indexedPath())) {
+        emit fileRemovedFromSet( file );
+    }
+}
+
+void Project::addPathToFileSet( const IndexedString& path )
+{
+    Q_D(Project);
+
+    if (d->addToFileSet(path)) {
+        emit filePathAddedToSet( path );
     }
+}
+
+void Project::removePathFromFileSet( const IndexedString& path )
+{
+    Q_D(Project);
 
-    d->fileSet.erase( it );
-    emit fileRemovedFromSet( file );
+    if (d->removeFromFileSet(path)) {
+        emit filePathRemovedFromSet( path );
+    }
 }
 
 QSet<IndexedString> Project::fileSet() const
 {
     Q_D(const Project);
 
+    // merge the pending changes once, instead of on every call
+    d->fileSet.squeeze();
+    return d->fileSet.toSet();
+}
+
+ProjectFileSet Project::fileSetSnapshot() const
+{
+    Q_D(const Project);
+
     return d->fileSet;
 }
 
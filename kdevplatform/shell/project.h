@@ -75,7 +75,10 @@ public:
 
     void addToFileSet( ProjectFileItem* file ) override;
     void removeFromFileSet( ProjectFileItem* file ) override;
+    void addPathToFileSet( const IndexedString& path ) override;
+    void removePathFromFileSet( const IndexedString& path ) override;
     QSet<IndexedString> fileSet() const override;
+    ProjectFileSet fileSetSnapshot() const override;
 
     bool isReady() const override;
 
@@ -868,7 +868,8 @@ void ProjectController::openProject( const QUrl &projectFile )
         }
     }
 
-    if ( ! existingSessions.isEmpty() ) {
+    // without UI, e.g. in headless tools like duchainify, just add the project to the current session
+    if ( ! existingSessions.isEmpty() && Core::self()->setupFlags() != Core::NoUi ) {
         ScopedDialog<QDialog> dialog(Core::self()->uiControllerInternal()->activeMainWindow());
         dialog->setWindowTitle(i18nc("@title:window", "Project Already Open"));
 
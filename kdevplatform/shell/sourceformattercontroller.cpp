@@ -427,29 +427,24 @@ QString SourceFormatterController::indentationMode(const QMimeType& mime)
 
 QString SourceFormatterController::addModelineForCurrentLang(QString input, const QUrl& url, const QMimeType& mime)
 {
-    if( !isMimeTypeSupported(mime) )
-        return input;
+    bool addIfMissing = false;
+    const QString modeline = modelineForCurrentLang(url, mime, &addIfMissing);
+    return applyModeline(input, modeline, addIfMissing);
+}
 
-    QRegExp kateModelineWithNewline(QStringLiteral("\\s*\\n//\\s*kate:(.*)$"));
+QString SourceFormatterController::modelineForCurrentLang(const QUrl& url, const QMimeType& mime, bool* addIfMissing)
+{
+    if( !isMimeTypeSupported(mime) )
+        return QString();
 
-    // If there already is a modeline in the document, adapt it while formatting, even
-    // if "add modeline" is disabled.
-    if (!configForUrl(url).readEntry(SourceFormatterController::kateModeLineConfigKey(), false) &&
-            kateModelineWithNewline.indexIn( input ) == -1 )
-        return input;
+    *addIfMissing = configForUrl(url).readEntry(SourceFormatterController::kateModeLineConfigKey(), false);
 
     ISourceFormatter* fmt = formatterForUrl(url, mime);
+    Q_ASSERT(fmt);
     ISourceFormatter::Indentation indentation = fmt->indentation(url);
 
     if( !indentation.isValid() )
-        return input;
-
-    QString output;
-    QTextStream os(&output, QIODevice::WriteOnly);
-    QTextStream is(&input, QIODevice::ReadOnly);
-
-    Q_ASSERT(fmt);
-
+        return QString();
 
     QString modeline(QStringLiteral("// kate: ")
                    + QLatin1String("indent-mode ") + indentationMode(mime) + QLatin1String("; "));
@@ -466,6 +461,23 @@ QString SourceFormatterController::addModelineForCurrentLang(QString input, cons
     }
 
     qCDebug(SHELL) << "created modeline: " << modeline;
+    return modeline;
+}
+
+QString SourceFormatterController::applyModeline(QString input, const QString& modeline, bool addIfMissing)
+{
+    if (modeline.isEmpty())
+        return input;
+
+    // If there already is a modeline in the document, adapt it while formatting, even
+    // if "add modeline" is disabled.
+    QRegExp kateModelineWithNewline(QStringLiteral("\\s*\\n//\\s*kate:(.*)$"));
+    if (!addIfMissing && kateModelineWithNewline.indexIn( input ) == -1)
+        return input;
+
+    QString output;
+    QTextStream os(&output, QIODevice::WriteOnly);
+    QTextStream is(&input, QIODevice::ReadOnly);
 
     QRegExp kateModeline(QStringLiteral("^\\s*//\\s*kate:(.*)$"));
 
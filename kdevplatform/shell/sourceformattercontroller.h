@@ -163,6 +163,14 @@ private:
     * corresponding to the settings of the active language.
     */
     QString addModelineForCurrentLang(QString input, const QUrl& url, const QMimeType&);
+    /** \return The modeline for @p url, or an empty string if the indentation of its formatter is unknown.
+    * @p addIfMissing is set to whether the modeline should also be added to files which do not have one yet.
+    */
+    QString modelineForCurrentLang(const QUrl& url, const QMimeType& mime, bool* addIfMissing);
+    /** \return @p input with its modeline replaced by @p modeline, or with @p modeline appended
+    * if it has none and @p addIfMissing is set. This function is thread-safe.
+    */
+    static QString applyModeline(QString input, const QString& modeline, bool addIfMissing);
     /** \return The name of kate indentation mode for the mime type.
     * examples are cstyle, python, etc.
     */
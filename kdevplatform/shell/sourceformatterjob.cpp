@@ -27,8 +27,11 @@
 
 #include <debug.h>
 
+#include <QFile>
+#include <QFutureWatcher>
 #include <QMimeDatabase>
 #include <QTextStream>
+#include <QtConcurrentRun>
 
 #include <KIO/StoredTransferJob>
 #include <KLocalizedString>
@@ -36,6 +39,8 @@
 #include <interfaces/icore.h>
 #include <interfaces/iuicontroller.h>
 #include <interfaces/idocumentcontroller.h>
+#include <interfaces/iproject.h>
+#include <interfaces/iprojectcontroller.h>
 #include <interfaces/isourceformatter.h>
 #include <sublime/message.h>
 
@@ -66,36 +71,60 @@ QString SourceFormatterJob::statusName() const
 
 void SourceFormatterJob::doWork()
 {
+    m_workScheduled = false;
+
     // TODO: consider to use ExecuteCompositeJob, with every file a separate subjob
     switch (m_workState) {
         case WorkIdle:
             m_workState = WorkFormat;
             m_fileIndex = 0;
+            m_finishedFiles = 0;
             emit showProgress(this, 0, 0, 0);
             emit showMessage(this, i18np("Reformatting one file",
                                          "Reformatting %1 files",
                                          m_fileList.length()));
 
-            QMetaObject::invokeMethod(this, "doWork", Qt::QueuedConnection);
+            scheduleWork();
             break;
-        case WorkFormat:
-            if (m_fileIndex < m_fileList.length()) {
-                emit showProgress(this, 0, m_fileList.length(), m_fileIndex);
-                formatFile(m_fileList[m_fileIndex]);
-
-                // trigger formatting of next file
+        case WorkFormat: {
+            // keep the thread pool busy, but do not read more files ahead than it can format
+            const int maxRunningFiles = 2 * m_threadPool.maxThreadCount();
+            while (m_fileIndex < m_fileList.length() && m_runningFiles < maxRunningFiles) {
+                const bool inBackground = formatFile(m_fileList[m_fileIndex]);
                 ++m_fileIndex;
-                QMetaObject::invokeMethod(this, "doWork", Qt::QueuedConnection);
-            } else {
+                if (!inBackground) {
+                    // files formatted in the GUI thread are done one per event loop iteration
+                    ++m_finishedFiles;
+                    break;
+                }
+            }
+
+            emit showProgress(this, 0, m_fileList.length(), m_finishedFiles);
+            if (m_fileIndex < m_fileList.length()) {
+                // otherwise continued once a file formatted in the background is done
+                if (m_runningFiles < maxRunningFiles) {
+                    scheduleWork();
+                }
+            } else if (m_runningFiles == 0) {
                 m_workState = WorkIdle;
                 emitResult();
             }
             break;
+        }
         case WorkCancelled:
             break;
     }
 }
 
+void SourceFormatterJob::scheduleWork()
+{
+    if (m_workScheduled)
+        return;
+
+    m_workScheduled = true;
+    QMetaObject::invokeMethod(this, "doWork", Qt::QueuedConnection);
+}
+
 void SourceFormatterJob::start()
 {
     if (m_workState != WorkIdle)
@@ -103,12 +132,14 @@ void SourceFormatterJob::start()
 
     m_workState = WorkIdle;
 
-    QMetaObject::invokeMethod(this, "doWork", Qt::QueuedConnection);
+    scheduleWork();
 }
 
 bool SourceFormatterJob::doKill()
 {
     m_workState = WorkCancelled;
+    // files already being formatted are completed when the thread pool is destroyed
+    m_threadPool.clear();
     return true;
 }
 
@@ -117,21 +148,29 @@ void SourceFormatterJob::setFiles(const QList<QUrl>& fileList)
     m_fileList = fileList;
 }
 
-void SourceFormatterJob::formatFile(const QUrl& url)
+bool SourceFormatterJob::formatFile(const QUrl& url)
 {
     // check mimetype
     QMimeType mime = QMimeDatabase().mimeTypeForUrl(url);
     qCDebug(SHELL) << "Checking file " << url << " of mime type " << mime.name();
     auto formatter = m_sourceFormatterController->formatterForUrl(url, mime);
     if (!formatter) // unsupported mime type
-        return;
+        return false;
 
     // if the file is opened in the editor, format the text in the editor without saving it
     auto doc = ICore::self()->documentController()->documentForUrl(url);
     if (doc) {
         qCDebug(SHELL) << "Processing file " << url << "opened in editor";
         m_sourceFormatterController->formatDocument(doc, formatter, mime);
-        return;
+        return false;
+    }
+
+    if (url.isLocalFile() && formatter->isThreadSafe()) {
+        const auto settings = formatSettings(url, mime, formatter);
+        if (!settings.style.content().isEmpty()) {
+            formatFileInBackground(url, mime, settings);
+            return true;
+        }
     }
 
     qCDebug(SHELL) << "Processing file " << url;
@@ -153,4 +192,81 @@ void SourceFormatterJob::formatFile(const QUrl& url)
         auto* message = new Sublime::Message(getJob->errorString(), Sublime::Message::Error);
         ICore::self()->uiController()->postMessage(message);
     }
+    return false;
+}
+
+SourceFormatterJob::FormatSettings SourceFormatterJob::formatSettings(const QUrl& url, const QMimeType& mime,
+                                                                      ISourceFormatter* formatter)
+{
+    // the formatter configuration is either the one of the project or the one of the session
+    const auto project = ICore::self()->projectController()->findProjectForUrl(url);
+    const QString key = (project ? project->name() : QString()) + QLatin1String("||") + mime.name();
+
+    auto it = m_formatSettings.find(key);
+    if (it == m_formatSettings.end()) {
+        FormatSettings settings;
+        settings.formatter = formatter;
+        settings.style = m_sourceFormatterController->styleForUrl(url, mime);
+        if (settings.style.content().isEmpty()) {
+            // predefined styles are only stored by their name
+            const auto predefinedStyles = formatter->predefinedStyles();
+            for (const auto& style : predefinedStyles) {
+                if (style.name() == settings.style.name()) {
+                    settings.style = style;
+                    break;
+                }
+            }
+        }
+        settings.modeline = m_sourceFormatterController->modelineForCurrentLang(url, mime,
+                                                                                &settings.addModelineIfMissing);
+        it = m_formatSettings.insert(key, settings);
+    }
+    return *it;
+}
+
+void SourceFormatterJob::formatFileInBackground(const QUrl& url, const QMimeType& mime, const FormatSettings& settings)
+{
+    qCDebug(SHELL) << "Processing file " << url << "in the background";
+
+    auto format = [url, mime, settings]() -> QString {
+        QFile file(url.toLocalFile());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return i18n("Could not read %1: %2", url.toDisplayString(QUrl::PreferLocalFile), file.errorString());
+        }
+        const QByteArray original = file.readAll();
+        file.close();
+
+        // TODO: really fromLocal8Bit/toLocal8Bit? no encoding detection? see formatFile()
+        QString text = QString::fromLocal8Bit(original);
+        text = settings.formatter->formatSourceWithStyle(settings.style, text, url, mime);
+        text = SourceFormatterController::applyModeline(text, settings.modeline, settings.addModelineIfMissing);
+
+        const QByteArray formatted = text.toLocal8Bit();
+        if (formatted == original) {
+            return QString();
+        }
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(formatted) != formatted.size()) {
+            return i18n("Could not write %1: %2", url.toDisplayString(QUrl::PreferLocalFile), file.errorString());
+        }
+        return QString();
+    };
+
+    ++m_runningFiles;
+    auto* watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher]() {
+        const QString errorMessage = watcher->result();
+        watcher->deleteLater();
+        --m_runningFiles;
+        ++m_finishedFiles;
+
+        if (m_workState != WorkFormat)
+            return;
+
+        if (!errorMessage.isEmpty()) {
+            auto* message = new Sublime::Message(errorMessage, Sublime::Message::Error);
+            ICore::self()->uiController()->postMessage(message);
+        }
+        scheduleWork();
+    });
+    watcher->setFuture(QtConcurrent::run(&m_threadPool, format));
 }
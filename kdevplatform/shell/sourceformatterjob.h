@@ -22,11 +22,14 @@
 #ifndef KDEVPLATFORM_SOURCEFORMATTERJOB_H
 #define KDEVPLATFORM_SOURCEFORMATTERJOB_H
 
+#include <QHash>
 #include <QList>
+#include <QThreadPool>
 #include <QUrl>
 
 #include <KJob>
 
+#include <interfaces/isourceformatter.h>
 #include <interfaces/istatus.h>
 
 
@@ -63,9 +66,22 @@ Q_SIGNALS: // KDevelop::IStatus API
     void showProgress(KDevelop::IStatus* status, int minimum, int maximum, int value) override;
 
 private:
+    /// Everything needed to format a file in the background, which only depends on the project and mime type of the file
+    struct FormatSettings
+    {
+        ISourceFormatter* formatter = nullptr;
+        SourceFormatterStyle style;
+        QString modeline;
+        bool addModelineIfMissing = false;
+    };
+
     Q_INVOKABLE void doWork();
+    void scheduleWork();
 
-    void formatFile(const QUrl& url);
+    /// @return whether the file is being formatted in the background
+    bool formatFile(const QUrl& url);
+    void formatFileInBackground(const QUrl& url, const QMimeType& mime, const FormatSettings& settings);
+    FormatSettings formatSettings(const QUrl& url, const QMimeType& mime, ISourceFormatter* formatter);
 
 private:
     SourceFormatterController* const m_sourceFormatterController;
@@ -78,6 +94,12 @@ private:
 
     QList<QUrl> m_fileList;
     int m_fileIndex;
+    int m_finishedFiles = 0;
+    int m_runningFiles = 0;
+    bool m_workScheduled = false;
+
+    QHash<QString, FormatSettings> m_formatSettings;
+    QThreadPool m_threadPool;
 };
 
 }
@@ -37,7 +37,7 @@ void TestPluginController::initTestCase()
 {
     qApp->addLibraryPath(QStringLiteral(TEST_PLUGIN_DIR));
 
-    AutoTestShell::init({QStringLiteral("test_nonguiinterface")});
+    AutoTestShell::init({QStringLiteral("test_nonguiinterface"), QStringLiteral("test_ondemand")});
     TestCore::initialize( Core::NoUi );
     m_pluginCtrl = Core::self()->pluginControllerInternal();
 }
@@ -89,6 +89,38 @@ void TestPluginController::loadFromExtension()
     QVERIFY( plugin->extension<ITestNonGuiInterface>());
 }
 
+void TestPluginController::loadTimings()
+{
+    QVERIFY(m_pluginCtrl->loadPlugin(QStringLiteral("test_nonguiinterface")));
+
+    const auto timings = m_pluginCtrl->loadTimings();
+    const bool found = std::any_of(timings.begin(), timings.end(), [](const PluginController::PluginLoadTiming& timing) {
+        return timing.pluginId == QLatin1String("test_nonguiinterface");
+    });
+    QVERIFY(found);
+    QVERIFY(m_pluginCtrl->loadReport().contains(QLatin1String("test_nonguiinterface")));
+}
+
+void TestPluginController::loadOnDemandPlugins()
+{
+    const QString pluginId = QStringLiteral("test_ondemand");
+    // deferred at startup
+    QVERIFY(!m_pluginCtrl->plugin(pluginId));
+
+    // e.g. the settings dialog needs all plugins to be loaded
+    m_pluginCtrl->loadOnDemandPlugins();
+    QVERIFY(m_pluginCtrl->plugin(pluginId));
+
+    const auto timings = m_pluginCtrl->loadTimings();
+    const auto timing = std::find_if(timings.begin(), timings.end(), [&](const PluginController::PluginLoadTiming& timing) {
+        return timing.pluginId == pluginId;
+    });
+    QVERIFY(timing != timings.end());
+    QVERIFY(timing->onDemand);
+
+    QVERIFY(m_pluginCtrl->unloadPlugin(pluginId));
+}
+
 void TestPluginController::benchPluginForExtension()
 {
     QBENCHMARK {
@@ -39,6 +39,8 @@ private Q_SLOTS:
     void loadUnloadPlugin();
     void loadFromExtension();
     void pluginInfo();
+    void loadTimings();
+    void loadOnDemandPlugins();
     void benchPluginForExtension();
 
 private:
@@ -31,6 +31,7 @@
 
 #include <interfaces/iplugin.h>
 #include <project/interfaces/iprojectfilemanager.h>
+#include <project/projectfileset.h>
 #include <project/projectmodel.h>
 #include <shell/core.h>
 #include <shell/projectcontroller.h>
@@ -511,6 +512,70 @@ Path TestProjectController::writeProjectConfig(const QString& name)
     return configPath;
 }
 
+void TestProjectController::fileSetChanged()
+{
+    qRegisterMetaType<ProjectFileSetDelta>();
+    m_projCtrl->openProject(m_projFilePath.toUrl());
+    WAIT_FOR_OPEN_SIGNAL;
+    auto* proj = assertProjectOpened(m_projName);
+    QVERIFY(proj->fileSet().isEmpty());
+
+    FakeFileManager* fileMng = createFileManager();
+    proj->setManagerPlugin(fileMng);
+    QSignalSpy spy(proj, &IProject::fileSetChanged);
+
+    // clearing the empty file set is no change
+    proj->reloadModel();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 0);
+
+    const Path filePath(m_projFolder, QStringLiteral("foobar"));
+    const IndexedString indexedFilePath(filePath.pathOrUrl());
+    fileMng->addFileToFolder(m_projFolder, filePath);
+    proj->reloadModel();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+    auto delta = spy.takeFirst().at(0).value<ProjectFileSetDelta>();
+    QVERIFY(!delta.cleared);
+    QCOMPARE(delta.added, QVector<IndexedString>{indexedFilePath});
+    QVERIFY(delta.removed.isEmpty());
+    QCOMPARE(delta.toVersion, proj->fileSetSnapshot().version());
+
+    // changes done in one go are reported together, undone changes are not reported at all
+    const quint64 version = proj->fileSetSnapshot().version();
+    const IndexedString a(Path(m_projFolder, QStringLiteral("a")).pathOrUrl());
+    const IndexedString b(Path(m_projFolder, QStringLiteral("b")).pathOrUrl());
+    proj->addPathToFileSet(a);
+    proj->addPathToFileSet(b);
+    proj->removePathFromFileSet(a);
+    proj->removePathFromFileSet(indexedFilePath);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    delta = spy.takeFirst().at(0).value<ProjectFileSetDelta>();
+    QVERIFY(!delta.cleared);
+    QCOMPARE(delta.fromVersion, version);
+    QCOMPARE(delta.toVersion, proj->fileSetSnapshot().version());
+    QCOMPARE(delta.added, QVector<IndexedString>{b});
+    QCOMPARE(delta.removed, QVector<IndexedString>{indexedFilePath});
+
+    // reloading clears the file set, the files found again are reported as added
+    proj->reloadModel();
+    QTest::qWait(100);
+    QVERIFY(!spy.isEmpty());
+    delta = spy.first().at(0).value<ProjectFileSetDelta>();
+    QVERIFY(delta.cleared);
+    QVERIFY(!delta.removed.contains(b));
+    delta = spy.last().at(0).value<ProjectFileSetDelta>();
+    QCOMPARE(delta.toVersion, proj->fileSetSnapshot().version());
+    QCOMPARE(proj->fileSet(), QSet<IndexedString>{indexedFilePath});
+
+    // answered from the file set, which only contains files
+    QVERIFY(proj->inProject(indexedFilePath));
+    QVERIFY(!proj->inProject(b));
+    QVERIFY(!proj->inProject(IndexedString(m_projFolder.pathOrUrl())));
+}
+
 ////////////////// Custom assertions /////////////////////////////////////////
 
 KDevelop::Project* TestProjectController::assertProjectOpened(const QString& name)
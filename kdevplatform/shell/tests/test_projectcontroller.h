@@ -60,6 +60,7 @@ private Q_SLOTS:
     void fileInSubdirectory();
     void prettyFileName_data();
     void prettyFileName();
+    void fileSetChanged();
 
 private:
     KDevelop::Path writeProjectConfig(const QString& name);
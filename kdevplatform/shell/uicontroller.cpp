@@ -570,6 +570,9 @@ void UiController::showSettingsDialog()
         }
     };
 
+    // plugins loaded on demand can provide config pages as well
+    Core::self()->pluginControllerInternal()->loadOnDemandPlugins();
+
     auto plugins = ICore::self()->pluginController()->loadedPlugins();
     std::sort(plugins.begin(), plugins.end());
 
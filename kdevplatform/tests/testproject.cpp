@@ -114,9 +114,9 @@ QList<ProjectFileItem*> TestProject::filesForPath(const IndexedString& path) con
 
 void TestProject::addToFileSet(ProjectFileItem* file)
 {
-    if (!m_fileSet.contains(file->indexedPath())) {
-        m_fileSet.insert(file->indexedPath());
+    if (m_fileSet.insert(file->indexedPath())) {
         emit fileAddedToSet(file);
+        emitFileSetChanged(file->indexedPath(), IndexedString());
     }
 }
 
@@ -124,9 +124,41 @@ void TestProject::removeFromFileSet(ProjectFileItem* file)
 {
     if (m_fileSet.remove(file->indexedPath())) {
         emit fileRemovedFromSet(file);
+        emitFileSetChanged(IndexedString(), file->indexedPath());
     }
 }
 
+void TestProject::addPathToFileSet(const IndexedString& path)
+{
+    if (m_fileSet.insert(path)) {
+        emit filePathAddedToSet(path);
+        emitFileSetChanged(path, IndexedString());
+    }
+}
+
+void TestProject::removePathFromFileSet(const IndexedString& path)
+{
+    if (m_fileSet.remove(path)) {
+        emit filePathRemovedFromSet(path);
+        emitFileSetChanged(IndexedString(), path);
+    }
+}
+
+void TestProject::emitFileSetChanged(const IndexedString& added, const IndexedString& removed)
+{
+    // unlike Project, every change is emitted right away
+    ProjectFileSetDelta delta;
+    delta.fromVersion = m_fileSet.version() - 1;
+    delta.toVersion = m_fileSet.version();
+    if (!added.isEmpty()) {
+        delta.added.append(added);
+    }
+    if (!removed.isEmpty()) {
+        delta.removed.append(removed);
+    }
+    emit fileSetChanged(delta);
+}
+
 void TestProjectController::initialize()
 {
 }
@@ -24,6 +24,7 @@
 #include <QSet>
 
 #include <interfaces/iproject.h>
+#include <project/projectfileset.h>
 
 #include <serialization/indexedstring.h>
 #include <shell/projectcontroller.h>
@@ -69,7 +70,10 @@ public:
     KSharedConfigPtr projectConfiguration() const override { return m_projectConfiguration; }
     void addToFileSet(ProjectFileItem* file) override;
     void removeFromFileSet(ProjectFileItem* file) override;
-    QSet<IndexedString> fileSet() const override { return m_fileSet; }
+    void addPathToFileSet(const IndexedString& path) override;
+    void removePathFromFileSet(const IndexedString& path) override;
+    QSet<IndexedString> fileSet() const override { return m_fileSet.toSet(); }
+    ProjectFileSet fileSetSnapshot() const override { return m_fileSet; }
     bool isReady() const override { return true; }
 
     void setPath(const Path& path);
@@ -80,7 +84,9 @@ public:
     void setReloadJob(KJob*) override {}
 
 private:
-    QSet<IndexedString> m_fileSet;
+    void emitFileSetChanged(const IndexedString& added, const IndexedString& removed);
+
+    ProjectFileSet m_fileSet;
     Path m_path;
     ProjectFolderItem* m_root = nullptr;
     KSharedConfigPtr m_projectConfiguration;
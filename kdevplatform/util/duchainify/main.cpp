@@ -31,7 +31,13 @@
 #include <language/duchain/problem.h>
 #include <language/duchain/persistentsymboltable.h>
 
+#include <serialization/itemrepositoryregistry.h>
+#include <serialization/itemrepositorystatistics.h>
+
 #include <interfaces/ilanguagecontroller.h>
+#include <interfaces/iproject.h>
+#include <interfaces/iprojectcontroller.h>
+#include <interfaces/isession.h>
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
 
@@ -39,8 +45,11 @@
 #include <QCommandLineParser>
 #include <QCommandLineOption>
 #include <QDebug>
+#include <QDir>
 #include <QDirIterator>
+#include <QStandardPaths>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 
 #include <cstdio>
@@ -83,9 +92,11 @@ Manager::Manager(QCommandLineParser* args) : m_total(0)
 
 void Manager::init()
 {
-    if (m_args->positionalArguments().isEmpty()) {
-        std::cerr << "Need file or directory to duchainify" << std::endl;
+    const auto projects = m_args->values(QStringLiteral("project"));
+    if (m_args->positionalArguments().isEmpty() && projects.isEmpty()) {
+        std::cerr << "Need file, directory or project to duchainify" << std::endl;
         QCoreApplication::exit(1);
+        return;
     }
 
     TopDUContext::Features features = TopDUContext::VisibleDeclarationsAndContexts;
@@ -123,6 +134,9 @@ void Manager::init()
             QCoreApplication::exit(3);
             return;
         }
+    } else if (!projects.isEmpty()) {
+        // batch indexing of whole projects, use all the machine has to offer
+        ICore::self()->languageController()->backgroundParser()->setThreadCount(QThread::idealThreadCount());
     }
 
     // quit when everything is done
@@ -133,9 +147,19 @@ void Manager::init()
     connect(
         ICore::self()->languageController()->backgroundParser(), &BackgroundParser::hideProgress, this,
         [this]() {
-            if (ICore::self()->languageController()->backgroundParser()->isIdle())
-                QTimer::singleShot(0, this, &Manager::finish);
+            checkFinished();
         });
+    connect(ICore::self()->languageController()->backgroundParser(), &BackgroundParser::parseJobFinished,
+            this, &Manager::parseJobFinished);
+
+    m_parseTimer.start();
+
+    for (const auto& project : projects) {
+        if (!openProject(project)) {
+            QCoreApplication::exit(4);
+            return;
+        }
+    }
 
     const auto files = m_args->positionalArguments();
     for (const auto& file : files) {
@@ -144,7 +168,12 @@ void Manager::init()
 
     m_allFilesAdded = 1;
 
-    if (m_total) {
+    if (m_pendingProjects) {
+        std::cerr << "Importing " << m_pendingProjects << " project(s)" << std::endl;
+        if (m_total) {
+            std::cerr << "Added " << m_total << " files to the background parser" << std::endl;
+        }
+    } else if (m_total) {
         std::cerr << "Added " << m_total << " files to the background parser" << std::endl;
         const int threads = ICore::self()->languageController()->backgroundParser()->threadCount();
         std::cerr << "parsing with " << threads << " threads" << std::endl;
@@ -248,6 +277,76 @@ void Manager::addToBackgroundParser(const QString& path, TopDUContext::Features
     }
 }
 
+bool Manager::openProject(const QString& path)
+{
+    QFileInfo info(path);
+    if (info.isDir()) {
+        const auto projectFiles = QDir(path).entryInfoList({QStringLiteral("*.kdev4")}, QDir::Files);
+        if (projectFiles.isEmpty()) {
+            std::cerr << "no .kdev4 project file found in " << qPrintable(path) << std::endl;
+            return false;
+        }
+        info = projectFiles.first();
+    } else if (!info.isFile()) {
+        std::cerr << "project file " << qPrintable(path) << " does not exist" << std::endl;
+        return false;
+    }
+
+    auto* projectController = ICore::self()->projectController();
+    if (!m_pendingProjects) {
+        connect(projectController, &IProjectController::projectOpened,
+                this, &Manager::projectOpened, Qt::UniqueConnection);
+        connect(projectController, &IProjectController::projectOpeningAborted,
+                this, &Manager::projectOpeningAborted, Qt::UniqueConnection);
+    }
+
+    qDebug() << "opening project" << info.absoluteFilePath();
+    ++m_pendingProjects;
+    projectController->openProject(QUrl::fromLocalFile(info.absoluteFilePath()));
+    return true;
+}
+
+void Manager::projectOpened(IProject* project)
+{
+    const int fileCount = project->fileSet().size();
+    std::cerr << "imported project " << qPrintable(project->name()) << " with " << fileCount << " files" << std::endl;
+
+    // the project controller already started parsing the project when opening it,
+    // only replace that job if the existing top-contexts have to be updated
+    if (m_args->isSet(QStringLiteral("force-update"))) {
+        ICore::self()->projectController()->reparseProject(project, true);
+    }
+
+    --m_pendingProjects;
+    if (!fileCount) {
+        // nothing gets queued for this project, so the background parser might never report progress
+        checkFinished();
+    }
+}
+
+void Manager::projectOpeningAborted(IProject* project)
+{
+    std::cerr << "failed to import project " << qPrintable(project->name()) << std::endl;
+
+    --m_pendingProjects;
+    checkFinished();
+}
+
+void Manager::parseJobFinished(ParseJob* job)
+{
+    Q_UNUSED(job);
+
+    ++m_parsedFiles;
+}
+
+void Manager::checkFinished()
+{
+    if (m_allFilesAdded && !m_pendingProjects
+        && ICore::self()->languageController()->backgroundParser()->isIdle()) {
+        QTimer::singleShot(0, this, &Manager::finish);
+    }
+}
+
 QSet<QUrl> Manager::waiting()
 {
     return m_waiting;
@@ -255,6 +354,27 @@ QSet<QUrl> Manager::waiting()
 
 void Manager::finish()
 {
+    const double seconds = m_parseTimer.elapsed() / 1000.0;
+    const int threads = ICore::self()->languageController()->backgroundParser()->threadCount();
+    std::cerr << "parsed " << m_parsedFiles << " files in " << seconds << " s with " << threads << " threads ("
+              << (seconds > 0 ? m_parsedFiles / seconds : 0.0) << " files/s)" << std::endl;
+
+    if (!m_args->values(QStringLiteral("project")).isEmpty()) {
+        QElapsedTimer storeTimer;
+        storeTimer.start();
+        DUChain::self()->storeToDisk();
+        std::cerr << "stored DUChain of session " << qPrintable(ICore::self()->activeSession()->name())
+                  << " in " << storeTimer.elapsed() << " ms" << std::endl;
+    }
+
+    if (m_args->isSet(QStringLiteral("dump-repository-statistics"))) {
+        QTextStream stream(stdout);
+        const auto statistics = globalItemRepositoryRegistry().runtimeStatistics();
+        for (const auto& repositoryStatistics : statistics) {
+            stream << repositoryStatistics.print() << '\n';
+        }
+    }
+
     std::cerr << "ready" << std::endl;
     QCoreApplication::quit();
 }
@@ -287,6 +407,14 @@ int main(int argc, char** argv)
                                             "Enforce an update of the top-contexts corresponding to the given files and all included files")});
     parser.addOption(QCommandLineOption{QStringList{QStringLiteral("t"), QStringLiteral("threads")},
                                         i18n("Number of threads to use"), QStringLiteral("count")});
+    parser.addOption(QCommandLineOption{QStringList{QStringLiteral("p"), QStringLiteral("project")},
+                                        i18n(
+                                            "Import the given project (a .kdev4 file or a directory containing one) through its project manager and parse all of its files, using all available cores unless --threads is given"),
+                                        QStringLiteral("project")});
+    parser.addOption(QCommandLineOption{QStringList{QStringLiteral("s"), QStringLiteral("session")},
+                                        i18n(
+                                            "Name or id of the session to use. The DUChain cache is written to this session, so KDevelop finds it when opening the session"),
+                                        QStringLiteral("session"), QStringLiteral("duchainify")});
     parser.addOption(QCommandLineOption{QStringList{QStringLiteral("f"), QStringLiteral("features")},
                                         i18n(
                                             "Features to build. Options: empty, simplified-visible-declarations, visible-declarations (default), all-declarations, all-declarations-and-uses, all-declarations-and-uses-and-AST"),
@@ -309,17 +437,30 @@ int main(int argc, char** argv)
                                         i18n("Print problems encountered during parsing")});
     parser.addOption(QCommandLineOption{QStringList{QStringLiteral("dump-imported-errors")},
                                         i18n("Recursively dump errors from imported contexts.")});
+    parser.addOption(QCommandLineOption{QStringList{QStringLiteral("dump-repository-statistics")},
+                                        i18n(
+                                            "Print sizes, lookup latencies and lock wait times of all DUChain item-repositories when done")});
 
     parser.process(app);
 
     aboutData.processCommandLine(&parser);
 
+    if (parser.isSet(QStringLiteral("dump-repository-statistics"))) {
+        setItemRepositoryInstrumentationEnabled(true);
+    }
+
     verbose = parser.isSet(QStringLiteral("verbose"));
     warnings = parser.isSet(QStringLiteral("warnings"));
     qInstallMessageHandler(messageOutput);
 
     AutoTestShell::init();
-    TestCore::initialize(Core::NoUi, QStringLiteral("duchainify"));
+    if (parser.isSet(QStringLiteral("project"))) {
+        // the cache is meant to be used by KDevelop later on, so neither write it to the
+        // test mode location nor clear it on startup, as AutoTestShell sets up for unit tests
+        QStandardPaths::setTestModeEnabled(false);
+        qunsetenv("CLEAR_DUCHAIN_DIR");
+    }
+    TestCore::initialize(Core::NoUi, parser.value(QStringLiteral("session")));
     Manager manager(&parser);
 
     QTimer::singleShot(0, &manager, &Manager::init);
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QUrl>
 
 #include <language/duchain/topducontext.h>
@@ -29,6 +30,11 @@
 
 class QCommandLineParser;
 
+namespace KDevelop {
+class IProject;
+class ParseJob;
+}
+
 class Manager : public QObject
 {
     Q_OBJECT
@@ -36,18 +42,28 @@ class Manager : public QObject
 public:
     explicit Manager(QCommandLineParser* args);
     void addToBackgroundParser(const QString& path, KDevelop::TopDUContext::Features features);
+    bool openProject(const QString& path);
     QSet<QUrl> waiting();
 
 private:
+    void checkFinished();
+
     QSet<QUrl> m_waiting;
     uint m_total;
     QCommandLineParser* m_args;
     QAtomicInt m_allFilesAdded;
+    // projects whose import through the project manager did not finish yet
+    int m_pendingProjects = 0;
+    int m_parsedFiles = 0;
+    QElapsedTimer m_parseTimer;
 
 public Q_SLOTS:
     // delay init into event loop so the DUChain can always shutdown gracefully
     void init();
     void updateReady(const KDevelop::IndexedString& url, const KDevelop::ReferencedTopDUContext& topContext);
+    void projectOpened(KDevelop::IProject* project);
+    void projectOpeningAborted(KDevelop::IProject* project);
+    void parseJobFinished(KDevelop::ParseJob* job);
     void finish();
     void dump(const KDevelop::ReferencedTopDUContext& topContext);
 };
@@ -30,6 +30,7 @@
 #include <QUrl>
 
 #include <algorithm>
+#include <utility>
 
 namespace KDevelop {
 
@@ -356,6 +357,14 @@ public:
     Path cd(const QString& dir) const;
 
 private:
+    friend class InternedPath;
+
+    // used by InternedPath, which stores the segments in its prefix tree
+    explicit Path(QVector<QString> segments)
+        : m_data(std::move(segments))
+    {
+    }
+
     // for remote urls the first element contains the a Path prefix
     // containing the protocol, user, port etc. pp.
     QVector<QString> m_data;
@@ -169,6 +169,12 @@ void DVcsJob::setResults(const QVariant &res)
     d->results = res;
 }
 
+void DVcsJob::setPartialResults(const QVariant &res)
+{
+    setResults(res);
+    emit resultsReady(this);
+}
+
 QVariant DVcsJob::fetchResults()
 {
     Q_D(DVcsJob);
@@ -316,6 +322,8 @@ void DVcsJob::slotReceivedStdout()
     // accumulate output
     d->output.append(output);
 
+    emit outputReceived(this, output);
+
     displayOutput(QString::fromLocal8Bit(output));
 }
 
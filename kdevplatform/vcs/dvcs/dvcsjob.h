@@ -179,6 +179,14 @@ public:
      */
     virtual void setResults(const QVariant &res);
 
+    /**
+     * Sets the results parsed from the output received so far and emits resultsReady().
+     * Later calls of setResults() and setPartialResults() should only pass the results
+     * which were not reported yet.
+     * @see outputReceived()
+     */
+    void setPartialResults(const QVariant &res);
+
     /**
      * Returns execution results stored in QVariant.
      * Mostly used in vcscommitdialog.
@@ -211,6 +219,14 @@ public Q_SLOTS:
 Q_SIGNALS:
     void readyForParsing(KDevelop::DVcsJob *job);
 
+    /**
+     * Emitted for every part of the standard output received while the process runs,
+     * which allows to parse long output incrementally.
+     * @param output the newly received output, which is also appended to rawOutput()
+     * @see setPartialResults()
+     */
+    void outputReceived(KDevelop::DVcsJob *job, const QByteArray& output);
+
 protected Q_SLOTS:
     virtual void slotProcessError( QProcess::ProcessError );
 
@@ -73,15 +73,23 @@ public:
     {
         if( job == this->job )
         {
+            // jobs may report the lines in several parts, for big parts a single reset is cheaper
+            // than letting the annotation border update for each line
+            const int maximumChangedLines = 32;
+
             const auto results = job->fetchResults().toList();
+            const bool resetAll = results.size() > maximumChangedLines;
             for (const QVariant& v : results) {
                 if( v.canConvert<KDevelop::VcsAnnotationLine>() )
                 {
                     VcsAnnotationLine l = v.value<KDevelop::VcsAnnotationLine>();
                     m_annotation.insertLine( l.lineNumber(), l );
-                    emit q->lineChanged( l.lineNumber() );
+                    if( !resetAll )
+                        emit q->lineChanged( l.lineNumber() );
                 }
             }
+            if( resetAll )
+                emit q->reset();
         }
     }
 };
@@ -151,4 +151,45 @@ void TestVcsAnnotation::testAssignOperator()
     }
 }
 
+void TestVcsAnnotation::testSharedCommitData()
+{
+    VcsRevision revision;
+    revision.setRevisionValue("A", VcsRevision::GlobalNumber);
+    const QDateTime date = QDateTime::fromString("2001-01-01T00:00:00+00:00", Qt::ISODate);
+    const VcsAnnotationLine commit = createAnnotationLine(-1, QString(), QStringLiteral("Author A"), revision, date, QStringLiteral("Commit A"));
+
+    // lines copied from one line keep its commit data, changing it only affects the changed line
+    VcsAnnotationLine lineA = commit;
+    lineA.setLineNumber(0);
+    VcsAnnotationLine lineB = commit;
+    lineB.setLineNumber(5);
+    lineB.setAuthor(QStringLiteral("Author B"));
+
+    QCOMPARE(lineA.lineNumber(), 0);
+    QCOMPARE(lineA.author(), QStringLiteral("Author A"));
+    QCOMPARE(lineA.revision(), revision);
+    QCOMPARE(lineA.date(), date);
+    QCOMPARE(lineA.commitMessage(), QStringLiteral("Commit A"));
+    QCOMPARE(lineB.lineNumber(), 5);
+    QCOMPARE(lineB.author(), QStringLiteral("Author B"));
+    QCOMPARE(lineB.commitMessage(), QStringLiteral("Commit A"));
+    QCOMPARE(commit.lineNumber(), -1);
+    QCOMPARE(commit.author(), QStringLiteral("Author A"));
+
+    // lines can be inserted in any order
+    VcsAnnotation annotation;
+    annotation.insertLine(lineB.lineNumber(), lineB);
+    annotation.insertLine(lineA.lineNumber(), lineA);
+    annotation.insertLine(lineA.lineNumber(), lineA);
+    QCOMPARE(annotation.lineCount(), 2);
+    QVERIFY(annotation.containsLine(0));
+    QVERIFY(!annotation.containsLine(1));
+    QVERIFY(annotation.containsLine(5));
+    QVERIFY(!annotation.containsLine(6));
+    QVERIFY(!annotation.containsLine(-1));
+    QCOMPARE(annotation.line(5).author(), QStringLiteral("Author B"));
+    QCOMPARE(annotation.line(1).lineNumber(), -1);
+    QCOMPARE(annotation.line(1).author(), QString());
+}
+
 QTEST_GUILESS_MAIN(TestVcsAnnotation)
@@ -31,6 +31,7 @@ private Q_SLOTS:
     void initTestCase();
     void testCopyConstructor();
     void testAssignOperator();
+    void testSharedCommitData();
 };
 
 #endif // KDEVPLATFORM_TESTVCSANNOTATION_H
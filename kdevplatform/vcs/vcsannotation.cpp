@@ -21,9 +21,10 @@
 #include "vcsannotation.h"
 
 #include <QSharedData>
+#include <QBitArray>
 #include <QDateTime>
-#include <QHash>
 #include <QUrl>
+#include <QVector>
 
 #include "vcsrevision.h"
 
@@ -33,26 +34,53 @@ namespace KDevelop
 class VcsAnnotationPrivate : public QSharedData
 {
 public:
-    QHash<int, VcsAnnotationLine> lines;
+    // indexed by line number, with the lines which were not inserted cleared in containedLines
+    QVector<VcsAnnotationLine> lines;
+    QBitArray containedLines;
+    int lineCount = 0;
     QUrl location;
 };
 
-class VcsAnnotationLinePrivate : public QSharedData
+/**
+ * The data of the last change of a line
+ *
+ * Lines which are copies of each other share it as long as it is not modified,
+ * so it is stored once per revision when the lines of a revision are created from one line.
+ */
+class VcsAnnotationCommitData : public QSharedData
 {
 public:
     QString author;
     QDateTime date;
-    QString text;
-    QString line;
     VcsRevision revision;
     QString message;
-    int lineno;
 };
 
+class VcsAnnotationLinePrivate : public QSharedData
+{
+public:
+    VcsAnnotationLinePrivate()
+        : commit(new VcsAnnotationCommitData)
+    {
+    }
+
+    QSharedDataPointer<VcsAnnotationCommitData> commit;
+    QString text;
+    int lineno = -1;
+};
+
+namespace {
+// shared by all default constructed lines, so e.g. resizing a vector of lines doesn't allocate per line
+const QSharedDataPointer<VcsAnnotationLinePrivate>& emptyLine()
+{
+    static const QSharedDataPointer<VcsAnnotationLinePrivate> empty(new VcsAnnotationLinePrivate);
+    return empty;
+}
+}
+
 VcsAnnotationLine::VcsAnnotationLine()
-    : d( new VcsAnnotationLinePrivate )
+    : d(emptyLine())
 {
-    d->lineno = -1;
 }
 
 VcsAnnotationLine::VcsAnnotationLine( const VcsAnnotationLine& rhs )
@@ -74,17 +102,17 @@ QString VcsAnnotationLine::text() const
 
 QString VcsAnnotationLine::author() const
 {
-    return d->author;
+    return d->commit->author;
 }
 
 VcsRevision VcsAnnotationLine::revision() const
 {
-    return d->revision;
+    return d->commit->revision;
 }
 
 QDateTime VcsAnnotationLine::date() const
 {
-    return d->date;
+    return d->commit->date;
 }
 
 void VcsAnnotationLine::setLineNumber( int lineno )
@@ -99,17 +127,17 @@ void VcsAnnotationLine::setText( const QString& text )
 
 void VcsAnnotationLine::setAuthor( const QString& author )
 {
-    d->author = author;
+    d->commit->author = author;
 }
 
 void KDevelop::VcsAnnotationLine::setRevision( const KDevelop::VcsRevision& revision )
 {
-    d->revision = revision;
+    d->commit->revision = revision;
 }
 
 void VcsAnnotationLine::setDate( const QDateTime& date )
 {
-    d->date = date;
+    d->commit->date = date;
 }
 
 VcsAnnotationLine& VcsAnnotationLine::operator=( const VcsAnnotationLine& rhs)
@@ -120,13 +148,13 @@ VcsAnnotationLine& VcsAnnotationLine::operator=( const VcsAnnotationLine& rhs)
 
 QString VcsAnnotationLine::commitMessage() const
 {
-    return d->message;
+    return d->commit->message;
 }
 
 
 void VcsAnnotationLine::setCommitMessage ( const QString& msg )
 {
-    d->message = msg;
+    d->commit->message = msg;
 }
 
 VcsAnnotation::VcsAnnotation()
@@ -148,7 +176,7 @@ QUrl VcsAnnotation::location() const
 
 int VcsAnnotation::lineCount() const
 {
-    return d->lines.count();
+    return d->lineCount;
 }
 
 void VcsAnnotation::insertLine( int lineno, const VcsAnnotationLine& line )
@@ -157,7 +185,17 @@ void VcsAnnotation::insertLine( int lineno, const VcsAnnotationLine& line )
     {
         return;
     }
-    d->lines.insert( lineno, line );
+    if( lineno >= d->lines.size() )
+    {
+        d->lines.resize( lineno + 1 );
+        d->containedLines.resize( lineno + 1 );
+    }
+    d->lines[lineno] = line;
+    if( !d->containedLines.testBit( lineno ) )
+    {
+        d->containedLines.setBit( lineno );
+        ++d->lineCount;
+    }
 }
 
 void VcsAnnotation::setLocation(const QUrl& u)
@@ -167,7 +205,7 @@ void VcsAnnotation::setLocation(const QUrl& u)
 
 VcsAnnotationLine VcsAnnotation::line( int lineno ) const
 {
-    return d->lines[lineno];
+    return d->lines.value( lineno );
 }
 
 VcsAnnotation& VcsAnnotation::operator=( const VcsAnnotation& rhs)
@@ -178,7 +216,7 @@ VcsAnnotation& VcsAnnotation::operator=( const VcsAnnotation& rhs)
 
 bool VcsAnnotation::containsLine( int lineno ) const
 {
-    return d->lines.contains( lineno );
+    return lineno >= 0 && lineno < d->containedLines.size() && d->containedLines.testBit( lineno );
 }
 
 }
@@ -32,24 +32,103 @@
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/duchain.h>
 
+#include <QSet>
+#include <QThread>
+
 #include <clang-c/Index.h>
 
 using namespace KDevelop;
 
-ClangIndex::ClangIndex()
-    // NOTE: We don't exclude PCH declarations. That way we could retrieve imports manually, as clang_getInclusions returns nothing on reparse with CXTranslationUnit_PrecompiledPreamble flag.
-    : m_index(clang_createIndex(0 /*Exclude PCH Decls*/, qEnvironmentVariableIsSet("KDEV_CLANG_DISPLAY_DIAGS") /*Display diags*/))
+namespace {
+CXIndex createIndex()
 {
+    // NOTE: We don't exclude PCH declarations. That way we could retrieve imports manually, as clang_getInclusions returns nothing on reparse with CXTranslationUnit_PrecompiledPreamble flag.
+    CXIndex index = clang_createIndex(0 /*Exclude PCH Decls*/, qEnvironmentVariableIsSet("KDEV_CLANG_DISPLAY_DIAGS") /*Display diags*/);
     // demote the priority of the clang parse threads to reduce potential UI lockups
     // but the code completion threads still retain their normal priority to return
     // the results as quickly as possible
-    clang_CXIndex_setGlobalOptions(m_index, clang_CXIndex_getGlobalOptions(m_index)
+    clang_CXIndex_setGlobalOptions(index, clang_CXIndex_getGlobalOptions(index)
         | CXGlobalOpt_ThreadBackgroundPriorityForIndexing);
+    return index;
+}
+
+uint nextIndexId()
+{
+    static QAtomicInt lastId;
+    return lastId.fetchAndAddRelaxed(1) + 1;
+}
+
+/// The ids of the existing ClangIndex instances, to prune the thread local caches of destroyed ones
+struct LiveIndexIds
+{
+    QMutex mutex;
+    QSet<uint> ids;
+    /// Incremented whenever an instance is destroyed
+    QAtomicInt destroyedGeneration;
+};
+
+LiveIndexIds& liveIndexIds()
+{
+    static LiveIndexIds liveIds;
+    return liveIds;
+}
+
+/// Removes the entries of destroyed instances from the thread local @p cache, if any was destroyed since the last call
+template<typename Cache>
+void pruneDestroyedIndices(Cache& cache, int& prunedGeneration)
+{
+    auto& liveIds = liveIndexIds();
+    const int generation = liveIds.destroyedGeneration.loadAcquire();
+    if (generation == prunedGeneration) {
+        return;
+    }
+    prunedGeneration = generation;
+
+    QMutexLocker lock(&liveIds.mutex);
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (liveIds.ids.contains(it.key())) {
+            ++it;
+        } else {
+            it = cache.erase(it);
+        }
+    }
+}
+
+struct MappingCache
+{
+    int generation = -1;
+    // an empty value means no TU is pinned for the url
+    QHash<IndexedString, IndexedString> tuForUrl;
+};
+}
+
+ClangIndex::ClangIndex()
+    : m_id(nextIndexId())
+    , m_indexPool(qMax(1, QThread::idealThreadCount()), nullptr)
+{
+    auto& liveIds = liveIndexIds();
+    QMutexLocker lock(&liveIds.mutex);
+    liveIds.ids.insert(m_id);
 }
 
 CXIndex ClangIndex::index() const
 {
-    return m_index;
+    // keyed by m_id instead of this, as another instance may be created at the same address later on
+    thread_local QHash<uint, CXIndex> threadIndices;
+    thread_local int prunedGeneration = 0;
+    pruneDestroyedIndices(threadIndices, prunedGeneration);
+
+    CXIndex& index = threadIndices[m_id];
+    if (!index) {
+        QMutexLocker lock(&m_indexPoolMutex);
+        CXIndex& pooled = m_indexPool[m_nextPoolIndex];
+        m_nextPoolIndex = (m_nextPoolIndex + 1) % m_indexPool.size();
+        if (!pooled) {
+            pooled = createIndex();
+        }
+        index = pooled;
+    }
+    return index;
 }
 
 QSharedPointer<const ClangPCH> ClangIndex::pch(const ClangParsingEnvironment& environment)
@@ -77,21 +156,31 @@ QSharedPointer<const ClangPCH> ClangIndex::pch(const ClangParsingEnvironment& en
 
 ClangIndex::~ClangIndex()
 {
-    clang_disposeIndex(m_index);
+    {
+        auto& liveIds = liveIndexIds();
+        QMutexLocker lock(&liveIds.mutex);
+        liveIds.ids.remove(m_id);
+        liveIds.destroyedGeneration.ref();
+    }
+
+    for (CXIndex index : qAsConst(m_indexPool)) {
+        if (index) {
+            clang_disposeIndex(index);
+        }
+    }
 }
 
 IndexedString ClangIndex::translationUnitForUrl(const IndexedString& url)
 {
     { // try explicit pin data first
-        QMutexLocker lock(&m_mappingMutex);
-        auto tu = m_tuForUrl.find(url);
-        if (tu != m_tuForUrl.end()) {
-            if (!QFile::exists(tu.value().str())) {
+        const auto tu = pinnedTranslationUnit(url);
+        if (!tu.isEmpty()) {
+            if (!QFile::exists(tu.str())) {
                 // TU doesn't exist, unpin
-                m_tuForUrl.erase(tu);
+                unpinStaleTranslationUnit(tu, url);
                 return url;
             }
-            return tu.value();
+            return tu;
         }
     }
     // if no explicit pin data is available, follow back the duchain import chain
@@ -135,14 +224,68 @@ IndexedString ClangIndex::translationUnitForUrl(const IndexedString& url)
     return url;
 }
 
+IndexedString ClangIndex::pinnedTranslationUnit(const IndexedString& url) const
+{
+    thread_local QHash<uint, MappingCache> threadCaches;
+    thread_local int prunedGeneration = 0;
+    pruneDestroyedIndices(threadCaches, prunedGeneration);
+
+    auto& cache = threadCaches[m_id];
+    // load the generation before looking into m_tuForUrl: if the mapping changes in between,
+    // the result is cached for an outdated generation and thus dropped on the next call
+    const int generation = m_mappingGeneration.loadAcquire();
+    if (cache.generation != generation) {
+        cache.tuForUrl.clear();
+        cache.generation = generation;
+    }
+
+    const auto cached = cache.tuForUrl.constFind(url);
+    if (cached != cache.tuForUrl.constEnd()) {
+        return cached.value();
+    }
+
+    IndexedString tu;
+    {
+        QReadLocker lock(&m_mappingLock);
+        tu = m_tuForUrl.value(url);
+    }
+    cache.tuForUrl.insert(url, tu);
+    return tu;
+}
+
 void ClangIndex::pinTranslationUnitForUrl(const IndexedString& tu, const IndexedString& url)
 {
-    QMutexLocker lock(&m_mappingMutex);
-    m_tuForUrl.insert(url, tu);
+    // the same TU is pinned again whenever it is reparsed, only synchronize with the other threads on changes
+    if (pinnedTranslationUnit(url) == tu) {
+        return;
+    }
+
+    QWriteLocker lock(&m_mappingLock);
+    auto& pinned = m_tuForUrl[url];
+    if (pinned != tu) {
+        pinned = tu;
+        m_mappingGeneration.ref();
+    }
 }
 
 void ClangIndex::unpinTranslationUnitForUrl(const IndexedString& url)
 {
-    QMutexLocker lock(&m_mappingMutex);
-    m_tuForUrl.remove(url);
+    if (pinnedTranslationUnit(url).isEmpty()) {
+        return;
+    }
+
+    QWriteLocker lock(&m_mappingLock);
+    if (m_tuForUrl.remove(url)) {
+        m_mappingGeneration.ref();
+    }
+}
+
+void ClangIndex::unpinStaleTranslationUnit(const IndexedString& tu, const IndexedString& url)
+{
+    QWriteLocker lock(&m_mappingLock);
+    auto it = m_tuForUrl.find(url);
+    if (it != m_tuForUrl.end() && it.value() == tu) {
+        m_tuForUrl.erase(it);
+        m_mappingGeneration.ref();
+    }
 }
@@ -29,8 +29,11 @@
 
 #include <util/path.h>
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QSharedPointer>
+#include <QVector>
 
 #include <clang-c/Index.h>
 
@@ -43,6 +46,15 @@ public:
     ClangIndex();
     ~ClangIndex();
 
+    /**
+     * @returns the CXIndex to use for parsing in the calling thread
+     *
+     * The indices are taken from a pool of up to QThread::idealThreadCount() instances,
+     * each thread keeps the index it got on its first call. This way, parse jobs running
+     * in different threads mostly don't share an index, while all translation units of one
+     * thread still belong to the same index.
+     * This function is thread safe.
+     */
     CXIndex index() const;
 
     /**
@@ -57,11 +69,17 @@ public:
      * Gets the currently pinned TU for @p url
      *
      * If the currently pinned TU does not import @p url, @p url is returned
+     *
+     * The pinned TUs are cached per thread, so this only synchronizes with other
+     * threads after the mapping was changed by pinTranslationUnitForUrl() or
+     * unpinTranslationUnitForUrl().
      */
     KDevelop::IndexedString translationUnitForUrl(const KDevelop::IndexedString& url);
 
     /**
      * Pin @p tu as the translation unit to use when parsing @p url
+     *
+     * Does nothing if @p tu already is pinned for @p url.
      */
     void pinTranslationUnitForUrl(const KDevelop::IndexedString& tu, const KDevelop::IndexedString& url);
 
@@ -71,13 +89,26 @@ public:
     void unpinTranslationUnitForUrl(const KDevelop::IndexedString& url);
 
 private:
-    CXIndex m_index;
+    /// @returns the pinned TU for @p url, or an empty string if there is none
+    KDevelop::IndexedString pinnedTranslationUnit(const KDevelop::IndexedString& url) const;
+    /// Unpins @p tu for @p url, unless another thread changed the pinned TU meanwhile
+    void unpinStaleTranslationUnit(const KDevelop::IndexedString& tu, const KDevelop::IndexedString& url);
+
+    /// Identifies this instance in the thread local caches, never reused. The cache entries
+    /// of destroyed instances are pruned on the next access from the same thread.
+    const uint m_id;
+
+    mutable QMutex m_indexPoolMutex;
+    mutable QVector<CXIndex> m_indexPool;
+    mutable int m_nextPoolIndex = 0;
 
     QReadWriteLock m_pchLock;
     QHash<KDevelop::Path, QSharedPointer<const ClangPCH>> m_pch;
 
-    QMutex m_mappingMutex;
+    mutable QReadWriteLock m_mappingLock;
     QHash<KDevelop::IndexedString, KDevelop::IndexedString> m_tuForUrl;
+    /// Incremented on every change of m_tuForUrl, invalidates the thread local caches
+    QAtomicInt m_mappingGeneration;
 };
 
 #endif //CLANGINDEX_H
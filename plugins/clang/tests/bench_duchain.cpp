@@ -26,11 +26,53 @@
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
 #include <tests/testfile.h>
+#include <interfaces/ilanguagecontroller.h>
+#include <language/backgroundparser/backgroundparser.h>
 #include <language/duchain/duchainlock.h>
 #include <language/duchain/duchain.h>
 
+#include <memory>
+#include <vector>
+
 using namespace KDevelop;
 
+namespace {
+const char* const stdIncludes =
+    "#include <vector>\n"
+    "#include <map>\n"
+    "#include <set>\n"
+    "#include <algorithm>\n"
+    "#include <functional>\n"
+    "#include <limits>\n"
+    "#include <bitset>\n"
+    "#include <iostream>\n"
+    "#include <string>\n"
+    "#include <mutex>\n";
+
+/// Sets the thread count of the background parser, restores the previous one on destruction
+class ThreadCountGuard
+{
+public:
+    ThreadCountGuard(BackgroundParser* backgroundParser, int threads)
+        : m_backgroundParser(backgroundParser)
+        , m_oldThreadCount(backgroundParser->threadCount())
+    {
+        m_backgroundParser->setThreadCount(threads);
+    }
+
+    ~ThreadCountGuard()
+    {
+        m_backgroundParser->setThreadCount(m_oldThreadCount);
+    }
+
+private:
+    Q_DISABLE_COPY(ThreadCountGuard)
+
+    BackgroundParser* const m_backgroundParser;
+    const int m_oldThreadCount;
+};
+}
+
 BenchDUChain::BenchDUChain()
 {
 }
@@ -56,17 +98,7 @@ void BenchDUChain::cleanupTestCase()
 void BenchDUChain::benchDUChainBuilder()
 {
     QBENCHMARK_ONCE {
-        TestFile file(
-            "#include <vector>\n"
-            "#include <map>\n"
-            "#include <set>\n"
-            "#include <algorithm>\n"
-            "#include <functional>\n"
-            "#include <limits>\n"
-            "#include <bitset>\n"
-            "#include <iostream>\n"
-            "#include <string>\n"
-            "#include <mutex>\n", QStringLiteral("cpp"));
+        TestFile file(QString::fromLatin1(stdIncludes), QStringLiteral("cpp"));
         file.parse(TopDUContext::AllDeclarationsContextsAndUses);
         QVERIFY(file.waitForParsed(60000));
 
@@ -76,4 +108,41 @@ void BenchDUChain::benchDUChainBuilder()
     }
 }
 
+void BenchDUChain::benchDUChainBuilderParallel_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+    QTest::newRow("8") << 8;
+}
+
+void BenchDUChain::benchDUChainBuilderParallel()
+{
+    QFETCH(int, threads);
+
+    // also restores the thread count when a check fails
+    const ThreadCountGuard threadCountGuard(ICore::self()->languageController()->backgroundParser(), threads);
+
+    // the same amount of work per thread, so the time stays constant with perfect scaling
+    const int filesPerThread = 2;
+    QBENCHMARK_ONCE {
+        std::vector<std::unique_ptr<TestFile>> files;
+        for (int i = 0; i < threads * filesPerThread; ++i) {
+            files.emplace_back(new TestFile(QString::fromLatin1(stdIncludes)
+                                            + QStringLiteral("int foo%1();\n").arg(i), QStringLiteral("cpp")));
+            files.back()->parse(TopDUContext::AllDeclarationsContextsAndUses);
+        }
+        for (const auto& file : files) {
+            QVERIFY(file->waitForParsed(60000));
+        }
+
+        DUChainReadLocker lock;
+        for (const auto& file : files) {
+            QVERIFY(file->topContext());
+        }
+    }
+}
+
 QTEST_MAIN(BenchDUChain)
@@ -36,6 +36,8 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void benchDUChainBuilder();
+    void benchDUChainBuilderParallel_data();
+    void benchDUChainBuilderParallel();
 
 private:
 };
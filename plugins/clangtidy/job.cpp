@@ -30,7 +30,9 @@
 #include <KLocalizedString>
 // Qt
 #include <QApplication>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QRegularExpression>
 
 namespace ClangTidy
@@ -99,6 +101,29 @@ Job::~Job()
 {
 }
 
+QStringList Job::configFiles(const QString& source) const
+{
+    if (!m_parameters.useConfigFile) {
+        return {};
+    }
+
+    const auto directory = QFileInfo(source).absolutePath();
+    auto it = m_configFilesForDirectory.find(directory);
+    if (it == m_configFilesForDirectory.end()) {
+        // clang-tidy reads the closest .clang-tidy file, which may inherit the ones of parent directories
+        QStringList configFiles;
+        QDir dir(directory);
+        do {
+            const auto configFile = dir.filePath(QStringLiteral(".clang-tidy"));
+            if (QFile::exists(configFile)) {
+                configFiles << configFile;
+            }
+        } while (dir.cdUp());
+        it = m_configFilesForDirectory.insert(directory, configFiles);
+    }
+    return *it;
+}
+
 void Job::processStdoutLines(const QStringList& lines)
 {
     m_parser.addData(lines);
@@ -64,6 +64,9 @@ public:
 public: // KJob API
     void start() override;
 
+public: // CompileAnalyzeJob API
+    QStringList configFiles(const QString& source) const override;
+
 protected Q_SLOTS:
     void postProcessStdout(const QStringList& lines) override;
     void postProcessStderr(const QStringList& lines) override;
@@ -77,6 +80,8 @@ protected:
 
 protected:
     ClangTidyParser m_parser;
+    // the .clang-tidy files which apply to the files of a directory
+    mutable QHash<QString, QStringList> m_configFilesForDirectory;
     QStringList m_standardOutput;
     QStringList m_xmlOutput;
     const Job::Parameters m_parameters;
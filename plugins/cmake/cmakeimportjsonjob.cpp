@@ -34,22 +34,165 @@
 #include <interfaces/iruntimecontroller.h>
 
 #include <KShell>
+#include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 #include <QFutureWatcher>
 #include <QRegularExpression>
+#include <QSet>
 
 using namespace KDevelop;
 
+namespace CMake {
+
+bool splitCommandsFileEntries(const QByteArray& contents, QVector<CommandsFileEntry>& entries)
+{
+    const char* data = contents.constData();
+    const int size = contents.size();
+    int pos = 0;
+
+    auto skipWhitespace = [&]() {
+        while (pos < size && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t')) {
+            ++pos;
+        }
+    };
+
+    skipWhitespace();
+    if (pos == size || data[pos] != '[') {
+        return false;
+    }
+    ++pos;
+
+    while (true) {
+        skipWhitespace();
+        if (pos == size) {
+            return false;
+        } else if (data[pos] == ']') {
+            return true;
+        } else if (data[pos] == ',') {
+            ++pos;
+            continue;
+        } else if (data[pos] != '{') {
+            return false;
+        }
+
+        const int begin = pos;
+        int depth = 0;
+        bool inString = false;
+        for (; pos < size; ++pos) {
+            const char c = data[pos];
+            if (inString) {
+                if (c == '\\') {
+                    ++pos;
+                } else if (c == '"') {
+                    inString = false;
+                }
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                break;
+            }
+        }
+        if (pos >= size) {
+            return false;
+        }
+        ++pos;
+        entries.append({begin, pos - begin});
+    }
+}
+
+QString commandFlags(const QString& command, const QString& file)
+{
+    QString flags = command;
+
+    const QLatin1String outputArgument(" -o ");
+    int index = flags.indexOf(outputArgument);
+    if (index != -1) {
+        const int end = flags.indexOf(QLatin1Char(' '), index + outputArgument.size());
+        flags.remove(index, (end == -1 ? flags.size() : end) - index);
+    }
+
+    const QString sourceArgument = QLatin1Char(' ') + file;
+    index = flags.lastIndexOf(sourceArgument);
+    const int end = index + sourceArgument.size();
+    if (index != -1 && (end == flags.size() || flags.at(end) == QLatin1Char(' '))) {
+        flags.remove(index, sourceArgument.size());
+    }
+
+    return flags;
+}
+
+}
+
 namespace {
 
+using CMake::CommandsFileEntry;
+
+/// Result of importing a consecutive range of entries of a commands file
+struct CommandsFileChunk
+{
+    QVector<CommandsFileEntry> entries;
+    bool isValid = true;
+    /// the files in the order of the entries, together with the key of their flags
+    QVector<QPair<Path, QString>> files;
+    QHash<QString, CMakeFile> fileDataForFlags;
+};
+
+void importCommandsChunk(const QByteArray& contents, IRuntime* rt, CommandsFileChunk& chunk)
+{
+    // the resolver caches paths and strings internally, so every chunk needs its own one
+    MakeFileResolver resolver;
+    const QString KEY_COMMAND = QStringLiteral("command");
+    const QString KEY_DIRECTORY = QStringLiteral("directory");
+    const QString KEY_FILE = QStringLiteral("file");
+    auto convert = [rt](const Path &path) { return rt->pathInHost(path); };
+
+    chunk.files.reserve(chunk.entries.size());
+    for (const auto& entryRange : qAsConst(chunk.entries)) {
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(contents.mid(entryRange.begin, entryRange.length), &error);
+        if (error.error) {
+            qCWarning(CMAKE) << "Failed to parse JSON in commands file:" << error.errorString();
+            chunk.isValid = false;
+            return;
+        }
+
+        const QJsonObject entry = document.object();
+        if (!entry.contains(KEY_FILE) || !entry.contains(KEY_COMMAND) || !entry.contains(KEY_DIRECTORY)) {
+            qCWarning(CMAKE) << "JSON command file entry does not contain required keys:" << entry;
+            continue;
+        }
+
+        const QString file = entry[KEY_FILE].toString();
+        const QString directory = entry[KEY_DIRECTORY].toString();
+        const QString command = entry[KEY_COMMAND].toString();
+        // relative include paths are resolved against the directory, so it is part of the key
+        const QString flagsKey = directory + QLatin1Char('\n') + CMake::commandFlags(command, file);
+
+        if (!chunk.fileDataForFlags.contains(flagsKey)) {
+            PathResolutionResult result = resolver.processOutput(command, directory);
+
+            CMakeFile ret;
+            ret.includes = kTransform<Path::List>(result.paths, convert);
+            ret.frameworkDirectories = kTransform<Path::List>(result.frameworkDirectories, convert);
+            ret.defines = result.defines;
+            chunk.fileDataForFlags.insert(flagsKey, ret);
+        }
+
+        chunk.files.append({rt->pathInHost(Path(file)), flagsKey});
+    }
+}
+
 CMakeFilesCompilationData importCommands(const Path& commandsFile)
 {
     // NOTE: to get compile_commands.json, you need -DCMAKE_EXPORT_COMPILE_COMMANDS=ON
     QFile f(commandsFile.toLocalFile());
-    bool r = f.open(QFile::ReadOnly|QFile::Text);
+    bool r = f.open(QFile::ReadOnly);
     if(!r) {
         qCWarning(CMAKE) << "Couldn't open commands file" << commandsFile;
         return {};
@@ -57,49 +200,75 @@ CMakeFilesCompilationData importCommands(const Path& commandsFile)
 
     qCDebug(CMAKE) << "Found commands file" << commandsFile;
 
+    // map the file instead of reading it, the entries are parsed one by one anyway
+    QByteArray contents;
+    const uchar* mapped = f.size() > 0 ? f.map(0, f.size()) : nullptr;
+    if (mapped) {
+        contents = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), f.size());
+    } else {
+        contents = f.readAll();
+    }
+
     CMakeFilesCompilationData data;
-    QJsonParseError error;
-    const QJsonDocument document = QJsonDocument::fromJson(f.readAll(), &error);
-    if (error.error) {
-        qCWarning(CMAKE) << "Failed to parse JSON in commands file:" << error.errorString() << commandsFile;
-        data.isValid = false;
-        return data;
-    } else if (!document.isArray()) {
-        qCWarning(CMAKE) << "JSON document in commands file is not an array: " << commandsFile;
+    QVector<CommandsFileEntry> entries;
+    if (!CMake::splitCommandsFileEntries(contents, entries)) {
+        qCWarning(CMAKE) << "JSON document in commands file is not an array of objects: " << commandsFile;
         data.isValid = false;
         return data;
     }
 
-    MakeFileResolver resolver;
-    const QString KEY_COMMAND = QStringLiteral("command");
-    const QString KEY_DIRECTORY = QStringLiteral("directory");
-    const QString KEY_FILE = QStringLiteral("file");
+    const int entriesPerChunk = 512;
+    QVector<CommandsFileChunk> chunks;
+    chunks.reserve(entries.size() / entriesPerChunk + 1);
+    for (int i = 0; i < entries.size(); i += entriesPerChunk) {
+        CommandsFileChunk chunk;
+        chunk.entries = entries.mid(i, entriesPerChunk);
+        chunks.append(chunk);
+    }
+
     auto rt = ICore::self()->runtimeController()->currentRuntime();
-    const auto values = document.array();
-    for (const QJsonValue& value : values) {
-        if (!value.isObject()) {
-            qCWarning(CMAKE) << "JSON command file entry is not an object:" << value;
-            continue;
-        }
-        const QJsonObject entry = value.toObject();
-        if (!entry.contains(KEY_FILE) || !entry.contains(KEY_COMMAND) || !entry.contains(KEY_DIRECTORY)) {
-            qCWarning(CMAKE) << "JSON command file entry does not contain required keys:" << entry;
-            continue;
+    QtConcurrent::blockingMap(chunks, [&contents, rt](CommandsFileChunk& chunk) {
+        importCommandsChunk(contents, rt, chunk);
+    });
+
+    // Share the data between all files with the same flags, and the path lists between
+    // all distinct flags resolving to the same paths. Later entries win, like before.
+    QHash<QString, CMakeFile> fileDataForFlags;
+    QSet<Path::List> pathLists;
+    auto internPaths = [&pathLists](const Path::List& paths) {
+        const auto it = pathLists.constFind(paths);
+        if (it != pathLists.constEnd()) {
+            return *it;
         }
+        pathLists.insert(paths);
+        return paths;
+    };
 
-        PathResolutionResult result = resolver.processOutput(entry[KEY_COMMAND].toString(), entry[KEY_DIRECTORY].toString());
+    data.files.reserve(entries.size());
+    for (const auto& chunk : qAsConst(chunks)) {
+        if (!chunk.isValid) {
+            qCWarning(CMAKE) << "Failed to parse JSON in commands file:" << commandsFile;
+            data.files.clear();
+            data.isValid = false;
+            return data;
+        }
 
-        auto convert = [rt](const Path &path) { return rt->pathInHost(path); };
+        for (auto it = chunk.fileDataForFlags.constBegin(), end = chunk.fileDataForFlags.constEnd(); it != end; ++it) {
+            if (!fileDataForFlags.contains(it.key())) {
+                CMakeFile fileData = it.value();
+                fileData.includes = internPaths(fileData.includes);
+                fileData.frameworkDirectories = internPaths(fileData.frameworkDirectories);
+                fileDataForFlags.insert(it.key(), fileData);
+            }
+        }
 
-        CMakeFile ret;
-        ret.includes = kTransform<Path::List>(result.paths, convert);
-        ret.frameworkDirectories = kTransform<Path::List>(result.frameworkDirectories, convert);
-        ret.defines = result.defines;
-        const Path path(rt->pathInHost(Path(entry[KEY_FILE].toString())));
-        qCDebug(CMAKE) << "entering..." << path << entry[KEY_FILE];
-        data.files[path] = ret;
+        for (const auto& file : chunk.files) {
+            data.files[file.first] = fileDataForFlags.value(file.second);
+        }
     }
 
+    qCDebug(CMAKE) << "Imported" << data.files.size() << "files with" << fileDataForFlags.size() << "distinct sets of flags";
+
     data.isValid = true;
     data.rebuildFileForFolderMapping();
     return data;
@@ -27,6 +27,7 @@
 #include <KJob>
 
 #include <QFutureWatcher>
+#include <QVector>
 
 class CMakeFolderItem;
 
@@ -42,6 +43,35 @@ class IProject;
 class ReferencedTopDUContext;
 }
 
+namespace CMake
+{
+/// Byte range of one entry of the top-level array in a commands file
+struct CommandsFileEntry
+{
+    int begin;
+    int length;
+};
+
+/**
+ * Splits the top-level array of a commands file into the byte ranges of its entries.
+ *
+ * This allows parsing the entries independently and in parallel, instead of building
+ * one QJsonDocument for the whole file, which for big projects costs hundreds of MB.
+ * The entries themselves are validated when they are parsed.
+ *
+ * @return false if @p contents is not an array of objects
+ */
+bool splitCommandsFileEntries(const QByteArray& contents, QVector<CommandsFileEntry>& entries);
+
+/**
+ * @return the part of @p command that determines the include paths and defines of a file
+ *
+ * Build systems usually pass the same flags for all files of a target, only the source
+ * and the output file differ. Stripping those lets us process each distinct set of flags once.
+ */
+QString commandFlags(const QString& command, const QString& file);
+}
+
 class CMakeImportJsonJob : public KJob
 {
     Q_OBJECT
@@ -0,0 +1,124 @@
+/* This file is part of KDevelop
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include <QTest>
+#include <QObject>
+
+#include <cmakeimportjsonjob.h>
+
+class TestCMakeImportJson : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSplitCommandsFileEntries_data()
+    {
+        QTest::addColumn<QByteArray>("contents");
+        QTest::addColumn<bool>("valid");
+        QTest::addColumn<QList<QByteArray>>("expectedEntries");
+
+        QTest::newRow("empty-array") << QByteArray("[]") << true << QList<QByteArray>{};
+        QTest::newRow("whitespace") << QByteArray(" \n[\r\n\t]\n") << true << QList<QByteArray>{};
+        QTest::newRow("entries")
+            << QByteArray("[\n  {\"file\": \"a.cpp\"},\n  {\"file\": \"b.cpp\"}\n]")
+            << true << QList<QByteArray>{"{\"file\": \"a.cpp\"}", "{\"file\": \"b.cpp\"}"};
+        QTest::newRow("nested")
+            << QByteArray("[{\"arguments\": [\"c++\", {\"x\": []}], \"file\": \"a.cpp\"}]")
+            << true << QList<QByteArray>{"{\"arguments\": [\"c++\", {\"x\": []}], \"file\": \"a.cpp\"}"};
+        QTest::newRow("brackets-in-strings")
+            << QByteArray("[{\"command\": \"c++ -DFOO=\\\"}]\\\" a.cpp\"}, {\"file\": \"{[\"}]")
+            << true << QList<QByteArray>{"{\"command\": \"c++ -DFOO=\\\"}]\\\" a.cpp\"}", "{\"file\": \"{[\"}"};
+
+        QTest::newRow("no-array") << QByteArray("{\"file\": \"a.cpp\"}") << false << QList<QByteArray>{};
+        QTest::newRow("no-contents") << QByteArray() << false << QList<QByteArray>{};
+        QTest::newRow("no-objects") << QByteArray("[1, 2]") << false << QList<QByteArray>{};
+        QTest::newRow("unterminated-array") << QByteArray("[{\"file\": \"a.cpp\"}") << false << QList<QByteArray>{};
+        QTest::newRow("unterminated-object") << QByteArray("[{\"file\": \"a.cpp\"") << false << QList<QByteArray>{};
+        QTest::newRow("unterminated-string") << QByteArray("[{\"file\": \"a.cpp}]") << false << QList<QByteArray>{};
+    }
+
+    void testSplitCommandsFileEntries()
+    {
+        QFETCH(QByteArray, contents);
+        QFETCH(bool, valid);
+        QFETCH(QList<QByteArray>, expectedEntries);
+
+        QVector<CMake::CommandsFileEntry> entries;
+        QCOMPARE(CMake::splitCommandsFileEntries(contents, entries), valid);
+        if (!valid) {
+            return;
+        }
+
+        QList<QByteArray> actualEntries;
+        for (const auto& entry : qAsConst(entries)) {
+            actualEntries << contents.mid(entry.begin, entry.length);
+        }
+        QCOMPARE(actualEntries, expectedEntries);
+    }
+
+    void testCommandFlags_data()
+    {
+        QTest::addColumn<QString>("command");
+        QTest::addColumn<QString>("file");
+        QTest::addColumn<QString>("expectedFlags");
+
+        QTest::newRow("source-last")
+            << QStringLiteral("/usr/bin/c++ -DFOO -I/inc -o CMakeFiles/foo.dir/a.cpp.o -c /src/a.cpp")
+            << QStringLiteral("/src/a.cpp")
+            << QStringLiteral("/usr/bin/c++ -DFOO -I/inc -c");
+        QTest::newRow("output-last")
+            << QStringLiteral("/usr/bin/c++ -DFOO -c /src/a.cpp -o a.o")
+            << QStringLiteral("/src/a.cpp")
+            << QStringLiteral("/usr/bin/c++ -DFOO -c");
+        QTest::newRow("no-output")
+            << QStringLiteral("/usr/bin/c++ -DFOO -c /src/a.cpp")
+            << QStringLiteral("/src/a.cpp")
+            << QStringLiteral("/usr/bin/c++ -DFOO -c");
+        QTest::newRow("source-is-prefix")
+            << QStringLiteral("/usr/bin/c++ -c /src/a.cpp.in")
+            << QStringLiteral("/src/a.cpp")
+            << QStringLiteral("/usr/bin/c++ -c /src/a.cpp.in");
+        QTest::newRow("source-not-found")
+            << QStringLiteral("/usr/bin/c++ -c a.cpp")
+            << QStringLiteral("/src/a.cpp")
+            << QStringLiteral("/usr/bin/c++ -c a.cpp");
+    }
+
+    void testCommandFlags()
+    {
+        QFETCH(QString, command);
+        QFETCH(QString, file);
+        QFETCH(QString, expectedFlags);
+
+        QCOMPARE(CMake::commandFlags(command, file), expectedFlags);
+    }
+
+    void testCommandFlagsShared()
+    {
+        // files of the same target only differ in their source and output files
+        const auto flagsA = CMake::commandFlags(QStringLiteral("c++ -I/inc -o a.cpp.o -c /src/a.cpp"), QStringLiteral("/src/a.cpp"));
+        const auto flagsB = CMake::commandFlags(QStringLiteral("c++ -I/inc -o b.cpp.o -c /src/b.cpp"), QStringLiteral("/src/b.cpp"));
+        QCOMPARE(flagsA, flagsB);
+
+        const auto flagsC = CMake::commandFlags(QStringLiteral("c++ -I/other -o c.cpp.o -c /src/c.cpp"), QStringLiteral("/src/c.cpp"));
+        QVERIFY(flagsA != flagsC);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestCMakeImportJson)
+#include "test_cmakeimportjson.moc"
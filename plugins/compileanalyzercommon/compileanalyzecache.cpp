@@ -0,0 +1,406 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "compileanalyzecache.h"
+
+// lib
+#include "compileanalyzeutils.h"
+#include <debug.h>
+// KDevPlatform
+#include <interfaces/iproject.h>
+#include <language/editor/documentrange.h>
+#include <shell/problem.h>
+// Qt
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace
+{
+
+// bump whenever the format of the stored data changes
+const quint32 cacheFormatVersion = 2;
+
+void writeProblem(QDataStream& stream, const KDevelop::IProblem::Ptr& problem)
+{
+    const auto location = problem->finalLocation();
+    stream << static_cast<qint32>(problem->source())
+           << problem->sourceString()
+           << static_cast<qint32>(problem->severity())
+           << static_cast<qint32>(problem->finalLocationMode())
+           << location.document.str()
+           << location.start().line() << location.start().column()
+           << location.end().line() << location.end().column()
+           << problem->description()
+           << problem->explanation();
+
+    const auto diagnostics = problem->diagnostics();
+    stream << static_cast<qint32>(diagnostics.size());
+    for (const auto& diagnostic : diagnostics) {
+        writeProblem(stream, diagnostic);
+    }
+}
+
+KDevelop::IProblem::Ptr readProblem(QDataStream& stream)
+{
+    qint32 source, severity, finalLocationMode;
+    QString sourceString, document, description, explanation;
+    int startLine, startColumn, endLine, endColumn;
+
+    stream >> source
+           >> sourceString
+           >> severity
+           >> finalLocationMode
+           >> document
+           >> startLine >> startColumn
+           >> endLine >> endColumn
+           >> description
+           >> explanation;
+
+    KDevelop::IProblem::Ptr problem(new KDevelop::DetectedProblem(sourceString));
+    problem->setSource(static_cast<KDevelop::IProblem::Source>(source));
+    problem->setSeverity(static_cast<KDevelop::IProblem::Severity>(severity));
+    problem->setFinalLocationMode(static_cast<KDevelop::IProblem::FinalLocationMode>(finalLocationMode));
+    problem->setFinalLocation(KDevelop::DocumentRange(KDevelop::IndexedString(document),
+                                                      KTextEditor::Range(startLine, startColumn, endLine, endColumn)));
+    problem->setDescription(description);
+    problem->setExplanation(explanation);
+
+    qint32 diagnosticsCount;
+    stream >> diagnosticsCount;
+    for (qint32 i = 0; i < diagnosticsCount && stream.status() == QDataStream::Ok; ++i) {
+        problem->addDiagnostic(readProblem(stream));
+    }
+
+    return problem;
+}
+
+}
+
+namespace KDevelop
+{
+
+CompileAnalyzeCache::CompileAnalyzeCache(const QString& filePath)
+    : m_filePath(filePath)
+{
+}
+
+CompileAnalyzeCache::~CompileAnalyzeCache() = default;
+
+QString CompileAnalyzeCache::filePathForProject(const QString& directory, const IProject* project)
+{
+    const auto projectHash = QCryptographicHash::hash(project->path().pathOrUrl().toUtf8(), QCryptographicHash::Md5);
+    return directory + QLatin1Char('/') + QString::fromLatin1(projectHash.toHex()) + QLatin1String(".analyzercache");
+}
+
+QString CompileAnalyzeCache::filePath() const
+{
+    return m_filePath;
+}
+
+bool CompileAnalyzeCache::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+bool CompileAnalyzeCache::load()
+{
+    m_entries.clear();
+    m_fileHashes.clear();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 version = 0;
+    stream >> version;
+    if (stream.status() != QDataStream::Ok || version != cacheFormatVersion) {
+        qCDebug(KDEV_COMPILEANALYZER) << "Discarding analyzer cache of unsupported version" << version << m_filePath;
+        return false;
+    }
+
+    qint32 fileHashCount;
+    stream >> fileHashCount;
+    for (qint32 i = 0; i < fileHashCount && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        FileHash hashEntry;
+        stream >> path >> hashEntry.size >> hashEntry.lastModified >> hashEntry.hash;
+        m_fileHashes.insert(path, hashEntry);
+    }
+
+    qint32 entryCount;
+    stream >> entryCount;
+    for (qint32 i = 0; i < entryCount && stream.status() == QDataStream::Ok; ++i) {
+        QString source;
+        Entry entry;
+        qint32 problemCount;
+        stream >> source >> entry.inputHash >> entry.inputFiles >> problemCount;
+        entry.problems.reserve(problemCount);
+        for (qint32 j = 0; j < problemCount && stream.status() == QDataStream::Ok; ++j) {
+            entry.problems.append(readProblem(stream));
+        }
+        m_entries.insert(source, entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KDEV_COMPILEANALYZER) << "Discarding corrupted analyzer cache" << m_filePath;
+        m_entries.clear();
+        m_fileHashes.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool CompileAnalyzeCache::save() const
+{
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDEV_COMPILEANALYZER) << "Could not write analyzer cache" << m_filePath << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << cacheFormatVersion;
+
+    // only keep the content hashes of files which are still an input of some entry
+    QSet<QString> inputFiles;
+    for (const auto& entry : m_entries) {
+        for (const auto& inputFile : entry.inputFiles) {
+            inputFiles.insert(inputFile);
+        }
+    }
+    QVector<QHash<QString, FileHash>::const_iterator> fileHashes;
+    fileHashes.reserve(inputFiles.size());
+    for (auto it = m_fileHashes.constBegin(), end = m_fileHashes.constEnd(); it != end; ++it) {
+        if (inputFiles.contains(it.key())) {
+            fileHashes.append(it);
+        }
+    }
+
+    stream << static_cast<qint32>(fileHashes.size());
+    for (const auto& it : qAsConst(fileHashes)) {
+        stream << it.key() << it->size << it->lastModified << it->hash;
+    }
+
+    stream << static_cast<qint32>(m_entries.size());
+    for (auto it = m_entries.constBegin(), end = m_entries.constEnd(); it != end; ++it) {
+        stream << it.key() << it->inputHash << it->inputFiles << static_cast<qint32>(it->problems.size());
+        for (const auto& problem : it->problems) {
+            writeProblem(stream, problem);
+        }
+    }
+
+    return file.commit();
+}
+
+QByteArray CompileAnalyzeCache::fileHash(const QString& filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists()) {
+        return QByteArray();
+    }
+
+    const auto size = info.size();
+    const auto lastModified = info.lastModified();
+
+    auto it = m_fileHashes.find(filePath);
+    if (it != m_fileHashes.end() && it->size == size && it->lastModified == lastModified) {
+        return it->hash;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    const auto result = hash.result();
+
+    m_fileHashes.insert(filePath, {size, lastModified, result});
+    return result;
+}
+
+QByteArray CompileAnalyzeCache::inputHash(const QString& toolCommand, const QString& compileCommand,
+                                          const QString& source, const QStringList& includedFiles,
+                                          const QStringList& configFiles)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(toolCommand.toUtf8());
+    hash.addData(compileCommand.toUtf8());
+    hash.addData(source.toUtf8());
+    hash.addData(fileHash(source));
+
+    // sort, so the hash does not depend on the order the includes were reported in
+    auto sortedIncludedFiles = includedFiles;
+    sortedIncludedFiles.sort();
+    for (const auto& includedFile : qAsConst(sortedIncludedFiles)) {
+        hash.addData(includedFile.toUtf8());
+        hash.addData(fileHash(includedFile));
+    }
+
+    // the paths are hashed as well, so adding or removing a config file changes the hash
+    for (const auto& configFile : configFiles) {
+        hash.addData(configFile.toUtf8());
+        hash.addData(fileHash(configFile));
+    }
+
+    return hash.result();
+}
+
+CompileAnalyzeCache::SourceCheck CompileAnalyzeCache::check(const QString& toolCommand, const QStringList& sources,
+                                                             const QHash<QString, QString>& compileCommands,
+                                                             const std::function<QStringList(const QString&)>& configFiles,
+                                                             const QAtomicInt& canceled)
+{
+    SourceCheck result;
+    result.sources = sources;
+
+    const auto includedFiles = Utils::includedFilesFromDUChain(sources);
+
+    for (const auto& source : sources) {
+        if (canceled.loadAcquire()) {
+            break;
+        }
+
+        const auto includedFilesIt = includedFiles.constFind(source);
+        if (includedFilesIt == includedFiles.constEnd()) {
+            // without knowing the included files we cannot tell whether cached results are still valid
+            result.hasUncacheableSources = true;
+            result.outdatedSources << source;
+            continue;
+        }
+
+        SourceInputs inputs;
+        inputs.includedFiles = *includedFilesIt;
+        inputs.configFiles = configFiles ? configFiles(source) : QStringList();
+        inputs.inputHash = inputHash(toolCommand, compileCommands.value(source), source,
+                                     inputs.includedFiles, inputs.configFiles);
+        if (isUpToDate(source, inputs.inputHash)) {
+            result.cachedProblems += problems(source);
+        } else {
+            result.cacheableSources.insert(source, inputs);
+            result.outdatedSources << source;
+        }
+    }
+
+    qCDebug(KDEV_COMPILEANALYZER) << "Reusing cached results for" << (sources.size() - result.outdatedSources.size())
+                                  << "of" << sources.size() << "files";
+
+    return result;
+}
+
+bool CompileAnalyzeCache::insertResults(const SourceCheck& check, const QVector<IProblem::Ptr>& detectedProblems)
+{
+    // problems located in headers are reported for the sources including them
+    QHash<IndexedString, QStringList> sourcesForFile;
+    for (auto it = check.cacheableSources.constBegin(), end = check.cacheableSources.constEnd(); it != end; ++it) {
+        sourcesForFile[IndexedString(it.key())] << it.key();
+        for (const auto& includedFile : it->includedFiles) {
+            sourcesForFile[IndexedString(includedFile)] << it.key();
+        }
+    }
+
+    QHash<QString, QVector<IProblem::Ptr>> problemsForSource;
+    for (const auto& problem : detectedProblems) {
+        const auto sourcesIt = sourcesForFile.constFind(problem->finalLocation().document);
+        if (sourcesIt == sourcesForFile.constEnd()) {
+            if (!check.hasUncacheableSources) {
+                // should not happen, unless the DUChain misses some includes,
+                // better not cache anything in that case
+                qCDebug(KDEV_COMPILEANALYZER) << "Not caching results, could not map problem to source:"
+                                              << problem->finalLocation().document.str();
+                return false;
+            }
+            // assume it comes from one of the uncacheable sources, which are always analyzed again
+            continue;
+        }
+        for (const auto& source : *sourcesIt) {
+            problemsForSource[source] << problem;
+        }
+    }
+
+    for (auto it = check.cacheableSources.constBegin(), end = check.cacheableSources.constEnd(); it != end; ++it) {
+        insert(it.key(), it->inputHash, problemsForSource.value(it.key()),
+               QStringList{it.key()} + it->includedFiles + it->configFiles);
+    }
+    return true;
+}
+
+void CompileAnalyzeCache::retainSources(const QStringList& sources)
+{
+    QSet<QString> sourceSet;
+    sourceSet.reserve(sources.size());
+    for (const auto& source : sources) {
+        sourceSet.insert(source);
+    }
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (sourceSet.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+        }
+    }
+}
+
+bool CompileAnalyzeCache::isUpToDate(const QString& source, const QByteArray& inputHash) const
+{
+    const auto it = m_entries.constFind(source);
+    return (it != m_entries.constEnd() && it->inputHash == inputHash);
+}
+
+QVector<IProblem::Ptr> CompileAnalyzeCache::problems(const QString& source) const
+{
+    return m_entries.value(source).problems;
+}
+
+QVector<IProblem::Ptr> CompileAnalyzeCache::allProblems() const
+{
+    QVector<IProblem::Ptr> result;
+    for (const auto& entry : m_entries) {
+        result += entry.problems;
+    }
+    return result;
+}
+
+void CompileAnalyzeCache::insert(const QString& source, const QByteArray& inputHash,
+                                 const QVector<IProblem::Ptr>& problems,
+                                 const QStringList& inputFiles)
+{
+    m_entries.insert(source, {inputHash, problems, inputFiles});
+}
+
+void CompileAnalyzeCache::remove(const QString& source)
+{
+    m_entries.remove(source);
+}
+
+}
@@ -0,0 +1,176 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef COMPILEANALYZER_COMPILEANALYZECACHE_H
+#define COMPILEANALYZER_COMPILEANALYZECACHE_H
+
+// lib
+#include <compileanalyzercommonexport.h>
+// KDevPlatform
+#include <interfaces/iproblem.h>
+// Qt
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+// Std
+#include <functional>
+
+namespace KDevelop
+{
+class IProject;
+
+/**
+ * Persistent store of analyzer results per source file.
+ *
+ * Each entry is keyed by a hash over everything influencing the result of analyzing
+ * a source file: the tool command line (including the selected checks), the compile
+ * command of the source and the contents of the source, of all files it includes and
+ * of the configuration files the tool reads for it.
+ * A source only needs to be analyzed again if its current input hash differs from
+ * the stored one.
+ *
+ * The cache is not thread safe, but it may be used from a worker thread as long as
+ * no other thread uses it at the same time, see check().
+ */
+class KDEVCOMPILEANALYZERCOMMON_EXPORT CompileAnalyzeCache
+{
+public:
+    /// The inputs of analyzing a source whose results can be cached
+    struct SourceInputs
+    {
+        QByteArray inputHash;
+        QStringList includedFiles;
+        QStringList configFiles;
+    };
+
+    /// The result of check()
+    struct SourceCheck
+    {
+        /// all checked sources
+        QStringList sources;
+        /// the sources which need to be analyzed
+        QStringList outdatedSources;
+        /// the outdated sources whose results can be cached
+        QHash<QString, SourceInputs> cacheableSources;
+        /// whether some outdated sources are not known to the DUChain, so their results cannot be cached
+        bool hasUncacheableSources = false;
+        /// the cached problems of the up-to-date sources
+        QVector<KDevelop::IProblem::Ptr> cachedProblems;
+    };
+
+public:
+    explicit CompileAnalyzeCache(const QString& filePath);
+    ~CompileAnalyzeCache();
+
+    /**
+     * @return the path of the cache file for @p project in @p directory,
+     *         named after a hash of the project path, as project names need not be unique
+     */
+    static QString filePathForProject(const QString& directory, const KDevelop::IProject* project);
+
+public:
+    QString filePath() const;
+
+    bool load();
+    bool save() const;
+
+    bool isEmpty() const;
+
+    /**
+     * Computes the hash over all inputs of analyzing @p source.
+     *
+     * Content hashes of the files are remembered together with their size and modification time,
+     * so unchanged files are not read again.
+     */
+    QByteArray inputHash(const QString& toolCommand, const QString& compileCommand,
+                         const QString& source, const QStringList& includedFiles,
+                         const QStringList& configFiles = {});
+
+    /**
+     * Finds the sources out of @p sources which need to be analyzed again.
+     *
+     * This hashes the contents of all inputs and looks up the included files in the DUChain,
+     * so run it in a worker thread. Returns early with an incomplete result if @p canceled is set.
+     *
+     * @param compileCommands the compile command of each source
+     * @param configFiles returns the configuration files the tool reads for a source
+     */
+    SourceCheck check(const QString& toolCommand, const QStringList& sources,
+                      const QHash<QString, QString>& compileCommands,
+                      const std::function<QStringList(const QString&)>& configFiles,
+                      const QAtomicInt& canceled);
+
+    /**
+     * Stores the results of analyzing the cacheable sources of @p check.
+     *
+     * Problems located in headers are stored for the sources including them.
+     * If a problem cannot be attributed to any analyzed source, nothing is stored.
+     *
+     * @param detectedProblems all problems reported by the tool
+     * @return whether the results were stored
+     */
+    bool insertResults(const SourceCheck& check, const QVector<KDevelop::IProblem::Ptr>& detectedProblems);
+
+    /// Removes the entries of all sources not in @p sources, e.g. of the files which left the project
+    void retainSources(const QStringList& sources);
+
+    bool isUpToDate(const QString& source, const QByteArray& inputHash) const;
+    QVector<KDevelop::IProblem::Ptr> problems(const QString& source) const;
+    QVector<KDevelop::IProblem::Ptr> allProblems() const;
+
+    /**
+     * @param inputFiles the files hashed into @p inputHash, only their content hashes are kept when saving
+     */
+    void insert(const QString& source, const QByteArray& inputHash,
+                const QVector<KDevelop::IProblem::Ptr>& problems,
+                const QStringList& inputFiles = {});
+    void remove(const QString& source);
+
+private:
+    QByteArray fileHash(const QString& filePath);
+
+private:
+    struct Entry
+    {
+        QByteArray inputHash;
+        QVector<KDevelop::IProblem::Ptr> problems;
+        QStringList inputFiles;
+    };
+
+    struct FileHash
+    {
+        qint64 size;
+        QDateTime lastModified;
+        QByteArray hash;
+    };
+
+    const QString m_filePath;
+    QHash<QString, Entry> m_entries;
+    QHash<QString, FileHash> m_fileHashes;
+};
+
+}
+
+#endif
@@ -70,6 +70,17 @@ void CompileAnalyzeJob::setCommand(const QString& command, bool verboseOutput)
     m_verboseOutput = verboseOutput;
 }
 
+QStringList CompileAnalyzeJob::configFiles(const QString& source) const
+{
+    Q_UNUSED(source);
+    return {};
+}
+
+QString CompileAnalyzeJob::command() const
+{
+    return m_command;
+}
+
 void CompileAnalyzeJob::setToolDisplayName(const QString& toolDisplayName)
 {
     m_toolDisplayName = toolDisplayName;
@@ -51,9 +51,16 @@ public:
     void setParallelJobCount(int parallelJobCount);
     void setBuildDirectoryRoot(const QString& buildDir);
     void setCommand(const QString& commandcommand, bool verboseOutput = true);
+    QString command() const;
     void setToolDisplayName(const QString& toolDisplayName);
     void setSources(const QStringList& sources);
 
+    /**
+     * @return the configuration files the tool reads when analyzing @p source,
+     *         which are part of the key of cached results. None by default.
+     */
+    virtual QStringList configFiles(const QString& source) const;
+
 Q_SIGNALS:
     void problemsDetected(const QVector<KDevelop::IProblem::Ptr>& problems);
 
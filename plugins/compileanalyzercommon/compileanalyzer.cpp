@@ -24,8 +24,10 @@
 
 // lib
 #include "compileanalyzeutils.h"
+#include "compileanalyzecache.h"
 #include "compileanalyzejob.h"
 #include "compileanalyzeproblemmodel.h"
+#include <debug.h>
 // KDevPlatform
 #include <interfaces/iplugin.h>
 #include <interfaces/icore.h>
@@ -38,10 +40,12 @@
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/iruncontroller.h>
+#include <interfaces/isession.h>
 #include <interfaces/iuicontroller.h>
 #include <project/interfaces/ibuildsystemmanager.h>
 #include <project/projectconfigpage.h>
 #include <project/projectmodel.h>
+#include <serialization/indexedstring.h>
 #include <shell/problemmodelset.h>
 #include <util/jobstatus.h>
 // KF
@@ -55,6 +59,7 @@
 #include <QMimeType>
 #include <QMimeDatabase>
 #include <QThread>
+#include <QtConcurrentRun>
 
 namespace KDevelop
 {
@@ -72,6 +77,7 @@ CompileAnalyzer::CompileAnalyzer(IPlugin* plugin,
                                  ProblemModel::Features modelFeatures,
                                  QObject* parent)
     : QObject(parent)
+    , m_plugin(plugin)
     , m_core(plugin->core())
     , m_toolName(toolName)
     , m_toolIcon(QIcon::fromTheme(toolIconName))
@@ -102,6 +108,8 @@ CompileAnalyzer::CompileAnalyzer(IPlugin* plugin,
 
     connect(core()->projectController(), &KDevelop::IProjectController::projectOpened,
             this, &CompileAnalyzer::updateActions);
+    connect(core()->projectController(), &KDevelop::IProjectController::projectOpened,
+            this, &CompileAnalyzer::handleProjectOpened);
     connect(core()->projectController(), &KDevelop::IProjectController::projectClosed,
             this, &CompileAnalyzer::handleProjectClosed);
 
@@ -160,12 +168,129 @@ void CompileAnalyzer::updateActions()
 
 void CompileAnalyzer::handleProjectClosed(IProject* project)
 {
-    if (project != m_model->project()) {
+    if (project == m_model->project()) {
+        killJob();
+        m_model->reset();
+    }
+
+    if (project == m_cacheProject) {
+        m_cache.reset();
+        m_cacheProject = nullptr;
+    }
+}
+
+void CompileAnalyzer::handleProjectOpened(IProject* project)
+{
+    if (isRunning() || m_model->project()) {
         return;
     }
 
-    killJob();
-    m_model->reset();
+    // show the results of the last analysis of the project right away
+    const auto cache = resultCache(project);
+    if (cache->isEmpty()) {
+        return;
+    }
+
+    m_model->reset(project, project->path().toUrl(), true);
+    m_model->addProblems(cache->allProblems());
+    m_model->finishAddProblems();
+}
+
+void CompileAnalyzer::handleProblemsDetected(const QVector<IProblem::Ptr>& problems)
+{
+    m_detectedProblems += problems;
+    m_model->addProblems(problems);
+}
+
+QSharedPointer<CompileAnalyzeCache> CompileAnalyzer::resultCache(IProject* project)
+{
+    if (m_cacheProject != project) {
+        const auto dataArea = core()->activeSession()->pluginDataArea(m_plugin).toLocalFile();
+        m_cache.reset(new CompileAnalyzeCache(CompileAnalyzeCache::filePathForProject(dataArea, project)));
+        m_cache->load();
+        m_cacheProject = project;
+    }
+    return m_cache;
+}
+
+void CompileAnalyzer::checkSources(const QStringList& filePaths, const QHash<QString, QString>& compileCommands,
+                                   bool allFiles)
+{
+    m_sourceCheck = {};
+    m_allFiles = allFiles;
+    m_detectedProblems.clear();
+
+    // hashing the inputs of all sources takes long for large projects, so do it in the background,
+    // the cache and the job are not used by this thread until the check finished
+    const auto cache = resultCache(m_model->project());
+    const auto toolCommand = m_job->command();
+    CompileAnalyzeJob* job = m_job;
+    QAtomicInt* canceled = &m_sourceCheckCanceled;
+    m_sourceCheckCanceled.storeRelease(0);
+
+    m_sourceCheckWatcher = new QFutureWatcher<CompileAnalyzeCache::SourceCheck>(this);
+    connect(m_sourceCheckWatcher, &QFutureWatcherBase::finished, this, [this]() {
+        m_sourceCheck = m_sourceCheckWatcher->result();
+        m_sourceCheckWatcher->deleteLater();
+        m_sourceCheckWatcher = nullptr;
+        m_model->addProblems(m_sourceCheck.cachedProblems);
+        startJob();
+    });
+    m_sourceCheckWatcher->setFuture(QtConcurrent::run([cache, toolCommand, filePaths, compileCommands, job, canceled]() {
+        const auto configFiles = [job](const QString& source) {
+            return job->configFiles(source);
+        };
+        return cache->check(toolCommand, filePaths, compileCommands, configFiles, *canceled);
+    }));
+}
+
+void CompileAnalyzer::cancelSourceCheck()
+{
+    if (!m_sourceCheckWatcher) {
+        return;
+    }
+
+    // the check uses the job and the cache, so wait for it
+    m_sourceCheckCanceled.storeRelease(1);
+    m_sourceCheckWatcher->disconnect(this);
+    m_sourceCheckWatcher->waitForFinished();
+    m_sourceCheckWatcher->deleteLater();
+    m_sourceCheckWatcher = nullptr;
+}
+
+void CompileAnalyzer::startJob()
+{
+    if (m_sourceCheck.outdatedSources.isEmpty()) {
+        // everything is up-to-date, the cached results are all we need
+        delete m_job;
+        m_job = nullptr;
+        m_model->finishAddProblems();
+        raiseProblemsToolView();
+        updateActions();
+        return;
+    }
+    m_job->setSources(m_sourceCheck.outdatedSources);
+
+    core()->uiController()->registerStatus(new KDevelop::JobStatus(m_job, m_toolName));
+    core()->runController()->registerJob(m_job);
+
+    if (isOutputToolViewPreferred()) {
+        raiseOutputToolView();
+    } else {
+        raiseProblemsToolView();
+    }
+}
+
+void CompileAnalyzer::storeResults()
+{
+    const auto cache = resultCache(m_model->project());
+
+    if (m_allFiles) {
+        // forget the files which left the project
+        cache->retainSources(m_sourceCheck.sources);
+    }
+    cache->insertResults(m_sourceCheck, m_detectedProblems);
+    cache->save();
 }
 
 void CompileAnalyzer::runTool(bool allFiles)
@@ -194,7 +319,8 @@ void CompileAnalyzer::runTool(const QUrl& url, bool allFiles)
     const auto buildDir = project->buildSystemManager()->buildDirectory(project->projectItem());
 
     QString error;
-    const auto filePaths = Utils::filesFromCompilationDatabase(buildDir, url, allFiles, error);
+    QHash<QString, QString> compileCommands;
+    const auto filePaths = Utils::filesFromCompilationDatabase(buildDir, url, allFiles, error, &compileCommands);
 
     if (!error.isEmpty()) {
         QMessageBox::critical(nullptr, m_toolName,
@@ -204,19 +330,13 @@ void CompileAnalyzer::runTool(const QUrl& url, bool allFiles)
 
     m_job = createJob(project, buildDir, url, filePaths);
 
-    connect(m_job, &CompileAnalyzeJob::problemsDetected, m_model, &CompileAnalyzeProblemModel::addProblems);
+    connect(m_job, &CompileAnalyzeJob::problemsDetected, this, &CompileAnalyzer::handleProblemsDetected);
     connect(m_job, &KJob::finished, this, &CompileAnalyzer::result);
 
-    core()->uiController()->registerStatus(new KDevelop::JobStatus(m_job, m_toolName));
-    core()->runController()->registerJob(m_job);
-
     updateActions();
 
-    if (isOutputToolViewPreferred()) {
-        raiseOutputToolView();
-    } else {
-        raiseProblemsToolView();
-    }
+    // the job is started once it is known which sources need to be analyzed again
+    checkSources(filePaths, compileCommands, allFiles);
 }
 
 void CompileAnalyzer::raiseProblemsToolView()
@@ -240,6 +360,7 @@ bool CompileAnalyzer::isRunning() const
 
 void CompileAnalyzer::killJob()
 {
+    cancelSourceCheck();
     if (m_job) {
         m_job->kill(KJob::EmitResult);
     }
@@ -273,6 +394,10 @@ void CompileAnalyzer::result(KJob* job)
     } else {
         m_model->finishAddProblems();
 
+        if (m_job->status() == KDevelop::OutputExecuteJob::JobStatus::JobSucceeded) {
+            storeResults();
+        }
+
         if (m_job->status() == KDevelop::OutputExecuteJob::JobStatus::JobSucceeded ||
             m_job->status() == KDevelop::OutputExecuteJob::JobStatus::JobCanceled) {
             raiseProblemsToolView();
@@ -282,6 +407,9 @@ void CompileAnalyzer::result(KJob* job)
     }
 
     m_job = nullptr; // job automatically deletes itself later
+    m_sourceCheck = {};
+    m_allFiles = false;
+    m_detectedProblems.clear();
 
     updateActions();
 }
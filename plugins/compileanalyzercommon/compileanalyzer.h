@@ -24,12 +24,17 @@
 #define COMPILEANALYZER_COMPILEANALYZER_H
 
 // lib
+#include "compileanalyzecache.h"
 #include <compileanalyzercommonexport.h>
 // KDevPlatform
 #include <shell/problemmodel.h>
 // Qt
 #include <QObject>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QIcon>
+#include <QSharedPointer>
 
 class KJob;
 class QAction;
@@ -76,6 +81,12 @@ private:
     bool isRunning() const;
     ICore* core() const;
 
+    QSharedPointer<CompileAnalyzeCache> resultCache(KDevelop::IProject* project);
+    void checkSources(const QStringList& filePaths, const QHash<QString, QString>& compileCommands, bool allFiles);
+    void cancelSourceCheck();
+    void startJob();
+    void storeResults();
+
 private Q_SLOTS:
     void runTool(const QUrl& url, bool allFiles = false);
     void runTool(bool allFiles = false);
@@ -86,8 +97,11 @@ private Q_SLOTS:
     void result(KJob* job);
     void updateActions();
     void handleProjectClosed(KDevelop::IProject* project);
+    void handleProjectOpened(KDevelop::IProject* project);
+    void handleProblemsDetected(const QVector<KDevelop::IProblem::Ptr>& problems);
 
 private:
+    IPlugin* const m_plugin;
     ICore* const m_core;
     const QString m_toolName;
     const QIcon m_toolIcon;
@@ -97,6 +111,18 @@ private:
 
     CompileAnalyzeJob* m_job = nullptr;
 
+    // results of previous runs, for the project of the last run
+    QSharedPointer<CompileAnalyzeCache> m_cache;
+    KDevelop::IProject* m_cacheProject = nullptr;
+    // checks in a worker thread which sources the current job needs to analyze
+    QFutureWatcher<CompileAnalyzeCache::SourceCheck>* m_sourceCheckWatcher = nullptr;
+    QAtomicInt m_sourceCheckCanceled;
+    // the sources analyzed by the current job
+    CompileAnalyzeCache::SourceCheck m_sourceCheck;
+    // whether the current job analyzes all sources of the project
+    bool m_allFiles = false;
+    QVector<KDevelop::IProblem::Ptr> m_detectedProblems;
+
     QAction* m_checkFileAction;
     QAction* m_checkProjectAction;
 };
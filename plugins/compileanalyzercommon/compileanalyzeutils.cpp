@@ -24,6 +24,9 @@
 // lib
 #include <debug.h>
 // KDevPlatform
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/topducontext.h>
 #include <util/path.h>
 // KF
 #include <KLocalizedString>
@@ -50,7 +53,8 @@ QString findExecutable(const QString& fallbackExecutablePath)
 
 QStringList filesFromCompilationDatabase(const KDevelop::Path& buildPath,
                                          const QUrl& urlToCheck, bool allFiles,
-                                         QString& error)
+                                         QString& error,
+                                         QHash<QString, QString>* compileCommands)
 {
     QStringList result;
 
@@ -90,6 +94,19 @@ QStringList filesFromCompilationDatabase(const KDevelop::Path& buildPath,
     const bool isPathToCheckAFile = pathToCheckInfo.isFile();
     const auto canonicalPathToCheck = pathToCheckInfo.canonicalFilePath();
 
+    const auto commandOf = [](const QJsonObject& entry) {
+        const auto command = entry.value(QLatin1String("command"));
+        if (command.isString()) {
+            return command.toString();
+        }
+        QStringList arguments;
+        const auto argumentsArray = entry.value(QLatin1String("arguments")).toArray();
+        for (const auto& argument : argumentsArray) {
+            arguments << argument.toString();
+        }
+        return arguments.join(QLatin1Char(' '));
+    };
+
     const auto fileDataArray = commandsDocument.array();
     for (const auto& value : fileDataArray) {
         if (!value.isObject()) {
@@ -104,19 +121,28 @@ QStringList filesFromCompilationDatabase(const KDevelop::Path& buildPath,
             const auto path = it->toString();
             const auto pathInfo = QFileInfo(path);
             if (pathInfo.exists()) {
+                bool matches = false;
                 if (allFiles) {
                     result += path;
+                    matches = true;
                 } else {
                     const auto canonicalPath = pathInfo.canonicalFilePath();
                     if (isPathToCheckAFile) {
                         if (canonicalPath == canonicalPathToCheck) {
                             result = QStringList{path};
+                            if (compileCommands) {
+                                compileCommands->insert(path, commandOf(entry));
+                            }
                             break;
                         }
                     } else if (canonicalPath.startsWith(canonicalPathToCheck)) {
                         result.append(path);
+                        matches = true;
                     }
                 }
+                if (matches && compileCommands) {
+                    compileCommands->insert(path, commandOf(entry));
+                }
             }
         }
     }
@@ -128,6 +154,31 @@ QStringList filesFromCompilationDatabase(const KDevelop::Path& buildPath,
     return result;
 }
 
+QHash<QString, QStringList> includedFilesFromDUChain(const QStringList& sources)
+{
+    QHash<QString, QStringList> result;
+
+    KDevelop::DUChainReadLocker lock;
+
+    for (const auto& source : sources) {
+        const auto* topContext = KDevelop::DUChain::self()->chainForDocument(KDevelop::IndexedString(source));
+        if (!topContext) {
+            continue;
+        }
+
+        auto& includedFiles = result[source];
+        const auto imports = topContext->recursiveImportIndices().set().stdSet();
+        for (const uint index : imports) {
+            const auto url = KDevelop::IndexedTopDUContext(index).url();
+            if (!url.isEmpty() && url != topContext->url()) {
+                includedFiles << url.str();
+            }
+        }
+    }
+
+    return result;
+}
+
 }
 
 }
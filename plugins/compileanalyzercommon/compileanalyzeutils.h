@@ -25,6 +25,8 @@
 // lib
 #include <compileanalyzercommonexport.h>
 
+#include <QHash>
+
 class QUrl;
 class QString;
 class QStringList;
@@ -39,10 +41,24 @@ namespace Utils
 KDEVCOMPILEANALYZERCOMMON_EXPORT
 QString findExecutable(const QString& fallbackExecutablePath);
 
+/**
+ * @param compileCommands if not null, filled with the compile command of each returned file
+ */
 KDEVCOMPILEANALYZERCOMMON_EXPORT
 QStringList filesFromCompilationDatabase(const KDevelop::Path& buildPath,
                                          const QUrl& urlToCheck, bool allFiles,
-                                         QString& error);
+                                         QString& error,
+                                         QHash<QString, QString>* compileCommands = nullptr);
+
+/**
+ * Collects the files included directly or indirectly by each of @p sources, as known from the DUChain.
+ *
+ * All sources are looked up while holding the DUChain lock once.
+ *
+ * @return the included files per source, sources the DUChain has no information about are missing
+ */
+KDEVCOMPILEANALYZERCOMMON_EXPORT
+QHash<QString, QStringList> includedFilesFromDUChain(const QStringList& sources);
 
 }
 
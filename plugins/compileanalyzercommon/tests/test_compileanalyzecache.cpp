@@ -0,0 +1,211 @@
+/* This file is part of KDevelop
+
+   Copyright 2020 The KDevelop developers
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "test_compileanalyzecache.h"
+
+#include "compileanalyzecache.h"
+
+#include <language/editor/documentrange.h>
+#include <shell/problem.h>
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace KDevelop;
+
+namespace {
+
+void writeFile(const QString& path, const QByteArray& contents)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+}
+
+}
+
+void TestCompileAnalyzeCache::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+}
+
+void TestCompileAnalyzeCache::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void TestCompileAnalyzeCache::testInputHash()
+{
+    QTemporaryDir dir;
+    const auto source = dir.filePath(QStringLiteral("source.cpp"));
+    const auto header = dir.filePath(QStringLiteral("header.h"));
+    writeFile(source, "#include \"header.h\"\n");
+    writeFile(header, "int foo();\n");
+
+    CompileAnalyzeCache cache(dir.filePath(QStringLiteral("cache")));
+    const auto hash = cache.inputHash(QStringLiteral("tool -checks=a"), QStringLiteral("c++ -c source.cpp"), source, {header});
+    QCOMPARE(cache.inputHash(QStringLiteral("tool -checks=a"), QStringLiteral("c++ -c source.cpp"), source, {header}), hash);
+
+    // other checks, other flags
+    QVERIFY(cache.inputHash(QStringLiteral("tool -checks=b"), QStringLiteral("c++ -c source.cpp"), source, {header}) != hash);
+    QVERIFY(cache.inputHash(QStringLiteral("tool -checks=a"), QStringLiteral("c++ -O2 -c source.cpp"), source, {header}) != hash);
+
+    // changed contents of an included file
+    writeFile(header, "int foo(int bar);\n");
+    QVERIFY(cache.inputHash(QStringLiteral("tool -checks=a"), QStringLiteral("c++ -c source.cpp"), source, {header}) != hash);
+}
+
+void TestCompileAnalyzeCache::testConfigFilesInInputHash()
+{
+    QTemporaryDir dir;
+    const auto source = dir.filePath(QStringLiteral("source.cpp"));
+    const auto configFile = dir.filePath(QStringLiteral(".clang-tidy"));
+    writeFile(source, "int foo();\n");
+
+    CompileAnalyzeCache cache(dir.filePath(QStringLiteral("cache")));
+    const auto toolCommand = QStringLiteral("tool");
+    const auto compileCommand = QStringLiteral("c++ -c source.cpp");
+    const auto hash = cache.inputHash(toolCommand, compileCommand, source, {});
+
+    // a config file was added
+    writeFile(configFile, "Checks: 'a'\n");
+    const auto configHash = cache.inputHash(toolCommand, compileCommand, source, {}, {configFile});
+    QVERIFY(configHash != hash);
+    QCOMPARE(cache.inputHash(toolCommand, compileCommand, source, {}, {configFile}), configHash);
+
+    // the config file was edited
+    writeFile(configFile, "Checks: 'a,b'\n");
+    QVERIFY(cache.inputHash(toolCommand, compileCommand, source, {}, {configFile}) != configHash);
+}
+
+void TestCompileAnalyzeCache::testStoreAndLoad()
+{
+    QTemporaryDir dir;
+    const auto cacheFile = dir.filePath(QStringLiteral("cache"));
+    const auto source = dir.filePath(QStringLiteral("source.cpp"));
+
+    IProblem::Ptr problem(new DetectedProblem(QStringLiteral("TestAnalyzer")));
+    problem->setSeverity(IProblem::Warning);
+    problem->setDescription(QStringLiteral("some warning"));
+    problem->setFinalLocation(DocumentRange(IndexedString(source), KTextEditor::Range(1, 2, 1, 5)));
+    IProblem::Ptr diagnostic(new DetectedProblem(QStringLiteral("TestAnalyzer")));
+    diagnostic->setDescription(QStringLiteral("some note"));
+    problem->addDiagnostic(diagnostic);
+
+    {
+        CompileAnalyzeCache cache(cacheFile);
+        QVERIFY(!cache.load());
+        QVERIFY(cache.isEmpty());
+        cache.insert(source, "hash", {problem});
+        QVERIFY(cache.save());
+    }
+
+    CompileAnalyzeCache cache(cacheFile);
+    QVERIFY(cache.load());
+    QVERIFY(cache.isUpToDate(source, "hash"));
+    QVERIFY(!cache.isUpToDate(source, "otherhash"));
+
+    const auto problems = cache.problems(source);
+    QCOMPARE(problems.size(), 1);
+    QCOMPARE(problems.first()->description(), problem->description());
+    QCOMPARE(problems.first()->severity(), problem->severity());
+    QCOMPARE(problems.first()->sourceString(), problem->sourceString());
+    QVERIFY(problems.first()->finalLocation() == problem->finalLocation());
+    QCOMPARE(problems.first()->diagnostics().size(), 1);
+    QCOMPARE(problems.first()->diagnostics().first()->description(), diagnostic->description());
+
+    cache.remove(source);
+    QVERIFY(cache.isEmpty());
+}
+
+void TestCompileAnalyzeCache::testCheckUnknownSources()
+{
+    QTemporaryDir dir;
+    const auto source = dir.filePath(QStringLiteral("source.cpp"));
+    writeFile(source, "int foo();\n");
+
+    // the DUChain knows nothing about the source, so it is always analyzed again
+    CompileAnalyzeCache cache(dir.filePath(QStringLiteral("cache")));
+    cache.insert(source, "hash", {});
+    const QAtomicInt canceled;
+    const auto check = cache.check(QStringLiteral("tool"), {source}, {}, {}, canceled);
+    QCOMPARE(check.sources, QStringList{source});
+    QCOMPARE(check.outdatedSources, QStringList{source});
+    QVERIFY(check.cacheableSources.isEmpty());
+    QVERIFY(check.hasUncacheableSources);
+    QVERIFY(check.cachedProblems.isEmpty());
+}
+
+void TestCompileAnalyzeCache::testInsertResults()
+{
+    QTemporaryDir dir;
+    const auto cacheFile = dir.filePath(QStringLiteral("cache"));
+    const auto source = dir.filePath(QStringLiteral("source.cpp"));
+    const auto otherSource = dir.filePath(QStringLiteral("other.cpp"));
+    const auto header = dir.filePath(QStringLiteral("header.h"));
+    writeFile(source, "#include \"header.h\"\n");
+    writeFile(otherSource, "int bar();\n");
+    writeFile(header, "int foo();\n");
+
+    IProblem::Ptr problem(new DetectedProblem(QStringLiteral("TestAnalyzer")));
+    problem->setDescription(QStringLiteral("warning in header"));
+    problem->setFinalLocation(DocumentRange(IndexedString(header), KTextEditor::Range(0, 0, 0, 3)));
+
+    CompileAnalyzeCache cache(cacheFile);
+    CompileAnalyzeCache::SourceCheck check;
+    check.sources = QStringList{source, otherSource};
+    check.outdatedSources = check.sources;
+    const auto sourceHash = cache.inputHash(QStringLiteral("tool"), QString(), source, {header});
+    const auto otherSourceHash = cache.inputHash(QStringLiteral("tool"), QString(), otherSource, {});
+    check.cacheableSources.insert(source, {sourceHash, {header}, {}});
+    check.cacheableSources.insert(otherSource, {otherSourceHash, {}, {}});
+
+    // problems in headers are stored for the sources including them
+    QVERIFY(cache.insertResults(check, {problem}));
+    QVERIFY(cache.isUpToDate(source, sourceHash));
+    QCOMPARE(cache.problems(source).size(), 1);
+    QVERIFY(cache.isUpToDate(otherSource, otherSourceHash));
+    QVERIFY(cache.problems(otherSource).isEmpty());
+
+    // nothing is stored if a problem cannot be attributed to a source
+    IProblem::Ptr unknownProblem(new DetectedProblem(QStringLiteral("TestAnalyzer")));
+    unknownProblem->setFinalLocation(DocumentRange(IndexedString(dir.filePath(QStringLiteral("unknown.h"))),
+                                                   KTextEditor::Range(0, 0, 0, 3)));
+    CompileAnalyzeCache otherCache(dir.filePath(QStringLiteral("othercache")));
+    QVERIFY(!otherCache.insertResults(check, {unknownProblem}));
+    QVERIFY(otherCache.isEmpty());
+
+    // files which left the project are forgotten
+    cache.retainSources({source});
+    QVERIFY(cache.isUpToDate(source, sourceHash));
+    QVERIFY(!cache.isUpToDate(otherSource, otherSourceHash));
+
+    QVERIFY(cache.save());
+    CompileAnalyzeCache loadedCache(cacheFile);
+    QVERIFY(loadedCache.load());
+    QVERIFY(loadedCache.isUpToDate(source, sourceHash));
+    QVERIFY(!loadedCache.isUpToDate(otherSource, otherSourceHash));
+}
+
+QTEST_GUILESS_MAIN(TestCompileAnalyzeCache)
@@ -25,6 +25,7 @@
 #include "browsemanager.h"
 #include "debug.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 #include <QAction>
@@ -34,6 +35,7 @@
 #include <QTimer>
 #include <QToolButton>
 #include <QWidgetAction>
+#include <QtConcurrentRun>
 
 #include <KActionCollection>
 #include <KLocalizedString>
@@ -74,6 +76,8 @@
 #include <language/duchain/navigation/quickopenembeddedwidgetcombiner.h>
 
 #include <language/util/navigationtooltip.h>
+#include <language/backgroundparser/backgroundparser.h>
+#include <language/backgroundparser/documentchangetracker.h>
 
 #include <shell/problemmodel.h>
 #include <shell/problemmodelset.h>
@@ -98,6 +102,81 @@ namespace {
 const unsigned int highlightingTimeout = 150;
 const float highlightingZDepth = -5000;
 const int maxHistoryLength = 30;
+// how long the GUI thread may wait for the duchain when showing a tooltip
+const unsigned int toolTipLockTimeout = 50;
+// the declarations of the uses this many lines above and below the cursor are resolved in the background
+const int toolTipSnapshotLines = 20;
+// how often a tooltip or a highlight update waits for a busy duchain before it is dropped
+const int maxToolTipRetries = 4;
+const int maxUpdateRetries = 5;
+
+///Duchain must be locked
+Declaration* toolTipDeclaration(Declaration* declaration)
+{
+    declaration = DUChainUtils::declarationForDefinition(declaration);
+    if (declaration && declaration->kind() == Declaration::Alias) {
+        auto* alias = dynamic_cast<AliasDeclaration*>(declaration);
+        Q_ASSERT(alias);
+        declaration = alias->aliasedDeclaration().declaration();
+    }
+    return declaration;
+}
+
+///Duchain must be locked
+void collectToolTipItems(const DUContext* context, TopDUContext* topContext, int firstLine, int lastLine,
+                         QVector<ToolTipSnapshot::Item>& items)
+{
+    const auto contextRange = context->range();
+    if (contextRange.end.line < firstLine || contextRange.start.line > lastLine) {
+        return;
+    }
+
+    const Use* uses = context->uses();
+    for (int i = 0, count = context->usesCount(); i < count; ++i) {
+        const auto& range = uses[i].m_range;
+        if (range.start.line < firstLine || range.end.line > lastLine) {
+            continue;
+        }
+        if (auto* declaration = toolTipDeclaration(uses[i].usedDeclaration(topContext))) {
+            items.append({range, IndexedDeclaration(declaration)});
+        }
+    }
+
+    const auto declarations = context->localDeclarations();
+    for (auto* localDeclaration : declarations) {
+        const auto range = localDeclaration->range();
+        if (range.start.line < firstLine || range.end.line > lastLine) {
+            continue;
+        }
+        if (auto* declaration = toolTipDeclaration(localDeclaration)) {
+            items.append({range, IndexedDeclaration(declaration)});
+        }
+    }
+
+    const auto childContexts = context->childContexts();
+    for (auto* childContext : childContexts) {
+        collectToolTipItems(childContext, topContext, firstLine, lastLine, items);
+    }
+}
+
+// Runs in a background thread, so waiting for the duchain lock doesn't block the user interface
+ToolTipSnapshot createToolTipSnapshot(const IndexedString& url, int firstLine, int lastLine)
+{
+    ToolTipSnapshot snapshot;
+
+    DUChainReadLocker lock;
+    TopDUContext* topContext = DUChainUtils::standardContextForUrl(url.toUrl());
+    if (!topContext || !topContext->parsingEnvironmentFile()) {
+        return snapshot;
+    }
+
+    snapshot.url = url;
+    snapshot.revision = topContext->parsingEnvironmentFile()->modificationRevision().revision;
+    snapshot.firstLine = firstLine;
+    snapshot.lastLine = lastLine;
+    collectToolTipItems(topContext, topContext, firstLine, lastLine, snapshot.items);
+    return snapshot;
+}
 
 // Helper that determines the context to use for highlighting at a specific position
 DUContext* contextForHighlightingAt(const KTextEditor::Cursor& position, TopDUContext* topContext)
@@ -301,6 +380,8 @@ K_PLUGIN_FACTORY_WITH_JSON(ContextBrowserFactory, "kdevcontextbrowser.json", reg
 ContextBrowserPlugin::ContextBrowserPlugin(QObject* parent, const QVariantList&)
     : KDevelop::IPlugin(QStringLiteral("kdevcontextbrowser"), parent)
     , m_viewFactory(new ContextBrowserViewFactory(this))
+    , m_pendingToolTipBackoff(highlightingTimeout, maxToolTipRetries)
+    , m_updateBackoff(highlightingTimeout, maxUpdateRetries)
     , m_nextHistoryIndex(0)
     , m_textHintProvider(this)
 {
@@ -321,6 +402,16 @@ ContextBrowserPlugin::ContextBrowserPlugin(QObject* parent, const QVariantList&)
     m_updateTimer->setSingleShot(true);
     connect(m_updateTimer, &QTimer::timeout, this, &ContextBrowserPlugin::updateViews);
 
+    m_snapshotTimer = new QTimer(this);
+    m_snapshotTimer->setSingleShot(true);
+    connect(m_snapshotTimer, &QTimer::timeout, this, &ContextBrowserPlugin::startToolTipSnapshot);
+
+    m_pendingToolTipTimer = new QTimer(this);
+    m_pendingToolTipTimer->setSingleShot(true);
+    connect(m_pendingToolTipTimer, &QTimer::timeout, this, &ContextBrowserPlugin::createPendingToolTip);
+    connect(&m_toolTipSnapshotWatcher, &QFutureWatcher<ToolTipSnapshot>::finished,
+            this, &ContextBrowserPlugin::toolTipSnapshotReady);
+
     //Needed global action for the context-menu extensions
     m_findUses = new QAction(i18nc("@action", "Find Uses"), this);
     connect(m_findUses, &QAction::triggered, this, &ContextBrowserPlugin::findUses);
@@ -338,6 +429,8 @@ ContextBrowserPlugin::~ContextBrowserPlugin()
         iface->unregisterTextHintProvider(&m_textHintProvider);
     }
 
+    delete m_deferredToolTipWidget.data();
+
     ///TODO: QObject inheritance should suffice?
     delete m_nextMenu;
     delete m_previousMenu;
@@ -350,6 +443,7 @@ ContextBrowserPlugin::~ContextBrowserPlugin()
 
 void ContextBrowserPlugin::unload()
 {
+    m_toolTipSnapshotWatcher.waitForFinished();
     core()->uiController()->removeToolView(m_viewFactory);
 }
 
@@ -459,6 +553,8 @@ void ContextBrowserPlugin::startDelayedBrowsing(KTextEditor::View* view)
 
 void ContextBrowserPlugin::hideToolTip()
 {
+    m_pendingToolTipView = nullptr;
+    m_pendingToolTipTimer->stop();
     if (m_currentToolTip) {
         m_currentToolTip->deleteLater();
         m_currentToolTip = nullptr;
@@ -468,7 +564,7 @@ void ContextBrowserPlugin::hideToolTip()
     }
 }
 
-static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(TopDUContext* topContext, KTextEditor::Cursor position,
+static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(const IndexedString& url, KTextEditor::Cursor position,
                                                                 KTextEditor::Range& handleRange)
 {
     QVector<KDevelop::IProblem::Ptr> problems;
@@ -476,7 +572,7 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(TopDUContext* to
 
     const auto modelsData = ICore::self()->languageController()->problemModelSet()->models();
     for (const auto& modelData : modelsData) {
-        const auto modelProblems = modelData.model->problems(topContext->url());
+        const auto modelProblems = modelData.model->problems(url);
         for (const auto& problem : modelProblems) {
             DocumentRange problemRange = problem->finalLocation();
             if (problemRange.contains(position) ||
@@ -495,7 +591,7 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsUnderCursor(TopDUContext* to
     return problems;
 }
 
-static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const TopDUContext* topContext,
+static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const IndexedString& url,
                                                                   KTextEditor::Cursor position,
                                                                   KTextEditor::Range& handleRange)
 {
@@ -504,7 +600,7 @@ static QVector<KDevelop::IProblem::Ptr> findProblemsCloseToCursor(const TopDUCon
     QVector<KDevelop::IProblem::Ptr> allProblems;
     const auto modelsData = ICore::self()->languageController()->problemModelSet()->models();
     for (const auto& modelData : modelsData) {
-        const auto problems = modelData.model->problems(topContext->url());
+        const auto problems = modelData.model->problems(url);
         allProblems.reserve(allProblems.size() + problems.size());
         for (const auto& problem : problems) {
             allProblems += problem;
@@ -564,7 +660,43 @@ QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* vi
     QUrl viewUrl = view->document()->url();
     const auto languages = ICore::self()->languageController()->languagesForUrl(viewUrl);
 
-    DUChainReadLocker lock(DUChain::lock());
+    // Find problems under the cursor (first pass), this doesn't need the duchain
+    QVector<KDevelop::IProblem::Ptr> problems = findProblemsUnderCursor(IndexedString(viewUrl), position, itemRange);
+
+    // Use the widget created for a deferred tooltip, so it is shown without waiting for the duchain again
+    if (problems.isEmpty() && m_deferredToolTipWidget) {
+        KTextEditor::Range declarationRange;
+        const auto declaration = snapshotDeclarationAt(viewUrl, position, declarationRange);
+        if (declaration != IndexedDeclaration() && declaration == m_deferredToolTipDeclaration) {
+            QWidget* widget = m_deferredToolTipWidget;
+            m_deferredToolTipWidget = nullptr;
+            m_deferredToolTipDeclaration = {};
+            if (m_currentToolTip && m_currentToolTipProblems.isEmpty() && declaration == m_currentToolTipDeclaration) {
+                delete widget;
+                return nullptr;
+            }
+            itemRange = declarationRange;
+            m_currentToolTipProblems.clear();
+            m_currentToolTipDeclaration = declaration;
+            return widget;
+        }
+    }
+
+    DUChainReadLocker lock(DUChain::lock(), toolTipLockTimeout);
+    if (!lock.locked()) {
+        // Don't block the editor while the duchain is busy. Resolve the position in the
+        // background instead, the tooltip is shown once its declaration is known.
+        qCDebug(PLUGIN_CONTEXTBROWSER) << "failed to lock the duchain in time, deferring tooltip";
+        m_pendingToolTipView = view;
+        m_pendingToolTipPosition = position;
+        m_pendingToolTipBackoff.reset();
+        // the user is waiting for this one, don't delay it like the ones of cursor moves
+        m_nextSnapshotView = view;
+        m_nextSnapshotPosition = position;
+        m_snapshotTimer->stop();
+        startToolTipSnapshot();
+        return nullptr;
+    }
 
     for (const auto language : languages) {
         auto widget = language->specialLanguageObjectNavigationWidget(viewUrl, position);
@@ -575,12 +707,7 @@ QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* vi
         }
     }
 
-    // Find problems under the cursor (first pass)
     TopDUContext* topContext = DUChainUtils::standardContextForUrl(view->document()->url());
-    QVector<KDevelop::IProblem::Ptr> problems;
-    if (topContext) {
-        problems = findProblemsUnderCursor(topContext, position, itemRange);
-    }
 
     // Find decl (declaration) under the cursor
     const auto itemUnderCursor = DUChainUtils::itemUnderCursor(viewUrl, position);
@@ -642,7 +769,7 @@ QWidget* ContextBrowserPlugin::navigationWidgetForPosition(KTextEditor::View* vi
     // Nothing has been found so far which created a widget.
     // Thus, find the closest problem to the cursor in a second pass.
     if (topContext) {
-        problems = findProblemsCloseToCursor(topContext, position, itemRange);
+        problems = findProblemsCloseToCursor(IndexedString(viewUrl), position, itemRange);
         if (!problems.isEmpty()) {
             // Return nullptr if the correct contents are already being shown in the tool tip currently.
             if (m_currentToolTip &&
@@ -675,6 +802,8 @@ void ContextBrowserPlugin::showToolTip(KTextEditor::View* view, KTextEditor::Cur
     if (contextView && contextView->isVisible() && !contextView->isLocked())
         return; // If the context-browser view is visible, it will care about updating by itself
 
+    m_pendingToolTipView = nullptr;
+
     KTextEditor::Range itemRange = KTextEditor::Range::invalid();
     auto navigationWidget = navigationWidgetForPosition(view, position, itemRange);
     if (navigationWidget) {
@@ -820,7 +949,7 @@ ContextBrowserView* ContextBrowserPlugin::browserViewForWidget(QWidget* widget)
     return (it != m_views.end()) ? *it : nullptr;
 }
 
-void ContextBrowserPlugin::updateForView(View* view)
+bool ContextBrowserPlugin::updateForView(View* view)
 {
     bool allowHighlight = true;
     if (view->selection()) {
@@ -832,7 +961,7 @@ void ContextBrowserPlugin::updateForView(View* view)
 
     if (m_highlightedRanges[view].keep) {
         m_highlightedRanges[view].keep = false;
-        return;
+        return true;
     }
 
     // Clear all highlighting
@@ -856,11 +985,13 @@ void ContextBrowserPlugin::updateForView(View* view)
     else
         highlightPosition = KTextEditor::Cursor(view->cursorPosition());
 
+    requestToolTipSnapshot(view, highlightPosition);
+
     ///Pick a language
     ILanguageSupport* const language = ICore::self()->languageController()->languagesForUrl(url).value(0);
     if (!language) {
         qCDebug(PLUGIN_CONTEXTBROWSER) << "found no language for document" << url;
-        return;
+        return true;
     }
 
     ///Check whether there is a special language object to highlight (for example a macro)
@@ -883,15 +1014,15 @@ void ContextBrowserPlugin::updateForView(View* view)
         KDevelop::DUChainReadLocker lock(DUChain::lock(), 100);
         if (!lock.locked()) {
             qCDebug(PLUGIN_CONTEXTBROWSER) << "Failed to lock du-chain in time";
-            return;
+            return false;
         }
 
         TopDUContext* topContext = DUChainUtils::standardContextForUrl(view->document()->url());
         if (!topContext)
-            return;
+            return true;
         DUContext* ctx = contextForHighlightingAt(highlightPosition, topContext);
         if (!ctx)
-            return;
+            return true;
 
         //Only update the history if this context is around the text cursor
         if (core()->documentController()->activeDocument() &&
@@ -914,16 +1045,166 @@ void ContextBrowserPlugin::updateForView(View* view)
                 updateBrowserView->setContext(ctx);
         }
     }
+    return true;
 }
 
 void ContextBrowserPlugin::updateViews()
 {
+    // views are tried again later if the duchain is busy, instead of dropping the update
+    QSet<View*> retryViews;
     for (View* view : qAsConst(m_updateViews)) {
-        updateForView(view);
+        if (!updateForView(view)) {
+            retryViews.insert(view);
+        }
+    }
+
+    const int retryDelay = retryViews.isEmpty() ? -1 : m_updateBackoff.nextDelay();
+    if (retryDelay == -1) {
+        if (!retryViews.isEmpty()) {
+            qCDebug(PLUGIN_CONTEXTBROWSER) << "duchain still busy, dropping the highlight update";
+        }
+        m_updateBackoff.reset();
+        m_updateViews.clear();
+        m_useDeclaration = IndexedDeclaration();
+    } else {
+        m_updateViews = retryViews;
+        m_updateTimer->start(retryDelay);
+    }
+}
+
+void ContextBrowserPlugin::requestToolTipSnapshot(View* view, const KTextEditor::Cursor& position)
+{
+    // only resolve once the cursor rests, not for every line it passes
+    m_nextSnapshotView = view;
+    m_nextSnapshotPosition = position;
+    m_snapshotTimer->start(highlightingTimeout);
+}
+
+void ContextBrowserPlugin::startToolTipSnapshot()
+{
+    View* view = m_nextSnapshotView;
+    if (!view) {
+        return;
+    }
+
+    const IndexedString url(view->document()->url());
+    const int line = m_nextSnapshotPosition.line();
+
+    // don't resolve again while the cursor is not close to the edge of the last snapshot
+    if (!m_toolTipSnapshotWatcher.isRunning() && m_toolTipSnapshot.covers(url, line, toolTipSnapshotLines / 2)) {
+        m_nextSnapshotView = nullptr;
+        if (m_pendingToolTipView) {
+            m_pendingToolTipTimer->start(0);
+        }
+        return;
+    }
+
+    if (m_toolTipSnapshotWatcher.isRunning()) {
+        // started again once the running one is done
+        return;
+    }
+
+    m_nextSnapshotView = nullptr;
+    m_runningSnapshotView = view;
+    m_runningSnapshotPosition = m_nextSnapshotPosition;
+    const int firstLine = qMax(0, line - toolTipSnapshotLines);
+    const int lastLine = line + toolTipSnapshotLines;
+    m_toolTipSnapshotWatcher.setFuture(QtConcurrent::run(createToolTipSnapshot, url, firstLine, lastLine));
+}
+
+void ContextBrowserPlugin::toolTipSnapshotReady()
+{
+    if (m_toolTipSnapshotOutdated) {
+        // the document was reparsed in the meantime, the declarations may not exist anymore
+        m_toolTipSnapshotOutdated = false;
+        if (!m_nextSnapshotView) {
+            m_nextSnapshotView = m_runningSnapshotView;
+            m_nextSnapshotPosition = m_runningSnapshotPosition;
+        }
+    } else {
+        m_toolTipSnapshot = m_toolTipSnapshotWatcher.result();
+        if (m_pendingToolTipView) {
+            m_pendingToolTipTimer->start(0);
+        }
+    }
+
+    if (m_nextSnapshotView && !m_snapshotTimer->isActive()) {
+        startToolTipSnapshot();
+    }
+}
+
+KDevelop::IndexedDeclaration ContextBrowserPlugin::snapshotDeclarationAt(const QUrl& url, const KTextEditor::Cursor& position,
+                                                                         KTextEditor::Range& itemRange) const
+{
+    if (!m_toolTipSnapshot.isValid() || m_toolTipSnapshot.url.toUrl() != url) {
+        return IndexedDeclaration();
     }
 
-    m_updateViews.clear();
-    m_useDeclaration = IndexedDeclaration();
+    DocumentChangeTracker* tracker = ICore::self()->languageController()->backgroundParser()->trackerForUrl(m_toolTipSnapshot.url);
+    return m_toolTipSnapshot.declarationAt(position, tracker, itemRange);
+}
+
+void ContextBrowserPlugin::createPendingToolTip()
+{
+    View* view = m_pendingToolTipView;
+    if (!view) {
+        return;
+    }
+    const auto position = m_pendingToolTipPosition;
+
+    const bool stillWanted = (m_mouseHoverCursor == position && m_mouseHoverDocument == view->document()->url())
+                             || view->cursorPosition() == position;
+    KTextEditor::Range itemRange;
+    const auto indexedDeclaration = stillWanted ? snapshotDeclarationAt(view->document()->url(), position, itemRange)
+                                                : IndexedDeclaration();
+    if (indexedDeclaration == IndexedDeclaration()) {
+        m_pendingToolTipView = nullptr;
+        return;
+    }
+
+    // only the widget of the tooltip which is waiting is created, with the lock held as briefly as possible
+    DUChainReadLocker lock(DUChain::lock(), toolTipLockTimeout);
+    if (!lock.locked()) {
+        const int retryDelay = m_pendingToolTipBackoff.nextDelay();
+        if (retryDelay == -1) {
+            qCDebug(PLUGIN_CONTEXTBROWSER) << "duchain still busy, dropping the deferred tooltip";
+            m_pendingToolTipView = nullptr;
+        } else {
+            m_pendingToolTipTimer->start(retryDelay);
+        }
+        return;
+    }
+
+    const QUrl url = view->document()->url();
+    TopDUContext* topContext = DUChainUtils::standardContextForUrl(url);
+    Declaration* declaration = indexedDeclaration.data();
+    // special language objects like macro expansions bring their own widgets, leave them to navigationWidgetForPosition
+    const auto languages = ICore::self()->languageController()->languagesForUrl(url);
+    const bool isSpecialLanguageObject = std::any_of(languages.begin(), languages.end(), [&](ILanguageSupport* language) {
+        return language->specialLanguageObjectRange(url, position).isValid();
+    });
+    QWidget* widget = nullptr;
+    if (topContext && declaration && declaration->context() && !isSpecialLanguageObject) {
+        widget = declaration->context()->createNavigationWidget(declaration, topContext);
+    }
+    lock.unlock();
+
+    m_pendingToolTipView = nullptr;
+    if (!widget) {
+        return;
+    }
+
+    delete m_deferredToolTipWidget.data();
+    m_deferredToolTipWidget = widget;
+    m_deferredToolTipDeclaration = indexedDeclaration;
+    showToolTip(view, position);
+}
+
+void ContextBrowserPlugin::clearToolTipSnapshot()
+{
+    m_toolTipSnapshot = ToolTipSnapshot();
+    delete m_deferredToolTipWidget.data();
+    m_deferredToolTipDeclaration = {};
 }
 
 void ContextBrowserPlugin::declarationSelectedInUI(const DeclarationPointer& decl)
@@ -939,6 +1220,14 @@ void ContextBrowserPlugin::declarationSelectedInUI(const DeclarationPointer& dec
 
 void ContextBrowserPlugin::updateReady(const IndexedString& file, const ReferencedTopDUContext& /*topContext*/)
 {
+    if (file == m_toolTipSnapshot.url) {
+        clearToolTipSnapshot();
+    }
+    if (m_toolTipSnapshotWatcher.isRunning() && m_runningSnapshotView
+        && file.toUrl() == m_runningSnapshotView->document()->url()) {
+        m_toolTipSnapshotOutdated = true;
+    }
+
     const auto url = file.toUrl();
     for (QMap<View*, ViewHighlights>::iterator it = m_highlightedRanges.begin(); it != m_highlightedRanges.end();
          ++it) {
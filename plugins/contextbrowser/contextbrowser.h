@@ -25,10 +25,12 @@
 
 #include <QVariant>
 #include <QSet>
+#include <QVector>
 #include <QMap>
 #include <QList>
 #include <QUrl>
 #include <QPointer>
+#include <QFutureWatcher>
 
 #include <KTextEditor/TextHintInterface>
 #include <interfaces/iplugin.h>
@@ -39,9 +41,12 @@
 #include <language/editor/persistentmovingrange.h>
 #include <language/interfaces/iquickopen.h>
 #include <language/editor/documentcursor.h>
+#include <serialization/indexedstring.h>
 
 #include <language/interfaces/icontextbrowser.h>
 
+#include "tooltipsnapshot.h"
+
 class QHBoxLayout;
 class QMenu;
 class QToolButton;
@@ -152,6 +157,10 @@ public Q_SLOTS:
     void hideToolTip();
     void findUses();
 
+    void startToolTipSnapshot();
+    void toolTipSnapshotReady();
+    void createPendingToolTip();
+
     void textInserted(KTextEditor::Document* doc, const KTextEditor::Cursor& cursor, const QString& text);
     void selectionChanged(KTextEditor::View*);
 
@@ -193,7 +202,15 @@ private:
      *  Tries to find a 'specialLanguageObject' (eg macro) in @p view under cursor @c.
      *  If found returns true and sets @p pickedLanguage to the language this object belongs to */
     KDevelop::Declaration* findDeclaration(KTextEditor::View* view, const KTextEditor::Cursor&, bool mouseHighlight);
-    void updateForView(KTextEditor::View* view);
+    /// @return false if the duchain could not be locked in time and the view needs to be updated again
+    bool updateForView(KTextEditor::View* view);
+
+    /// Resolves the declarations around @p position in the background, once the cursor rests there
+    void requestToolTipSnapshot(KTextEditor::View* view, const KTextEditor::Cursor& position);
+    /// @return the declaration at @p position according to the last snapshot, without locking the duchain
+    KDevelop::IndexedDeclaration snapshotDeclarationAt(const QUrl& url, const KTextEditor::Cursor& position,
+                                                       KTextEditor::Range& itemRange) const;
+    void clearToolTipSnapshot();
 
     // history browsing
     bool isPreviousEntry(KDevelop::DUContext*, const KTextEditor::Cursor& cursor) const;
@@ -243,6 +260,29 @@ private:
     QVector<KDevelop::IProblem::Ptr> m_currentToolTipProblems;
     QAction* m_findUses;
 
+    // asynchronous tooltip resolution
+    QFutureWatcher<ToolTipSnapshot> m_toolTipSnapshotWatcher;
+    ToolTipSnapshot m_toolTipSnapshot;
+    // the document and position of the snapshot which is being created
+    QPointer<KTextEditor::View> m_runningSnapshotView;
+    KTextEditor::Cursor m_runningSnapshotPosition;
+    // set when the document was reparsed while its snapshot was being created
+    bool m_toolTipSnapshotOutdated = false;
+    // the position to resolve next, when the cursor rests there and the running snapshot is done
+    QPointer<KTextEditor::View> m_nextSnapshotView;
+    KTextEditor::Cursor m_nextSnapshotPosition;
+    QTimer* m_snapshotTimer;
+    // a tooltip which could not be shown because the duchain was locked
+    QPointer<KTextEditor::View> m_pendingToolTipView;
+    KTextEditor::Cursor m_pendingToolTipPosition;
+    QTimer* m_pendingToolTipTimer;
+    RetryBackoff m_pendingToolTipBackoff;
+    // the navigation widget created for the pending tooltip, not shown yet
+    KDevelop::IndexedDeclaration m_deferredToolTipDeclaration;
+    QPointer<QWidget> m_deferredToolTipWidget;
+    // highlight updates which could not lock the duchain in time are retried a few times
+    RetryBackoff m_updateBackoff;
+
     QPointer<KTextEditor::Document> m_lastInsertionDocument;
     KTextEditor::Cursor m_lastInsertionPos;
 
@@ -0,0 +1,109 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "../tooltipsnapshot.h"
+
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+
+#include <QTest>
+
+using namespace KDevelop;
+
+class TestToolTipSnapshot : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        AutoTestShell::init({});
+        TestCore::initialize(Core::NoUi);
+    }
+
+    void cleanupTestCase()
+    {
+        TestCore::shutdown();
+    }
+
+    void testCovers()
+    {
+        const IndexedString url(QStringLiteral("/tooltipsnapshot/a.cpp"));
+        ToolTipSnapshot snapshot;
+        QVERIFY(!snapshot.covers(url, 0, 0));
+
+        snapshot.url = url;
+        snapshot.firstLine = 10;
+        snapshot.lastLine = 50;
+        QVERIFY(snapshot.covers(url, 30, 10));
+        QVERIFY(snapshot.covers(url, 20, 10));
+        QVERIFY(snapshot.covers(url, 40, 10));
+        // too close to the edges
+        QVERIFY(!snapshot.covers(url, 19, 10));
+        QVERIFY(!snapshot.covers(url, 41, 10));
+        QVERIFY(!snapshot.covers(IndexedString(QStringLiteral("/tooltipsnapshot/b.cpp")), 30, 10));
+
+        // there is nothing above the first line of a document
+        snapshot.firstLine = 0;
+        QVERIFY(snapshot.covers(url, 0, 10));
+    }
+
+    void testDeclarationAt()
+    {
+        ToolTipSnapshot snapshot;
+        snapshot.url = IndexedString(QStringLiteral("/tooltipsnapshot/a.cpp"));
+        const IndexedDeclaration outer(1, 1);
+        const IndexedDeclaration inner(1, 2);
+        const IndexedDeclaration other(1, 3);
+        snapshot.items = {
+            {RangeInRevision(2, 0, 2, 30), outer},
+            {RangeInRevision(2, 10, 2, 15), inner},
+            {RangeInRevision(5, 0, 5, 5), other},
+        };
+
+        KTextEditor::Range itemRange;
+        QCOMPARE(snapshot.declarationAt({2, 12}, nullptr, itemRange), inner);
+        QCOMPARE(itemRange, KTextEditor::Range(2, 10, 2, 15));
+
+        QCOMPARE(snapshot.declarationAt({2, 20}, nullptr, itemRange), outer);
+        QCOMPARE(itemRange, KTextEditor::Range(2, 0, 2, 30));
+
+        // the end of a range still belongs to it, like for the highlighting
+        QCOMPARE(snapshot.declarationAt({5, 5}, nullptr, itemRange), other);
+
+        QCOMPARE(snapshot.declarationAt({3, 0}, nullptr, itemRange), IndexedDeclaration());
+    }
+
+    void testRetryBackoff()
+    {
+        RetryBackoff backoff(100, 3);
+        QCOMPARE(backoff.nextDelay(), 100);
+        QCOMPARE(backoff.nextDelay(), 200);
+        QCOMPARE(backoff.nextDelay(), 400);
+        QCOMPARE(backoff.nextDelay(), -1);
+        QCOMPARE(backoff.nextDelay(), -1);
+
+        backoff.reset();
+        QCOMPARE(backoff.nextDelay(), 100);
+    }
+};
+
+QTEST_MAIN(TestToolTipSnapshot)
+
+#include "test_tooltipsnapshot.moc"
@@ -0,0 +1,53 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "tooltipsnapshot.h"
+
+#include <language/backgroundparser/documentchangetracker.h>
+
+using namespace KDevelop;
+
+bool ToolTipSnapshot::covers(const IndexedString& url, int line, int margin) const
+{
+    return isValid() && this->url == url
+           && (firstLine == 0 || line >= firstLine + margin)
+           && line <= lastLine - margin;
+}
+
+IndexedDeclaration ToolTipSnapshot::declarationAt(const KTextEditor::Cursor& position, DocumentChangeTracker* tracker,
+                                                  KTextEditor::Range& itemRange) const
+{
+    // prefer the innermost item, e.g. the use of a member over the declaration containing it
+    // IndexedDeclaration::isValid() needs the duchain, which is not locked here
+    IndexedDeclaration ret;
+    bool found = false;
+    for (const auto& item : items) {
+        const KTextEditor::Range range = tracker
+            ? tracker->transformToCurrentRevision(item.range, revision)
+            : item.range.castToSimpleRange();
+        if (range.contains(position) || range.end() == position) {
+            if (!found || itemRange.contains(range)) {
+                found = true;
+                ret = item.declaration;
+                itemRange = range;
+            }
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of KDevelop
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KDEVPLATFORM_PLUGIN_TOOLTIPSNAPSHOT_H
+#define KDEVPLATFORM_PLUGIN_TOOLTIPSNAPSHOT_H
+
+#include <QVector>
+
+#include <KTextEditor/Range>
+
+#include <language/duchain/indexeddeclaration.h>
+#include <language/editor/rangeinrevision.h>
+#include <serialization/indexedstring.h>
+
+namespace KDevelop {
+class DocumentChangeTracker;
+}
+
+/**
+ * The declarations used or declared in some lines of a document, resolved in a
+ * background thread. The ranges refer to the revision of the top-context they
+ * were taken from, so they can be mapped to the current document without locking the duchain.
+ */
+struct ToolTipSnapshot
+{
+    struct Item
+    {
+        KDevelop::RangeInRevision range;
+        KDevelop::IndexedDeclaration declaration;
+    };
+
+    bool isValid() const
+    {
+        return !url.isEmpty();
+    }
+
+    /**
+     * @return whether @p line of @p url is covered by this snapshot, and not too close to
+     * the edge of it to look up the items around it
+     */
+    bool covers(const KDevelop::IndexedString& url, int line, int margin) const;
+
+    /**
+     * @return the innermost declaration at @p position, or a default-constructed one if there is none.
+     * Doesn't need the duchain to be locked.
+     *
+     * @param tracker maps the item ranges to the current revision of the document, may be null
+     * @param itemRange is set to the range of the item the declaration was found for
+     */
+    KDevelop::IndexedDeclaration declarationAt(const KTextEditor::Cursor& position, KDevelop::DocumentChangeTracker* tracker,
+                                               KTextEditor::Range& itemRange) const;
+
+    KDevelop::IndexedString url;
+    qint64 revision = -1;
+    int firstLine = 0;
+    int lastLine = -1;
+    QVector<Item> items;
+};
+
+/**
+ * Counts the attempts of an operation that has to wait for a busy resource,
+ * and doubles the delay before each of them up to a limit.
+ */
+class RetryBackoff
+{
+public:
+    RetryBackoff(int initialDelay, int maxRetries)
+        : m_initialDelay(initialDelay)
+        , m_maxRetries(maxRetries)
+    {
+    }
+
+    /// @return the delay in milliseconds before the next attempt, or -1 if no attempts are left
+    int nextDelay()
+    {
+        if (m_retries >= m_maxRetries) {
+            return -1;
+        }
+        return m_initialDelay << m_retries++;
+    }
+
+    void reset()
+    {
+        m_retries = 0;
+    }
+
+private:
+    int m_initialDelay;
+    int m_maxRetries;
+    int m_retries = 0;
+};
+
+#endif
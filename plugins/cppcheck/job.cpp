@@ -41,6 +41,7 @@
 #include <QApplication>
 #include <QElapsedTimer>
 #include <QRegularExpression>
+#include <QTemporaryFile>
 
 namespace cppcheck
 {
@@ -62,8 +63,20 @@ Job::Job(const Parameters& params, QObject* parent)
     setProperties(KDevelop::OutputExecuteJob::JobProperty::DisplayStderr);
     setProperties(KDevelop::OutputExecuteJob::JobProperty::PostProcessOutput);
 
-    *this << params.commandLine();
-    qCDebug(KDEV_CPPCHECK) << "checking path" << params.checkPath;
+    if (params.sources.isEmpty()) {
+        *this << params.commandLine();
+    } else {
+        // pass the files in a file, the command line would get too long for large projects
+        Parameters fileListParams = params;
+        m_fileList.reset(new QTemporaryFile);
+        if (m_fileList->open()) {
+            m_fileList->write(params.sources.join(QLatin1Char('\n')).toUtf8());
+            m_fileList->flush();
+            fileListParams.fileListPath = m_fileList->fileName();
+        }
+        *this << fileListParams.commandLine();
+    }
+    qCDebug(KDEV_CPPCHECK) << "checking path" << params.checkPath << params.sources.size() << "files";
 }
 
 Job::~Job()
@@ -32,6 +32,7 @@
 #include <outputview/outputexecutejob.h>
 
 class QElapsedTimer;
+class QTemporaryFile;
 
 namespace cppcheck
 {
@@ -72,6 +73,8 @@ protected:
     bool m_showXmlOutput;
 
     KDevelop::Path m_projectRootPath;
+
+    QScopedPointer<QTemporaryFile> m_fileList;
 };
 
 }
@@ -248,7 +248,11 @@ QStringList Parameters::commandLine(QString& infoMessage) const
         }
     }
 
-    result << checkPath;
+    if (fileListPath.isEmpty()) {
+        result << checkPath;
+    } else {
+        result << QLatin1String("--file-list=") + fileListPath;
+    }
 
     return result;
 }
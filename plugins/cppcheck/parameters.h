@@ -86,6 +86,10 @@ public:
 
     // runtime settings
     QString checkPath;
+    // if not empty, the files to check instead of checkPath
+    QStringList sources;
+    // if set, the file listing the files to check, instead of checkPath
+    QString fileListPath;
 
     KDevelop::Path projectRootPath() const;
 
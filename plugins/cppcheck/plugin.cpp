@@ -31,11 +31,14 @@
 #include <interfaces/contextmenuextension.h>
 #include <interfaces/icore.h>
 #include <interfaces/idocumentcontroller.h>
+#include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/iruncontroller.h>
+#include <interfaces/isession.h>
 #include <interfaces/iuicontroller.h>
 #include <language/interfaces/editorcontext.h>
 #include <project/projectconfigpage.h>
+#include <project/projectfileset.h>
 #include <project/projectmodel.h>
 #include <util/jobstatus.h>
 
@@ -43,10 +46,41 @@
 #include <KPluginFactory>
 
 #include <QAction>
+#include <QFileInfo>
 #include <QMimeDatabase>
+#include <QtConcurrentRun>
 
 K_PLUGIN_FACTORY_WITH_JSON(CppcheckFactory, "kdevcppcheck.json", registerPlugin<cppcheck::Plugin>();)
 
+namespace
+{
+
+/// @return the C and C++ sources of @p files in @p checkPath, or just @p checkPath if it is a file
+QStringList sourcesInPath(const KDevelop::ProjectFileSet& files, const QString& checkPath)
+{
+    if (!QFileInfo(checkPath).isDir()) {
+        return {checkPath};
+    }
+
+    const QString directory = checkPath.endsWith(QLatin1Char('/')) ? checkPath : checkPath + QLatin1Char('/');
+    const QMimeDatabase db;
+    QStringList sources;
+    files.forEach([&](const KDevelop::IndexedString& file) {
+        const QString path = file.str();
+        if (!path.startsWith(directory)) {
+            return;
+        }
+        const QString mimeName = db.mimeTypeForFile(path, QMimeDatabase::MatchExtension).name();
+        if (mimeName == QLatin1String("text/x-c++src") || mimeName == QLatin1String("text/x-csrc")) {
+            sources << path;
+        }
+    });
+    sources.sort();
+    return sources;
+}
+
+}
+
 namespace cppcheck
 {
 
@@ -92,6 +126,8 @@ Plugin::Plugin(QObject* parent, const QVariantList&)
 
     connect(core()->projectController(), &KDevelop::IProjectController::projectOpened,
             this, &Plugin::updateActions);
+    connect(core()->projectController(), &KDevelop::IProjectController::projectOpened,
+            this, &Plugin::projectOpened);
     connect(core()->projectController(), &KDevelop::IProjectController::projectClosed,
             this, &Plugin::projectClosed);
 
@@ -105,11 +141,16 @@ Plugin::~Plugin()
 
 bool Plugin::isRunning()
 {
-    return m_job;
+    return m_job || m_sourceCheckWatcher;
 }
 
 void Plugin::killCppcheck()
 {
+    if (m_sourceCheckWatcher) {
+        cancelSourceCheck();
+        m_model->setProblems();
+        updateActions();
+    }
     if (m_job) {
         m_job->kill(KJob::EmitResult);
     }
@@ -155,14 +196,45 @@ void Plugin::updateActions()
     m_menuActionProject->setEnabled(true);
 }
 
-void Plugin::projectClosed(KDevelop::IProject* project)
+void Plugin::projectOpened(KDevelop::IProject* project)
 {
-    if (project != m_model->project()) {
+    if (isRunning() || m_model->project()) {
         return;
     }
 
-    killCppcheck();
-    m_model->reset();
+    // show the results of the last analysis of the project right away
+    const auto cache = resultCache(project);
+    if (cache->isEmpty()) {
+        return;
+    }
+
+    m_model->reset(project, project->path().toLocalFile());
+    m_model->addProblems(cache->allProblems());
+    m_model->setProblems();
+}
+
+void Plugin::projectClosed(KDevelop::IProject* project)
+{
+    if (project == m_model->project()) {
+        killCppcheck();
+        m_model->reset();
+    }
+
+    if (project == m_cacheProject) {
+        m_cache.reset();
+        m_cacheProject = nullptr;
+    }
+}
+
+QSharedPointer<KDevelop::CompileAnalyzeCache> Plugin::resultCache(KDevelop::IProject* project)
+{
+    if (m_cacheProject != project) {
+        const auto dataArea = core()->activeSession()->pluginDataArea(this).toLocalFile();
+        m_cache.reset(new KDevelop::CompileAnalyzeCache(KDevelop::CompileAnalyzeCache::filePathForProject(dataArea, project)));
+        m_cache->load();
+        m_cacheProject = project;
+    }
+    return m_cache;
 }
 
 void Plugin::runCppcheck(bool checkProject)
@@ -184,9 +256,81 @@ void Plugin::runCppcheck(KDevelop::IProject* project, const QString& path)
     Parameters params(project);
     params.checkPath = path;
 
+    m_sourceCheck = {};
+    m_detectedProblems.clear();
+    m_checkProject = (KDevelop::Path(path) == project->path());
+    // the unused function check needs the whole program, so its results can't be cached per source
+    m_cacheResults = !params.checkUnusedFunction;
+    if (m_cacheResults) {
+        checkSources(project, params);
+        updateActions();
+    } else {
+        startJob(params);
+    }
+}
+
+void Plugin::checkSources(KDevelop::IProject* project, const Parameters& params)
+{
+    // the checked files are not part of the key
+    Parameters keyParams = params;
+    keyParams.checkPath.clear();
+    const QString toolCommand = keyParams.commandLine().join(QLatin1Char(' '));
+
+    // hashing the inputs of all sources takes long for large projects, so do it in the background,
+    // the cache is not used by this thread until the check finished
+    const auto cache = resultCache(project);
+    const auto files = project->fileSetSnapshot();
+    const QString checkPath = params.checkPath;
+    QAtomicInt* canceled = &m_sourceCheckCanceled;
+    m_sourceCheckCanceled.storeRelease(0);
+
+    m_sourceCheckWatcher = new QFutureWatcher<KDevelop::CompileAnalyzeCache::SourceCheck>(this);
+    connect(m_sourceCheckWatcher, &QFutureWatcherBase::finished, this, [this, params]() {
+        m_sourceCheck = m_sourceCheckWatcher->result();
+        m_sourceCheckWatcher->deleteLater();
+        m_sourceCheckWatcher = nullptr;
+        m_model->addProblems(m_sourceCheck.cachedProblems);
+        startJob(params);
+    });
+    m_sourceCheckWatcher->setFuture(QtConcurrent::run([cache, toolCommand, files, checkPath, canceled]() {
+        const QStringList sources = sourcesInPath(files, checkPath);
+        return cache->check(toolCommand, sources, {}, {}, *canceled);
+    }));
+}
+
+void Plugin::cancelSourceCheck()
+{
+    if (!m_sourceCheckWatcher) {
+        return;
+    }
+
+    // the check uses the cache, so wait for it
+    m_sourceCheckCanceled.storeRelease(1);
+    m_sourceCheckWatcher->disconnect(this);
+    m_sourceCheckWatcher->waitForFinished();
+    m_sourceCheckWatcher->deleteLater();
+    m_sourceCheckWatcher = nullptr;
+}
+
+void Plugin::startJob(Parameters params)
+{
+    if (m_cacheResults) {
+        if (m_sourceCheck.outdatedSources.isEmpty()) {
+            // everything is up-to-date, the cached results are all we need
+            m_model->setProblems();
+            raiseProblemsView();
+            updateActions();
+            return;
+        }
+        params.sources = m_sourceCheck.outdatedSources;
+    }
+
     m_job = new Job(params);
 
     connect(m_job, &Job::problemsDetected, m_model.data(), &ProblemModel::addProblems);
+    connect(m_job, &Job::problemsDetected, this, [this](const QVector<KDevelop::IProblem::Ptr>& problems) {
+        m_detectedProblems += problems;
+    });
     connect(m_job, &Job::finished, this, &Plugin::result);
 
     core()->uiController()->registerStatus(new KDevelop::JobStatus(m_job, QStringLiteral("Cppcheck")));
@@ -208,6 +352,16 @@ void Plugin::result(KJob*)
     } else {
         m_model->setProblems();
 
+        if (m_cacheResults && m_job->status() == KDevelop::OutputExecuteJob::JobStatus::JobSucceeded) {
+            const auto cache = resultCache(m_model->project());
+            if (m_checkProject) {
+                // forget the files which left the project
+                cache->retainSources(m_sourceCheck.sources);
+            }
+            cache->insertResults(m_sourceCheck, m_detectedProblems);
+            cache->save();
+        }
+
         if (m_job->status() == KDevelop::OutputExecuteJob::JobStatus::JobSucceeded ||
             m_job->status() == KDevelop::OutputExecuteJob::JobStatus::JobCanceled) {
             raiseProblemsView();
@@ -217,6 +371,8 @@ void Plugin::result(KJob*)
     }
 
     m_job = nullptr; // job is automatically deleted later
+    m_sourceCheck = {};
+    m_detectedProblems.clear();
 
     updateActions();
 }
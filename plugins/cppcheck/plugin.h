@@ -23,8 +23,13 @@
 
 #include "job.h"
 
+#include <compileanalyzecache.h>
 #include <interfaces/iplugin.h>
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
 #include <QScopedPointer>
+#include <QSharedPointer>
 
 class KJob;
 
@@ -65,14 +70,32 @@ private:
     void raiseOutputView();
 
     void updateActions();
+    void projectOpened(KDevelop::IProject* project);
     void projectClosed(KDevelop::IProject* project);
 
     void runCppcheck(bool checkProject);
+    void checkSources(KDevelop::IProject* project, const Parameters& params);
+    void cancelSourceCheck();
+    void startJob(Parameters params);
+    QSharedPointer<KDevelop::CompileAnalyzeCache> resultCache(KDevelop::IProject* project);
 
     void result(KJob* job);
 
     Job* m_job;
 
+    // results of previous runs, for the project of the last run
+    QSharedPointer<KDevelop::CompileAnalyzeCache> m_cache;
+    KDevelop::IProject* m_cacheProject = nullptr;
+    // checks in a worker thread which sources the next job needs to analyze
+    QFutureWatcher<KDevelop::CompileAnalyzeCache::SourceCheck>* m_sourceCheckWatcher = nullptr;
+    QAtomicInt m_sourceCheckCanceled;
+    // whether the results of the current job are cached
+    bool m_cacheResults = false;
+    // whether the current job checks the whole project
+    bool m_checkProject = false;
+    KDevelop::CompileAnalyzeCache::SourceCheck m_sourceCheck;
+    QVector<KDevelop::IProblem::Ptr> m_detectedProblems;
+
     KDevelop::IProject* m_currentProject;
 
     QAction* m_menuActionFile;
@@ -18,6 +18,7 @@
 
 #include "test_cppcheckjob.h"
 
+#include <QFile>
 #include <QTest>
 #include <tests/testcore.h>
 #include <tests/autotestshell.h>
@@ -90,6 +91,23 @@ void TestCppcheckJob::testJob()
     QCOMPARE(jobTester.xmlOutput(), stderrOutput.join('\n'));
 }
 
+void TestCppcheckJob::testFileList()
+{
+    Parameters jobParams;
+    jobParams.checkPath = QStringLiteral("/project");
+    jobParams.sources = QStringList{QStringLiteral("/project/a.cpp"), QStringLiteral("/project/b.cpp")};
+    JobTester jobTester(jobParams);
+
+    // the sources are passed in a file instead of the checked path
+    const QStringList commandLine = jobTester.commandLine();
+    QVERIFY(!commandLine.contains(jobParams.checkPath));
+    QVERIFY(commandLine.last().startsWith(QLatin1String("--file-list=")));
+
+    QFile fileList(commandLine.last().mid(QStringLiteral("--file-list=").size()));
+    QVERIFY(fileList.open(QIODevice::ReadOnly));
+    QCOMPARE(QString::fromUtf8(fileList.readAll()).split('\n'), jobParams.sources);
+}
+
 QTEST_GUILESS_MAIN(TestCppcheckJob)
 
 #include "test_cppcheckjob.moc"
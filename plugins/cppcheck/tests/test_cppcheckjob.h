@@ -29,6 +29,7 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void testJob();
+    void testFileList();
 };
 
 #endif
@@ -20,7 +20,6 @@
 
 #include <KLocalizedString>
 #include <interfaces/iproject.h>
-#include <serialization/indexedstring.h>
 #include <util/path.h>
 
 using namespace KDevelop;
@@ -217,7 +216,7 @@ QString ProjectPathsModel::sanitizeUrl( const QUrl& url, bool needRelative ) con
 QString ProjectPathsModel::sanitizePath( const QString& path, bool expectRelative, bool needRelative ) const
 {
     Q_ASSERT( project );
-    Q_ASSERT( expectRelative || project->inProject(IndexedString(path)) );
+    Q_ASSERT( expectRelative || project->path() == KDevelop::Path(path) || project->path().isParentOf(KDevelop::Path(path)) );
 
     QUrl url;
     if( expectRelative ) {
@@ -10,25 +10,33 @@
  */
 
 #include "custommakemanager.h"
+#include "custommakepreferences.h"
 #include "custommakemodelitems.h"
 #include <debug.h>
 #include <interfaces/icore.h>
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/iplugincontroller.h>
+#include <interfaces/isession.h>
 #include <makebuilder/imakebuilder.h>
 #include <project/projectmodel.h>
 #include <project/helper.h>
 #include <custom-definesandincludes/idefinesandincludesmanager.h>
 #include <makefileresolver/makefileresolver.h>
+#include <makefileresolver/makefiledatabase.h>
 
+#include <KConfigGroup>
 #include <KPluginFactory>
 #include <KLocalizedString>
 
+#include <QCryptographicHash>
 #include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
+#include <QtConcurrentRun>
 
 
 #include <algorithm>
@@ -47,23 +55,48 @@ public:
     // cf. https://gcc.gnu.org/bugzilla/show_bug.cgi?id=53613
     ~CustomMakeProvider() Q_DECL_NOEXCEPT override;
 
-    QHash< QString, QString > definesInBackground(const QString&) const override
+    /**
+     * @return whether @p path belongs to one of the projects. The project-wide database of
+     * that project is returned in @p database, if there is one.
+     */
+    bool findProject(const QString& path, QSharedPointer<const MakeFileDatabase>* database) const
     {
-        return {};
+        QReadLocker lock(&m_lock);
+
+        auto it = std::find_if(m_customMakeManager->m_projectPaths.constBegin(), m_customMakeManager->m_projectPaths.constEnd(), [&path](const QString& projectPath)
+        {
+            return path.startsWith(projectPath);
+        } );
+
+        if (it == m_customMakeManager->m_projectPaths.constEnd()) {
+            return false;
+        }
+
+        *database = m_customMakeManager->m_databases.value(*it);
+        return true;
     }
 
-    Path::List resolvePathInBackground(const QString& path, const bool isFrameworks) const
+    QHash< QString, QString > definesInBackground(const QString& path) const override
     {
-        {
-            QReadLocker lock(&m_lock);
+        QSharedPointer<const MakeFileDatabase> database;
+        if (!findProject(path, &database) || !database) {
+            return {};
+        }
+        return database->resolve(path).defines;
+    }
 
-            bool inProject = std::any_of(m_customMakeManager->m_projectPaths.constBegin(), m_customMakeManager->m_projectPaths.constEnd(), [&path](const QString& projectPath)
-            {
-                return path.startsWith(projectPath);
-            } );
+    Path::List resolvePathInBackground(const QString& path, const bool isFrameworks) const
+    {
+        QSharedPointer<const MakeFileDatabase> database;
+        if (!findProject(path, &database)) {
+            return {};
+        }
 
-            if (!inProject) {
-                return {};
+        if (database) {
+            // served from the project-wide index, no need to run make
+            const auto result = database->resolve(path);
+            if (result) {
+                return isFrameworks ? result.frameworkDirectories : result.paths;
             }
         }
 
@@ -125,6 +158,8 @@ CustomMakeManager::CustomMakeManager( QObject *parent, const QVariantList& args
 
     connect(ICore::self()->projectController(), &IProjectController::projectClosing,
             this, &CustomMakeManager::projectClosing);
+    connect(ICore::self()->projectController(), &IProjectController::projectConfigurationChanged,
+            this, &CustomMakeManager::projectConfigurationChanged);
 
 
     IDefinesAndIncludesManager::manager()->registerBackgroundProvider(m_provider.data());
@@ -279,9 +314,98 @@ KDevelop::ProjectFolderItem* CustomMakeManager::import(KDevelop::IProject *proje
         m_projectPaths.insert(project->path().path());
     }
 
+    loadDatabase(project);
+
     return AbstractFileManagerPlugin::import( project );
 }
 
+static QSharedPointer<const MakeFileDatabase> createDatabase(const QString& buildDirectory, const QString& compileCommandsFile,
+                                                             const QString& databaseFile, bool dryRun)
+{
+    QSharedPointer<MakeFileDatabase> database(new MakeFileDatabase);
+
+    if (QFileInfo::exists(compileCommandsFile)) {
+        if (database->importCompileCommands(compileCommandsFile)) {
+            qCDebug(CUSTOMMAKE) << "imported" << database->fileCount() << "files from" << compileCommandsFile;
+            return database;
+        }
+        qCWarning(CUSTOMMAKE) << "could not import compilation database" << compileCommandsFile;
+    }
+
+    if (!dryRun) {
+        return {};
+    }
+
+    // the stored database is outdated once one of the makefiles changed, e.g. after re-running configure
+    const QFileInfo storedDatabase(databaseFile);
+    if (storedDatabase.exists() && database->load(databaseFile)) {
+        if (!database->makefilesChangedSince(storedDatabase.lastModified())) {
+            qCDebug(CUSTOMMAKE) << "loaded" << database->fileCount() << "files from" << databaseFile;
+            return database;
+        }
+        database.reset(new MakeFileDatabase);
+    }
+
+    QString errorMessage;
+    if (!database->importDryRun(buildDirectory, &errorMessage)) {
+        qCWarning(CUSTOMMAKE) << errorMessage;
+        return {};
+    }
+    qCDebug(CUSTOMMAKE) << "indexed" << database->fileCount() << "files from a dry run in" << buildDirectory;
+
+    if (!database->save(databaseFile)) {
+        qCWarning(CUSTOMMAKE) << "could not store" << databaseFile;
+    }
+    return database;
+}
+
+void CustomMakeManager::loadDatabase(IProject* project)
+{
+    const QString projectPath = project->path().path();
+    const QString buildDirectory = project->path().toLocalFile();
+    // compile_commands.json is where bear and similar tools store their output by default
+    const QString compileCommandsFile = buildDirectory + QLatin1String("/compile_commands.json");
+    // see custommakeconfig.kcfg
+    const bool dryRun = KConfigGroup(project->projectConfiguration(), "CustomMakeManager").readEntry("ProjectWideDryRun", false);
+    if (!dryRun && !QFileInfo::exists(compileCommandsFile)) {
+        return;
+    }
+
+    // key the stored database by the project path, names of different projects can be the same
+    const QByteArray projectHash = QCryptographicHash::hash(projectPath.toUtf8(), QCryptographicHash::Md5).toHex();
+    const QString databaseFile = core()->activeSession()->pluginDataArea(this).toLocalFile()
+                               + QLatin1Char('/') + QString::fromLatin1(projectHash) + QLatin1String(".makefiledb");
+
+    using DatabaseWatcher = QFutureWatcher<QSharedPointer<const MakeFileDatabase>>;
+    auto* watcher = new DatabaseWatcher(this);
+    connect(watcher, &DatabaseWatcher::finished, this, [this, watcher, projectPath]() {
+        watcher->deleteLater();
+        const auto database = watcher->result();
+        if (!database) {
+            return;
+        }
+
+        QWriteLocker lock(&m_provider->m_lock);
+        if (m_projectPaths.contains(projectPath)) {
+            m_databases.insert(projectPath, database);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(createDatabase, buildDirectory, compileCommandsFile, databaseFile, dryRun));
+}
+
+int CustomMakeManager::perProjectConfigPages() const
+{
+    return 1;
+}
+
+ConfigPage* CustomMakeManager::perProjectConfigPage(int number, const ProjectConfigOptions& options, QWidget* parent)
+{
+    if (number == 0) {
+        return new CustomMakePreferences(this, options, parent);
+    }
+    return nullptr;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // private slots
 
@@ -323,6 +447,22 @@ void CustomMakeManager::projectClosing(IProject* project)
 {
     QWriteLocker lock(&m_provider->m_lock);
     m_projectPaths.remove(project->path().path());
+    m_databases.remove(project->path().path());
+}
+
+void CustomMakeManager::projectConfigurationChanged(IProject* project)
+{
+    const QString projectPath = project->path().path();
+    {
+        QWriteLocker lock(&m_provider->m_lock);
+        if (!m_projectPaths.contains(projectPath)) {
+            return;
+        }
+        // the project-wide dry run might just have been disabled
+        m_databases.remove(projectPath);
+    }
+
+    loadDatabase(project);
 }
 
 void CustomMakeManager::unload()
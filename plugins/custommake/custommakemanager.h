@@ -15,11 +15,14 @@
 #include <project/abstractfilemanagerplugin.h>
 #include <project/interfaces/ibuildsystemmanager.h>
 
+#include <QHash>
 #include <QScopedPointer>
 #include <QSet>
+#include <QSharedPointer>
 
 class IMakeBuilder;
 class CustomMakeProvider;
+class MakeFileDatabase;
 
 class CustomMakeManager : public KDevelop::AbstractFileManagerPlugin,
                           public KDevelop::IBuildSystemManager
@@ -115,6 +118,9 @@ public:
 
     KDevelop::Path compiler(KDevelop::ProjectTargetItem * p) const override;
 
+    int perProjectConfigPages() const override;
+    KDevelop::ConfigPage* perProjectConfigPage(int number, const KDevelop::ProjectConfigOptions& options, QWidget* parent) override;
+
 protected:
     KDevelop::ProjectFileItem* createFileItem(KDevelop::IProject* project,
                                                       const KDevelop::Path& path,
@@ -130,6 +136,8 @@ private Q_SLOTS:
 
     void projectClosing(KDevelop::IProject*);
 
+    void projectConfigurationChanged(KDevelop::IProject* project);
+
 private:
     /**
      * Initialize targets by reading Makefile in @arg dir
@@ -139,10 +147,18 @@ private:
 
     void createTargetItems(KDevelop::IProject* project, const KDevelop::Path& path, KDevelop::ProjectBaseItem* parent);
 
+    /**
+     * Fills the project-wide database of compiler flags in the background, from a
+     * compile_commands.json in the project root, or, if enabled on the project's
+     * configuration page, from a dry run of the whole build.
+     */
+    void loadDatabase(KDevelop::IProject* project);
+
 private:
     IMakeBuilder *m_builder = nullptr;
     QScopedPointer<CustomMakeProvider> m_provider;
     QSet<QString> m_projectPaths;
+    QHash<QString, QSharedPointer<const MakeFileDatabase>> m_databases;
     friend class CustomMakeProvider;
 };
 #endif
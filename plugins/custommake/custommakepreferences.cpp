@@ -0,0 +1,45 @@
+/* KDevelop Custom Makefile Support
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#include "custommakepreferences.h"
+
+#include "ui_custommakeconfig.h"
+#include "custommakeconfig.h"
+
+#include <KLocalizedString>
+
+using namespace KDevelop;
+
+CustomMakePreferences::CustomMakePreferences(IPlugin* plugin,
+                                             const ProjectConfigOptions& options,
+                                             QWidget* parent)
+    : ProjectConfigPage<CustomMakeSettings>(plugin, options, parent)
+{
+    m_prefsUi = new Ui::CustomMakeConfig;
+    m_prefsUi->setupUi(this);
+}
+
+CustomMakePreferences::~CustomMakePreferences()
+{
+    delete m_prefsUi;
+}
+
+QString CustomMakePreferences::name() const
+{
+    return i18nc("@title:tab", "Custom Makefile");
+}
+
+QString CustomMakePreferences::fullName() const
+{
+    return i18nc("@title:tab", "Configure Custom Makefile Settings");
+}
+
+QIcon CustomMakePreferences::icon() const
+{
+    return QIcon::fromTheme(QStringLiteral("text-x-makefile"));
+}
@@ -0,0 +1,37 @@
+/* KDevelop Custom Makefile Support
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef CUSTOMMAKEPREFERENCES_H
+#define CUSTOMMAKEPREFERENCES_H
+
+#include <project/projectconfigpage.h>
+
+#include "custommakeconfig.h"
+
+namespace Ui {
+class CustomMakeConfig;
+}
+
+class CustomMakePreferences
+    : public ProjectConfigPage<CustomMakeSettings>
+{
+    Q_OBJECT
+
+public:
+    explicit CustomMakePreferences(KDevelop::IPlugin* plugin, const KDevelop::ProjectConfigOptions& options, QWidget* parent = nullptr);
+    ~CustomMakePreferences() override;
+
+    QString name() const override;
+    QString fullName() const override;
+    QIcon icon() const override;
+
+private:
+    Ui::CustomMakeConfig* m_prefsUi;
+};
+
+#endif
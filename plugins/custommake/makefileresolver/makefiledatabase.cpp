@@ -0,0 +1,409 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public License
+ * as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "makefiledatabase.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStack>
+
+#include <KLocalizedString>
+#include <KProcess>
+#include <KShell>
+
+#include <algorithm>
+
+using namespace KDevelop;
+
+namespace {
+// bump whenever the format of the stored data changes
+const quint32 databaseFormatVersion = 2;
+
+// a dry run of a whole project takes a lot longer than one for a single directory
+const int dryRunTimeoutSeconds = 600;
+
+bool isSourceFile(const QStringRef& argument)
+{
+    const int dot = argument.lastIndexOf(QLatin1Char('.'));
+    if (dot == -1) {
+        return false;
+    }
+    const auto suffix = argument.mid(dot + 1);
+    return suffix == QLatin1String("c") || suffix == QLatin1String("cc") || suffix == QLatin1String("cpp")
+        || suffix == QLatin1String("cxx") || suffix == QLatin1String("c++") || suffix == QLatin1String("C")
+        || suffix == QLatin1String("m") || suffix == QLatin1String("mm") || suffix == QLatin1String("cu");
+}
+
+QStringList toStringList(const Path::List& paths)
+{
+    QStringList ret;
+    ret.reserve(paths.size());
+    for (const auto& path : paths) {
+        ret << path.toLocalFile();
+    }
+    return ret;
+}
+
+Path::List toPathList(const QStringList& paths, PathInterner& interner)
+{
+    Path::List ret;
+    ret.reserve(paths.size());
+    for (const auto& path : paths) {
+        ret << interner.internPath(path);
+    }
+    return ret;
+}
+
+/**
+ * Appends @p makefile and the files it includes to @p makefiles. Like make, relative
+ * names are resolved against the directory make runs in, not the one of the makefile.
+ */
+void collectMakefiles(const QString& makefile, const QDir& directory, QStringList& makefiles)
+{
+    if (makefiles.contains(makefile)) {
+        return;
+    }
+    makefiles << makefile;
+
+    QFile file(makefile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    static const QRegularExpression includeRx(QStringLiteral("^\\s*-?s?include\\s+(.*)$"));
+    while (!file.atEnd()) {
+        const QString line = QString::fromLocal8Bit(file.readLine());
+        const auto match = includeRx.match(line);
+        if (!match.hasMatch()) {
+            continue;
+        }
+        const auto names = match.captured(1).split(QRegularExpression(QStringLiteral("\\s+")), QString::SkipEmptyParts);
+        for (const auto& name : names) {
+            if (name.startsWith(QLatin1Char('#'))) {
+                break;
+            }
+            // we don't know the values of variables, and dependency files don't contain rules
+            if (name.contains(QLatin1Char('$')) || name.endsWith(QLatin1String(".d"))) {
+                continue;
+            }
+            const QString path = QDir::cleanPath(directory.absoluteFilePath(name));
+            if (QFileInfo(path).isFile()) {
+                collectMakefiles(path, directory, makefiles);
+            }
+        }
+    }
+}
+}
+
+void MakeFileDatabase::clear()
+{
+    m_flags.clear();
+    m_fileFlags.clear();
+    m_directoryFlags.clear();
+    m_commandFlags.clear();
+    m_makefiles.clear();
+}
+
+bool MakeFileDatabase::isEmpty() const
+{
+    return m_fileFlags.isEmpty();
+}
+
+int MakeFileDatabase::fileCount() const
+{
+    return m_fileFlags.size();
+}
+
+QStringList MakeFileDatabase::makefiles() const
+{
+    return m_makefiles;
+}
+
+bool MakeFileDatabase::makefilesChangedSince(const QDateTime& time) const
+{
+    return std::any_of(m_makefiles.begin(), m_makefiles.end(), [&time](const QString& makefile) {
+        const QFileInfo info(makefile);
+        return !info.exists() || info.lastModified() > time;
+    });
+}
+
+void MakeFileDatabase::addMakefiles(const QString& directory)
+{
+    // the names make looks for, in this order
+    const QDir dir(directory);
+    for (const auto* name : {"GNUmakefile", "makefile", "Makefile"}) {
+        const QString makefile = dir.filePath(QLatin1String(name));
+        if (QFileInfo(makefile).isFile()) {
+            collectMakefiles(makefile, dir, m_makefiles);
+            return;
+        }
+    }
+}
+
+bool MakeFileDatabase::addCompilerInvocation(const QString& command, const QString& workingDirectory, const QString& file)
+{
+    // keep quoted arguments, e.g. paths with spaces, in one piece
+    KShell::Errors error;
+    QStringList arguments = KShell::splitArgs(command, KShell::NoOptions, &error);
+    if (error != KShell::NoError) {
+        arguments = command.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    }
+    const bool compiles = arguments.contains(QStringLiteral("-c"));
+    if (!compiles) {
+        return false;
+    }
+
+    // the key is everything but the source and the output file, so all files
+    // compiled with the same flags in the same directory share one entry
+    QString key = workingDirectory;
+    QString sourceFile = file;
+    for (int i = 0; i < arguments.size(); ++i) {
+        const auto& argument = arguments.at(i);
+        if (argument == QLatin1String("-o")) {
+            ++i;
+            continue;
+        }
+        if (isSourceFile(QStringRef(&argument))) {
+            const QString path = QDir::cleanPath(QDir(workingDirectory).absoluteFilePath(argument));
+            if (file.isEmpty() ? sourceFile.isEmpty() : path == file) {
+                sourceFile = path;
+                continue;
+            }
+        }
+        key += QLatin1Char(' ');
+        key += argument;
+    }
+
+    if (sourceFile.isEmpty()) {
+        return false;
+    }
+
+    int index = m_commandFlags.value(key, -1);
+    if (index == -1) {
+        // processOutput expects the arguments to be surrounded by whitespace
+        const auto result = m_resolver.processOutput(QLatin1Char(' ') + command + QLatin1Char(' '), workingDirectory);
+        index = m_flags.size();
+        m_flags.append({result.paths, result.frameworkDirectories, result.defines});
+        m_commandFlags.insert(key, index);
+    }
+
+    m_fileFlags.insert(sourceFile, index);
+    const QString directory = sourceFile.left(sourceFile.lastIndexOf(QLatin1Char('/')));
+    if (!m_directoryFlags.contains(directory)) {
+        m_directoryFlags.insert(directory, index);
+    }
+    return true;
+}
+
+void MakeFileDatabase::importMakeOutput(const QString& output, const QString& workingDirectory)
+{
+    static const QRegularExpression directoryRx(
+        QStringLiteral("^\\S*make(?:\\[\\d+\\])?: (Entering|Leaving) directory [`'\"](.*)['\"]$"));
+    static const QRegularExpression separatorRx(QStringLiteral("&&|;"));
+
+    QString fullOutput = output;
+    fullOutput.remove(QStringLiteral("\\\n"));
+
+    QStack<QString> directories;
+    QString currentDirectory = workingDirectory;
+    QStringList enteredDirectories = {workingDirectory};
+
+    const auto lines = fullOutput.splitRef(QLatin1Char('\n'), QString::SkipEmptyParts);
+    for (const auto& line : lines) {
+        const auto match = directoryRx.match(line);
+        if (match.hasMatch()) {
+            if (match.capturedRef(1) == QLatin1String("Entering")) {
+                directories.push(currentDirectory);
+                currentDirectory = match.captured(2);
+                if (!enteredDirectories.contains(currentDirectory)) {
+                    enteredDirectories << currentDirectory;
+                }
+            } else if (!directories.isEmpty()) {
+                currentDirectory = directories.pop();
+            }
+            continue;
+        }
+
+        // handle "cd foo && gcc ..." style recipes
+        QString lineDirectory = currentDirectory;
+        const auto commands = line.toString().split(separatorRx, QString::SkipEmptyParts);
+        for (const auto& command : commands) {
+            const auto trimmed = command.trimmed();
+            if (trimmed.startsWith(QLatin1String("cd "))) {
+                lineDirectory = QDir::cleanPath(QDir(lineDirectory).absoluteFilePath(trimmed.mid(3).trimmed()));
+            } else {
+                addCompilerInvocation(trimmed, lineDirectory);
+            }
+        }
+    }
+
+    for (const auto& directory : qAsConst(enteredDirectories)) {
+        addMakefiles(directory);
+    }
+}
+
+bool MakeFileDatabase::importDryRun(const QString& buildDirectory, QString* errorMessage)
+{
+    KProcess proc;
+    proc.setWorkingDirectory(buildDirectory);
+    proc.setOutputChannelMode(KProcess::OnlyStdoutChannel);
+    // -B: print the commands of all targets, also the ones which are up to date
+    // -w: print the directory changes of recursive make calls
+    proc.setProgram(QStringLiteral("make"), {QStringLiteral("-k"), QStringLiteral("-n"), QStringLiteral("-B"), QStringLiteral("-w")});
+
+    const int status = proc.execute(dryRunTimeoutSeconds * 1000);
+    if (status < 0) {
+        if (errorMessage) {
+            *errorMessage = i18n("Failed to run make in folder \"%1\"", buildDirectory);
+        }
+        return false;
+    }
+
+    // with -k, make returns an error as soon as one target can't be made, the output is still useful
+    importMakeOutput(QString::fromLocal8Bit(proc.readAllStandardOutput()), buildDirectory);
+
+    if (isEmpty()) {
+        if (errorMessage) {
+            *errorMessage = i18n("Could not find any compiler invocations in the output of make in folder \"%1\"", buildDirectory);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool MakeFileDatabase::importCompileCommands(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const auto document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isArray()) {
+        return false;
+    }
+
+    const QString KEY_ARGUMENTS = QStringLiteral("arguments");
+    const QString KEY_COMMAND = QStringLiteral("command");
+    const QString KEY_DIRECTORY = QStringLiteral("directory");
+    const QString KEY_FILE = QStringLiteral("file");
+    const auto entries = document.array();
+    for (const auto& value : entries) {
+        const auto entry = value.toObject();
+        const QString directory = entry[KEY_DIRECTORY].toString();
+        // bear writes the arguments as an array, CMake as one command line
+        QString command = entry[KEY_COMMAND].toString();
+        if (command.isEmpty()) {
+            const auto argumentValues = entry[KEY_ARGUMENTS].toArray();
+            QStringList arguments;
+            arguments.reserve(argumentValues.size());
+            for (const auto& argument : argumentValues) {
+                arguments << argument.toString();
+            }
+            command = KShell::joinArgs(arguments);
+        }
+        const QString sourceFile = QDir::cleanPath(QDir(directory).absoluteFilePath(entry[KEY_FILE].toString()));
+        addCompilerInvocation(command, directory, sourceFile);
+    }
+
+    return !isEmpty();
+}
+
+PathResolutionResult MakeFileDatabase::resolve(const QString& file) const
+{
+    int index = m_fileFlags.value(file, -1);
+    if (index == -1) {
+        index = m_directoryFlags.value(file.left(file.lastIndexOf(QLatin1Char('/'))), -1);
+        if (index == -1) {
+            return PathResolutionResult(false, i18n("No compiler invocation known for %1", file));
+        }
+    }
+
+    const auto& flags = m_flags.at(index);
+    PathResolutionResult ret(true);
+    ret.paths = flags.paths;
+    ret.frameworkDirectories = flags.frameworkDirectories;
+    ret.defines = flags.defines;
+    return ret;
+}
+
+bool MakeFileDatabase::load(const QString& filePath)
+{
+    clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 version = 0;
+    stream >> version;
+    if (stream.status() != QDataStream::Ok || version != databaseFormatVersion) {
+        return false;
+    }
+
+    PathInterner interner;
+    qint32 flagsCount = 0;
+    stream >> flagsCount;
+    for (qint32 i = 0; i < flagsCount && stream.status() == QDataStream::Ok; ++i) {
+        QStringList paths, frameworkDirectories;
+        QHash<QString, QString> defines;
+        stream >> paths >> frameworkDirectories >> defines;
+        m_flags.append({toPathList(paths, interner), toPathList(frameworkDirectories, interner), defines});
+    }
+    stream >> m_fileFlags >> m_directoryFlags >> m_commandFlags >> m_makefiles;
+
+    if (stream.status() != QDataStream::Ok) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool MakeFileDatabase::save(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << databaseFormatVersion << static_cast<qint32>(m_flags.size());
+    for (const auto& flags : m_flags) {
+        stream << toStringList(flags.paths) << toStringList(flags.frameworkDirectories) << flags.defines;
+    }
+    stream << m_fileFlags << m_directoryFlags << m_commandFlags << m_makefiles;
+
+    return file.commit();
+}
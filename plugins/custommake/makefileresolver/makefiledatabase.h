@@ -0,0 +1,116 @@
+/*
+ * This file is part of KDevelop
+ *
+ * Copyright 2020 The KDevelop developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public License
+ * as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MAKEFILEDATABASE_H
+#define MAKEFILEDATABASE_H
+
+#include "makefileresolver.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QDateTime;
+
+/**
+ * Project-wide index of the include paths and defines of all files built by a Makefile.
+ *
+ * Instead of running make once per directory like MakeFileResolver does, the database
+ * is filled in one pass from a dry run of the whole build, or from a compilation database
+ * as written by tools like bear. All files compiled with the same flags share one entry.
+ *
+ * Once filled, the database is only read, so it can be shared between threads.
+ */
+class MakeFileDatabase
+{
+public:
+    /**
+     * Runs a dry run of the complete build in @p buildDirectory and indexes
+     * all compiler invocations of its output.
+     */
+    bool importDryRun(const QString& buildDirectory, QString* errorMessage = nullptr);
+
+    /**
+     * Indexes the compiler invocations in the output of "make -n -w",
+     * which was run in @p workingDirectory.
+     */
+    void importMakeOutput(const QString& output, const QString& workingDirectory);
+
+    /**
+     * Indexes all entries of a compile_commands.json file.
+     */
+    bool importCompileCommands(const QString& filePath);
+
+    bool load(const QString& filePath);
+    bool save(const QString& filePath) const;
+
+    bool isEmpty() const;
+    int fileCount() const;
+
+    /**
+     * @return the makefiles read by the dry run the database was filled from: the makefile of every
+     * directory make entered, and the files they include. Includes whose names contain variables
+     * are not expanded and thus not part of the list.
+     */
+    QStringList makefiles() const;
+
+    /**
+     * @return whether one of the makefiles() was modified or removed after @p time
+     */
+    bool makefilesChangedSince(const QDateTime& time) const;
+
+    /**
+     * @return the include paths and defines of @p file, or those of another file in the
+     * same directory if @p file itself is not known. The result is unsuccessful if neither is known.
+     */
+    PathResolutionResult resolve(const QString& file) const;
+
+private:
+    struct Flags
+    {
+        KDevelop::Path::List paths;
+        KDevelop::Path::List frameworkDirectories;
+        QHash<QString, QString> defines;
+    };
+
+    /**
+     * Indexes one compiler invocation. If @p file is empty, the source file
+     * is taken from the command, otherwise it must be absolute.
+     * @return false if the command doesn't compile a source file
+     */
+    bool addCompilerInvocation(const QString& command, const QString& workingDirectory, const QString& file = QString());
+    /// adds the makefile make reads in @p directory, and recursively the files it includes
+    void addMakefiles(const QString& directory);
+    void clear();
+
+    QVector<Flags> m_flags;
+    /// maps absolute file paths to their index in m_flags
+    QHash<QString, int> m_fileFlags;
+    /// maps directories to the flags of the first file seen in them
+    QHash<QString, int> m_directoryFlags;
+    /// maps the working directory and command without the source file to their index in m_flags
+    QHash<QString, int> m_commandFlags;
+    QStringList m_makefiles;
+    MakeFileResolver m_resolver;
+};
+
+#endif
@@ -25,11 +25,13 @@
 #include <QTextStream>
 #include <QDebug>
 #include <QTemporaryDir>
+#include <QDateTime>
 
 #include <tests/autotestshell.h>
 #include <tests/testcore.h>
 
 #include "../makefileresolver.h"
+#include "../makefiledatabase.h"
 
 #include <QTest>
 
@@ -120,6 +122,114 @@ void TestCustomMake::testDefines()
     QCOMPARE(result.defines.value("X", "not found"), QString("not found"));
 }
 
+void TestCustomMake::testDatabase()
+{
+    const QString output =
+        "make: Entering directory '/project'\n"
+        "make[1]: Entering directory '/project/lib'\n"
+        "g++ -DLIB -I/project/include \\\n -Iinternal -c -o a.o a.cpp\n"
+        "g++ -DLIB -I/project/include -Iinternal -c -o b.o b.cpp\n"
+        "make[1]: Leaving directory '/project/lib'\n"
+        "cd app && gcc -DAPP=1 -iframework /Frameworks -c main.c -o main.o\n"
+        "g++ -o app app/main.o lib/a.o lib/b.o\n"
+        "make: Leaving directory '/project'\n";
+
+    MakeFileDatabase database;
+    database.importMakeOutput(output, "/");
+    QCOMPARE(database.fileCount(), 3);
+
+    auto result = database.resolve("/project/lib/a.cpp");
+    QVERIFY(result.success);
+    QCOMPARE(result.paths, Path::List({Path("/project/include"), Path("/project/lib/internal")}));
+    QCOMPARE(result.defines.value("LIB", "not found"), QString());
+    QCOMPARE(database.resolve("/project/lib/b.cpp").paths, result.paths);
+
+    // unknown files in known directories use the flags of their neighbors
+    QCOMPARE(database.resolve("/project/lib/c.cpp").paths, result.paths);
+    QVERIFY(!database.resolve("/project/unknown/c.cpp").success);
+
+    result = database.resolve("/project/app/main.c");
+    QVERIFY(result.success);
+    QCOMPARE(result.frameworkDirectories, Path::List{Path("/Frameworks")});
+    QCOMPARE(result.defines.value("APP"), QString("1"));
+
+    QTemporaryDir tempDir;
+    const QString databaseFile = tempDir.path() + "/database";
+    QVERIFY(database.save(databaseFile));
+
+    MakeFileDatabase loadedDatabase;
+    QVERIFY(loadedDatabase.load(databaseFile));
+    QCOMPARE(loadedDatabase.fileCount(), 3);
+    QCOMPARE(loadedDatabase.resolve("/project/lib/b.cpp").paths, database.resolve("/project/lib/b.cpp").paths);
+    QCOMPARE(loadedDatabase.resolve("/project/app/main.c").defines, result.defines);
+}
+
+void TestCustomMake::testDatabaseMakefiles()
+{
+    QTemporaryDir tempDir;
+    const QString dir = tempDir.path();
+    auto writeFile = [](const QString& fileName, const QByteArray& contents) {
+        QFile file(fileName);
+        createFile(file);
+        file.write(contents);
+    };
+    writeFile(dir + "/Makefile", "include rules.mk # comment.mk\n-include $(DEPS) missing.mk\nall:\n\tgcc -c a.c\n");
+    writeFile(dir + "/rules.mk", "sinclude common.mk\n");
+    writeFile(dir + "/common.mk", "CFLAGS = -O2\n");
+
+    MakeFileDatabase database;
+    database.importMakeOutput("gcc -c a.c -o a.o\n", dir);
+    QCOMPARE(database.fileCount(), 1);
+    QCOMPARE(database.makefiles(), QStringList({dir + "/Makefile", dir + "/rules.mk", dir + "/common.mk"}));
+
+    const auto now = QDateTime::currentDateTime();
+    QVERIFY(!database.makefilesChangedSince(now.addSecs(60)));
+    QVERIFY(database.makefilesChangedSince(now.addSecs(-60)));
+
+    // the makefiles are stored together with the flags
+    const QString databaseFile = dir + "/database";
+    QVERIFY(database.save(databaseFile));
+    MakeFileDatabase loadedDatabase;
+    QVERIFY(loadedDatabase.load(databaseFile));
+    QCOMPARE(loadedDatabase.makefiles(), database.makefiles());
+
+    // changes to included makefiles are noticed, too
+    QVERIFY(QFile::remove(dir + "/common.mk"));
+    QVERIFY(loadedDatabase.makefilesChangedSince(now.addSecs(60)));
+}
+
+void TestCustomMake::testDatabaseCompileCommands()
+{
+    QTemporaryDir tempDir;
+    const QString compileCommandsFile = tempDir.path() + "/compile_commands.json";
+    QFile file(compileCommandsFile);
+    createFile(file);
+    // as written by bear, with arguments containing spaces
+    file.write("[\n"
+               "  {\"arguments\": [\"g++\", \"-DFOO\", \"-I/include\", \"-c\", \"-o\", \"a.o\", \"my file.cpp\"],\n"
+               "   \"directory\": \"/project\", \"file\": \"my file.cpp\"},\n"
+               "  {\"arguments\": [\"g++\", \"-DFOO\", \"-I/include\", \"-c\", \"-o\", \"b.o\", \"b.cpp\"],\n"
+               "   \"directory\": \"/project\", \"file\": \"b.cpp\"},\n"
+               "  {\"command\": \"gcc -DBAR -c /project/c.c\", \"directory\": \"/project\", \"file\": \"c.c\"}\n"
+               "]\n");
+    file.close();
+
+    MakeFileDatabase database;
+    QVERIFY(database.importCompileCommands(compileCommandsFile));
+    QCOMPARE(database.fileCount(), 3);
+
+    auto result = database.resolve("/project/my file.cpp");
+    QVERIFY(result.success);
+    QCOMPARE(result.paths, Path::List{Path("/include")});
+    QVERIFY(result.defines.contains("FOO"));
+    QCOMPARE(database.resolve("/project/b.cpp").paths, result.paths);
+
+    result = database.resolve("/project/c.c");
+    QVERIFY(result.success);
+    QVERIFY(result.defines.contains("BAR"));
+    QVERIFY(!result.defines.contains("FOO"));
+}
+
 QTEST_GUILESS_MAIN(TestCustomMake)
 
 #include "moc_test_custommake.cpp"
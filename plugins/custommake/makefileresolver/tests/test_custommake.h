@@ -34,6 +34,9 @@ private Q_SLOTS:
     void testIncludeDirectories();
     void testFrameworkDirectories();
     void testDefines();
+    void testDatabase();
+    void testDatabaseMakefiles();
+    void testDatabaseCompileCommands();
 };
 
 #endif // TEST_CUSTOMMAKE_H
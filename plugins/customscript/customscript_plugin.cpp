@@ -25,11 +25,13 @@
 #include <QTemporaryFile>
 #include <QMimeDatabase>
 #include <KProcess>
+#include <KShell>
 #include <interfaces/icore.h>
 #include <interfaces/isourceformattercontroller.h>
 #include <interfaces/isourceformatter.h>
 #include <memory>
 #include <QDir>
+#include <QMutexLocker>
 #include <QTimer>
 
 #include <util/formattinghelpers.h>
@@ -48,6 +50,10 @@ using namespace KDevelop;
 
 static QPointer<CustomScriptPlugin> indentPluginSingleton;
 
+// How long an indentation computed from a sample is reused, so changes of configuration files
+// of the formatter, which are not part of the style, still become effective soon
+static const qint64 indentationCacheTimeout = 60000;
+
 K_PLUGIN_FACTORY_WITH_JSON(CustomScriptFactory, "kdevcustomscript.json", registerPlugin<CustomScriptPlugin>(); )
 
 // Replaces ${KEY} in command with variables[KEY]
@@ -76,6 +82,20 @@ CustomScriptPlugin::CustomScriptPlugin(QObject* parent, const QVariantList&)
     : IPlugin(QStringLiteral("kdevcustomscript"), parent)
 {
     indentPluginSingleton = this;
+
+    auto* projectController = ICore::self()->projectController();
+    const auto projects = projectController->projects();
+    for (IProject* project : projects) {
+        m_projectVariables[project->name()] = project->path().toUrl().toLocalFile();
+    }
+    connect(projectController, &IProjectController::projectOpened, this, [this](IProject* project) {
+        QMutexLocker lock(&m_projectVariablesMutex);
+        m_projectVariables[project->name()] = project->path().toUrl().toLocalFile();
+    });
+    connect(projectController, &IProjectController::projectClosed, this, [this](IProject* project) {
+        QMutexLocker lock(&m_projectVariablesMutex);
+        m_projectVariables.remove(project->name());
+    });
 }
 
 CustomScriptPlugin::~CustomScriptPlugin()
@@ -123,9 +143,9 @@ QString CustomScriptPlugin::formatSourceWithStyle(SourceFormatterStyle style, co
     useText = leftContext + useText + rightContext;
 
     QMap<QString, QString> projectVariables;
-    const auto projects = ICore::self()->projectController()->projects();
-    for (IProject* project : projects) {
-        projectVariables[project->name()] = project->path().toUrl().toLocalFile();
+    {
+        QMutexLocker lock(&m_projectVariablesMutex);
+        projectVariables = m_projectVariables;
     }
 
     QString command = style.content();
@@ -152,8 +172,17 @@ QString CustomScriptPlugin::formatSourceWithStyle(SourceFormatterStyle style, co
         tmpFile->close();
     }
 
-    qCDebug(CUSTOMSCRIPT) << "using shell command for indentation: " << command;
-    proc.setShellCommand(command);
+    // Starting the formatter through a shell costs an extra process for every call,
+    // which is only needed if the command uses shell syntax
+    KShell::Errors splitError;
+    const QStringList arguments = KShell::splitArgs(command, KShell::TildeExpand | KShell::AbortOnMeta, &splitError);
+    if (splitError == KShell::NoError && !arguments.isEmpty()) {
+        qCDebug(CUSTOMSCRIPT) << "using command for indentation: " << arguments;
+        proc.setProgram(arguments);
+    } else {
+        qCDebug(CUSTOMSCRIPT) << "using shell command for indentation: " << command;
+        proc.setShellCommand(command);
+    }
     proc.setOutputChannelMode(KProcess::OnlyStdoutChannel);
 
     proc.start();
@@ -209,6 +238,11 @@ QString CustomScriptPlugin::formatSource(const QString& text, const QUrl& url, c
     return formatSourceWithStyle(style, text, url, mime, leftContext, rightContext);
 }
 
+bool CustomScriptPlugin::isThreadSafe() const
+{
+    return true;
+}
+
 static QVector<SourceFormatterStyle> stylesFromLanguagePlugins()
 {
     QVector<KDevelop::SourceFormatterStyle> styles;
@@ -446,6 +480,31 @@ QStringList CustomScriptPlugin::computeIndentationFromSample(const QUrl& url) co
 }
 
 CustomScriptPlugin::Indentation CustomScriptPlugin::indentation(const QUrl& url) const
+{
+    // Computing the indentation runs the formatter on a sample, and it is needed whenever a document
+    // is loaded or formatted, so remember it for every style and directory for a while
+    const QMimeType mime = QMimeDatabase().mimeTypeForUrl(url);
+    const auto style = ICore::self()->sourceFormatterController()->styleForUrl(url, mime);
+    const QString key = mime.name() + QLatin1Char('\n') + style.name() + QLatin1Char('\n') + style.content()
+                        + QLatin1Char('\n') + url.adjusted(QUrl::RemoveFilename).toString();
+    {
+        QMutexLocker lock(&m_indentationCacheMutex);
+        const auto it = m_indentationCache.constFind(key);
+        if (it != m_indentationCache.constEnd() && !it->age.hasExpired(indentationCacheTimeout)) {
+            return it->indentation;
+        }
+    }
+
+    CachedIndentation cached;
+    cached.indentation = computeIndentation(url);
+    cached.age.start();
+
+    QMutexLocker lock(&m_indentationCacheMutex);
+    m_indentationCache.insert(key, cached);
+    return cached.indentation;
+}
+
+CustomScriptPlugin::Indentation CustomScriptPlugin::computeIndentation(const QUrl& url) const
 {
     Indentation ret;
     QStringList indent = computeIndentationFromSample(url);
@@ -28,6 +28,10 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
 
 class QTimer;
 
@@ -55,6 +59,10 @@ public:
                                   const QString& leftContext = QString(),
                                   const QString& rightContext = QString()) const override;
 
+    /** The formatting runs in an external process, so it can be done in parallel.
+     */
+    bool isThreadSafe() const override;
+
     /** \return A map of predefined styles (a key and a caption for each type)
      */
     QVector<KDevelop::SourceFormatterStyle> predefinedStyles() const override;
@@ -73,7 +81,21 @@ public:
 
 private:
     QStringList computeIndentationFromSample(const QUrl& url) const;
+    Indentation computeIndentation(const QUrl& url) const;
     KDevelop::SourceFormatterStyle predefinedStyle(const QString& name) const;
+
+    // Paths of the open projects by their names, for the ${Project} variables of the commands.
+    // Kept up to date in the main thread, so formatting in other threads does not have to access the projects.
+    mutable QMutex m_projectVariablesMutex;
+    QMap<QString, QString> m_projectVariables;
+
+    struct CachedIndentation
+    {
+        Indentation indentation;
+        QElapsedTimer age;
+    };
+    mutable QMutex m_indentationCacheMutex;
+    mutable QHash<QString, CachedIndentation> m_indentationCache;
 };
 
 class CustomScriptPreferences
@@ -102,6 +102,7 @@ namespace KDevMI { namespace MI {
         StackListArguments,
         StackListFrames,
         StackListLocals,
+        StackListVariables,
         StackSelectFrame,
 
         SymbolListLines,
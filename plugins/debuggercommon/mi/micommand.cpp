@@ -269,6 +269,8 @@ QString MICommand::miCommand() const
             return QStringLiteral("-stack-list-frames");
         case StackListLocals:
             return QStringLiteral("-stack-list-locals");
+        case StackListVariables:
+            return QStringLiteral("-stack-list-variables");
         case StackSelectFrame:
             return QStringLiteral("-stack-select-frame");
 
@@ -825,7 +825,7 @@ void MIDebugSession::executeCmd()
                                  && currentCmd->type() != MI::VarDelete);
 
     bool stackCommandWithContext = (currentCmd->type() >= MI::StackInfoDepth
-                                    && currentCmd->type() <= MI::StackListLocals);
+                                    && currentCmd->type() <= MI::StackListVariables);
 
     if (varCommandWithContext || stackCommandWithContext) {
         // Most var commands should be executed in the context
@@ -85,8 +85,9 @@ private:
     QString m_varobj;
 
     // How many children should be fetched in one
-    // increment.
-    static const int s_fetchStep = 5;
+    // increment. Roughly one screen of the variables view, further
+    // pages are only requested when the "..." item is shown.
+    static const int s_fetchStep = 100;
 };
 } // end of KDevMI
 
@@ -107,70 +107,44 @@ void MIVariableController::handleVarUpdate(const ResultRecord& r)
     }
 }
 
-class StackListArgumentsHandler : public MICommandHandler
+class StackListVariablesHandler : public MICommandHandler
 {
 public:
-    explicit StackListArgumentsHandler(const QStringList& localsName)
-        : m_localsName(localsName)
-    {}
-
     void handle(const ResultRecord &r) override
     {
         if (!KDevelop::ICore::self()->debugController()) return; //happens on shutdown
 
-        if (r.hasField(QStringLiteral("stack-args")) && r[QStringLiteral("stack-args")].size() > 0) {
-            const Value& locals = r[QStringLiteral("stack-args")][0][QStringLiteral("args")];
-
-            m_localsName.reserve(m_localsName.size() + locals.size());
-            for (int i = 0; i < locals.size(); i++) {
-                m_localsName << locals[i].literal();
-            }
-            const QList<Variable*> variables = KDevelop::ICore::self()->debugController()->variableCollection()
-                    ->locals()->updateLocals(m_localsName);
-            for (Variable* v : variables) {
-                v->attachMaybe();
+        if (r.hasField(QStringLiteral("variables"))) {
+            const Value& variables = r[QStringLiteral("variables")];
+
+            // the arguments are reported first, but have always been shown after the locals
+            QStringList localsName, argumentsName;
+            localsName.reserve(variables.size());
+            for (int i = 0; i < variables.size(); i++) {
+                const Value& var = variables[i];
+                if (var.hasField(QStringLiteral("arg"))) {
+                    argumentsName << var[QStringLiteral("name")].literal();
+                } else {
+                    localsName << var[QStringLiteral("name")].literal();
+                }
             }
-        }
-    }
-
-private:
-    QStringList m_localsName;
-};
+            localsName += argumentsName;
 
-class StackListLocalsHandler : public MICommandHandler
-{
-public:
-    explicit StackListLocalsHandler(MIDebugSession *session)
-        : m_session(session)
-    {}
-
-    void handle(const ResultRecord &r) override
-    {
-        if (r.hasField(QStringLiteral("locals"))) {
-            const Value& locals = r[QStringLiteral("locals")];
-
-            QStringList localsName;
-            localsName.reserve(locals.size());
-            for (int i = 0; i < locals.size(); i++) {
-                const Value& var = locals[i];
-                localsName << var[QStringLiteral("name")].literal();
+            const QList<Variable*> newVariables = KDevelop::ICore::self()->debugController()->variableCollection()
+                    ->locals()->updateLocals(localsName);
+            for (Variable* v : newVariables) {
+                v->attachMaybe();
             }
-            int frame = m_session->frameStackModel()->currentFrame();
-            m_session->addCommand(StackListArguments,
-                                // do not show value, low-frame, high-frame
-                                QStringLiteral("0 %1 %2").arg(frame).arg(frame),
-                                new StackListArgumentsHandler(localsName));
         }
     }
-
-private:
-    MIDebugSession *m_session;
 };
 
 void MIVariableController::updateLocals()
 {
-    debugSession()->addCommand(StackListLocals, QStringLiteral("--simple-values"),
-                               new StackListLocalsHandler(debugSession()));
+    // one command for both locals and arguments of the current frame, instead of
+    // -stack-list-locals followed by -stack-list-arguments on every stop
+    debugSession()->addCommand(StackListVariables, QStringLiteral("--no-values"),
+                               new StackListVariablesHandler);
 }
 
 Range MIVariableController::expressionRangeUnderCursor(Document* doc, const Cursor& cursor)
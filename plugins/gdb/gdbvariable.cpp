@@ -23,12 +23,56 @@
 #include "gdbvariable.h"
 
 #include "debugsession.h"
+#include "mi/micommand.h"
 
 using namespace KDevelop;
+using namespace KDevMI;
 using namespace KDevMI::GDB;
+using namespace KDevMI::MI;
 
 GdbVariable::GdbVariable(DebugSession *session, TreeModel *model, TreeItem *parent,
                          const QString& expression, const QString& display)
     : MIVariable(session, model, parent, expression, display)
 {
+    connect(this, &TreeItem::collapsed, this, [this]() { setFrozen(true); });
+    connect(this, &TreeItem::expanded, this, [this]() { setFrozen(false); });
+}
+
+void GdbVariable::setFrozen(bool frozen)
+{
+    if (frozen == m_frozen || !sessionIsAlive() || varobj().isEmpty()) {
+        return;
+    }
+
+    if (frozen) {
+        // A frozen varobj does not update its own value either, which is only
+        // fine for structs and arrays, their value is just "{...}" or "[n]".
+        const QString currentValue = value();
+        if (childCount() == 0
+            || !(currentValue.startsWith(QLatin1Char('{')) || currentValue.startsWith(QLatin1Char('[')))) {
+            return;
+        }
+    }
+
+    m_frozen = frozen;
+    m_debugSession->addCommand(VarSetFrozen, QStringLiteral("\"%1\" %2").arg(varobj()).arg(frozen ? 1 : 0));
+
+    if (!frozen) {
+        // unfreezing does not update the varobjs, only the next -var-update does
+        QPointer<MIDebugSession> session = m_debugSession;
+        m_debugSession->addCommand(VarUpdate, QStringLiteral("--all-values \"%1\"").arg(varobj()),
+                                   [session](const ResultRecord& r) {
+            if (!session) {
+                return;
+            }
+            const Value& changed = r[QStringLiteral("changelist")];
+            for (int i = 0; i < changed.size(); ++i) {
+                const Value& var = changed[i];
+                MIVariable* v = session->findVariableByVarobjName(var[QStringLiteral("name")].literal());
+                if (v) {
+                    v->handleUpdate(var);
+                }
+            }
+        });
+    }
 }
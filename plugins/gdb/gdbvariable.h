@@ -39,6 +39,16 @@ class GdbVariable : public KDevMI::MIVariable
 public:
     GdbVariable(DebugSession *session, KDevelop::TreeModel* model, KDevelop::TreeItem* parent,
                 const QString& expression, const QString& display = QString());
+
+private:
+    /**
+     * A frozen varobj and its children are skipped by "-var-update *", so the
+     * children of collapsed variables are not evaluated again on every stop.
+     * Thawing updates them once.
+     */
+    void setFrozen(bool frozen);
+
+    bool m_frozen = false;
 };
 
 } // end of namespace GDB
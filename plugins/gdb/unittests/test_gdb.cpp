@@ -1049,6 +1049,44 @@ void GdbTest::testVariablesLocalsStruct()
     WAIT_FOR_STATE(session, DebugSession::EndedState);
 }
 
+void GdbTest::testVariablesCollapsedStruct()
+{
+    auto *session = new TestDebugSession;
+    KDevelop::ICore::self()->debugController()->variableCollection()->variableWidgetShown();
+
+    TestLaunchConfiguration cfg;
+
+    breakpoints()->addCodeBreakpoint(QUrl::fromLocalFile(debugeeFileName), 39);
+    QVERIFY(session->startDebugging(&cfg, m_iface));
+    WAIT_FOR_STATE(session, DebugSession::PausedState);
+
+    variableCollection()->watches()->add(QStringLiteral("ts"));
+    QTest::qWait(300);
+
+    QModelIndex i = variableCollection()->index(0, 0);
+    QModelIndex ts = variableCollection()->index(0, 0, i);
+    variableCollection()->expanded(ts);
+    QTest::qWait(100);
+    COMPARE_DATA(variableCollection()->index(0, 0, ts), "a");
+    COMPARE_DATA(variableCollection()->index(0, 1, ts), "0");
+
+    // the collapsed struct is frozen, so its children are not updated while stepping
+    variableCollection()->collapsed(ts);
+    session->stepInto();
+    WAIT_FOR_STATE(session, DebugSession::PausedState);
+    QTest::qWait(100);
+    COMPARE_DATA(variableCollection()->index(0, 1, i), "{...}");
+
+    // expanding it again updates the children
+    variableCollection()->expanded(ts);
+    QTest::qWait(100);
+    COMPARE_DATA(variableCollection()->index(0, 0, ts), "a");
+    COMPARE_DATA(variableCollection()->index(0, 1, ts), "1");
+
+    session->run();
+    WAIT_FOR_STATE(session, DebugSession::EndedState);
+}
+
 void GdbTest::testVariablesWatches()
 {
     auto *session = new TestDebugSession;
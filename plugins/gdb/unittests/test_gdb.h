@@ -68,6 +68,7 @@ private Q_SLOTS:
     void testCoreFile();
     void testVariablesLocals();
     void testVariablesLocalsStruct();
+    void testVariablesCollapsedStruct();
     void testVariablesWatches();
     void testVariablesWatchesQuotes();
     void testVariablesWatchesTwoSessions();
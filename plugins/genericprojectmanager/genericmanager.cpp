@@ -30,4 +30,11 @@ GenericProjectManager::GenericProjectManager( QObject* parent, const QVariantLis
 {
 }
 
+bool GenericProjectManager::storesFilesCompactly(IProject* project) const
+{
+    Q_UNUSED(project);
+    // generic projects have no build system which cares about individual files
+    return true;
+}
+
 #include "genericmanager.moc"
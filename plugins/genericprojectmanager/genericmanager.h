@@ -28,6 +28,9 @@ class GenericProjectManager: public KDevelop::AbstractFileManagerPlugin
 
 public:
     explicit GenericProjectManager( QObject* parent = nullptr, const QVariantList& args = QVariantList() );
+
+protected:
+    bool storesFilesCompactly(KDevelop::IProject* project) const override;
 };
 
 #endif // KDEVPLATFORM_PLUGIN_GENERICIMPORTER_H
@@ -26,10 +26,12 @@
 #include <QProcess>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 #include <QMenu>
 #include <QTimer>
 #include <QRegularExpression>
 #include <QPointer>
+#include <QSharedPointer>
 
 #include <interfaces/icore.h>
 #include <interfaces/iproject.h>
@@ -78,6 +80,88 @@ QVariant runSynchronously(KDevelop::VcsJob* job)
 namespace
 {
 
+/**
+ * Parses the output of "git blame --incremental" part by part while it is received.
+ *
+ * The output consists of one entry per range of lines which were last changed by the same commit.
+ * The metadata of a commit is only part of its first entry, its lines share one VcsAnnotationLine
+ * for the metadata, which is copied for each line.
+ */
+class GitBlameParser
+{
+public:
+    /// @return the annotation lines of all entries which were completed by @p output
+    QVariantList parse(const QByteArray& output)
+    {
+        m_buffer += output;
+
+        QVariantList results;
+        int start = 0;
+        for (int end = m_buffer.indexOf('\n'); end != -1; end = m_buffer.indexOf('\n', start)) {
+            parseLine(QString::fromLocal8Bit(m_buffer.constData() + start, end - start), results);
+            start = end + 1;
+        }
+        m_buffer.remove(0, start);
+        return results;
+    }
+
+private:
+    void parseLine(const QString& line, QVariantList& results)
+    {
+        if (line.isEmpty())
+            return;
+
+        const int nameEnd = line.indexOf(QLatin1Char(' '));
+        const QStringRef name = line.leftRef(nameEnd);
+        const QStringRef value = nameEnd == -1 ? QStringRef() : line.midRef(nameEnd + 1);
+
+        if (!m_commit) {
+            // "<sha1> <line in the original file> <line in the final file> <number of lines>"
+            const auto values = value.split(QLatin1Char(' '));
+            if (values.size() < 3)
+                return;
+
+            const QString hash = name.toString();
+            auto commitIt = m_commits.find(hash);
+            if (commitIt == m_commits.end()) {
+                VcsRevision rev;
+                rev.setRevisionValue(hash.left(8), KDevelop::VcsRevision::GlobalNumber);
+                commitIt = m_commits.insert(hash, VcsAnnotationLine());
+                commitIt->setRevision(rev);
+            }
+            m_commit = &commitIt.value();
+            m_firstLine = values[1].toInt() - 1;
+            m_lineCount = values[2].toInt();
+            return;
+        }
+
+        if (name == QLatin1String("author"))
+            m_commit->setAuthor(value.toString());
+        else if (name == QLatin1String("author-time"))
+            m_commit->setDate(QDateTime::fromSecsSinceEpoch(value.toUInt(), Qt::LocalTime));
+        else if (name == QLatin1String("summary"))
+            m_commit->setCommitMessage(value.toString());
+        else if (name == QLatin1String("filename")) {
+            // ends the entry
+            results.reserve(results.size() + m_lineCount);
+            for (int i = 0; i < m_lineCount; ++i) {
+                VcsAnnotationLine annotation = *m_commit;
+                annotation.setLineNumber(m_firstLine + i);
+                results += QVariant::fromValue(annotation);
+            }
+            m_commit = nullptr;
+        }
+        // the other headers, e.g. of the committer, are not needed
+    }
+
+    QByteArray m_buffer;
+    QHash<QString, VcsAnnotationLine> m_commits;
+    // the entry which is parsed currently
+    VcsAnnotationLine* m_commit = nullptr;
+    int m_firstLine = 0;
+    int m_lineCount = 0;
+};
+
 QDir dotGitDirectory(const QUrl& dirPath, bool silent = false)
 {
     const QFileInfo finfo(dirPath.toLocalFile());
@@ -636,67 +720,22 @@ KDevelop::VcsJob* GitPlugin::annotate(const QUrl &localLocation, const KDevelop:
 {
     DVcsJob* job = new GitJob(dotGitDirectory(localLocation), this, KDevelop::OutputJob::Silent);
     job->setType(VcsJob::Annotate);
-    *job << "git" << "blame" << "--porcelain" << "-w";
+    *job << "git" << "blame" << "--incremental" << "-w";
     *job << "--" << localLocation;
-    connect(job, &DVcsJob::readyForParsing, this, &GitPlugin::parseGitBlameOutput);
-    return job;
-}
-
-void GitPlugin::parseGitBlameOutput(DVcsJob *job)
-{
-    QVariantList results;
-    VcsAnnotationLine* annotation = nullptr;
-    const auto output = job->output();
-    const auto lines = output.splitRef(QLatin1Char('\n'));
-
-    bool skipNext=false;
-    QMap<QString, VcsAnnotationLine> definedRevisions;
-    for (auto& line : lines) {
-        if(skipNext) {
-            skipNext=false;
-            results += QVariant::fromValue(*annotation);
-
-            continue;
-        }
-
-        if (line.isEmpty())
-            continue;
 
-        QStringRef name = line.left(line.indexOf(QLatin1Char(' ')));
-        QStringRef value = line.mid(name.size()+1);
-
-        if(name==QLatin1String("author"))
-            annotation->setAuthor(value.toString());
-        else if(name==QLatin1String("author-mail")) {} //TODO: do smth with the e-mail?
-        else if(name==QLatin1String("author-tz")) {} //TODO: does it really matter?
-        else if(name==QLatin1String("author-time"))
-            annotation->setDate(QDateTime::fromSecsSinceEpoch(value.toUInt(), Qt::LocalTime));
-        else if(name==QLatin1String("summary"))
-            annotation->setCommitMessage(value.toString());
-        else if(name.startsWith(QLatin1String("committer"))) {} //We will just store the authors
-        else if(name==QLatin1String("previous")) {} //We don't need that either
-        else if(name==QLatin1String("filename")) { skipNext=true; }
-        else if(name==QLatin1String("boundary")) {
-            definedRevisions.insert(QStringLiteral("boundary"), VcsAnnotationLine());
+    // report the lines as soon as git found them, instead of waiting for the blame of the whole file
+    auto parser = QSharedPointer<GitBlameParser>::create();
+    connect(job, &DVcsJob::outputReceived, this, [parser](DVcsJob* job, const QByteArray& output) {
+        const QVariantList results = parser->parse(output);
+        if (!results.isEmpty()) {
+            job->setPartialResults(results);
         }
-        else
-        {
-            const auto values = value.split(QLatin1Char(' '));
-
-            VcsRevision rev;
-            rev.setRevisionValue(name.left(8).toString(), KDevelop::VcsRevision::GlobalNumber);
-
-            skipNext = definedRevisions.contains(name.toString());
-
-            if(!skipNext)
-                definedRevisions.insert(name.toString(), VcsAnnotationLine());
-
-            annotation = &definedRevisions[name.toString()];
-            annotation->setLineNumber(values[1].toInt() - 1);
-            annotation->setRevision(rev);
-        }
-    }
-    job->setResults(results);
+    });
+    connect(job, &DVcsJob::readyForParsing, this, [parser](DVcsJob* job) {
+        // only the lines which were not reported yet
+        job->setResults(parser->parse(QByteArray()));
+    });
+    return job;
 }
 
 
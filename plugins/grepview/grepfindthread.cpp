@@ -2,8 +2,8 @@
 #include "debug.h"
 
 #include <QDir>
-#include <QSet>
 
+#include <project/projectfileset.h>
 #include <project/projectmodel.h>
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
@@ -19,6 +19,7 @@
 #include <utility>
 
 using KDevelop::IndexedString;
+using KDevelop::ProjectFileSet;
 
 /**
  * @return Return true in case @p url is in @p dir within a maximum depth of @p maxDepth
@@ -49,7 +50,7 @@ public:
         , m_abort{abort}
     {}
 
-    void getProjectFiles(const QSet<IndexedString>& projectFileSet,
+    void getProjectFiles(const ProjectFileSet& projectFileSet,
                          const QUrl& dir, int depth, QList<QUrl>& results);
     void findFiles(const QDir& dir, int depth, QList<QUrl>& results);
 
@@ -61,35 +62,37 @@ private:
     const std::atomic<bool>& m_abort;
 };
 
-void FileFinder::getProjectFiles(const QSet<IndexedString>& projectFileSet,
+void FileFinder::getProjectFiles(const ProjectFileSet& projectFileSet,
                                  const QUrl& dir, int depth, QList<QUrl>& results)
 {
-    for (const IndexedString& item : projectFileSet) {
-        if (shouldAbort()) {
-            break;
+    bool aborted = false;
+    projectFileSet.forEach([&](const IndexedString& item) {
+        if (aborted || shouldAbort()) {
+            aborted = true;
+            return;
         }
         QUrl url = item.toUrl();
         if( url != dir )
         {
             if ( depth == 0 ) {
                 if ( url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash) != dir.adjusted(QUrl::StripTrailingSlash) ) {
-                    continue;
+                    return;
                 }
             } else if ( !dir.isParentOf(url) ) {
-                continue;
+                return;
             } else if ( depth > 0 ) {
                 // To ensure the current file is within the defined depth limit, navigate up the tree for as many levels
                 // as the depth value, trying to find "dir", which is the project folder. If after all the loops there
                 // is no match, it means the current file is deeper down the project tree than the limit depth, and so
                 // it must be skipped.
                 if(!isInDirectory(url, dir, depth))
-                    continue;
+                    return;
             }
         }
         if (QDir::match(m_include, url.fileName()) && !WildcardHelpers::match(m_exclude, url.toLocalFile())) {
             results.push_back(std::move(url));
         }
-    }
+    });
 }
 
 void FileFinder::findFiles(const QDir& dir, int depth, QList<QUrl>& results)
@@ -126,7 +129,7 @@ void FileFinder::findFiles(const QDir& dir, int depth, QList<QUrl>& results)
     }
 }
 
-using FileSetCollection = std::queue<QSet<IndexedString>>;
+using FileSetCollection = std::queue<ProjectFileSet>;
 
 FileSetCollection getProjectFileSets(const QList<QUrl>& dirs)
 {
@@ -135,7 +138,7 @@ FileSetCollection getProjectFileSets(const QList<QUrl>& dirs)
         const auto* const project = KDevelop::ICore::self()->projectController()->findProjectForUrl(dir);
         // Store an empty file set when project==nullptr because each element
         // of fileSets must correspond to an element of dirs at the same index.
-        fileSets.push(project ? project->fileSet() : FileSetCollection::value_type{});
+        fileSets.push(project ? project->fileSetSnapshot() : FileSetCollection::value_type{});
     }
     return fileSets;
 }
@@ -203,9 +206,9 @@ void GrepFindFilesThread::run()
             finder.findFiles(directory.toLocalFile(), d->m_depth, d->m_files);
         } else {
             finder.getProjectFiles(d->m_projectFileSets.front(), directory, d->m_depth, d->m_files);
-            // Removing the no longer needed file set from the collection as
-            // soon as possible may save some memory or prevent a copy on write
-            // if the project's file set is changed during the search.
+            // Removing the no longer needed snapshot from the collection as
+            // soon as possible may save some memory if the project's file set
+            // is changed during the search.
             d->m_projectFileSets.pop();
         }
     }
@@ -30,10 +30,14 @@
 #include "settings/mesonrewriterpage.h"
 
 #include <interfaces/icore.h>
+#include <interfaces/ilanguagecontroller.h>
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
 #include <interfaces/iruncontroller.h>
+#include <interfaces/isession.h>
 #include <interfaces/itestcontroller.h>
+#include <language/backgroundparser/backgroundparser.h>
+#include <serialization/indexedstring.h>
 #include <project/projectconfigpage.h>
 #include <project/projectmodel.h>
 #include <util/executecompositejob.h>
@@ -42,6 +46,7 @@
 #include <KDirWatch>
 #include <KLocalizedString>
 #include <KPluginFactory>
+#include <QCryptographicHash>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QStandardPaths>
@@ -123,6 +128,9 @@ MesonManager::MesonManager(QObject* parent, const QVariantList& args)
     if (m_builder->hasError()) {
         setErrorDescription(i18n("Meson builder error: %1", m_builder->errorDescription()));
     }
+
+    connect(ICore::self()->projectController(), &IProjectController::projectClosing, this,
+            &MesonManager::projectClosing);
 }
 
 MesonManager::~MesonManager()
@@ -235,16 +243,35 @@ void MesonManager::onMesonInfoChanged(QString path, QString projectName)
         return;
     }
 
+    const auto oldTargets = m_projectTargets.value(foundProject);
+
     KJob* job = createImportJob(foundProject->projectItem());
     foundProject->setReloadJob(job);
     ICore::self()->runController()->registerJob(job);
-    connect(job, &KJob::finished, this, [foundProject](KJob* job) -> void {
+    connect(job, &KJob::finished, this, [this, foundProject, oldTargets](KJob* job) -> void {
         if (job->error()) {
             return;
         }
 
         emit KDevelop::ICore::self()->projectController()->projectConfigurationChanged(foundProject);
-        KDevelop::ICore::self()->projectController()->reparseProject(foundProject);
+
+        const auto newTargets = m_projectTargets.value(foundProject);
+        if (!oldTargets || !newTargets) {
+            KDevelop::ICore::self()->projectController()->reparseProject(foundProject);
+            return;
+        }
+
+        // Only reparse the files whose compiler flags actually changed
+        const auto changedFiles
+            = newTargets == oldTargets ? Path::List() : newTargets->filesWithChangedBuildInfo(*oldTargets);
+        qCDebug(KDEV_Meson) << "Build information of" << changedFiles.size() << "files changed";
+        auto* backgroundParser = ICore::self()->languageController()->backgroundParser();
+        for (const auto& file : changedFiles) {
+            const IndexedString document(file.pathOrUrl());
+            if (foundProject->inProject(document)) {
+                backgroundParser->addDocument(document);
+            }
+        }
     });
 }
 
@@ -270,6 +297,8 @@ KJob* MesonManager::createImportJob(ProjectFolderItem* item)
     auto introJob = new MesonIntrospectJob(
         project, buildDir, { MesonIntrospectJob::TARGETS, MesonIntrospectJob::TESTS, MesonIntrospectJob::PROJECTINFO },
         MesonIntrospectJob::BUILD_DIR, this);
+    auto cache = introspectCache(project);
+    introJob->setCache(cache);
 
     KDirWatchPtr watcher = m_projectWatchers[project];
     if (!watcher) {
@@ -289,13 +318,15 @@ KJob* MesonManager::createImportJob(ProjectFolderItem* item)
         watcher->addFile(watchFile.path());
     }
 
-    connect(introJob, &KJob::result, this, [this, introJob, item, project]() {
+    connect(introJob, &KJob::result, this, [this, introJob, item, project, cache]() {
         auto targets = introJob->targets();
         auto tests = introJob->tests();
         if (!targets || !tests) {
             return;
         }
 
+        cache->save();
+
         // Remove old test suites before deleting them
         if (m_projectTestSuites[project]) {
             for (auto i : m_projectTestSuites[project]->testSuites()) {
@@ -365,6 +396,27 @@ MesonSourcePtr MesonManager::sourceFromItem(KDevelop::ProjectBaseItem* item) con
     return targets->fileSource(item->path());
 }
 
+MesonIntrospectCachePtr MesonManager::introspectCache(IProject* project)
+{
+    auto& cache = m_introspectCaches[project];
+    if (!cache) {
+        const auto dataArea = ICore::self()->activeSession()->pluginDataArea(this).toLocalFile();
+        // key the stored cache by the project path, names of different projects can be the same
+        const QByteArray projectHash
+            = QCryptographicHash::hash(project->path().pathOrUrl().toUtf8(), QCryptographicHash::Md5).toHex();
+        cache = make_shared<MesonIntrospectCache>(dataArea + QLatin1Char('/') + QString::fromLatin1(projectHash)
+                                                  + QLatin1String(".introspection"));
+        cache->load();
+    }
+    return cache;
+}
+
+void MesonManager::projectClosing(IProject* project)
+{
+    // running jobs keep their own reference to the cache
+    m_introspectCaches.remove(project);
+}
+
 KDevelop::Path::List MesonManager::includeDirectories(KDevelop::ProjectBaseItem* item) const
 {
     auto src = sourceFromItem(item);
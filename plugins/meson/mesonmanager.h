@@ -21,6 +21,7 @@
 #pragma once
 
 #include "mesonconfig.h"
+#include "mintro/mesonintrospectcache.h"
 #include "mintro/mesontests.h"
 
 #include <project/abstractfilemanagerplugin.h>
@@ -117,13 +118,16 @@ public:
 
 private:
     void onMesonInfoChanged(QString path, QString projectName);
+    void projectClosing(KDevelop::IProject* project);
 
 private:
     MesonBuilder* m_builder;
     QHash<KDevelop::IProject*, MesonTargetsPtr> m_projectTargets;
     QHash<KDevelop::IProject*, MesonTestSuitesPtr> m_projectTestSuites;
     QHash<KDevelop::IProject*, KDirWatchPtr> m_projectWatchers;
+    QHash<KDevelop::IProject*, MesonIntrospectCachePtr> m_introspectCaches;
 
     MesonSourcePtr sourceFromItem(KDevelop::ProjectBaseItem* item) const;
+    MesonIntrospectCachePtr introspectCache(KDevelop::IProject* project);
     void populateTargets(KDevelop::ProjectFolderItem* item, QVector<MesonTarget*> targets);
 };
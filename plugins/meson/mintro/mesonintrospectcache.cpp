@@ -0,0 +1,156 @@
+/* This file is part of KDevelop
+    Copyright 2020 The KDevelop developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "mesonintrospectcache.h"
+
+#include <debug.h>
+
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+namespace {
+// bump whenever the format of the stored data changes
+const quint32 cacheFormatVersion = 1;
+}
+
+MesonIntrospectCache::MesonIntrospectCache(const QString& filePath)
+    : m_filePath(filePath)
+{
+}
+
+MesonIntrospectCache::FileStamp MesonIntrospectCache::stamp(const QString& introFile)
+{
+    const QFileInfo info(introFile);
+    if (!info.exists()) {
+        return {};
+    }
+    return { info.size(), info.lastModified() };
+}
+
+QJsonValue MesonIntrospectCache::json(const QString& introFile, const FileStamp& stamp) const
+{
+    QMutexLocker lock(&m_mutex);
+    auto it = m_json.constFind(introFile);
+    if (!stamp.isValid() || it == m_json.constEnd() || !(it->stamp == stamp)) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    return it->value;
+}
+
+void MesonIntrospectCache::setJson(const QString& introFile, const FileStamp& stamp, const QJsonValue& json)
+{
+    QMutexLocker lock(&m_mutex);
+    m_json.insert(introFile, { stamp, json });
+}
+
+MesonTargetsPtr MesonIntrospectCache::targets(const QString& introFile, const FileStamp& stamp) const
+{
+    QMutexLocker lock(&m_mutex);
+    auto it = m_targets.constFind(introFile);
+    if (!stamp.isValid() || it == m_targets.constEnd() || !(it->stamp == stamp)) {
+        return nullptr;
+    }
+    return it->value;
+}
+
+void MesonIntrospectCache::setTargets(const QString& introFile, const FileStamp& stamp, const MesonTargetsPtr& targets)
+{
+    QMutexLocker lock(&m_mutex);
+    m_targets.insert(introFile, { stamp, targets });
+    m_targetsChanged = true;
+}
+
+bool MesonIntrospectCache::load()
+{
+    if (m_filePath.isEmpty()) {
+        return false;
+    }
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 version = 0;
+    stream >> version;
+    if (stream.status() != QDataStream::Ok || version != cacheFormatVersion) {
+        qCDebug(KDEV_Meson) << "MINTRO: Discarding introspection cache of unsupported version" << version;
+        return false;
+    }
+
+    QHash<QString, Entry<MesonTargetsPtr>> targets;
+    qint32 count = 0;
+    stream >> count;
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString introFile;
+        FileStamp stamp;
+        stream >> introFile >> stamp.size >> stamp.lastModified;
+        targets.insert(introFile, { stamp, std::make_shared<MesonTargets>(stream) });
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KDEV_Meson) << "MINTRO: Discarding corrupted introspection cache" << m_filePath;
+        return false;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    // Entries which were already updated in memory are newer than the stored ones
+    for (auto it = targets.cbegin(), end = targets.cend(); it != end; ++it) {
+        if (!m_targets.contains(it.key())) {
+            m_targets.insert(it.key(), it.value());
+        }
+    }
+    qCDebug(KDEV_Meson) << "MINTRO: Loaded" << targets.size() << "cached introspection files from" << m_filePath;
+    return true;
+}
+
+bool MesonIntrospectCache::save()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_filePath.isEmpty() || !m_targetsChanged) {
+        return true;
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDEV_Meson) << "MINTRO: Could not write introspection cache" << m_filePath << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    stream << cacheFormatVersion << static_cast<qint32>(m_targets.size());
+    for (auto it = m_targets.cbegin(), end = m_targets.cend(); it != end; ++it) {
+        stream << it.key() << it->stamp.size << it->stamp.lastModified;
+        it->value->toStream(stream);
+    }
+
+    if (!file.commit()) {
+        return false;
+    }
+    m_targetsChanged = false;
+    return true;
+}
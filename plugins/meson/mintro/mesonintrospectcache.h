@@ -0,0 +1,92 @@
+/* This file is part of KDevelop
+    Copyright 2020 The KDevelop developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#pragma once
+
+#include "mesontargets.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonValue>
+#include <QMutex>
+#include <QString>
+
+#include <memory>
+
+class MesonIntrospectCache;
+using MesonIntrospectCachePtr = std::shared_ptr<MesonIntrospectCache>;
+
+/**
+ * Cache for the introspection files in the meson-info directory of a build directory.
+ *
+ * Every entry is only valid as long as the size and modification time of its
+ * intro-<section>.json file do not change, so a reload only reads and parses the
+ * sections meson actually rewrote. The targets, which are by far the largest
+ * section, can additionally be stored on disk, so they do not have to be parsed
+ * again when the project is opened in the next session.
+ *
+ * All functions are thread safe.
+ */
+class MesonIntrospectCache
+{
+public:
+    /// Identifies the state of an introspection file on disk
+    struct FileStamp
+    {
+        qint64 size = -1;
+        QDateTime lastModified;
+
+        bool isValid() const { return size >= 0; }
+        bool operator==(const FileStamp& other) const
+        {
+            return size == other.size && lastModified == other.lastModified;
+        }
+    };
+
+    /// @p filePath is the file load() and save() use, it may be empty if the cache is only kept in memory
+    explicit MesonIntrospectCache(const QString& filePath = QString());
+
+    static FileStamp stamp(const QString& introFile);
+
+    /// @returns the cached contents of @p introFile, or an undefined value if it changed since it was cached
+    QJsonValue json(const QString& introFile, const FileStamp& stamp) const;
+    void setJson(const QString& introFile, const FileStamp& stamp, const QJsonValue& json);
+
+    /// @returns the targets parsed from @p introFile, or nullptr if it changed since they were cached
+    MesonTargetsPtr targets(const QString& introFile, const FileStamp& stamp) const;
+    void setTargets(const QString& introFile, const FileStamp& stamp, const MesonTargetsPtr& targets);
+
+    bool load();
+    /// Stores the cached targets, does nothing if they did not change since the last load() or save()
+    bool save();
+
+private:
+    template<typename T>
+    struct Entry
+    {
+        FileStamp stamp;
+        T value;
+    };
+
+    const QString m_filePath;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry<QJsonValue>> m_json;
+    QHash<QString, Entry<MesonTargetsPtr>> m_targets;
+    bool m_targetsChanged = false;
+};
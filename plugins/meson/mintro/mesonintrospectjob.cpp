@@ -117,12 +117,22 @@ QString MesonIntrospectJob::getTypeString(MesonIntrospectJob::Type type) const
     return QStringLiteral("error");
 }
 
+void MesonIntrospectJob::setCache(MesonIntrospectCachePtr cache)
+{
+    m_cache = cache;
+}
+
+QString MesonIntrospectJob::introFilePath(const BuildDir& buildDir, MesonIntrospectJob::Type type) const
+{
+    QString fileName = QStringLiteral("intro-") + getTypeString(type) + QStringLiteral(".json");
+    QString infoDir = buildDir.buildDir.toLocalFile() + QStringLiteral("/") + QStringLiteral("meson-info");
+    return infoDir + QStringLiteral("/") + fileName;
+}
+
 QString MesonIntrospectJob::importJSONFile(const BuildDir& buildDir, MesonIntrospectJob::Type type, QJsonObject* out)
 {
     QString typeStr = getTypeString(type);
-    QString fileName = QStringLiteral("intro-") + typeStr + QStringLiteral(".json");
-    QString infoDir = buildDir.buildDir.toLocalFile() + QStringLiteral("/") + QStringLiteral("meson-info");
-    QFile introFile(infoDir + QStringLiteral("/") + fileName);
+    QFile introFile(introFilePath(buildDir, type));
 
     if (!introFile.exists()) {
         return i18n("Introspection file '%1' does not exist", QFileInfo(introFile).canonicalFilePath());
@@ -188,13 +198,39 @@ QString MesonIntrospectJob::importMesonAPI(const BuildDir& buildDir, MesonIntros
 QString MesonIntrospectJob::import(BuildDir buildDir)
 {
     QJsonObject rawData;
+    const bool useCache = m_cache && m_mode == BUILD_DIR;
+    QHash<Type, MesonIntrospectCache::FileStamp> stamps;
 
     // First load the complete JSON data
     for (auto i : m_types) {
         QString err;
         switch (m_mode) {
         case BUILD_DIR:
+            if (useCache) {
+                // Take the stamp before reading, a file written in between is then read again next time
+                const QString introFile = introFilePath(buildDir, i);
+                const auto stamp = MesonIntrospectCache::stamp(introFile);
+                stamps[i] = stamp;
+
+                if (i == TARGETS) {
+                    m_res_targets = m_cache->targets(introFile, stamp);
+                    if (m_res_targets) {
+                        qCDebug(KDEV_Meson) << "MINTRO: Reusing cached targets of" << introFile;
+                        break;
+                    }
+                } else {
+                    const auto cached = m_cache->json(introFile, stamp);
+                    if (!cached.isUndefined()) {
+                        rawData[getTypeString(i)] = cached;
+                        break;
+                    }
+                }
+            }
+
             err = importJSONFile(buildDir, i, &rawData);
+            if (useCache && err.isEmpty() && i != TARGETS) {
+                m_cache->setJson(introFilePath(buildDir, i), stamps[i], rawData[getTypeString(i)]);
+            }
             break;
         case MESON_FILE:
             err = importMesonAPI(buildDir, i, &rawData);
@@ -230,6 +266,9 @@ QString MesonIntrospectJob::import(BuildDir buildDir)
     auto targetsJSON = rawData[QStringLiteral("targets")];
     if (targetsJSON.isArray()) {
         m_res_targets = std::make_shared<MesonTargets>(targetsJSON.toArray());
+        if (useCache) {
+            m_cache->setTargets(introFilePath(buildDir, TARGETS), stamps[TARGETS], m_res_targets);
+        }
     }
 
     auto testsJSON = rawData[QStringLiteral("tests")];
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "mesonconfig.h"
+#include "mesonintrospectcache.h"
 #include "mesonoptions.h"
 #include "mesonprojectinfo.h"
 #include "mesontargets.h"
@@ -55,12 +56,19 @@ public:
 
     QString getTypeString(Type type) const;
 
+    /**
+     * Reuses the sections of @p cache whose introspection files did not change and
+     * stores the newly read ones in it. Only used in the BUILD_DIR mode.
+     */
+    void setCache(MesonIntrospectCachePtr cache);
+
     MesonOptsPtr buildOptions();
     MesonProjectInfoPtr projectInfo();
     MesonTargetsPtr targets();
     MesonTestSuitesPtr tests();
 
 private:
+    QString introFilePath(const Meson::BuildDir& buildDir, Type type) const;
     QString importJSONFile(const Meson::BuildDir& buildDir, Type type, QJsonObject* out);
     QString importMesonAPI(const Meson::BuildDir& buildDir, Type type, QJsonObject* out);
     QString import(Meson::BuildDir buildDir);
@@ -74,6 +82,7 @@ private:
     Meson::BuildDir m_buildDir;
     KDevelop::Path m_projectPath;
     KDevelop::IProject* m_project = nullptr;
+    MesonIntrospectCachePtr m_cache;
 
     // The results
     MesonOptsPtr m_res_options = nullptr;
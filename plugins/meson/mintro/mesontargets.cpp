@@ -21,6 +21,7 @@
 
 #include <debug.h>
 
+#include <QDataStream>
 #include <QJsonArray>
 #include <QJsonObject>
 
@@ -29,6 +30,24 @@
 using namespace std;
 using namespace KDevelop;
 
+namespace {
+QStringList toStringList(const Path::List& paths)
+{
+    QStringList ret;
+    ret.reserve(paths.size());
+    transform(begin(paths), end(paths), back_inserter(ret), [](const Path& x) { return x.pathOrUrl(); });
+    return ret;
+}
+
+Path::List toPathList(const QStringList& strings)
+{
+    Path::List ret;
+    ret.reserve(strings.size());
+    transform(begin(strings), end(strings), back_inserter(ret), [](const QString& x) { return Path(x); });
+    return ret;
+}
+}
+
 // MesonTargetSources
 
 MesonTargetSources::MesonTargetSources(const QJsonObject& json, MesonTarget* target)
@@ -37,6 +56,12 @@ MesonTargetSources::MesonTargetSources(const QJsonObject& json, MesonTarget* tar
     fromJSON(json);
 }
 
+MesonTargetSources::MesonTargetSources(QDataStream& stream, MesonTarget* target)
+    : m_target(target)
+{
+    fromStream(stream);
+}
+
 MesonTargetSources::~MesonTargetSources() {}
 
 QString MesonTargetSources::language() const
@@ -89,6 +114,12 @@ MesonTarget* MesonTargetSources::target()
     return m_target;
 }
 
+bool MesonTargetSources::hasSameBuildInfo(const MesonTargetSources& other) const
+{
+    return m_language == other.m_language && m_compiler == other.m_compiler && m_includeDirs == other.m_includeDirs
+        && m_defines == other.m_defines && m_extraArgs == other.m_extraArgs;
+}
+
 void MesonTargetSources::fromJSON(const QJsonObject& json)
 {
     m_language = json[QStringLiteral("language")].toString();
@@ -110,6 +141,23 @@ void MesonTargetSources::fromJSON(const QJsonObject& json)
                         << "defines";
 }
 
+void MesonTargetSources::fromStream(QDataStream& stream)
+{
+    QStringList src;
+    QStringList gensrc;
+    stream >> m_language >> m_compiler >> m_paramerters >> src >> gensrc;
+    m_sources = toPathList(src);
+    m_generatedSources = toPathList(gensrc);
+
+    // The include directories and defines are cheap to extract again, so they are not stored
+    splitParamerters();
+}
+
+void MesonTargetSources::toStream(QDataStream& stream) const
+{
+    stream << m_language << m_compiler << m_paramerters << toStringList(m_sources) << toStringList(m_generatedSources);
+}
+
 void MesonTargetSources::splitParamerters()
 {
     for (const QString& i : m_paramerters) {
@@ -150,6 +198,11 @@ MesonTarget::MesonTarget(const QJsonObject& json)
     fromJSON(json);
 }
 
+MesonTarget::MesonTarget(QDataStream& stream)
+{
+    fromStream(stream);
+}
+
 MesonTarget::~MesonTarget() {}
 
 QString MesonTarget::name() const
@@ -205,6 +258,29 @@ void MesonTarget::fromJSON(const QJsonObject& json)
     }
 }
 
+void MesonTarget::fromStream(QDataStream& stream)
+{
+    QString definedIn;
+    QStringList files;
+    qint32 sourcesCount = 0;
+    stream >> m_name >> m_type >> definedIn >> files >> m_buildByDefault >> m_installed >> sourcesCount;
+    m_definedIn = Path(definedIn);
+    m_filename = toPathList(files);
+
+    for (qint32 i = 0; i < sourcesCount && stream.status() == QDataStream::Ok; ++i) {
+        m_targetSources << make_shared<MesonTargetSources>(stream, this);
+    }
+}
+
+void MesonTarget::toStream(QDataStream& stream) const
+{
+    stream << m_name << m_type << m_definedIn.pathOrUrl() << toStringList(m_filename) << m_buildByDefault
+           << m_installed << static_cast<qint32>(m_targetSources.size());
+    for (const auto& i : m_targetSources) {
+        i->toStream(stream);
+    }
+}
+
 // MesonTargets
 
 MesonTargets::MesonTargets(const QJsonArray& json)
@@ -212,6 +288,11 @@ MesonTargets::MesonTargets(const QJsonArray& json)
     fromJSON(json);
 }
 
+MesonTargets::MesonTargets(QDataStream& stream)
+{
+    fromStream(stream);
+}
+
 MesonTargets::~MesonTargets() {}
 
 QVector<MesonTargetPtr> MesonTargets::targets()
@@ -234,6 +315,24 @@ MesonSourcePtr MesonTargets::operator[](KDevelop::Path p)
     return fileSource(p);
 }
 
+KDevelop::Path::List MesonTargets::filesWithChangedBuildInfo(const MesonTargets& other) const
+{
+    KDevelop::Path::List res;
+    for (auto it = m_sourceHash.cbegin(), itEnd = m_sourceHash.cend(); it != itEnd; ++it) {
+        auto otherSource = other.m_sourceHash.value(it.key());
+        if (!otherSource || !(*it)->hasSameBuildInfo(*otherSource)) {
+            res << it.key();
+        }
+    }
+
+    for (auto it = other.m_sourceHash.cbegin(), itEnd = other.m_sourceHash.cend(); it != itEnd; ++it) {
+        if (!m_sourceHash.contains(it.key())) {
+            res << it.key();
+        }
+    }
+    return res;
+}
+
 void MesonTargets::fromJSON(const QJsonArray& json)
 {
     qCDebug(KDEV_Meson) << "MINTRO: Loading targets from json...";
@@ -246,6 +345,25 @@ void MesonTargets::fromJSON(const QJsonArray& json)
                         << "total files";
 }
 
+void MesonTargets::fromStream(QDataStream& stream)
+{
+    qint32 targetsCount = 0;
+    stream >> targetsCount;
+    for (qint32 i = 0; i < targetsCount && stream.status() == QDataStream::Ok; ++i) {
+        m_targets << make_shared<MesonTarget>(stream);
+    }
+
+    buildHashMap();
+}
+
+void MesonTargets::toStream(QDataStream& stream) const
+{
+    stream << static_cast<qint32>(m_targets.size());
+    for (const auto& i : m_targets) {
+        i->toStream(stream);
+    }
+}
+
 void MesonTargets::buildHashMap()
 {
     for (auto& i : m_targets) {
@@ -26,6 +26,7 @@
 
 #include <memory>
 
+class QDataStream;
 class QJsonArray;
 class QJsonObject;
 class MesonTarget;
@@ -40,6 +41,7 @@ class MesonTargetSources
 {
 public:
     explicit MesonTargetSources(const QJsonObject& json, MesonTarget* target);
+    explicit MesonTargetSources(QDataStream& stream, MesonTarget* target);
     virtual ~MesonTargetSources();
 
     QString language() const;
@@ -55,7 +57,12 @@ public:
 
     MesonTarget* target();
 
+    /// @return whether compiling the sources of @p other requires the same flags
+    bool hasSameBuildInfo(const MesonTargetSources& other) const;
+
     void fromJSON(const QJsonObject& json);
+    void fromStream(QDataStream& stream);
+    void toStream(QDataStream& stream) const;
 
 private:
     QString m_language;
@@ -77,6 +84,7 @@ class MesonTarget
 {
 public:
     explicit MesonTarget(const QJsonObject& json);
+    explicit MesonTarget(QDataStream& stream);
     virtual ~MesonTarget();
 
     QString name() const;
@@ -89,6 +97,8 @@ public:
     QVector<MesonSourcePtr> targetSources();
 
     void fromJSON(const QJsonObject& json);
+    void fromStream(QDataStream& stream);
+    void toStream(QDataStream& stream) const;
 
 private:
     QString m_name;
@@ -105,6 +115,7 @@ class MesonTargets
 {
 public:
     explicit MesonTargets(const QJsonArray& json);
+    explicit MesonTargets(QDataStream& stream);
     virtual ~MesonTargets();
 
     QVector<MesonTargetPtr> targets();
@@ -112,7 +123,12 @@ public:
     MesonSourcePtr fileSource(KDevelop::Path p);
     MesonSourcePtr operator[](KDevelop::Path p);
 
+    /// @return all files whose build information differs between @p other and this, including the ones only one of them knows
+    KDevelop::Path::List filesWithChangedBuildInfo(const MesonTargets& other) const;
+
     void fromJSON(const QJsonArray& json);
+    void fromStream(QDataStream& stream);
+    void toStream(QDataStream& stream) const;
 
 private:
     QVector<MesonTargetPtr> m_targets;
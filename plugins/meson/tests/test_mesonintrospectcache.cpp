@@ -0,0 +1,174 @@
+/* This file is part of KDevelop
+    Copyright 2020 The KDevelop developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "test_mesonintrospectcache.h"
+
+#include "mintro/mesonintrospectcache.h"
+#include "mintro/mesontargets.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <algorithm>
+
+QTEST_GUILESS_MAIN(TestMesonIntrospectCache)
+
+using namespace KDevelop;
+
+namespace {
+QJsonObject targetSources(const QStringList& parameters, const QStringList& sources)
+{
+    return QJsonObject{
+        { QStringLiteral("language"), QStringLiteral("cpp") },
+        { QStringLiteral("compiler"), QJsonArray{ QStringLiteral("c++") } },
+        { QStringLiteral("parameters"), QJsonArray::fromStringList(parameters) },
+        { QStringLiteral("sources"), QJsonArray::fromStringList(sources) },
+        { QStringLiteral("generated_sources"), QJsonArray() },
+    };
+}
+
+QJsonArray targetsJson(const QJsonArray& sources)
+{
+    return QJsonArray{ QJsonObject{
+        { QStringLiteral("name"), QStringLiteral("app") },
+        { QStringLiteral("type"), QStringLiteral("executable") },
+        { QStringLiteral("defined_in"), QStringLiteral("/src/meson.build") },
+        { QStringLiteral("filename"), QJsonArray{ QStringLiteral("/build/app") } },
+        { QStringLiteral("build_by_default"), true },
+        { QStringLiteral("installed"), false },
+        { QStringLiteral("target_sources"), sources },
+    } };
+}
+
+MesonTargetsPtr appTargets()
+{
+    return std::make_shared<MesonTargets>(targetsJson(
+        { targetSources({ QStringLiteral("-I/src/include"), QStringLiteral("-DFOO=1"), QStringLiteral("-O2") },
+                        { QStringLiteral("/src/main.cpp"), QStringLiteral("/src/util.cpp") }) }));
+}
+
+Path::List sorted(Path::List paths)
+{
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+}
+
+void TestMesonIntrospectCache::testTargetsStreamRoundTrip()
+{
+    auto targets = appTargets();
+
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        targets->toStream(stream);
+    }
+    QDataStream stream(data);
+    MesonTargets loaded(stream);
+    QCOMPARE(stream.status(), QDataStream::Ok);
+    QVERIFY(stream.atEnd());
+
+    QCOMPARE(loaded.targets().size(), 1);
+    auto target = loaded.targets().first();
+    QCOMPARE(target->name(), QStringLiteral("app"));
+    QCOMPARE(target->type(), QStringLiteral("executable"));
+    QCOMPARE(target->definedIn(), Path(QStringLiteral("/src/meson.build")));
+    QCOMPARE(target->filename(), Path::List{ Path(QStringLiteral("/build/app")) });
+    QCOMPARE(target->buildByDefault(), true);
+    QCOMPARE(target->installed(), false);
+
+    auto source = loaded.fileSource(Path(QStringLiteral("/src/util.cpp")));
+    QVERIFY(source);
+    auto originalSource = targets->fileSource(Path(QStringLiteral("/src/util.cpp")));
+    QCOMPARE(source->sources(), originalSource->sources());
+    QCOMPARE(source->includeDirs(), Path::List{ Path(QStringLiteral("/src/include")) });
+    QCOMPARE(source->defines().value(QStringLiteral("FOO")), QStringLiteral("1"));
+    QCOMPARE(source->extraArgs(), originalSource->extraArgs());
+
+    QVERIFY(loaded.filesWithChangedBuildInfo(*targets).isEmpty());
+}
+
+void TestMesonIntrospectCache::testFilesWithChangedBuildInfo()
+{
+    auto oldTargets = std::make_shared<MesonTargets>(targetsJson(
+        { targetSources({ QStringLiteral("-DFOO=1") },
+                        { QStringLiteral("/src/main.cpp"), QStringLiteral("/src/util.cpp"),
+                          QStringLiteral("/src/removed.cpp") }) }));
+    auto newTargets = std::make_shared<MesonTargets>(targetsJson(
+        { targetSources({ QStringLiteral("-DFOO=1") }, { QStringLiteral("/src/util.cpp") }),
+          targetSources({ QStringLiteral("-DFOO=2") },
+                        { QStringLiteral("/src/main.cpp"), QStringLiteral("/src/added.cpp") }) }));
+
+    const Path::List expected = sorted({ Path(QStringLiteral("/src/main.cpp")), Path(QStringLiteral("/src/added.cpp")),
+                                         Path(QStringLiteral("/src/removed.cpp")) });
+    QCOMPARE(sorted(newTargets->filesWithChangedBuildInfo(*oldTargets)), expected);
+    QCOMPARE(sorted(oldTargets->filesWithChangedBuildInfo(*newTargets)), expected);
+    QVERIFY(newTargets->filesWithChangedBuildInfo(*newTargets).isEmpty());
+}
+
+void TestMesonIntrospectCache::testCacheSaveLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cacheFile = dir.filePath(QStringLiteral("project.introspection"));
+    const QString introFile = QStringLiteral("/build/meson-info/intro-targets.json");
+    const MesonIntrospectCache::FileStamp stamp{ 42, QDateTime::fromMSecsSinceEpoch(1000000) };
+
+    {
+        MesonIntrospectCache cache(cacheFile);
+        cache.setTargets(introFile, stamp, appTargets());
+        QVERIFY(cache.save());
+    }
+
+    MesonIntrospectCache cache(cacheFile);
+    QVERIFY(cache.load());
+    auto targets = cache.targets(introFile, stamp);
+    QVERIFY(targets);
+    QVERIFY(targets->filesWithChangedBuildInfo(*appTargets()).isEmpty());
+
+    // the cached targets are only valid for the same intro file
+    const MesonIntrospectCache::FileStamp changedStamp{ 43, stamp.lastModified };
+    QVERIFY(!cache.targets(introFile, changedStamp));
+}
+
+void TestMesonIntrospectCache::testCacheLoadInvalid()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cacheFile = dir.filePath(QStringLiteral("project.introspection"));
+
+    {
+        QFile file(cacheFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+    MesonIntrospectCache emptyCache(cacheFile);
+    QVERIFY(!emptyCache.load());
+
+    {
+        QFile file(cacheFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("\0\0", 2);
+    }
+    MesonIntrospectCache truncatedCache(cacheFile);
+    QVERIFY(!truncatedCache.load());
+}
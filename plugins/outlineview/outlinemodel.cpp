@@ -28,15 +28,36 @@
 #include <interfaces/idocument.h>
 #include <interfaces/idocumentcontroller.h>
 
+#include <QtConcurrentRun>
+
 #include <debug.h>
 #include "outlinenode.h"
 
 using namespace KDevelop;
 
+namespace {
+// how far ahead to look for an unchanged item before treating an item as new
+const int maxMatchDistance = 32;
+
+std::shared_ptr<OutlineNode> buildOutline(const IndexedString& url)
+{
+    DUChainReadLocker lock;
+    TopDUContext* topContext = DUChainUtils::standardContextForUrl(url.toUrl());
+    if (topContext) {
+        return OutlineNode::fromTopContext(topContext);
+    }
+    return OutlineNode::dummyNode();
+}
+}
+
 OutlineModel::OutlineModel(QObject* parent)
     : QAbstractItemModel(parent)
+    , m_rootNode(OutlineNode::dummyNode())
     , m_lastDoc(nullptr)
 {
+    connect(&m_outlineWatcher, &QFutureWatcherBase::finished,
+            this, &OutlineModel::outlineReady);
+
     auto docController = ICore::self()->documentController();
     // build the initial outline now
     rebuildOutline(docController->activeDocument());
@@ -72,6 +93,7 @@ OutlineModel::OutlineModel(QObject* parent)
 
 OutlineModel::~OutlineModel()
 {
+    m_outlineWatcher.waitForFinished();
 }
 
 Qt::ItemFlags OutlineModel::flags(const QModelIndex& index) const
@@ -174,25 +196,102 @@ QModelIndex OutlineModel::parent(const QModelIndex& index) const
 
 void OutlineModel::rebuildOutline(IDocument* doc)
 {
-    beginResetModel();
-    if (!doc) {
+    if (!doc || doc != m_lastDoc) {
+        // the outline of another document has nothing in common with the current one
+        beginResetModel();
         m_rootNode = OutlineNode::dummyNode();
+        m_lastUrl = doc ? IndexedString(doc->url()) : IndexedString();
+        m_lastDoc = doc;
+        endResetModel();
+    }
+    if (!doc) {
+        m_rebuildPending = false;
+        return;
+    }
+
+    // Building the outline of a large document takes a while, don't block the GUI thread for that.
+    if (m_outlineWatcher.isRunning()) {
+        m_rebuildPending = true;
+        return;
+    }
+    m_outlineUrl = m_lastUrl;
+    m_outlineWatcher.setFuture(QtConcurrent::run(buildOutline, m_outlineUrl));
+}
+
+void OutlineModel::outlineReady()
+{
+    if (m_outlineUrl == m_lastUrl) {
+        updateOutline(m_outlineWatcher.result());
+    }
+
+    if (m_rebuildPending) {
+        m_rebuildPending = false;
+        rebuildOutline(m_lastDoc);
+    }
+}
+
+void OutlineModel::updateOutline(const std::shared_ptr<OutlineNode>& outline)
+{
+    if (m_rootNode->childCount() == 0) {
+        // nothing to keep, which also makes the view expand the new items
+        beginResetModel();
+        m_rootNode = outline;
+        endResetModel();
     } else {
-        // TODO: do this in a separate thread? Might take a while for large documents
-        // and we really shouldn't be blocking the GUI thread!
-        DUChainReadLocker lock;
-        TopDUContext* topContext = DUChainUtils::standardContextForUrl(doc->url());
-        if (topContext) {
-            m_rootNode = OutlineNode::fromTopContext(topContext);
+        m_rootNode->updateFrom(*outline);
+        mergeChildren(m_rootNode.get(), QModelIndex(), outline.get());
+    }
+}
+
+void OutlineModel::mergeChildren(OutlineNode* node, const QModelIndex& parent, OutlineNode* newNode)
+{
+    auto newChildren = newNode->takeChildren();
+
+    if (node->childCount() == 0) {
+        if (!newChildren.empty()) {
+            beginInsertRows(parent, 0, static_cast<int>(newChildren.size()) - 1);
+            for (auto& newChild : newChildren) {
+                node->insertChild(node->childCount(), std::move(newChild));
+            }
+            endInsertRows();
+        }
+        return;
+    }
+
+    // Items which are still there are updated in place, so the view keeps their expansion state and selection.
+    int row = 0;
+    for (auto& newChild : newChildren) {
+        int match = -1;
+        const int matchEnd = qMin(node->childCount(), row + maxMatchDistance);
+        for (int i = row; i < matchEnd; ++i) {
+            if (node->childAt(i)->isSameItem(*newChild)) {
+                match = i;
+                break;
+            }
+        }
+
+        if (match == -1) {
+            beginInsertRows(parent, row, row);
+            node->insertChild(row, std::move(newChild));
+            endInsertRows();
         } else {
-            m_rootNode = OutlineNode::dummyNode();
+            if (match > row) {
+                beginRemoveRows(parent, row, match - 1);
+                node->removeChildren(row, match - 1);
+                endRemoveRows();
+            }
+            OutlineNode* child = node->childAt(row);
+            child->updateFrom(*newChild);
+            mergeChildren(child, index(row, 0, parent), newChild.get());
         }
+        ++row;
     }
-    if (doc != m_lastDoc) {
-        m_lastUrl = doc ? IndexedString(doc->url()) : IndexedString();
-        m_lastDoc = doc;
+
+    if (row < node->childCount()) {
+        beginRemoveRows(parent, row, node->childCount() - 1);
+        node->removeChildren(row, node->childCount() - 1);
+        endRemoveRows();
     }
-    endResetModel();
 }
 
 void OutlineModel::activate(const QModelIndex& realIndex)
@@ -21,6 +21,7 @@
 #include <serialization/indexedstring.h>
 
 #include <QAbstractItemModel>
+#include <QFutureWatcher>
 #include <vector>
 #include <memory>
 
@@ -53,8 +54,20 @@ public Q_SLOTS:
     void activate(const QModelIndex& realIndex);
 private Q_SLOTS:
     void rebuildOutline(KDevelop::IDocument* doc);
+    void outlineReady();
 private:
-    std::unique_ptr<OutlineNode> m_rootNode;
+    friend class TestOutlineModel;
+
+    /// Replaces the current outline by @p outline, keeping the nodes of unchanged items.
+    void updateOutline(const std::shared_ptr<OutlineNode>& outline);
+    /// Updates the children of @p node to match those of @p newNode, emitting only the changed rows.
+    void mergeChildren(OutlineNode* node, const QModelIndex& parent, OutlineNode* newNode);
+
+    std::shared_ptr<OutlineNode> m_rootNode;
     KDevelop::IDocument* m_lastDoc;
     KDevelop::IndexedString m_lastUrl;
+    // the outline is built in a background thread
+    QFutureWatcher<std::shared_ptr<OutlineNode>> m_outlineWatcher;
+    KDevelop::IndexedString m_outlineUrl;
+    bool m_rebuildPending = false;
 };
@@ -67,7 +67,8 @@ OutlineNode::OutlineNode(DUContext* ctx, const QString& name, OutlineNode* paren
         default:
             break;
     }
-    m_cachedIcon = DUChainUtils::iconForProperties(prop);
+    m_iconProperties = prop;
+    m_hasIcon = true;
     appendContext(ctx, ctx->topContext());
 }
 
@@ -80,7 +81,8 @@ OutlineNode::OutlineNode(Declaration* decl, OutlineNode* parent)
 
     // TODO: properly qualified identifier for out of line function definitions
     m_cachedText = decl->identifier().toString();
-    m_cachedIcon = DUChainUtils::iconForDeclaration(decl);
+    m_iconProperties = DUChainUtils::completionProperties(decl);
+    m_hasIcon = true;
     if (auto* alias = dynamic_cast<NamespaceAliasDeclaration*>(decl)) {
         //e.g. C++ using namespace statement
         m_cachedText = alias->importIdentifier().toString();
@@ -190,6 +192,7 @@ std::unique_ptr<OutlineNode> OutlineNode::dummyNode()
 std::unique_ptr<OutlineNode> OutlineNode::fromTopContext(TopDUContext* ctx)
 {
     auto result = dummyNode();
+    result->m_declOrContext = ctx;
     result->appendContext(ctx, ctx);
     return result;
 }
@@ -200,7 +203,7 @@ void OutlineNode::appendContext(DUContext* ctx, TopDUContext* top)
     const auto childDecls = ctx->localDeclarations(top);
     for (Declaration* childDecl : childDecls) {
         if (childDecl) {
-            m_children.emplace_back(childDecl, this);
+            m_children.emplace_back(new OutlineNode(childDecl, this));
         }
     }
     bool certainlyRequiresSorting = false;
@@ -239,22 +242,22 @@ void OutlineNode::appendContext(DUContext* ctx, TopDUContext* top)
                 //  +-+- FooClass
                 //  | \-- method2()
                 //  \ OtherStuff
-                auto it = std::find_if(m_children.begin(), m_children.end(), [childContext](const OutlineNode& node) {
-                    if (auto* ctx = dynamic_cast<DUContext*>(node.duChainObject())) {
+                auto it = std::find_if(m_children.begin(), m_children.end(), [childContext](const std::unique_ptr<OutlineNode>& node) {
+                    if (auto* ctx = dynamic_cast<DUContext*>(node->duChainObject())) {
                         return ctx->equalScopeIdentifier(childContext);
                     }
                     return false;
                 });
                 if (it != m_children.end()) {
-                    it->appendContext(childContext, top);
+                    (*it)->appendContext(childContext, top);
                 }
                 else {
                     // TODO: get the correct icon for the context
-                    m_children.emplace_back(childContext, ctxName, this);
+                    m_children.emplace_back(new OutlineNode(childContext, ctxName, this));
                 }
             } else {
                 // just add the context
-                m_children.emplace_back(childContext, ctxName, this);
+                m_children.emplace_back(new OutlineNode(childContext, ctxName, this));
             }
         }
     }
@@ -275,17 +278,17 @@ void OutlineNode::sortByLocation(bool requiresSorting)
     // TODO: does it make sense to cache m_declOrContext->range().start?
     // adds 8 bytes to each node, but save a lot of pointer lookups when sorting
     // qDebug("sorting children of %s (%p) by location", qPrintable(m_cachedText), this);
-    auto compare = [](const OutlineNode& n1, const OutlineNode& n2) -> bool {
+    auto compare = [](const std::unique_ptr<OutlineNode>& n1, const std::unique_ptr<OutlineNode>& n2) -> bool {
         // nodes without decl always go at the end
-        if (!n1.m_declOrContext) {
+        if (!n1->m_declOrContext) {
             return false;
-        } else if (!n2.m_declOrContext) {
+        } else if (!n2->m_declOrContext) {
             return true;
         }
-        return n1.m_declOrContext->range().start < n2.m_declOrContext->range().start;
+        return n1->m_declOrContext->range().start < n2->m_declOrContext->range().start;
     };
     // since most nodes will be correctly sorted we check that before calling std::sort().
-    // This saves a lot of move ctor/assignment calls in the common case.
+    // This saves a lot of swaps in the common case.
     // If we appended a context without a Declaration* we know that it will be unsorted
     // so we can pass requiresSorting = true to skip the useless std::is_sorted() call.
     // uncomment the following qDebug() lines to see whether this optimization really makes sense
@@ -300,3 +303,45 @@ void OutlineNode::sortByLocation(bool requiresSorting)
 OutlineNode::~OutlineNode()
 {
 }
+
+QIcon OutlineNode::icon() const
+{
+    if (m_hasIcon && m_cachedIcon.isNull()) {
+        m_cachedIcon = DUChainUtils::iconForProperties(m_iconProperties);
+    }
+    return m_cachedIcon;
+}
+
+bool OutlineNode::isSameItem(const OutlineNode& other) const
+{
+    return m_cachedText == other.m_cachedText
+        && m_hasIcon == other.m_hasIcon
+        && m_iconProperties == other.m_iconProperties;
+}
+
+void OutlineNode::updateFrom(const OutlineNode& other)
+{
+    Q_ASSERT(isSameItem(other));
+    m_declOrContext = other.m_declOrContext;
+}
+
+void OutlineNode::insertChild(int index, std::unique_ptr<OutlineNode> child)
+{
+    child->m_parent = this;
+    m_children.insert(m_children.begin() + index, std::move(child));
+}
+
+std::vector<std::unique_ptr<OutlineNode>> OutlineNode::takeChildren()
+{
+    std::vector<std::unique_ptr<OutlineNode>> children;
+    children.swap(m_children);
+    for (auto& child : children) {
+        child->m_parent = nullptr;
+    }
+    return children;
+}
+
+void OutlineNode::removeChildren(int first, int last)
+{
+    m_children.erase(m_children.begin() + first, m_children.begin() + last + 1);
+}
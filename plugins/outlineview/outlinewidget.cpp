@@ -93,6 +93,14 @@ OutlineWidget::OutlineWidget(QWidget* parent, OutlineViewPlugin* plugin)
     setLayout(vbox);
     expandFirstLevel();
     connect(m_model, &QAbstractItemModel::modelReset, this, &OutlineWidget::expandFirstLevel);
+    // the model is updated incrementally after a reparse, expand new top level items like the initial ones
+    connect(m_proxy, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex& parent, int first, int last) {
+        if (!parent.isValid()) {
+            for (int i = first; i <= last; i++) {
+                m_tree->expand(m_proxy->index(i, 0));
+            }
+        }
+    });
 }
 
 void OutlineWidget::activated(const QModelIndex& index)
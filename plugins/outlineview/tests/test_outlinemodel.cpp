@@ -0,0 +1,103 @@
+/*
+ *   KDevelop outline view
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "test_outlinemodel.h"
+
+#include "../outlinemodel.h"
+#include "../outlinenode.h"
+
+#include <QTest>
+#include <QSignalSpy>
+
+#include <tests/autotestshell.h>
+#include <tests/testcore.h>
+#include <language/duchain/declaration.h>
+#include <language/duchain/duchain.h>
+#include <language/duchain/duchainlock.h>
+#include <language/duchain/topducontext.h>
+
+QTEST_MAIN(TestOutlineModel)
+
+using namespace KDevelop;
+
+namespace {
+TopDUContext* createOutline(const QString& url, const QStringList& declarations)
+{
+    auto* top = new TopDUContext(IndexedString(url), {0, 0, declarations.size(), 0});
+    DUChain::self()->addDocumentChain(top);
+    int line = 0;
+    for (const QString& name : declarations) {
+        auto* decl = new Declaration({line, 0, line, name.size()}, top);
+        decl->setIdentifier(Identifier(name));
+        ++line;
+    }
+    return top;
+}
+}
+
+void TestOutlineModel::initTestCase()
+{
+    AutoTestShell::init();
+    TestCore::initialize(Core::NoUi);
+
+    DUChain::self()->disablePersistentStorage();
+}
+
+void TestOutlineModel::cleanupTestCase()
+{
+    TestCore::shutdown();
+}
+
+void TestOutlineModel::testMergeOutline()
+{
+    OutlineModel model;
+
+    DUChainWriteLocker lock;
+    TopDUContext* oldTop = createOutline(QStringLiteral("/test_outlinemodel/old.h"),
+                                         {QStringLiteral("first"), QStringLiteral("second")});
+    TopDUContext* newTop = createOutline(QStringLiteral("/test_outlinemodel/new.h"),
+                                         {QStringLiteral("first"), QStringLiteral("added"), QStringLiteral("second")});
+
+    model.updateOutline(OutlineNode::fromTopContext(oldTop));
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.m_rootNode->duChainObject(), static_cast<DUChainBase*>(oldTop));
+    const QModelIndex first = model.index(0, 0);
+    const QModelIndex second = model.index(1, 0);
+
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+
+    model.updateOutline(OutlineNode::fromTopContext(newTop));
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(removeSpy.count(), 0);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy.at(0).at(1).toInt(), 1);
+
+    // the root and the kept items refer to the new duchain objects
+    QCOMPARE(model.m_rootNode->duChainObject(), static_cast<DUChainBase*>(newTop));
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.index(0, 0).internalPointer(), first.internalPointer());
+    QCOMPARE(model.index(2, 0).internalPointer(), second.internalPointer());
+    QCOMPARE(model.index(1, 0).data().toString(), QStringLiteral("added"));
+    const auto* secondNode = static_cast<const OutlineNode*>(second.internalPointer());
+    QCOMPARE(secondNode->duChainObject(), static_cast<DUChainBase*>(newTop->localDeclarations().at(2)));
+
+    DUChain::self()->removeDocumentChain(oldTop);
+    DUChain::self()->removeDocumentChain(newTop);
+}
@@ -40,9 +40,12 @@
 #include <QPointer>
 #include <QTextBrowser>
 #include <QTextDocument>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include <algorithm>
+
 using namespace KDevelop;
 
 namespace
@@ -50,6 +53,10 @@ namespace
 QPointer<QWidget> currentTooltip;
 KTextEditor::MovingRange* currentTooltipMark;
 
+// Hunks this many lines above and below the displayed lines are highlighted as well,
+// so that they are ready when scrolling and views which are not laid out yet are covered
+const int visibleHunksMargin = 200;
+
 
 QSize sizeHintForHtml( const QString& html, QSize maxSize ) {
     QTextDocument doc;
@@ -292,6 +299,12 @@ void PatchHighlighter::performContentChange( KTextEditor::Document* doc, const Q
             qCDebug(PLUGIN_PATCHREVIEW) << "inserted destination" << s->string();
     }
 
+    m_pendingHunks.erase(std::remove_if(m_pendingHunks.begin(), m_pendingHunks.end(),
+                                        [&removed](const PendingHunk& hunk) {
+                                            return removed.contains(hunk.diff);
+                                        }),
+                         m_pendingHunks.end());
+
     // Remove all ranges that are in the same line (the line markers)
     for (auto it = m_ranges.begin(); it != m_ranges.end();) {
         if (removed.contains(it.value())) {
@@ -429,18 +442,16 @@ void PatchHighlighter::documentReloaded(KTextEditor::Document* doc)
     markIface->setMarkDescription( KTextEditor::MarkInterface::markType27, i18nc("@item", "Change") );
     markIface->setMarkPixmap(KTextEditor::MarkInterface::markType27, QIcon::fromTheme(QStringLiteral("text-field")).pixmap(markPixmapSize, markPixmapSize));
 
+    m_pendingHunks.reserve(m_model->differences()->size());
     for (Diff2::Difference* diff : qAsConst(*m_model->differences())) {
         int line, lineCount;
-        Diff2::DifferenceStringList lines;
 
         if( diff->applied() ) {
             line = diff->destinationLineNumber();
             lineCount = diff->destinationLineCount();
-            lines = diff->destinationLines();
         } else {
             line = diff->sourceLineNumber();
             lineCount = diff->sourceLineCount();
-            lines = diff->sourceLines();
         }
 
         if ( line > 0 )
@@ -454,11 +465,81 @@ void PatchHighlighter::documentReloaded(KTextEditor::Document* doc)
             endC.setLine( doc->lines() );
 
         if ( endC.isValid() && c.isValid() ) {
-            KTextEditor::MovingRange * r = moving->newMovingRange( KTextEditor::Range( c, endC ) );
-            m_ranges[r] = diff;
-            addLineMarker( r, diff );
+            m_pendingHunks.append({c.line(), endC.line(), diff});
         }
     }
+    std::stable_sort(m_pendingHunks.begin(), m_pendingHunks.end(), [](const PendingHunk& lhs, const PendingHunk& rhs) {
+        return lhs.startLine < rhs.startLine;
+    });
+
+    updateVisibleHunks();
+}
+
+void PatchHighlighter::viewCreated( KTextEditor::Document*, KTextEditor::View* view )
+{
+    connect(view, &KTextEditor::View::verticalScrollPositionChanged, this, [this]() {
+        m_visibleHunksTimer->start();
+    });
+    // the view is not laid out yet
+    m_visibleHunksTimer->start();
+}
+
+void PatchHighlighter::updateVisibleHunks()
+{
+    if ( m_pendingHunks.isEmpty() )
+        return;
+
+    const auto views = m_doc->textDocument()->views();
+    for (KTextEditor::View* view : views) {
+        highlightHunks(view->firstDisplayedLine() - visibleHunksMargin, view->lastDisplayedLine() + visibleHunksMargin);
+    }
+}
+
+void PatchHighlighter::highlightHunks( int firstLine, int lastLine )
+{
+    auto* moving = qobject_cast<KTextEditor::MovingInterface*>(m_doc->textDocument());
+    if ( !moving )
+        return;
+
+    auto begin = std::lower_bound(m_pendingHunks.begin(), m_pendingHunks.end(), firstLine,
+                                  [](const PendingHunk& hunk, int line) {
+                                      return hunk.startLine < line;
+                                  });
+    // hunks starting above firstLine may still reach into the lines
+    while (begin != m_pendingHunks.begin() && (begin - 1)->endLine >= firstLine) {
+        --begin;
+    }
+
+    auto end = begin;
+    for (; end != m_pendingHunks.end() && end->startLine <= lastLine; ++end) {
+        KTextEditor::MovingRange * r = moving->newMovingRange( KTextEditor::Range( end->startLine, 0, end->endLine, 0 ) );
+        m_ranges[r] = end->diff;
+        addLineMarker( r, end->diff );
+    }
+    m_pendingHunks.erase(begin, end);
+}
+
+void PatchHighlighter::pendingLineWrapped( KTextEditor::Document*, const KTextEditor::Cursor& position )
+{
+    // move the pending hunks like the cursors of the moving ranges would move
+    const int line = position.line();
+    for (PendingHunk& hunk : m_pendingHunks) {
+        if (hunk.startLine > line || (hunk.startLine == line && position.column() == 0))
+            ++hunk.startLine;
+        if (hunk.endLine > line)
+            ++hunk.endLine;
+        hunk.endLine = qMax(hunk.startLine, hunk.endLine);
+    }
+}
+
+void PatchHighlighter::pendingLineUnwrapped( KTextEditor::Document*, int line )
+{
+    for (PendingHunk& hunk : m_pendingHunks) {
+        if (hunk.startLine >= line)
+            --hunk.startLine;
+        if (hunk.endLine >= line)
+            --hunk.endLine;
+    }
 }
 
 void PatchHighlighter::textInserted(KTextEditor::Document* doc, const KTextEditor::Cursor& cursor, const QString& text) {
@@ -519,8 +600,22 @@ void PatchHighlighter::newlineInserted(KTextEditor::Document* doc, const KTextEd
 }
 
 PatchHighlighter::PatchHighlighter( Diff2::DiffModel* model, IDocument* kdoc, PatchReviewPlugin* plugin, bool updatePatchFromEdits )
-    : m_doc( kdoc ), m_plugin( plugin ), m_model( model ), m_applying( false ) {
+    : m_visibleHunksTimer( new QTimer( this ) ), m_doc( kdoc ), m_plugin( plugin ), m_model( model ), m_applying( false ) {
     KTextEditor::Document* doc = kdoc->textDocument();
+
+    m_visibleHunksTimer->setSingleShot( true );
+    m_visibleHunksTimer->setInterval( 0 );
+    connect(m_visibleHunksTimer, &QTimer::timeout, this, &PatchHighlighter::updateVisibleHunks);
+    // keep the lines of the hunks without moving range in sync with the document
+    connect(doc, &KTextEditor::Document::lineWrapped, this, &PatchHighlighter::pendingLineWrapped);
+    connect(doc, &KTextEditor::Document::lineUnwrapped, this, &PatchHighlighter::pendingLineUnwrapped);
+    connect(doc, &KTextEditor::Document::viewCreated, this, &PatchHighlighter::viewCreated);
+    const auto views = doc->views();
+    for (KTextEditor::View* view : views) {
+        connect(view, &KTextEditor::View::verticalScrollPositionChanged, this, [this]() {
+            m_visibleHunksTimer->start();
+        });
+    }
 //     connect( kdoc, SIGNAL(destroyed(QObject*)), this, SLOT(documentDestroyed()) );
     if (updatePatchFromEdits) {
         connect(doc, &KTextEditor::Document::textInserted, this, &PatchHighlighter::textInserted);
@@ -649,6 +744,8 @@ void PatchHighlighter::addLineMarker( KTextEditor::MovingRange* range, Diff2::Di
 }
 
 void PatchHighlighter::clear() {
+    m_pendingHunks.clear();
+
     if( m_ranges.empty() )
         return;
 
@@ -681,6 +778,8 @@ IDocument* PatchHighlighter::doc() {
 void PatchHighlighter::documentDestroyed() {
     qCDebug(PLUGIN_PATCHREVIEW) << "document destroyed";
     m_ranges.clear();
+    m_pendingHunks.clear();
+    m_visibleHunksTimer->stop();
 }
 
 void PatchHighlighter::aboutToDeleteMovingInterfaceContent( KTextEditor::Document* ) {
@@ -688,7 +787,18 @@ void PatchHighlighter::aboutToDeleteMovingInterfaceContent( KTextEditor::Documen
     clear();
 }
 
-QList< KTextEditor::MovingRange* > PatchHighlighter::ranges() const
+QVector<int> PatchHighlighter::hunkStartLines() const
 {
-    return m_ranges.keys();
+    QVector<int> ret;
+    ret.reserve(m_ranges.size() + m_pendingHunks.size());
+    for (auto it = m_ranges.constBegin(); it != m_ranges.constEnd(); ++it) {
+        // skip the ranges of the changed parts of lines
+        if (it.value()) {
+            ret.append(it.key()->start().line());
+        }
+    }
+    for (const PendingHunk& hunk : m_pendingHunks) {
+        ret.append(hunk.startLine);
+    }
+    return ret;
 }
@@ -21,6 +21,7 @@
 #include <QPair>
 #include <QPoint>
 #include <QSet>
+#include <QVector>
 
 namespace Diff2 {
 class Difference;
@@ -29,6 +30,8 @@ class DiffModel;
 
 class PatchReviewPlugin;
 
+class QTimer;
+
 namespace KDevelop
 {
 class IDocument;
@@ -37,6 +40,7 @@ class IDocument;
 namespace KTextEditor
 {
 class Document;
+class View;
 class Range;
 class Cursor;
 class Mark;
@@ -44,6 +48,9 @@ class MovingRange;
 }
 
 ///Delete itself when the document(or textDocument), or Diff-Model is deleted.
+///
+///Ranges and marks are only created for the hunks around the displayed lines of the document's views,
+///the remaining hunks are kept in a compact list until they are scrolled into view.
 class PatchHighlighter : public QObject
 {
     Q_OBJECT
@@ -51,12 +58,27 @@ public:
     PatchHighlighter( Diff2::DiffModel* model, KDevelop::IDocument* doc, PatchReviewPlugin* plugin, bool updatePatchFromEdits );
     ~PatchHighlighter() override;
     KDevelop::IDocument* doc();
-    QList< KTextEditor::MovingRange* > ranges() const;
+    /// @return the first lines of all hunks, including the ones which are not highlighted yet
+    QVector<int> hunkStartLines() const;
 private Q_SLOTS:
     void documentReloaded( KTextEditor::Document* );
     void documentDestroyed();
     void aboutToDeleteMovingInterfaceContent( KTextEditor::Document* );
+    void viewCreated( KTextEditor::Document*, KTextEditor::View* view );
+    void updateVisibleHunks();
+    void pendingLineWrapped( KTextEditor::Document*, const KTextEditor::Cursor& position );
+    void pendingLineUnwrapped( KTextEditor::Document*, int line );
 private:
+    /// A hunk without range and marks, its lines are shifted along with edits of the document
+    struct PendingHunk
+    {
+        int startLine;
+        int endLine;
+        Diff2::Difference* diff;
+    };
+
+    void highlightHunks( int firstLine, int lastLine );
+
     void addLineMarker( KTextEditor::MovingRange* arg1, Diff2::Difference* arg2 );
     void removeLineMarker( KTextEditor::MovingRange* range );
     void performContentChange( KTextEditor::Document* doc, const QStringList& oldLines, const QStringList& newLines, int editLineNumber );
@@ -65,6 +87,9 @@ private:
 
     void clear();
     QMap< KTextEditor::MovingRange*, Diff2::Difference* > m_ranges;
+    /// Sorted by line
+    QVector<PendingHunk> m_pendingHunks;
+    QTimer* m_visibleHunksTimer;
     KDevelop::IDocument* m_doc;
     PatchReviewPlugin* m_plugin;
     Diff2::DiffModel* m_model;
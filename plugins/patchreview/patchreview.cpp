@@ -15,9 +15,12 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QStandardPaths>
+#include <QThread>
 #include <QTimer>
 #include <QMimeDatabase>
+#include <QtConcurrentRun>
 
 #include <KActionCollection>
 #include <KLocalizedString>
@@ -64,6 +67,7 @@
 #include "localpatchsource.h"
 #include "debug.h"
 
+#include <algorithm>
 
 using namespace KDevelop;
 
@@ -71,6 +75,98 @@ namespace
 {
 // Maximum number of files to open directly within a tab when the review is started
 const int maximumFilesToOpenDirectly = 15;
+
+QUrl fileModelUrl( const QUrl& baseDir, uint depth, const Diff2::DiffModel* model )
+{
+    KDevelop::Path path(QDir::cleanPath(baseDir.toLocalFile()));
+    QVector<QString> destPath = KDevelop::Path(QLatin1Char('/') + model->destinationPath()).segments();
+    if (destPath.size() >= (int)depth) {
+        destPath.remove(0, depth);
+    }
+    for (const QString& segment : qAsConst(destPath)) {
+        path.addPath(segment);
+    }
+    path.addPath(model->destinationFile());
+
+    return path.toUrl();
+}
+}
+
+/// Parses a patch in a background thread, see PatchReviewPlugin::updateKompareModel()
+struct KompareModelUpdate
+{
+    QUrl baseDir;
+    bool alreadyApplied = false;
+
+    // declared before the model list, which uses them
+    QScopedPointer<DiffSettings> diffSettings;
+    QScopedPointer<Kompare::Info> kompareInfo;
+    QScopedPointer<Diff2::KompareModelList> modelList;
+
+    uint depth = 0;
+    QHash<QUrl, Diff2::DiffModel*> modelForUrl;
+    QString error;
+
+    void run( QWidget* widgetForKio, QThread* mainThread );
+
+private:
+    void parse( QThread* mainThread );
+};
+
+void KompareModelUpdate::run( QWidget* widgetForKio, QThread* mainThread )
+{
+    // the model list belongs to this thread, until the update is handed over to the main thread
+    modelList.reset( new Diff2::KompareModelList( diffSettings.data(), widgetForKio, nullptr ) );
+    modelList->slotKompareInfo( kompareInfo.data() );
+
+    parse( mainThread );
+
+    modelList->moveToThread( mainThread );
+}
+
+void KompareModelUpdate::parse( QThread* mainThread )
+{
+    try {
+        modelList->openDirAndDiff();
+    } catch ( const QString & str ) {
+        error = str;
+        return;
+    } catch ( ... ) {
+        error = QStringLiteral( "lib/libdiff2 crashed, memory may be corrupted. Please restart kdevelop." );
+        return;
+    }
+
+    const int modelCount = modelList->modelCount();
+    for (depth = 0; depth < 10; ++depth) {
+        bool allFound = true;
+        for (int i = 0; i < modelCount; ++i) {
+            if (!QFile::exists(fileModelUrl(baseDir, depth, modelList->modelAt(i)).toLocalFile())) {
+                allFound = false;
+                break;
+            }
+        }
+        if (allFound) {
+            break; // found depth
+        }
+    }
+
+    // the models were created in this thread, but are used by the main thread from now on
+    const auto moveToMainThread = [mainThread](QObject* object) {
+        if (!object->parent()) {
+            object->moveToThread(mainThread);
+        }
+    };
+
+    modelForUrl.reserve(modelCount);
+    for (int i = 0; i < modelCount; ++i) {
+        Diff2::DiffModel* model = modelList->modelAt(i);
+        for (auto* difference : *model->differences()) {
+            difference->apply(alreadyApplied);
+            moveToMainThread(difference);
+        }
+        moveToMainThread(model);
+        modelForUrl.insert(fileModelUrl(baseDir, depth, model), model);
+    }
 }
 
 void PatchReviewPlugin::seekHunk( bool forwards, const QUrl& fileName ) {
@@ -93,15 +189,13 @@ void PatchReviewPlugin::seekHunk( bool forwards, const QUrl& fileName ) {
 
             if ( doc && m_highlighters.contains( doc->url() ) && m_highlighters[doc->url()] ) {
                 if ( doc->textDocument() ) {
-                    const QList<KTextEditor::MovingRange*> ranges = m_highlighters[doc->url()]->ranges();
+                    const QVector<int> hunkLines = m_highlighters[doc->url()]->hunkStartLines();
 
                     KTextEditor::View * v = doc->activeTextView();
                     if ( v ) {
                         int bestLine = -1;
                         KTextEditor::Cursor c = v->cursorPosition();
-                        for (auto* range : ranges) {
-                            const int line = range->start().line();
-
+                        for (const int line : hunkLines) {
                             if ( forwards ) {
                                 if ( line > c.line() && ( bestLine == -1 || line < bestLine ) )
                                     bestLine = line;
@@ -132,60 +226,31 @@ void PatchReviewPlugin::seekHunk( bool forwards, const QUrl& fileName ) {
 }
 
 void PatchReviewPlugin::addHighlighting( const QUrl& highlightFile, IDocument* document ) {
-    try {
-        if ( !modelList() )
-            throw "no model";
-
-        for ( int a = 0; a < modelList()->modelCount(); ++a ) {
-            Diff2::DiffModel* model = modelList()->modelAt( a );
-            if ( !model )
-                continue;
-
-            QUrl file = urlForFileModel( model );
-
-            if ( file != highlightFile )
-                continue;
+    Diff2::DiffModel* model = m_modelForUrl.value( highlightFile );
+    if ( !model )
+        return;
 
-            qCDebug(PLUGIN_PATCHREVIEW) << "highlighting" << file.toDisplayString();
+    qCDebug(PLUGIN_PATCHREVIEW) << "highlighting" << highlightFile.toDisplayString();
 
-            IDocument* doc = document;
-            if( !doc )
-                doc = ICore::self()->documentController()->documentForUrl( file );
+    IDocument* doc = document;
+    if( !doc )
+        doc = ICore::self()->documentController()->documentForUrl( highlightFile );
 
-            qCDebug(PLUGIN_PATCHREVIEW) << "highlighting file" << file << "with doc" << doc;
+    qCDebug(PLUGIN_PATCHREVIEW) << "highlighting file" << highlightFile << "with doc" << doc;
 
-            if ( !doc || !doc->textDocument() )
-                continue;
+    if ( !doc || !doc->textDocument() )
+        return;
 
-            removeHighlighting( file );
+    removeHighlighting( highlightFile );
 
-            m_highlighters[file] = new PatchHighlighter(model, doc, this, (qobject_cast<LocalPatchSource*>(m_patch.data()) == nullptr));
-        }
-    } catch ( const QString & str ) {
-        qCDebug(PLUGIN_PATCHREVIEW) << "highlightFile():" << str;
-    } catch ( const char * str ) {
-        qCDebug(PLUGIN_PATCHREVIEW) << "highlightFile():" << str;
-    }
+    m_highlighters[highlightFile] = new PatchHighlighter(model, doc, this, (qobject_cast<LocalPatchSource*>(m_patch.data()) == nullptr));
 }
 
 void PatchReviewPlugin::highlightPatch() {
-    try {
-        if ( !modelList() )
-            throw "no model";
-
-        for ( int a = 0; a < modelList()->modelCount(); ++a ) {
-            const Diff2::DiffModel* model = modelList()->modelAt( a );
-            if ( !model )
-                continue;
-
-            QUrl file = urlForFileModel( model );
-
-            addHighlighting( file );
-        }
-    } catch ( const QString & str ) {
-        qCDebug(PLUGIN_PATCHREVIEW) << "highlightFile():" << str;
-    } catch ( const char * str ) {
-        qCDebug(PLUGIN_PATCHREVIEW) << "highlightFile():" << str;
+    // the other files are highlighted when they are opened, see textDocumentCreated()
+    const auto documents = ICore::self()->documentController()->openDocuments();
+    for (IDocument* doc : documents) {
+        addHighlighting( doc->url(), doc );
     }
 }
 
@@ -204,6 +269,9 @@ void PatchReviewPlugin::removeHighlighting( const QUrl& file ) {
 }
 
 void PatchReviewPlugin::notifyPatchChanged() {
+    // don't take over the models of the outdated patch
+    m_pendingModelUpdate.reset();
+
     if (m_patch) {
         qCDebug(PLUGIN_PATCHREVIEW) << "notifying patch change: " << m_patch->file();
         m_updateKompareTimer->start();
@@ -233,8 +301,11 @@ void PatchReviewPlugin::updateKompareModel() {
 
     qCDebug(PLUGIN_PATCHREVIEW) << "updating model";
     removeHighlighting();
+    m_pendingModelUpdate.reset();
     m_modelList.reset( nullptr );
+    m_modelForUrl.clear();
     m_depth = 0;
+    m_kompareInfo.reset( nullptr );
     delete m_diffSettings;
     {
         IDocument* patchDoc = ICore::self()->documentController()->documentForUrl( m_patch->file() );
@@ -254,62 +325,74 @@ void PatchReviewPlugin::updateKompareModel() {
         }
     }
 
-    if (!patchFile.isEmpty()) //only try to construct the model if we have a patch to load
-    try {
-        m_diffSettings = new DiffSettings( nullptr );
-        m_kompareInfo.reset( new Kompare::Info() );
-        m_kompareInfo->localDestination = patchFile;
-        m_kompareInfo->localSource = m_patch->baseDir().toLocalFile();
-        m_kompareInfo->depth = m_patch->depth();
-        m_kompareInfo->applied = m_patch->isAlreadyApplied();
-
-        m_modelList.reset( new Diff2::KompareModelList( m_diffSettings.data(), new QWidget, this ) );
-        m_modelList->slotKompareInfo( m_kompareInfo.data() );
-
-        try {
-            m_modelList->openDirAndDiff();
-        } catch ( const QString & /*str*/ ) {
-            throw;
-        } catch ( ... ) {
-            throw QStringLiteral( "lib/libdiff2 crashed, memory may be corrupted. Please restart kdevelop." );
-        }
-
-        for (m_depth = 0; m_depth < 10; ++m_depth) {
-            bool allFound = true;
-            for( int i = 0; i < m_modelList->modelCount(); i++ ) {
-                if (!QFile::exists(urlForFileModel(m_modelList->modelAt(i)).toLocalFile())) {
-                    allFound = false;
-                }
-            }
-            if (allFound) {
-                break; // found depth
-            }
-        }
-
+    if (patchFile.isEmpty()) { //only try to construct the model if we have a patch to load
+        m_openFilesAfterUpdate = false;
         emit patchChanged();
+        return;
+    }
 
-        for( int i = 0; i < m_modelList->modelCount(); i++ ) {
-            const Diff2::DiffModel* model = m_modelList->modelAt( i );
-            for (auto* difference : *model->differences()) {
-                difference->apply(m_patch->isAlreadyApplied());
-            }
-        }
+    QSharedPointer<KompareModelUpdate> update(new KompareModelUpdate);
+    update->baseDir = m_patch->baseDir();
+    update->alreadyApplied = m_patch->isAlreadyApplied();
+    update->diffSettings.reset( new DiffSettings( nullptr ) );
+    update->kompareInfo.reset( new Kompare::Info() );
+    update->kompareInfo->localDestination = patchFile;
+    update->kompareInfo->localSource = m_patch->baseDir().toLocalFile();
+    update->kompareInfo->depth = m_patch->depth();
+    update->kompareInfo->applied = m_patch->isAlreadyApplied();
+    m_pendingModelUpdate = update;
+
+    // Parsing and blending very large patches takes long, so it is done in the background.
+    // The background thread creates the model list of the update and owns it until it finishes.
+    auto* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, update]() {
+        watcher->deleteLater();
+        kompareModelUpdated(update);
+    });
+    KompareModelUpdate* runningUpdate = update.data();
+    auto* widgetForKio = new QWidget;
+    QThread* mainThread = thread();
+    const QFuture<void> future = QtConcurrent::run([runningUpdate, widgetForKio, mainThread]() {
+        runningUpdate->run(widgetForKio, mainThread);
+    });
+    watcher->setFuture(future);
+
+    m_modelUpdateFutures.erase(std::remove_if(m_modelUpdateFutures.begin(), m_modelUpdateFutures.end(),
+                                              [](const QFuture<void>& running) {
+                                                  return running.isFinished();
+                                              }),
+                               m_modelUpdateFutures.end());
+    m_modelUpdateFutures.append(future);
+}
 
-        highlightPatch();
+void PatchReviewPlugin::kompareModelUpdated( const QSharedPointer<KompareModelUpdate>& update ) {
+    if ( update != m_pendingModelUpdate ) {
+        // the patch changed or the review was closed in the meantime
+        return;
+    }
+    m_pendingModelUpdate.reset();
 
+    if ( !update->error.isEmpty() ) {
+        m_openFilesAfterUpdate = false;
+        KMessageBox::error(nullptr, update->error, i18nc("@title:window", "Kompare Model Update"));
+        emit patchChanged();
         return;
-    } catch ( const QString & str ) {
-        KMessageBox::error(nullptr, str, i18nc("@title:window", "Kompare Model Update"));
-    } catch ( const char * str ) {
-        KMessageBox::error(nullptr, QLatin1String(str), i18nc("@title:window", "Kompare Model Update"));
     }
-    removeHighlighting();
-    m_modelList.reset( nullptr );
-    m_depth = 0;
-    m_kompareInfo.reset( nullptr );
-    delete m_diffSettings;
+
+    m_diffSettings = update->diffSettings.take();
+    m_kompareInfo.reset( update->kompareInfo.take() );
+    m_modelList.reset( update->modelList.take() );
+    m_depth = update->depth;
+    m_modelForUrl = update->modelForUrl;
 
     emit patchChanged();
+
+    highlightPatch();
+
+    if ( m_openFilesAfterUpdate ) {
+        m_openFilesAfterUpdate = false;
+        openReviewFiles();
+    }
 }
 
 K_PLUGIN_FACTORY_WITH_JSON(KDevPatchReviewFactory, "kdevpatchreview.json",
@@ -345,6 +428,11 @@ PatchReviewPlugin::~PatchReviewPlugin()
     // and http://qt-project.org/forums/viewthread/38406/#162801
     // modified tweak: use setPatch() and deleteLater in that method.
     setPatch(nullptr);
+
+    // the running updates use models which are deleted along with their watchers
+    for (QFuture<void>& future : m_modelUpdateFutures) {
+        future.waitForFinished();
+    }
 }
 
 void PatchReviewPlugin::closeReview()
@@ -360,7 +448,10 @@ void PatchReviewPlugin::closeReview()
         }
 
         removeHighlighting();
+        m_pendingModelUpdate.reset();
+        m_openFilesAfterUpdate = false;
         m_modelList.reset( nullptr );
+        m_modelForUrl.clear();
         m_depth = 0;
 
         if (!qobject_cast<LocalPatchSource*>(m_patch.data())) {
@@ -413,17 +504,7 @@ void PatchReviewPlugin::switchToEmptyReviewArea()
 
 QUrl PatchReviewPlugin::urlForFileModel( const Diff2::DiffModel* model )
 {
-    KDevelop::Path path(QDir::cleanPath(m_patch->baseDir().toLocalFile()));
-    QVector<QString> destPath = KDevelop::Path(QLatin1Char('/') + model->destinationPath()).segments();
-    if (destPath.size() >= (int)m_depth) {
-        destPath.remove(0, m_depth);
-    }
-    for (const QString& segment : qAsConst(destPath)) {
-        path.addPath(segment);
-    }
-    path.addPath(model->destinationFile());
-
-    return path.toUrl();
+    return fileModelUrl(m_patch->baseDir(), m_depth, model);
 }
 
 void PatchReviewPlugin::updateReview()
@@ -435,12 +516,19 @@ void PatchReviewPlugin::updateReview()
 
     switchToEmptyReviewArea();
 
-    KDevelop::IDocumentController *docController = ICore::self()->documentController();
     // don't add documents opened automatically to the Files/Open Recent list
-    IDocument* futureActiveDoc = docController->openDocument( m_patch->file(), KTextEditor::Range::invalid(),
-                                                              IDocumentController::DoNotAddToRecentOpen );
+    ICore::self()->documentController()->openDocument( m_patch->file(), KTextEditor::Range::invalid(),
+                                                       IDocumentController::DoNotAddToRecentOpen );
 
+    // the files are opened once the patch was parsed
+    m_openFilesAfterUpdate = true;
     updateKompareModel();
+}
+
+void PatchReviewPlugin::openReviewFiles()
+{
+    KDevelop::IDocumentController *docController = ICore::self()->documentController();
+    IDocument* futureActiveDoc = docController->documentForUrl( m_patch->file() );
 
     if ( !m_modelList || !futureActiveDoc || !futureActiveDoc->textDocument() ) {
         // might happen if e.g. openDocument dialog was cancelled by user
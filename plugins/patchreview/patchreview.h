@@ -14,7 +14,11 @@
 #ifndef KDEVPLATFORM_PLUGIN_PATCHREVIEW_H
 #define KDEVPLATFORM_PLUGIN_PATCHREVIEW_H
 
+#include <QFuture>
+#include <QHash>
 #include <QPointer>
+#include <QSharedPointer>
+#include <QVector>
 
 #include <interfaces/iplugin.h>
 #include <interfaces/ipatchsource.h>
@@ -44,6 +48,7 @@ struct Info;
 
 class DiffSettings;
 class PatchReviewPlugin;
+struct KompareModelUpdate;
 
 class PatchReviewPlugin : public KDevelop::IPlugin, public KDevelop::IPatchReview, public KDevelop::ILanguageSupport
 {
@@ -116,6 +121,11 @@ private:
     void addHighlighting( const QUrl& file, KDevelop::IDocument* document = nullptr );
     void removeHighlighting( const QUrl& file = QUrl() );
 
+    /// Takes over the models parsed in the background by updateKompareModel()
+    void kompareModelUpdated( const QSharedPointer<KompareModelUpdate>& update );
+    /// Opens the changed files, the second part of updateReview() which needs the models
+    void openReviewFiles();
+
     KDevelop::IPatchSource::Ptr m_patch;
 
     QTimer* m_updateKompareTimer;
@@ -131,6 +141,10 @@ private:
     QScopedPointer< Kompare::Info > m_kompareInfo;
     QScopedPointer< Diff2::KompareModelList > m_modelList;
     uint m_depth = 0; // depth of the patch represented by m_modelList
+    QHash<QUrl, Diff2::DiffModel*> m_modelForUrl; // the models of m_modelList by urlForFileModel()
+    QSharedPointer<KompareModelUpdate> m_pendingModelUpdate; // the update which is parsed currently, if any
+    QVector<QFuture<void>> m_modelUpdateFutures; // waited for on destruction
+    bool m_openFilesAfterUpdate = false;
     using HighlightMap = QMap<QUrl, QPointer<PatchHighlighter>>;
     HighlightMap m_highlighters;
 
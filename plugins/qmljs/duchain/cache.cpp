@@ -30,6 +30,30 @@
 #include <QStandardPaths>
 #include <QCryptographicHash>
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QSaveFile>
+
+namespace {
+// bump whenever the format of the stored cache changes
+const quint32 cacheFormatVersion = 1;
+
+KDevelop::Path::List searchPaths(const KDevelop::Path::List& includeDirs)
+{
+    KDevelop::Path::List paths;
+
+    const auto& libraryPaths = QCoreApplication::instance()->libraryPaths();
+    for (auto& path : libraryPaths) {
+        KDevelop::Path p(path);
+
+        // Change /path/to/qt5/plugins to /path/to/qt5/{qml,imports}
+        paths << p.cd(QStringLiteral("../qml"));
+        paths << p.cd(QStringLiteral("../imports"));
+    }
+
+    paths << includeDirs;
+    return paths;
+}
+}
 
 QmlJS::Cache::Cache()
 {
@@ -55,40 +79,40 @@ QmlJS::Cache& QmlJS::Cache::instance()
 
 KDevelop::Path::List QmlJS::Cache::libraryPaths(const KDevelop::IndexedString& baseFile) const
 {
-    QMutexLocker lock(&m_mutex);
-    return libraryPaths_internal(baseFile);
+    KDevelop::Path::List includeDirs;
+    {
+        QReadLocker lock(&m_lock);
+        includeDirs = m_includeDirs.value(baseFile);
+    }
+    return searchPaths(includeDirs);
 }
 
-KDevelop::Path::List QmlJS::Cache::libraryPaths_internal(const KDevelop::IndexedString& baseFile) const
+QString QmlJS::Cache::moduleKey(const QString& uri, const QString& version, const KDevelop::Path::List& includeDirs)
 {
-    Q_ASSERT(!m_mutex.try_lock());
-
-    KDevelop::Path::List paths;
-
-    const auto& libraryPaths = QCoreApplication::instance()->libraryPaths();
-    for (auto& path : libraryPaths) {
-        KDevelop::Path p(path);
-
-        // Change /path/to/qt5/plugins to /path/to/qt5/{qml,imports}
-        paths << p.cd(QStringLiteral("../qml"));
-        paths << p.cd(QStringLiteral("../imports"));
+    QString key = uri + QLatin1Char(' ') + version;
+    for (const auto& dir : includeDirs) {
+        key += QLatin1Char('\n') + dir.pathOrUrl();
     }
-
-    paths << m_includeDirs[baseFile];
-    return paths;
+    return key;
 }
 
 QString QmlJS::Cache::modulePath(const KDevelop::IndexedString& baseFile, const QString& uri, const QString& version)
 {
-    QMutexLocker lock(&m_mutex);
-    QString cacheKey = uri + version;
-    QString path = m_modulePaths.value(cacheKey, QString());
-
-    if (!path.isEmpty()) {
-        return path;
+    KDevelop::Path::List includeDirs;
+    QString cacheKey;
+    {
+        QReadLocker lock(&m_lock);
+        includeDirs = m_includeDirs.value(baseFile);
+        cacheKey = moduleKey(uri, version, includeDirs);
+
+        const QString path = m_modulePaths.value(cacheKey);
+        if (!path.isEmpty()) {
+            return path;
+        }
     }
 
     // Find the path for which <path>/u/r/i exists
+    QString path;
     QString fragment = QString(uri).replace(QLatin1Char('.'), QDir::separator());
     bool isVersion1 = version.startsWith(QLatin1String("1."));
     bool isQtQuick = (uri == QLatin1String("QtQuick"));
@@ -107,7 +131,7 @@ QString QmlJS::Cache::modulePath(const KDevelop::IndexedString& baseFile, const
         fragment += QLatin1Char('.') + version.section(QLatin1Char('.'), 0, 0);
     }
 
-    const auto paths = libraryPaths_internal(baseFile);
+    const auto paths = searchPaths(includeDirs);
     for (auto& p : paths) {
         QString pathString = p.cd(fragment).path();
 
@@ -124,7 +148,11 @@ QString QmlJS::Cache::modulePath(const KDevelop::IndexedString& baseFile, const
         }
     }
 
-    m_modulePaths.insert(cacheKey, path);
+    // Modules which were not found are searched again, they may have been installed meanwhile
+    if (!path.isEmpty()) {
+        QWriteLocker lock(&m_lock);
+        m_modulePaths.insert(cacheKey, path);
+    }
     return path;
 }
 
@@ -150,15 +178,14 @@ QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
         }
 
         // Use the cache to speed-up reparses
+        const QDateTime lastModified = fileInfo.lastModified();
         {
-            QMutexLocker lock(&m_mutex);
+            QReadLocker lock(&m_lock);
 
-            const auto modulePathIt = m_modulePaths.constFind(filePath);
-            if (modulePathIt != m_modulePaths.constEnd()) {
-                const QString& cachedFilePath = *modulePathIt;
-
-                if (!cachedFilePath.isEmpty()) {
-                    result.append(cachedFilePath);
+            const auto pluginDumpIt = m_pluginDumps.constFind(filePath);
+            if (pluginDumpIt != m_pluginDumps.constEnd() && pluginDumpIt->pluginLastModified == lastModified) {
+                if (!pluginDumpIt->dumpPath.isEmpty()) {
+                    result.append(pluginDumpIt->dumpPath);
                 }
 
                 continue;
@@ -166,23 +193,25 @@ QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
         }
 
         // Locate an existing dump of the file
-        QString dumpFile = QStringLiteral("kdevqmljssupport/%1.qml").arg(
+        const QString dumpFileName = QStringLiteral("kdevqmljssupport/%1.qml").arg(
             QString::fromLatin1(QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Md5).toHex())
         );
         QString dumpPath = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-            dumpFile
+            dumpFileName
         );
 
         if (!dumpPath.isEmpty()) {
-            QMutexLocker lock(&m_mutex);
+            QWriteLocker lock(&m_lock);
 
             result.append(dumpPath);
-            m_modulePaths.insert(filePath, dumpPath);
+            m_pluginDumps.insert(filePath, {dumpPath, lastModified});
             continue;
         }
 
         // Create a dump of the file
         const QStringList args = {QStringLiteral("-noinstantiate"), QStringLiteral("-path"), filePath};
+        const QString dataLocation = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation);
+        QDir(dataLocation).mkpath(QStringLiteral("kdevqmljssupport"));
 
         for (const PluginDumpExecutable& executable : qAsConst(m_pluginDumpExecutables)) {
             QProcess qmlplugindump;
@@ -208,10 +237,7 @@ QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
             }
 
             // Open a file in which the dump can be written
-            QFile dumpFile(
-                QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
-                + dumpPath
-            );
+            QFile dumpFile(dataLocation + QLatin1Char('/') + dumpFileName);
 
             if (dumpFile.open(QIODevice::WriteOnly)) {
                 qmlplugindump.readLine();   // Skip "import QtQuick.tooling 1.1"
@@ -221,13 +247,15 @@ QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
                 dumpFile.write(qmlplugindump.readAllStandardOutput());
                 dumpFile.close();
 
-                result.append(dumpFile.fileName());
-
-                QMutexLocker lock(&m_mutex);
-                m_modulePaths.insert(filePath, dumpFile.fileName());
+                dumpPath = dumpFile.fileName();
+                result.append(dumpPath);
                 break;
             }
         }
+
+        // Failures are remembered as well, so qmlplugindump is only tried again once the plugin changed
+        QWriteLocker lock(&m_lock);
+        m_pluginDumps.insert(filePath, {dumpPath, lastModified});
     }
 
     return result;
@@ -235,14 +263,14 @@ QStringList QmlJS::Cache::getFileNames(const QFileInfoList& fileInfos)
 
 void QmlJS::Cache::setFileCustomIncludes(const KDevelop::IndexedString& file, const KDevelop::Path::List& dirs)
 {
-    QMutexLocker lock(&m_mutex);
+    QWriteLocker lock(&m_lock);
 
     m_includeDirs[file] = dirs;
 }
 
 void QmlJS::Cache::addDependency(const KDevelop::IndexedString& file, const KDevelop::IndexedString& dependency)
 {
-    QMutexLocker lock(&m_mutex);
+    QWriteLocker lock(&m_lock);
 
     m_dependees[dependency].insert(file);
     m_dependencies[file].insert(dependency);
@@ -250,28 +278,124 @@ void QmlJS::Cache::addDependency(const KDevelop::IndexedString& file, const KDev
 
 QList<KDevelop::IndexedString> QmlJS::Cache::filesThatDependOn(const KDevelop::IndexedString& file)
 {
-    QMutexLocker lock(&m_mutex);
+    QReadLocker lock(&m_lock);
 
-    return m_dependees[file].values();
+    return m_dependees.value(file).values();
 }
 
 QList<KDevelop::IndexedString> QmlJS::Cache::dependencies(const KDevelop::IndexedString& file)
 {
-    QMutexLocker lock(&m_mutex);
+    QReadLocker lock(&m_lock);
 
-    return m_dependencies[file].values();
+    return m_dependencies.value(file).values();
 }
 
 bool QmlJS::Cache::isUpToDate(const KDevelop::IndexedString& file)
 {
-    QMutexLocker lock(&m_mutex);
+    QReadLocker lock(&m_lock);
 
     return m_isUpToDate.value(file, false);
 }
 
 void QmlJS::Cache::setUpToDate(const KDevelop::IndexedString& file, bool upToDate)
 {
-    QMutexLocker lock(&m_mutex);
+    QWriteLocker lock(&m_lock);
 
     m_isUpToDate[file] = upToDate;
 }
+
+bool QmlJS::Cache::load(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    quint32 version = 0;
+    stream >> version;
+    if (stream.status() != QDataStream::Ok || version != cacheFormatVersion) {
+        qCDebug(KDEV_QMLJS_DUCHAIN) << "Discarding module cache of unsupported version" << version << filePath;
+        return false;
+    }
+
+    QStringList applicationLibraryPaths;
+    QHash<QString, QString> modulePaths;
+    qint32 pluginDumpCount = 0;
+    stream >> applicationLibraryPaths >> modulePaths >> pluginDumpCount;
+
+    QHash<QString, PluginDump> pluginDumps;
+    for (qint32 i = 0; i < pluginDumpCount && stream.status() == QDataStream::Ok; ++i) {
+        QString plugin;
+        PluginDump dump;
+        stream >> plugin >> dump.dumpPath >> dump.pluginLastModified;
+        pluginDumps.insert(plugin, dump);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KDEV_QMLJS_DUCHAIN) << "Discarding corrupted module cache" << filePath;
+        return false;
+    }
+
+    // Validate the entries before taking the lock, this accesses the file system
+    if (applicationLibraryPaths != QCoreApplication::instance()->libraryPaths()) {
+        // A different Qt is used, all module paths may have changed
+        modulePaths.clear();
+    }
+    for (auto it = modulePaths.begin(); it != modulePaths.end();) {
+        if (QFileInfo::exists(*it)) {
+            ++it;
+        } else {
+            it = modulePaths.erase(it);
+        }
+    }
+    for (auto it = pluginDumps.begin(); it != pluginDumps.end();) {
+        const QFileInfo plugin(it.key());
+        if (plugin.exists() && plugin.lastModified() == it->pluginLastModified
+            && (it->dumpPath.isEmpty() || QFileInfo::exists(it->dumpPath))) {
+            ++it;
+        } else {
+            it = pluginDumps.erase(it);
+        }
+    }
+
+    QWriteLocker lock(&m_lock);
+    // Entries resolved in this session already are newer
+    for (auto it = modulePaths.constBegin(); it != modulePaths.constEnd(); ++it) {
+        if (!m_modulePaths.contains(it.key())) {
+            m_modulePaths.insert(it.key(), it.value());
+        }
+    }
+    for (auto it = pluginDumps.constBegin(); it != pluginDumps.constEnd(); ++it) {
+        if (!m_pluginDumps.contains(it.key())) {
+            m_pluginDumps.insert(it.key(), it.value());
+        }
+    }
+    return true;
+}
+
+bool QmlJS::Cache::save(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDEV_QMLJS_DUCHAIN) << "Could not write module cache" << filePath << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+
+    {
+        QReadLocker lock(&m_lock);
+
+        stream << cacheFormatVersion << QCoreApplication::instance()->libraryPaths() << m_modulePaths
+               << static_cast<qint32>(m_pluginDumps.size());
+        for (auto it = m_pluginDumps.constBegin(); it != m_pluginDumps.constEnd(); ++it) {
+            stream << it.key() << it->dumpPath << it->pluginLastModified;
+        }
+    }
+
+    return file.commit();
+}
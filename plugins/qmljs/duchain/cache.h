@@ -27,12 +27,13 @@
 #include <serialization/indexedstring.h>
 #include <util/path.h>
 
+#include <QDateTime>
 #include <QHash>
 #include <QString>
 #include <QFileInfoList>
 #include <QList>
 #include <QSet>
-#include <QMutex>
+#include <QReadWriteLock>
 
 class QStringList;
 
@@ -42,6 +43,11 @@ namespace QmlJS
 /**
  * Cache for values that may be slow to compute (search paths, things
  * involving QStandardPaths, etc)
+ *
+ * The cache is read by all parse jobs at the same time, so lookups only take
+ * a read lock, and the file system is never accessed while the lock is held.
+ * The resolved module paths and the results of qmlplugindump are kept across
+ * sessions, see load() and save().
  */
 class KDEVQMLJSDUCHAIN_EXPORT Cache
 {
@@ -106,8 +112,18 @@ public:
     bool isUpToDate(const KDevelop::IndexedString& file);
     void setUpToDate(const KDevelop::IndexedString& file, bool upToDate);
 
+    /**
+     * Adds the module paths and plugin dumps stored in @p filePath to the cache.
+     *
+     * Entries are dropped if the library paths of Qt changed, if a module path
+     * does not exist any more, or if a plugin was changed since it was dumped.
+     */
+    bool load(const QString& filePath);
+    bool save(const QString& filePath) const;
+
 private:
-    KDevelop::Path::List libraryPaths_internal(const KDevelop::IndexedString& baseFile) const;
+    /// Key of a module path, includes the custom include dirs it was searched in
+    static QString moduleKey(const QString& uri, const QString& version, const KDevelop::Path::List& includeDirs);
 
     struct PluginDumpExecutable {
         QString executable;
@@ -118,8 +134,17 @@ private:
         {}
     };
 
-    mutable QMutex m_mutex;
+    struct PluginDump {
+        /// Empty if no qmlplugindump could dump the plugin
+        QString dumpPath;
+        QDateTime pluginLastModified;
+    };
+
+    mutable QReadWriteLock m_lock;
+    /// Maps the module keys to the found paths, which are empty if the module was not found
     QHash<QString, QString> m_modulePaths;
+    /// Maps the paths of binary plugins to their dumps
+    QHash<QString, PluginDump> m_pluginDumps;
     QList<PluginDumpExecutable> m_pluginDumpExecutables;
     QHash<KDevelop::IndexedString, QSet<KDevelop::IndexedString>> m_dependees;
     QHash<KDevelop::IndexedString, QSet<KDevelop::IndexedString>> m_dependencies;
@@ -36,6 +36,8 @@
 #include <language/duchain/classdeclaration.h>
 #include <language/editor/documentrange.h>
 
+#include <QDir>
+#include <QTemporaryDir>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestDeclarations)
@@ -289,3 +291,32 @@ void TestDeclarations::testQMLtypesImportPaths()
     path = QmlJS::Cache::instance().modulePath(stubPath, QStringLiteral("QtMultimedia"), QStringLiteral("5.6"));
     QVERIFY(QFileInfo::exists(path + "/plugins.qmltypes"));
 }
+
+void TestDeclarations::testModuleCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkpath(QStringLiteral("imports/Custom/Module.2")));
+    QFile qmltypes(dir.filePath(QStringLiteral("imports/Custom/Module.2/plugins.qmltypes")));
+    QVERIFY(qmltypes.open(QIODevice::WriteOnly));
+    qmltypes.close();
+
+    auto& cache = QmlJS::Cache::instance();
+    const KDevelop::IndexedString withIncludes(dir.filePath(QStringLiteral("withincludes.qml")));
+    const KDevelop::IndexedString withoutIncludes(dir.filePath(QStringLiteral("withoutincludes.qml")));
+    cache.setFileCustomIncludes(withIncludes, {KDevelop::Path(dir.filePath(QStringLiteral("imports")))});
+
+    // the search paths are part of the key, so the result of one file is not used for another one
+    const QString modulePath = cache.modulePath(withIncludes, QStringLiteral("Custom.Module"), QStringLiteral("2.0"));
+    QCOMPARE(modulePath, dir.filePath(QStringLiteral("imports/Custom/Module.2")));
+    QVERIFY(cache.modulePath(withoutIncludes, QStringLiteral("Custom.Module"), QStringLiteral("2.0")).isEmpty());
+
+    const QString cacheFile = dir.filePath(QStringLiteral("modulecache"));
+    QVERIFY(cache.save(cacheFile));
+    QVERIFY(cache.load(cacheFile));
+    QCOMPARE(cache.modulePath(withIncludes, QStringLiteral("Custom.Module"), QStringLiteral("2.0")), modulePath);
+
+    QFile corrupted(cacheFile);
+    QVERIFY(corrupted.resize(corrupted.size() / 2));
+    QVERIFY(!cache.load(cacheFile));
+}
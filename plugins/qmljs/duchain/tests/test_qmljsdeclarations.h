@@ -38,6 +38,7 @@ private Q_SLOTS:
     void testProperty();
 
     void testQMLtypesImportPaths();
+    void testModuleCache();
 };
 
 #endif // TESTCONTEXTS_H
@@ -25,6 +25,7 @@
 #include "codecompletion/model.h"
 #include "navigation/propertypreviewwidget.h"
 #include "duchain/helper.h"
+#include "duchain/cache.h"
 
 #include <qmljs/qmljsmodelmanagerinterface.h>
 
@@ -38,11 +39,13 @@
 #include <language/duchain/duchainutils.h>
 #include <language/interfaces/editorcontext.h>
 #include <interfaces/icore.h>
+#include <interfaces/isession.h>
 #include <interfaces/idocumentcontroller.h>
 #include <interfaces/ilanguagecontroller.h>
 #include <interfaces/contextmenuextension.h>
 
 #include <QReadWriteLock>
+#include <QTimer>
 
 K_PLUGIN_FACTORY_WITH_JSON(KDevQmlJsSupportFactory, "kdevqmljs.json", registerPlugin<KDevQmlJsPlugin>(); )
 
@@ -63,6 +66,13 @@ ModelManager::ModelManager(QObject* parent)
 
 ModelManager::~ModelManager() {}
 
+namespace {
+QString moduleCacheFile(KDevelop::IPlugin* plugin)
+{
+    return plugin->core()->activeSession()->pluginDataArea(plugin).toLocalFile() + QLatin1String("/modulecache");
+}
+}
+
 KDevQmlJsPlugin::KDevQmlJsPlugin(QObject* parent, const QVariantList& )
 : IPlugin(QStringLiteral("kdevqmljssupport"), parent )
 , ILanguageSupport()
@@ -71,6 +81,10 @@ KDevQmlJsPlugin::KDevQmlJsPlugin(QObject* parent, const QVariantList& )
 , m_modelManager(new ModelManager(this))
 {
     QmlJS::registerDUChainItems();
+    // the data area of the plugin is only known once the plugin controller registered it
+    QTimer::singleShot(0, this, [this]() {
+        QmlJS::Cache::instance().load(moduleCacheFile(this));
+    });
 
     CodeCompletionModel* codeCompletion = new QmlJS::CodeCompletionModel(this);
     new KDevelop::CodeCompletion(this, codeCompletion, name());
@@ -88,6 +102,11 @@ KDevQmlJsPlugin::~KDevQmlJsPlugin()
     QmlJS::unregisterDUChainItems();
 }
 
+void KDevQmlJsPlugin::unload()
+{
+    QmlJS::Cache::instance().save(moduleCacheFile(this));
+}
+
 ParseJob* KDevQmlJsPlugin::createParseJob(const IndexedString& url)
 {
     return new QmlJsParseJob(url, this);
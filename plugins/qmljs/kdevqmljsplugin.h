@@ -33,6 +33,8 @@ public:
     explicit KDevQmlJsPlugin( QObject* parent, const QVariantList& args = QVariantList() );
     ~KDevQmlJsPlugin() override;
 
+    void unload() override;
+
     KDevelop::ParseJob* createParseJob(const KDevelop::IndexedString& url) override;
     QString name() const override;
 
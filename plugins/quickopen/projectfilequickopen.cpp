@@ -36,6 +36,7 @@
 #include <language/duchain/parsingenvironment.h>
 #include <util/texteditorhelpers.h>
 
+#include <project/projectfileset.h>
 #include <project/projectmodel.h>
 #include <project/projectutils.h>
 
@@ -238,9 +239,9 @@ ProjectFileDataProvider::ProjectFileDataProvider()
 void ProjectFileDataProvider::projectClosing(IProject* project)
 {
     // Once we remove all project's files from set, there is no need to listen
-    // to &IProject::fileRemovedFromSet signal from this project and waste time
-    // searching in m_projectFiles. No need to listen to &IProject::fileAddedToSet
-    // signal from this project either - we are not interested in hypothetical
+    // to removals from the file set of this project and waste time searching
+    // in m_projectFiles. No need to listen to additions to the file set of this
+    // project either - we are not interested in hypothetical
     // file additions to the project that is about to be closed and destroyed.
     disconnect(project, nullptr, this, nullptr);
 
@@ -252,7 +253,11 @@ void ProjectFileDataProvider::projectClosing(IProject* project)
         return;
     }
 
-    const Path projectPath = project->path();
+    removeProjectFiles(project->path());
+}
+
+void ProjectFileDataProvider::removeProjectFiles(const Path& projectPath)
+{
     const auto logicalEnd = std::remove_if(m_projectFiles.begin(), m_projectFiles.end(),
                                            [&projectPath](const ProjectFile& f) {
                                                return f.projectPath == projectPath;
@@ -264,55 +269,83 @@ void ProjectFileDataProvider::projectOpened(IProject* project)
 {
     const int processAfter = 1000;
     int processed = 0;
-    KDevelop::forEachFile(project->projectItem(), [&](ProjectFileItem* file) {
-        fileAddedToSet(file);
+    const Path projectPath = project->path();
+    QVector<ProjectFile> files;
+    // does not create the items of compactly stored files
+    KDevelop::forEachFilePath(project->projectItem(), [&](const Path& path, const IndexedString& indexedPath) {
+        ProjectFile f;
+        f.projectPath = projectPath;
+        f.path = path;
+        f.indexedPath = indexedPath;
+        f.outsideOfProject = !projectPath.isParentOf(path);
+        files.append(std::move(f));
         if (++processed == processAfter) {
             // prevent UI-lockup when a huge project was imported
             QApplication::processEvents();
             processed = 0;
         }
     });
+    addFiles(files);
 
-    connect(project, &IProject::fileAddedToSet,
-            this, &ProjectFileDataProvider::fileAddedToSet);
-    connect(project, &IProject::fileRemovedFromSet,
-            this, &ProjectFileDataProvider::fileRemovedFromSet);
+    // changes which happened during the import are emitted later on, addFiles() ignores known files
+    connect(project, &IProject::fileSetChanged,
+            this, [this, project](const ProjectFileSetDelta& delta) {
+                fileSetChanged(project, delta);
+            });
 }
 
-void ProjectFileDataProvider::fileAddedToSet(ProjectFileItem* file)
+void ProjectFileDataProvider::fileSetChanged(IProject* project, const ProjectFileSetDelta& delta)
 {
-    ProjectFile f;
-    f.projectPath = file->project()->path();
-    f.path = file->path();
-    f.indexedPath = file->indexedPath();
-    f.outsideOfProject = !f.projectPath.isParentOf(f.path);
-    auto it = std::lower_bound(m_projectFiles.begin(), m_projectFiles.end(), f);
-    if (it == m_projectFiles.end() || it->path != f.path) {
-        m_projectFiles.insert(it, std::move(f));
+    const Path projectPath = project->path();
+    if (delta.cleared) {
+        removeProjectFiles(projectPath);
+    }
+
+    if (!delta.removed.isEmpty()) {
+        QSet<IndexedString> removed;
+        removed.reserve(delta.removed.size());
+        for (const IndexedString& file : delta.removed) {
+            removed.insert(file);
+        }
+        const auto logicalEnd = std::remove_if(m_projectFiles.begin(), m_projectFiles.end(),
+                                               [&removed](const ProjectFile& f) {
+                                                   return removed.contains(f.indexedPath);
+                                               });
+        m_projectFiles.erase(logicalEnd, m_projectFiles.end());
+    }
+
+    if (!delta.added.isEmpty()) {
+        QVector<ProjectFile> files;
+        files.reserve(delta.added.size());
+        for (const IndexedString& file : delta.added) {
+            ProjectFile f;
+            f.projectPath = projectPath;
+            f.path = Path(file.str());
+            f.indexedPath = file;
+            f.outsideOfProject = !projectPath.isParentOf(f.path);
+            files.append(std::move(f));
+        }
+        addFiles(files);
     }
 }
 
-void ProjectFileDataProvider::fileRemovedFromSet(ProjectFileItem* file)
+void ProjectFileDataProvider::addFiles(QVector<ProjectFile>& files)
 {
-    ProjectFile item;
-    item.path = file->path();
-
-    // fast-path for non-generated files
-    // NOTE: figuring out whether something is generated is expensive... and since
-    // generated files are rare we apply this two-step algorithm here
-    auto it = std::lower_bound(m_projectFiles.begin(), m_projectFiles.end(), item);
-    if (it != m_projectFiles.end() && !(item < *it)) {
-        m_projectFiles.erase(it);
+    if (files.isEmpty()) {
         return;
     }
 
-    // last try: maybe it was generated
-    item.outsideOfProject = true;
-    it = std::lower_bound(m_projectFiles.begin(), m_projectFiles.end(), item);
-    if (it != m_projectFiles.end() && !(item < *it)) {
-        m_projectFiles.erase(it);
-        return;
-    }
+    // merging a sorted batch is much cheaper than inserting the files one by one
+    std::sort(files.begin(), files.end());
+    const int oldSize = m_projectFiles.size();
+    m_projectFiles += files;
+    std::inplace_merge(m_projectFiles.begin(), m_projectFiles.begin() + oldSize, m_projectFiles.end());
+
+    const auto logicalEnd = std::unique(m_projectFiles.begin(), m_projectFiles.end(),
+                                        [](const ProjectFile& left, const ProjectFile& right) {
+                                            return left.path == right.path;
+                                        });
+    m_projectFiles.erase(logicalEnd, m_projectFiles.end());
 }
 
 void ProjectFileDataProvider::reset()
@@ -343,13 +376,21 @@ void ProjectFileDataProvider::reset()
 QSet<IndexedString> ProjectFileDataProvider::files() const
 {
     QSet<IndexedString> ret;
+    const auto open = openFiles();
 
+    // the snapshots don't merge the pending changes of the projects' sets, unlike IProject::fileSet()
     const auto projects = ICore::self()->projectController()->projects();
     for (IProject* project : projects) {
-        ret += project->fileSet();
+        const auto projectFiles = project->fileSetSnapshot();
+        ret.reserve(ret.size() + projectFiles.size());
+        projectFiles.forEach([&ret, &open](const IndexedString& file) {
+            if (!open.contains(file)) {
+                ret.insert(file);
+            }
+        });
     }
 
-    return ret - openFiles();
+    return ret;
 }
 
 void OpenFilesDataProvider::reset()
@@ -28,6 +28,7 @@
 namespace KDevelop {
 class IProject;
 class ProjectFileItem;
+struct ProjectFileSetDelta;
 }
 
 /**
@@ -129,9 +130,12 @@ public:
 private Q_SLOTS:
     void projectClosing(KDevelop::IProject*);
     void projectOpened(KDevelop::IProject*);
-    void fileAddedToSet(KDevelop::ProjectFileItem*);
-    void fileRemovedFromSet(KDevelop::ProjectFileItem*);
 private:
+    void fileSetChanged(KDevelop::IProject* project, const KDevelop::ProjectFileSetDelta& delta);
+    void removeProjectFiles(const KDevelop::Path& projectPath);
+    /// Merges the sorted @p files into m_projectFiles
+    void addFiles(QVector<ProjectFile>& files);
+
     // project files sorted by their url
     // this is done so we can limit ourselves to a relatively fast
     // filtering without any expensive sorting in reset().
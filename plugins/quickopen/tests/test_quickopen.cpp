@@ -20,6 +20,7 @@
 
 #include "test_quickopen.h"
 #include <interfaces/idocumentcontroller.h>
+#include <project/projectfileset.h>
 
 #include <QTemporaryDir>
 #include <QTest>
@@ -376,8 +377,9 @@ void TestQuickOpen::testProjectFileFilter()
     QCOMPARE(provider.itemCount(), 6u);
 
     // ensure we don't add stuff multiple times
-    QMetaObject::invokeMethod(&provider, "fileAddedToSet",
-                              Q_ARG(KDevelop::ProjectFileItem*, blub));
+    ProjectFileSetDelta delta;
+    delta.added.append(blub->indexedPath());
+    emit project->fileSetChanged(delta);
     QCOMPARE(provider.itemCount(), 6u);
     provider.reset();
     QCOMPARE(provider.itemCount(), 6u);